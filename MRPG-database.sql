@@ -1522,6 +1522,7 @@ ALTER TABLE `tw_accounts_farming`
 --
 ALTER TABLE `tw_accounts_items`
   ADD PRIMARY KEY (`ID`),
+  ADD UNIQUE KEY `UserItem` (`UserID`,`ItemID`),
   ADD KEY `OwnerID` (`UserID`),
   ADD KEY `ItemID` (`ItemID`);
 
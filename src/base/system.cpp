@@ -152,6 +152,16 @@ typedef struct
 	struct iovec iovecs[VLEN];
 	char bufs[VLEN][PACKETSIZE];
 	char sockaddrs[VLEN][128];
+
+	/* packets queued by net_udp_batch_begin */
+	int batching;
+	int batch_syscalls;
+	int send_num;
+	int send_socks[VLEN];
+	struct mmsghdr send_msgs[VLEN];
+	struct iovec send_iovecs[VLEN];
+	char send_bufs[VLEN][PACKETSIZE];
+	char send_sockaddrs[VLEN][sizeof(struct sockaddr_in6)];
 #else
 	char buf[PACKETSIZE];
 #endif
@@ -1622,6 +1632,73 @@ NETSOCKET net_udp_create(NETADDR bindaddr)
 	return sock;
 }
 
+#if defined(CONF_PLATFORM_LINUX)
+static void priv_net_udp_send_queued(NETSOCKET_BUFFER *buffer)
+{
+	int pos = 0;
+	while(pos < buffer->send_num)
+	{
+		/* one sendmmsg for each run of packets going out over the same socket */
+		int end = pos + 1;
+		while(end < buffer->send_num && buffer->send_socks[end] == buffer->send_socks[pos])
+			end++;
+
+		while(pos < end)
+		{
+			int sent = sendmmsg(buffer->send_socks[pos], &buffer->send_msgs[pos], end - pos, 0);
+			buffer->batch_syscalls++;
+			network_stats.sent_syscalls++;
+
+			/* the packet that failed is dropped, like a failed sendto */
+			pos += sent > 0 ? sent : 1;
+		}
+	}
+	buffer->send_num = 0;
+}
+#endif
+
+static int priv_net_udp_sendto(NETSOCKET sock, int socket, const void *data, int size, const struct sockaddr *sa, socklen_t sa_len)
+{
+#if defined(CONF_PLATFORM_LINUX)
+	NETSOCKET_BUFFER *buffer = &sock->buffer;
+	if(buffer->batching && size <= PACKETSIZE && sa_len <= (socklen_t)sizeof(buffer->send_sockaddrs[0]))
+	{
+		if(buffer->send_num == VLEN)
+			priv_net_udp_send_queued(buffer);
+
+		int i = buffer->send_num++;
+		mem_copy(buffer->send_bufs[i], data, size);
+		mem_copy(buffer->send_sockaddrs[i], sa, sa_len);
+		buffer->send_socks[i] = socket;
+		buffer->send_iovecs[i].iov_len = size;
+		buffer->send_msgs[i].msg_hdr.msg_namelen = sa_len;
+		return size;
+	}
+#endif
+	network_stats.sent_syscalls++;
+	return sendto(socket, (const char *)data, size, 0, sa, sa_len);
+}
+
+void net_udp_batch_begin(NETSOCKET sock)
+{
+#if defined(CONF_PLATFORM_LINUX)
+	sock->buffer.batching = 1;
+#endif
+}
+
+int net_udp_batch_flush(NETSOCKET sock)
+{
+	int syscalls = 0;
+#if defined(CONF_PLATFORM_LINUX)
+	NETSOCKET_BUFFER *buffer = &sock->buffer;
+	priv_net_udp_send_queued(buffer);
+	syscalls = buffer->batch_syscalls;
+	buffer->batch_syscalls = 0;
+	buffer->batching = 0;
+#endif
+	return syscalls;
+}
+
 int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size)
 {
 	int d = -1;
@@ -1641,7 +1718,7 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 			else
 				netaddr_to_sockaddr_in(addr, &sa);
 
-			d = sendto((int)sock->ipv4sock, (const char *)data, size, 0, (struct sockaddr *)&sa, sizeof(sa));
+			d = priv_net_udp_sendto(sock, sock->ipv4sock, data, size, (struct sockaddr *)&sa, sizeof(sa));
 		}
 		else
 			dbg_msg("net", "can't send ipv4 traffic to this socket");
@@ -1679,7 +1756,7 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 			else
 				netaddr_to_sockaddr_in6(addr, &sa);
 
-			d = sendto((int)sock->ipv6sock, (const char *)data, size, 0, (struct sockaddr *)&sa, sizeof(sa));
+			d = priv_net_udp_sendto(sock, sock->ipv6sock, data, size, (struct sockaddr *)&sa, sizeof(sa));
 		}
 		else
 			dbg_msg("net", "can't send ipv6 traffic to this socket");
@@ -1723,6 +1800,19 @@ void net_buffer_init(NETSOCKET_BUFFER *buffer)
 		buffer->msgs[i].msg_hdr.msg_name = &(buffer->sockaddrs[i]);
 		buffer->msgs[i].msg_hdr.msg_namelen = sizeof(buffer->sockaddrs[i]);
 	}
+
+	buffer->batching = 0;
+	buffer->batch_syscalls = 0;
+	buffer->send_num = 0;
+	mem_zero(buffer->send_msgs, sizeof(buffer->send_msgs));
+	mem_zero(buffer->send_iovecs, sizeof(buffer->send_iovecs));
+	for(i = 0; i < VLEN; ++i)
+	{
+		buffer->send_iovecs[i].iov_base = buffer->send_bufs[i];
+		buffer->send_msgs[i].msg_hdr.msg_iov = &(buffer->send_iovecs[i]);
+		buffer->send_msgs[i].msg_hdr.msg_iovlen = 1;
+		buffer->send_msgs[i].msg_hdr.msg_name = &(buffer->send_sockaddrs[i]);
+	}
 #endif
 }
 
@@ -1759,6 +1849,7 @@ int net_udp_recv(NETSOCKET sock, NETADDR *addr, unsigned char **data)
 		{
 			net_buffer_reinit(&sock->buffer);
 			sock->buffer.size = recvmmsg(sock->ipv4sock, sock->buffer.msgs, VLEN, 0, NULL);
+			network_stats.recv_syscalls++;
 			sock->buffer.pos = 0;
 		}
 	}
@@ -1769,6 +1860,7 @@ int net_udp_recv(NETSOCKET sock, NETADDR *addr, unsigned char **data)
 		{
 			net_buffer_reinit(&sock->buffer);
 			sock->buffer.size = recvmmsg(sock->ipv6sock, sock->buffer.msgs, VLEN, 0, NULL);
+			network_stats.recv_syscalls++;
 			sock->buffer.pos = 0;
 		}
 	}
@@ -1788,6 +1880,7 @@ int net_udp_recv(NETSOCKET sock, NETADDR *addr, unsigned char **data)
 	{
 		socklen_t fromlen = sizeof(struct sockaddr_in);
 		bytes = recvfrom(sock->ipv4sock, sock->buffer.buf, sizeof(sock->buffer.buf), 0, (struct sockaddr *)&sockaddrbuf, &fromlen);
+		network_stats.recv_syscalls++;
 		*data = (unsigned char *)sock->buffer.buf;
 	}
 
@@ -1795,6 +1888,7 @@ int net_udp_recv(NETSOCKET sock, NETADDR *addr, unsigned char **data)
 	{
 		socklen_t fromlen = sizeof(struct sockaddr_in6);
 		bytes = recvfrom(sock->ipv6sock, sock->buffer.buf, sizeof(sock->buffer.buf), 0, (struct sockaddr *)&sockaddrbuf, &fromlen);
+		network_stats.recv_syscalls++;
 		*data = (unsigned char *)sock->buffer.buf;
 	}
 #endif
@@ -1827,6 +1921,7 @@ int net_udp_recv(NETSOCKET sock, NETADDR *addr, unsigned char **data)
 
 int net_udp_close(NETSOCKET sock)
 {
+	net_udp_batch_flush(sock);
 	return priv_net_close_all_sockets(sock);
 }
 
@@ -953,6 +953,30 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 */
 int net_udp_recv(NETSOCKET sock, NETADDR *addr, unsigned char **data);
 
+/**
+ * Queues the packets sent over an UDP socket until net_udp_batch_flush
+ * is called, so they leave with as few syscalls as possible.
+ *
+ * @ingroup Network-UDP
+ *
+ * @param sock Socket to batch the packets of.
+ *
+ * @remark Only has an effect on Linux, elsewhere packets are sent right away.
+ * @remark The socket must only be sent on by one thread while batching.
+ */
+void net_udp_batch_begin(NETSOCKET sock);
+
+/**
+ * Sends the packets queued since net_udp_batch_begin and stops batching.
+ *
+ * @ingroup Network-UDP
+ *
+ * @param sock Socket to flush.
+ *
+ * @return Number of syscalls used to send the packets.
+ */
+int net_udp_batch_flush(NETSOCKET sock);
+
 /**
  * Closes an UDP socket.
  *
@@ -2165,6 +2189,8 @@ typedef struct
 	uint64_t sent_bytes;
 	uint64_t recv_packets;
 	uint64_t recv_bytes;
+	uint64_t sent_syscalls;
+	uint64_t recv_syscalls;
 } NETSTATS;
 
 void net_stats(NETSTATS *stats);
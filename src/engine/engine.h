@@ -13,9 +13,6 @@ class IEngine : public IInterface
 {
 	MACRO_INTERFACE("engine", 0)
 
-protected:
-	class CJobPool m_JobPool;
-
 public:
 	virtual ~IEngine() = default;
 
@@ -213,6 +213,7 @@ public:
 
 	virtual void SetClientLanguage(int ClientID, const char* pLanguage) = 0;
 	virtual const char* GetClientLanguage(int ClientID) const = 0;
+	virtual int GetClientLanguageIndex(int ClientID) const = 0;
 
 	// discord
 	virtual void SendDiscordMessage(const char *pChannel, int Color, const char* pTitle, const char* pText) = 0;
@@ -229,6 +230,12 @@ public:
 	virtual void *SnapNewItem(int Type, int ID, int Size) = 0;
 	virtual void SnapSetStaticsize(int ItemType, int Size) = 0;
 
+	// items of the calling thread go to the cache instead of the snapshot until reset with nullptr
+	virtual void SnapSetCapture(class CSnapItemCache *pCache) = 0;
+
+	// the snapshots of the client did not fit lately, details far away may be left out
+	virtual bool SnapOverBudget(int ClientID) const = 0;
+
 	enum
 	{
 		RCON_CID_SERV=-1,
@@ -386,7 +386,7 @@ void DiscordCommands::RegisterCommand(DiscordJob* pDiscord, std::string CommandI
 			pDiscord->editGlobalAppCommand(g_Config.m_SvDiscordApplicationID, CommandID, pName, pDesc, Option);
 		else
 			pDiscord->createGlobalAppCommand(g_Config.m_SvDiscordApplicationID, pName, pDesc, Option);
-		sleep_pause(500); // pause for disable many requests to discord api
+		std::this_thread::sleep_for(std::chrono::milliseconds(500)); // pause for disable many requests to discord api
 	}
 	else
 	{
@@ -395,7 +395,7 @@ void DiscordCommands::RegisterCommand(DiscordJob* pDiscord, std::string CommandI
 			pDiscord->editGlobalAppCommand(g_Config.m_SvDiscordApplicationID, CommandID, pName, pDesc);
 		else
 			pDiscord->createGlobalAppCommand(g_Config.m_SvDiscordApplicationID, pName, pDesc);
-		sleep_pause(500); // pause for disable many requests to discord api
+		std::this_thread::sleep_for(std::chrono::milliseconds(500)); // pause for disable many requests to discord api
 	}
 }
 
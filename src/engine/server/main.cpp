@@ -101,7 +101,8 @@ int main(int argc, const char** argv)
 	IKernel* pKernel = IKernel::Create();
 
 	// create the components
-	IEngine* pEngine = CreateEngine("MRPG", pFutureConsoleLogger, 2 * std::thread::hardware_concurrency() + 2);
+	// scheduler workers, the two extra ones cover blocking io tasks
+	IEngine* pEngine = CreateEngine("MRPG", pFutureConsoleLogger, std::thread::hardware_concurrency() + 2);
 	IConsole* pConsole = CreateConsole(CFGFLAG_SERVER | CFGFLAG_ECON).release();
 	IStorageEngine* pStorage = CreateStorage(IStorageEngine::STORAGETYPE_SERVER, argc, argv);
 	IConfigManager* pConfigManager = CreateConfigManager();
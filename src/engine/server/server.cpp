@@ -1,5 +1,6 @@
 ﻿/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <condition_variable>
 #include <cstdint>
 
 #include <base/logger.h>
@@ -20,6 +21,8 @@
 #include <engine/shared/packer.h>
 #include <engine/shared/protocol.h>
 #include <engine/shared/protocol_ex.h>
+#include <engine/shared/scheduler.h>
+#include <engine/shared/snap_item_cache.h>
 #include <engine/shared/snapshot.h>
 #include <mastersrv/mastersrv.h>
 #include "snapshot_ids_pool.h"
@@ -39,6 +42,10 @@
 #include "server_ban.h"
 #include "server_logger.h"
 
+// world being ticked by the current thread while worlds run in parallel, -1 otherwise
+static thread_local int gs_TickWorldID = -1;
+static thread_local CSnapItemCache* gs_pSnapCapture = nullptr;
+
 void CServer::CClient::Reset()
 {
 	// reset input
@@ -51,6 +58,9 @@ void CServer::CClient::Reset()
 	m_LastAckedSnapshot = -1;
 	m_LastInputTick = -1;
 	m_SnapRate = SNAPRATE_INIT;
+	m_SnapDroppedItems = 0;
+	m_SnapOverBudget = 0;
+	m_SnapLodUntilTick = 0;
 	m_Score = -1;
 	m_NextMapChunk = 0;
 	m_aBlockedInputKeys = 0;
@@ -304,6 +314,7 @@ void CServer::SetClientLanguage(int ClientID, const char* pLanguage)
 		return;
 
 	str_copy(m_aClients[ClientID].m_aLanguage, pLanguage, sizeof(m_aClients[ClientID].m_aLanguage));
+	m_aClients[ClientID].m_LanguageIndex = Localization()->GetLanguageIndex(pLanguage);
 }
 
 bool CServer::IsClientChangesWorld(int ClientID)
@@ -334,8 +345,23 @@ const char* CServer::GetClientLanguage(int ClientID) const
 	return m_aClients[ClientID].m_aLanguage;
 }
 
+int CServer::GetClientLanguageIndex(int ClientID) const
+{
+	if(ClientID < 0 || ClientID >= MAX_CLIENTS || m_aClients[ClientID].m_State < CClient::STATE_READY)
+		return -1;
+	return m_aClients[ClientID].m_LanguageIndex;
+}
+
 void CServer::ChangeWorld(int ClientID, int NewWorldID)
 {
+	// worlds are running in parallel, move the client after the tick barrier
+	if(gs_TickWorldID != -1)
+	{
+		std::lock_guard Lock(m_DeferredLock);
+		m_vDeferredChangeWorld.emplace_back(ClientID, NewWorldID);
+		return;
+	}
+
 	if(ClientID < 0 || ClientID >= MAX_PLAYERS || NewWorldID == m_aClients[ClientID].m_WorldID || !MultiWorlds()->IsValid(NewWorldID) || m_aClients[ClientID].m_State < CClient::STATE_READY)
 		return;
 
@@ -409,6 +435,14 @@ std::string CServer::EscapeDiscordMarkdown(const std::string& input)
 
 void CServer::Kick(int ClientID, const char* pReason)
 {
+	// dropping a client calls back into its world, wait for the tick barrier
+	if(gs_TickWorldID != -1)
+	{
+		std::lock_guard Lock(m_DeferredLock);
+		m_vDeferredKick.emplace_back(ClientID, pReason ? pReason : "");
+		return;
+	}
+
 	if(ClientID < 0 || ClientID >= MAX_PLAYERS || m_aClients[ClientID].m_State == CClient::STATE_EMPTY)
 	{
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", "invalid client id to kick");
@@ -452,6 +486,7 @@ int CServer::Init()
 	for(int i = 0; i < MAX_PLAYERS; i++)
 	{
 		str_copy(m_aClients[i].m_aLanguage, "en", sizeof(m_aClients[i].m_aLanguage));
+		m_aClients[i].m_LanguageIndex = -1;
 		m_aClients[i].m_State = CClient::STATE_EMPTY;
 		m_aClients[i].m_aName[0] = 0;
 		m_aClients[i].m_aClan[0] = 0;
@@ -712,13 +747,13 @@ int CServer::SendMsg(CMsgPacker* pMsg, int Flags, int ClientID, int64_t Mask, in
 						if(m_aClients[i].m_WorldID == WorldID)
 						{
 							Packet.m_ClientID = i;
-							m_NetServer.Send(&Packet);
+							NetSend(&Packet);
 						}
 						continue;
 					}
 
 					Packet.m_ClientID = i;
-					m_NetServer.Send(&Packet);
+					NetSend(&Packet);
 				}
 			}
 		}
@@ -733,15 +768,140 @@ int CServer::SendMsg(CMsgPacker* pMsg, int Flags, int ClientID, int64_t Mask, in
 			Packet.m_DataSize = Pack.Size();
 
 			if(!(Flags & MSGFLAG_NOSEND))
-				m_NetServer.Send(&Packet);
+				NetSend(&Packet);
 		}
 	}
 	return 0;
 }
 
+void CServer::NetSend(CNetChunk* pChunk)
+{
+	if(gs_TickWorldID == -1)
+	{
+		m_NetServer.Send(pChunk);
+		return;
+	}
+
+	// copy the packet, the outbox is flushed in world order after the barrier
+	CWorldOutbox& Outbox = m_aWorldOutbox[gs_TickWorldID];
+	const int Offset = (int)Outbox.m_vData.size();
+	const auto* pData = static_cast<const unsigned char*>(pChunk->m_pData);
+	Outbox.m_vData.insert(Outbox.m_vData.end(), pData, pData + pChunk->m_DataSize);
+	Outbox.m_vPackets.push_back({ pChunk->m_ClientID, pChunk->m_Flags, Offset, pChunk->m_DataSize });
+}
+
+CSnapshotBuilder* CServer::CurrentSnapshotBuilder()
+{
+	if(gs_TickWorldID == -1)
+		return &m_SnapshotBuilder;
+
+	// each world builds its snapshots on its own builder while in parallel
+	auto& pBuilder = m_apWorldSnapshotBuilder[gs_TickWorldID];
+	if(!pBuilder)
+		pBuilder = std::make_unique<CSnapshotBuilder>();
+	return pBuilder.get();
+}
+
+void CServer::UpdateWorldTickPool()
+{
+	int NumThreads = 0;
+	if(g_Config.m_SvParallelWorlds)
+	{
+		// the tick thread takes part in the batch
+		NumThreads = g_Config.m_SvParallelWorldsThreads ? g_Config.m_SvParallelWorldsThreads : (int)std::thread::hardware_concurrency() - 1;
+		NumThreads = clamp(NumThreads, 0, MultiWorlds()->GetSizeInitilized() - 1);
+	}
+
+	if(NumThreads != m_WorldTickPool.NumThreads())
+		m_WorldTickPool.Start(NumThreads);
+}
+
+void CServer::RunWorlds(bool Snapshot)
+{
+	const int NumWorlds = MultiWorlds()->GetSizeInitilized();
+	UpdateWorldTickPool();
+
+	if(!Snapshot)
+		MultiWorlds()->GetWorld(MAIN_WORLD_ID)->m_pGameServer->OnTickGlobal();
+
+	const int64_t StartTime = time_get_impl();
+
+	if(m_WorldTickPool.NumThreads() == 0)
+	{
+		for(int i = 0; i < NumWorlds; i++)
+		{
+			const int64_t WorldStartTime = time_get_impl();
+			if(Snapshot)
+				DoSnapshot(i);
+			else
+				MultiWorlds()->GetWorld(i)->m_pGameServer->OnTick();
+			m_WorldTickStats.m_aWorldTime[i] += time_get_impl() - WorldStartTime;
+		}
+	}
+	else
+	{
+		m_WorldTickPool.Run(NumWorlds, [this, Snapshot](int WorldID)
+		{
+			const int64_t WorldStartTime = time_get_impl();
+			gs_TickWorldID = WorldID;
+			if(Snapshot)
+				DoSnapshot(WorldID);
+			else
+				MultiWorlds()->GetWorld(WorldID)->m_pGameServer->OnTick();
+			gs_TickWorldID = -1;
+			m_WorldTickStats.m_aWorldTime[WorldID] += time_get_impl() - WorldStartTime;
+		});
+
+		// barrier passed, deliver everything the worlds produced in a stable order
+		for(int i = 0; i < NumWorlds; i++)
+		{
+			CWorldOutbox& Outbox = m_aWorldOutbox[i];
+			for(const auto& Deferred : Outbox.m_vPackets)
+			{
+				CNetChunk Packet {};
+				Packet.m_ClientID = Deferred.m_ClientID;
+				Packet.m_Flags = Deferred.m_Flags;
+				Packet.m_pData = Outbox.m_vData.data() + Deferred.m_Offset;
+				Packet.m_DataSize = Deferred.m_Size;
+				m_NetServer.Send(&Packet);
+			}
+			Outbox.m_vPackets.clear();
+			Outbox.m_vData.clear();
+		}
+		ApplyDeferredWorldActions();
+	}
+
+	const int64_t WallTime = time_get_impl() - StartTime;
+	m_WorldTickStats.m_WallTime += WallTime;
+	m_WorldTickStats.m_MaxWallTime = maximum(m_WorldTickStats.m_MaxWallTime, WallTime);
+	if(!Snapshot)
+		m_WorldTickStats.m_Ticks++;
+}
+
+void CServer::ApplyDeferredWorldActions()
+{
+	std::vector<std::pair<int, int>> vChangeWorld;
+	std::vector<std::pair<int, std::string>> vKick;
+	{
+		std::lock_guard Lock(m_DeferredLock);
+		vChangeWorld.swap(m_vDeferredChangeWorld);
+		vKick.swap(m_vDeferredKick);
+	}
+
+	for(const auto& [ClientID, WorldID] : vChangeWorld)
+		ChangeWorld(ClientID, WorldID);
+	for(const auto& [ClientID, Reason] : vKick)
+		Kick(ClientID, Reason.c_str());
+}
+
 void CServer::DoSnapshot(int WorldID)
 {
+	// the jobs of the last tick are reused, so their buffers are not allocated again
+	std::vector<CSnapJob>& vJobs = m_avSnapJobs[WorldID];
+	int NumJobs = 0;
+
 	GameServer(WorldID)->OnPreSnap();
+	const int64_t BuildStart = time_get_impl();
 	for(int i = 0; i < MAX_PLAYERS; i++)
 	{
 		// client must be ingame to recive snapshots
@@ -756,89 +916,186 @@ void CServer::DoSnapshot(int WorldID)
 		if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_INIT && (Tick() % 10) != 0)
 			continue;
 
+		CSnapshotBuilder* pBuilder = CurrentSnapshotBuilder();
+		pBuilder->Init();
+
+		GameServer(WorldID)->OnSnap(i);
+
+		// finish snapshot
+		char aData[CSnapshot::MAX_SIZE];
+		CSnapshot* pData = (CSnapshot*)aData; // Fix compiler warning for strict-aliasing
+		const int SnapshotSize = pBuilder->Finish(pData);
+
+		// the game adds the most important items first, these are the least important ones
+		if(const int Dropped = pBuilder->NumDropped())
 		{
-			m_SnapshotBuilder.Init();
+			m_aClients[i].m_SnapDroppedItems += Dropped;
+			m_aClients[i].m_SnapOverBudget++;
+			m_aClients[i].m_SnapLodUntilTick = m_CurrentGameTick + SERVER_TICK_SPEED;
+		}
 
-			GameServer(WorldID)->OnSnap(i);
+		// remove old snapshots
+		// keep 3 seconds worth of snapshots
+		m_aClients[i].m_Snapshots.PurgeUntil(m_CurrentGameTick - SERVER_TICK_SPEED * 3);
 
-			// finish snapshot
-			char aData[CSnapshot::MAX_SIZE];
-			CSnapshot* pData = (CSnapshot*)aData; // Fix compiler warning for strict-aliasing
-			int SnapshotSize = m_SnapshotBuilder.Finish(pData);
-			const unsigned Crc = pData->Crc();
+		// save the snapshot, the delta is made from the stored copy
+		m_aClients[i].m_Snapshots.Add(m_CurrentGameTick, time_get(), SnapshotSize, pData, 0, nullptr);
 
-			// remove old snapshots
-			// keep 3 seconds worth of snapshots
-			m_aClients[i].m_Snapshots.PurgeUntil(m_CurrentGameTick - SERVER_TICK_SPEED * 3);
+		if(NumJobs == (int)vJobs.size())
+			vJobs.emplace_back();
+		CSnapJob& Job = vJobs[NumJobs++];
+		Job.m_ClientID = i;
+		Job.m_pSnap = m_aClients[i].m_Snapshots.m_pLast->m_pSnap;
+		Job.m_Crc = pData->Crc();
+	}
+	GameServer(WorldID)->OnPostSnap();
 
-			// save the snapshot
-			m_aClients[i].m_Snapshots.Add(m_CurrentGameTick, time_get(), SnapshotSize, pData, 0, nullptr);
+	const int64_t EncodeStart = time_get_impl();
+	EncodeSnapshots(vJobs.data(), NumJobs);
 
-			// find snapshot that we can perform delta against
-			int DeltaTick = -1;
-			const CSnapshot* pDeltashot = CSnapshot::EmptySnapshot();
-			{
-				int DeltashotSize = m_aClients[i].m_Snapshots.Get(m_aClients[i].m_LastAckedSnapshot, 0, &pDeltashot, 0);
-				if(DeltashotSize >= 0)
-					DeltaTick = m_aClients[i].m_LastAckedSnapshot;
-				else
-				{
-					// no acked package found, force client to recover rate
-					if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_FULL)
-						m_aClients[i].m_SnapRate = CClient::SNAPRATE_RECOVER;
-				}
-			}
+	// packets go out in client order no matter which thread encoded them
+	const int64_t SendStart = time_get_impl();
+	for(int i = 0; i < NumJobs; i++)
+		SendSnapshot(vJobs[i], WorldID);
 
-			// create delta
-			char aDeltaData[CSnapshot::MAX_SIZE];
-			if(int DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData))
-			{
-				// compress it
-				constexpr int MaxSize = MAX_SNAPSHOT_PACKSIZE;
+	m_SnapStageStats.m_Snapshots += NumJobs;
+	m_SnapStageStats.m_Build += EncodeStart - BuildStart;
+	m_SnapStageStats.m_Encode += SendStart - EncodeStart;
+	m_SnapStageStats.m_Send += time_get_impl() - SendStart;
+}
 
-				char aCompData[CSnapshot::MAX_SIZE];
-				SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
-				const int NumPackets = (SnapshotSize + MaxSize - 1) / MaxSize;
+void CServer::EncodeSnapshots(CSnapJob* pJobs, int NumJobs)
+{
+	if(NumJobs <= 0)
+		return;
 
-				for(int n = 0, Left = SnapshotSize; Left > 0; n++)
-				{
-					int Chunk = Left < MaxSize ? Left : MaxSize;
-					Left -= Chunk;
+	// helpers may start after the tick went on, they only touch the jobs they claimed
+	struct CEncodeState
+	{
+		CSnapJob* m_pJobs;
+		int m_NumJobs;
+		std::atomic<int> m_NextJob {};
+		std::atomic<int> m_Encoded {};
+		std::mutex m_Lock;
+		std::condition_variable m_Done;
+	};
+	const auto pState = std::make_shared<CEncodeState>();
+	pState->m_pJobs = pJobs;
+	pState->m_NumJobs = NumJobs;
 
-					if(NumPackets == 1)
-					{
-						CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
-						Msg.AddInt(m_CurrentGameTick);
-						Msg.AddInt(m_CurrentGameTick - DeltaTick);
-						Msg.AddInt(Crc);
-						Msg.AddInt(Chunk);
-						Msg.AddRaw(&aCompData[n * MaxSize], Chunk);
-						SendMsg(&Msg, MSGFLAG_FLUSH, i, -1, WorldID);
-					}
-					else
-					{
-						CMsgPacker Msg(NETMSG_SNAP, true);
-						Msg.AddInt(m_CurrentGameTick);
-						Msg.AddInt(m_CurrentGameTick - DeltaTick);
-						Msg.AddInt(NumPackets);
-						Msg.AddInt(n);
-						Msg.AddInt(Crc);
-						Msg.AddInt(Chunk);
-						Msg.AddRaw(&aCompData[n * MaxSize], Chunk);
-						SendMsg(&Msg, MSGFLAG_FLUSH, i, -1, WorldID);
-					}
-				}
-			}
-			else
+	const auto Work = [this, pState]()
+	{
+		for(int i; (i = pState->m_NextJob++) < pState->m_NumJobs;)
+		{
+			EncodeSnapshot(pState->m_pJobs[i]);
+			if(++pState->m_Encoded == pState->m_NumJobs)
 			{
-				CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
-				Msg.AddInt(m_CurrentGameTick);
-				Msg.AddInt(m_CurrentGameTick - DeltaTick);
-				SendMsg(&Msg, MSGFLAG_FLUSH, i, -1, WorldID);
+				std::lock_guard Lock(pState->m_Lock);
+				pState->m_Done.notify_one();
 			}
 		}
+	};
+
+	// the calling thread works along, the helpers only take what is left
+	const int NumHelpers = g_Config.m_SvParallelSnapshots ? minimum(CScheduler::Get().NumThreads(), pState->m_NumJobs - 1) : 0;
+	for(int i = 0; i < NumHelpers; i++)
+		CScheduler::Get().Add(CScheduler::PRIORITY_TICK, Work);
+	Work();
+
+	// wait for the jobs still encoded by helpers, not for helpers that never started
+	std::unique_lock Lock(pState->m_Lock);
+	pState->m_Done.wait(Lock, [&]() { return pState->m_Encoded == pState->m_NumJobs; });
+}
+
+void CServer::EncodeSnapshot(CSnapJob& Job)
+{
+	// scratch space of the worker, too big for the stack of every thread
+	static thread_local std::unique_ptr<char[]> s_pDeltaData;
+	static thread_local std::unique_ptr<char[]> s_pCompressData;
+	if(!s_pDeltaData)
+	{
+		s_pDeltaData = std::make_unique<char[]>(CSnapshot::MAX_SIZE);
+		s_pCompressData = std::make_unique<char[]>(CSnapshot::MAX_SIZE);
+	}
+
+	CClient& Client = m_aClients[Job.m_ClientID];
+
+	// find snapshot that we can perform delta against
+	const int64_t DeltaStart = time_get_impl();
+	Job.m_DeltaTick = -1;
+	const CSnapshot* pDeltashot = CSnapshot::EmptySnapshot();
+	const CSnapshotDelta::CKeyHash* pDeltaHash = nullptr;
+	{
+		int DeltashotSize = Client.m_Snapshots.Get(Client.m_LastAckedSnapshot, 0, &pDeltashot, 0, &pDeltaHash);
+		if(DeltashotSize >= 0)
+			Job.m_DeltaTick = Client.m_LastAckedSnapshot;
+		else
+		{
+			// no acked package found, force client to recover rate
+			if(Client.m_SnapRate == CClient::SNAPRATE_FULL)
+				Client.m_SnapRate = CClient::SNAPRATE_RECOVER;
+		}
+	}
+
+	// create delta
+	const int DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, Job.m_pSnap, s_pDeltaData.get(), pDeltaHash);
+	const int64_t CompressStart = time_get_impl();
+	m_SnapStageStats.m_Delta += CompressStart - DeltaStart;
+
+	// compress it
+	Job.m_Size = 0;
+	if(DeltaSize)
+	{
+		// only the compressed bytes are kept for the send
+		Job.m_Size = CVariableInt::Compress(s_pDeltaData.get(), DeltaSize, s_pCompressData.get(), CSnapshot::MAX_SIZE);
+		if(Job.m_Size > 0)
+			Job.m_vData.assign(s_pCompressData.get(), s_pCompressData.get() + Job.m_Size);
+		m_SnapStageStats.m_Compress += time_get_impl() - CompressStart;
+	}
+}
+
+void CServer::SendSnapshot(const CSnapJob& Job, int WorldID)
+{
+	const int ClientID = Job.m_ClientID;
+	if(Job.m_Size <= 0)
+	{
+		CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
+		Msg.AddInt(m_CurrentGameTick);
+		Msg.AddInt(m_CurrentGameTick - Job.m_DeltaTick);
+		SendMsg(&Msg, MSGFLAG_FLUSH, ClientID, -1, WorldID);
+		return;
+	}
+
+	constexpr int MaxSize = MAX_SNAPSHOT_PACKSIZE;
+	const int NumPackets = (Job.m_Size + MaxSize - 1) / MaxSize;
+	for(int n = 0, Left = Job.m_Size; Left > 0; n++)
+	{
+		int Chunk = Left < MaxSize ? Left : MaxSize;
+		Left -= Chunk;
+
+		if(NumPackets == 1)
+		{
+			CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
+			Msg.AddInt(m_CurrentGameTick);
+			Msg.AddInt(m_CurrentGameTick - Job.m_DeltaTick);
+			Msg.AddInt(Job.m_Crc);
+			Msg.AddInt(Chunk);
+			Msg.AddRaw(&Job.m_vData[n * MaxSize], Chunk);
+			SendMsg(&Msg, MSGFLAG_FLUSH, ClientID, -1, WorldID);
+		}
+		else
+		{
+			CMsgPacker Msg(NETMSG_SNAP, true);
+			Msg.AddInt(m_CurrentGameTick);
+			Msg.AddInt(m_CurrentGameTick - Job.m_DeltaTick);
+			Msg.AddInt(NumPackets);
+			Msg.AddInt(n);
+			Msg.AddInt(Job.m_Crc);
+			Msg.AddInt(Chunk);
+			Msg.AddRaw(&Job.m_vData[n * MaxSize], Chunk);
+			SendMsg(&Msg, MSGFLAG_FLUSH, ClientID, -1, WorldID);
+		}
 	}
-	GameServer(WorldID)->OnPostSnap();
 }
 
 
@@ -889,6 +1146,7 @@ int CServer::NewClientCallback(int ClientID, void* pUser)
 
 	pThis->GameServer(MAIN_WORLD_ID)->ClearClientData(ClientID);
 	str_copy(pThis->m_aClients[ClientID].m_aLanguage, "en", sizeof(pThis->m_aClients[ClientID].m_aLanguage));
+	pThis->m_aClients[ClientID].m_LanguageIndex = -1;
 	pThis->m_aClients[ClientID].m_State = CClient::STATE_AUTH;
 	pThis->m_aClients[ClientID].m_aName[0] = 0;
 	pThis->m_aClients[ClientID].m_aClan[0] = 0;
@@ -2083,12 +2341,8 @@ int CServer::Run(ILogger* pLogger)
 					}
 				}
 
-				MultiWorlds()->GetWorld(MAIN_WORLD_ID)->m_pGameServer->OnTickGlobal();
-				for(int i = 0; i < MultiWorlds()->GetSizeInitilized(); i++)
-				{
-					IGameServer* pGameServer = MultiWorlds()->GetWorld(i)->m_pGameServer;
-					pGameServer->OnTick();
-				}
+				// global tick runs alone, then every world ticks (in parallel with sv_parallel_worlds)
+				RunWorlds(false);
 			}
 
 			if(NewTicks)
@@ -2168,9 +2422,19 @@ int CServer::Run(ILogger* pLogger)
 					// check if the server has high bandwidth or if the current game tick is even
 					if(g_Config.m_SvHighBandwidth || (m_CurrentGameTick % 2) == 0)
 					{
-						// perform a snapshot
-						for(int i = 0; i < MultiWorlds()->GetSizeInitilized(); i++)
-							DoSnapshot(i);
+						// perform a snapshot, the packets of all clients leave together after it
+						NETSTATS Before;
+						net_stats(&Before);
+						if(g_Config.m_SvBatchSend)
+							m_NetServer.BeginBatch();
+						RunWorlds(true);
+						m_NetServer.FlushBatch();
+
+						NETSTATS After;
+						net_stats(&After);
+						m_NetSyscallStats.m_SnapRounds++;
+						m_NetSyscallStats.m_SnapPackets += After.sent_packets - Before.sent_packets;
+						m_NetSyscallStats.m_SnapSyscalls += After.sent_syscalls - Before.sent_syscalls;
 					}
 
 					// Loop through all players
@@ -2289,6 +2553,120 @@ void CServer::ConStatus(IConsole::IResult* pResult, void* pUser)
 	}
 }
 
+// Display the state of the asynchronous SQL executor
+void CServer::ConSqlStatus(IConsole::IResult* pResult, void* pUser)
+{
+	char aBuf[256];
+	CServer* pThis = static_cast<CServer*>(pUser);
+	const CConectionPool::CExecutorStats Stats = Database->GetExecutorStats();
+
+	str_format(aBuf, sizeof(aBuf), "workers=%d pending=%d peak=%d queue_size=%d", Stats.m_Workers, Stats.m_Pending, Stats.m_PendingPeak, g_Config.m_SvMySqlQueueSize);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "sql", aBuf);
+	str_format(aBuf, sizeof(aBuf), "executed=%llu failed=%llu stalls=%llu stalled=%llums overflows=%llu", (unsigned long long)Stats.m_Executed,
+		(unsigned long long)Stats.m_Failed, (unsigned long long)Stats.m_Stalls, (unsigned long long)Stats.m_StallMilliseconds, (unsigned long long)Stats.m_Overflows);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "sql", aBuf);
+}
+
+void CServer::ConWorldTickStats(IConsole::IResult* pResult, void* pUser)
+{
+	char aBuf[256];
+	CServer* pThis = static_cast<CServer*>(pUser);
+	CWorldTickStats& Stats = pThis->m_WorldTickStats;
+	const int NumWorlds = pThis->MultiWorlds()->GetSizeInitilized();
+	const int Ticks = maximum(Stats.m_Ticks, 1);
+
+	// sum of the worlds is what a serial tick would cost, wall is what the tick actually took
+	int64_t WorldTime = 0;
+	for(int i = 0; i < NumWorlds; i++)
+		WorldTime += Stats.m_aWorldTime[i];
+	const double FreqMs = time_freq() / 1000.0;
+	const double WallMs = (double)Stats.m_WallTime / Ticks / FreqMs;
+	const double WorldsMs = (double)WorldTime / Ticks / FreqMs;
+
+	str_format(aBuf, sizeof(aBuf), "worlds=%d threads=%d ticks=%d wall=%.3fms worlds_sum=%.3fms max=%.3fms speedup=%.2fx", NumWorlds, pThis->m_WorldTickPool.NumThreads(), Stats.m_Ticks,
+		WallMs, WorldsMs, (double)Stats.m_MaxWallTime / FreqMs, WallMs > 0.0 ? WorldsMs / WallMs : 1.0);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "worlds", aBuf);
+	for(int i = 0; i < NumWorlds; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "  %d %s: %.3fms", i, pThis->GetWorldName(i), (double)Stats.m_aWorldTime[i] / Ticks / FreqMs);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "worlds", aBuf);
+	}
+
+	// each call starts a new measurement window
+	Stats = {};
+}
+
+void CServer::ConSnapStageStats(IConsole::IResult* pResult, void* pUser)
+{
+	char aBuf[256];
+	CServer* pThis = static_cast<CServer*>(pUser);
+	CSnapStageStats& Stats = pThis->m_SnapStageStats;
+	const int Snapshots = maximum(Stats.m_Snapshots.load(), 1);
+
+	// build, encode and send are wall time per world, delta and compress add up all threads
+	const double FreqUs = time_freq() / 1000000.0;
+	str_format(aBuf, sizeof(aBuf), "snapshots=%d threads=%d per snapshot: build=%.2fus encode=%.2fus (delta=%.2fus compress=%.2fus) send=%.2fus",
+		Stats.m_Snapshots.load(), g_Config.m_SvParallelSnapshots ? CScheduler::Get().NumThreads() : 0,
+		Stats.m_Build / FreqUs / Snapshots, Stats.m_Encode / FreqUs / Snapshots, Stats.m_Delta / FreqUs / Snapshots,
+		Stats.m_Compress / FreqUs / Snapshots, Stats.m_Send / FreqUs / Snapshots);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "snapshots", aBuf);
+
+	Stats.m_Snapshots = 0;
+	Stats.m_Build = 0;
+	Stats.m_Encode = 0;
+	Stats.m_Delta = 0;
+	Stats.m_Compress = 0;
+	Stats.m_Send = 0;
+}
+
+void CServer::ConSnapBudgetStats(IConsole::IResult* pResult, void* pUser)
+{
+	char aBuf[256];
+	CServer* pThis = static_cast<CServer*>(pUser);
+	int NumClients = 0;
+	for(int i = 0; i < MAX_PLAYERS; i++)
+	{
+		CClient& Client = pThis->m_aClients[i];
+		if(Client.m_SnapOverBudget)
+		{
+			str_format(aBuf, sizeof(aBuf), "  %d %s: %d snapshots over budget, %d items dropped", i, pThis->ClientName(i), Client.m_SnapOverBudget, Client.m_SnapDroppedItems);
+			pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "snapshots", aBuf);
+			NumClients++;
+		}
+
+		// each call starts a new measurement window
+		Client.m_SnapDroppedItems = 0;
+		Client.m_SnapOverBudget = 0;
+	}
+
+	str_format(aBuf, sizeof(aBuf), "%d clients went over the snapshot item budget", NumClients);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "snapshots", aBuf);
+}
+
+void CServer::ConNetSyscallStats(IConsole::IResult* pResult, void* pUser)
+{
+	char aBuf[256];
+	CServer* pThis = static_cast<CServer*>(pUser);
+	CNetSyscallStats& Stats = pThis->m_NetSyscallStats;
+
+	NETSTATS Now;
+	net_stats(&Now);
+	const double Ticks = maximum(pThis->Tick() - Stats.m_StartTick, 1);
+	const double Rounds = maximum(Stats.m_SnapRounds, 1);
+	str_format(aBuf, sizeof(aBuf), "ticks=%d per tick: send=%.1f syscalls (%.1f packets) recv=%.1f syscalls (%.1f packets)",
+		(int)Ticks, (Now.sent_syscalls - Stats.m_Start.sent_syscalls) / Ticks, (Now.sent_packets - Stats.m_Start.sent_packets) / Ticks,
+		(Now.recv_syscalls - Stats.m_Start.recv_syscalls) / Ticks, (Now.recv_packets - Stats.m_Start.recv_packets) / Ticks);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net", aBuf);
+	str_format(aBuf, sizeof(aBuf), "snapshots=%d per snapshot: %.1f syscalls (%.1f packets)", Stats.m_SnapRounds,
+		Stats.m_SnapSyscalls / Rounds, Stats.m_SnapPackets / Rounds);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net", aBuf);
+
+	// each call starts a new measurement window
+	Stats = {};
+	Stats.m_StartTick = pThis->Tick();
+	Stats.m_Start = Now;
+}
+
 // Shutdown the server
 void CServer::ConShutdown(IConsole::IResult* pResult, void* pUser)
 {
@@ -2468,6 +2846,11 @@ void CServer::RegisterCommands()
 	Console()->Register("shutdown", "", CFGFLAG_SERVER, ConShutdown, this, "Shut down");
 	Console()->Register("reload", "", CFGFLAG_SERVER, ConReload, this, "Reload maps and synchronize data with the database");
 	Console()->Register("logout", "", CFGFLAG_SERVER, ConLogout, this, "Logout of rcon");
+	Console()->Register("sql_status", "", CFGFLAG_SERVER, ConSqlStatus, this, "Show asynchronous SQL executor statistics");
+	Console()->Register("world_tick_stats", "", CFGFLAG_SERVER, ConWorldTickStats, this, "Show tick time per world since the last call and reset it");
+	Console()->Register("snap_stage_stats", "", CFGFLAG_SERVER, ConSnapStageStats, this, "Show snapshot time per stage since the last call and reset it");
+	Console()->Register("snap_budget_stats", "", CFGFLAG_SERVER, ConSnapBudgetStats, this, "Show clients whose snapshots dropped items since the last call and reset it");
+	Console()->Register("net_syscall_stats", "", CFGFLAG_SERVER, ConNetSyscallStats, this, "Show the network syscalls per tick since the last call and reset them");
 
 	// Chain console commands
 	Console()->Chain("sv_name", ConchainSpecialInfoupdate, this);
@@ -2505,7 +2888,8 @@ void CServer::InitClientBot(int ClientID)
 // Function to get a new ID from the ID pool
 int CServer::SnapNewID()
 {
-	// Return a new ID from the ID pool
+	// Return a new ID from the ID pool, worlds may share it from several threads
+	std::lock_guard Lock(m_IDPoolLock);
 	return m_IDPool.NewID();
 }
 
@@ -2513,6 +2897,7 @@ int CServer::SnapNewID()
 void CServer::SnapFreeID(int ID)
 {
 	// Free the specified ID in the ID pool
+	std::lock_guard Lock(m_IDPoolLock);
 	m_IDPool.FreeID(ID);
 }
 
@@ -2526,8 +2911,23 @@ void* CServer::SnapNewItem(int Type, int ID, int Size)
 	if(ID < 0)
 		return nullptr;
 
+	// Shared items of a world are serialised into its cache once per tick
+	if(gs_pSnapCapture)
+		return gs_pSnapCapture->NewItem(Type, ID, Size);
+
 	// Create a new item in the snapshot builder with the specified type, ID, and size
-	return m_SnapshotBuilder.NewItem(Type, ID, Size);
+	return CurrentSnapshotBuilder()->NewItem(Type, ID, Size);
+}
+
+void CServer::SnapSetCapture(CSnapItemCache* pCache)
+{
+	gs_pSnapCapture = pCache;
+}
+
+bool CServer::SnapOverBudget(int ClientID) const
+{
+	// a second after the last snapshot that did not fit
+	return ClientID >= 0 && ClientID < MAX_CLIENTS && m_CurrentGameTick < m_aClients[ClientID].m_SnapLodUntilTick;
 }
 
 // It sets the static size of a snapshot item
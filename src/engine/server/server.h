@@ -14,6 +14,13 @@
 
 #include "cache.h"
 #include "snapshot_ids_pool.h"
+#include "world_tick_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 class CServer : public IServer
 {
@@ -77,6 +84,11 @@ public:
 		int m_LastInputTick;
 		CSnapshotStorage m_Snapshots;
 
+		// snapshot items that did not fit, since the last snap_budget_stats
+		int m_SnapDroppedItems {};
+		int m_SnapOverBudget {};
+		int m_SnapLodUntilTick {}; // details far away are left out until then
+
 		CInput m_LatestInput;
 		CInput m_aInputs[200]; // TODO: handle input better
 		int m_CurrentInput;
@@ -87,6 +99,7 @@ public:
 
 		char m_aClan[MAX_CLAN_LENGTH];
 		char m_aLanguage[MAX_LANGUAGE_LENGTH];
+		int m_LanguageIndex;
 		int64_t m_aActionEventKeys;
 		int64_t m_aBlockedInputKeys;
 
@@ -123,6 +136,66 @@ public:
 	CSnapshotDelta m_SnapshotDelta;
 	CSnapshotBuilder m_SnapshotBuilder;
 	CSnapIDPool m_IDPool;
+	std::mutex m_IDPoolLock;
+
+	// parallel worlds: packets are kept per world until the tick barrier
+	struct CDeferredPacket
+	{
+		int m_ClientID;
+		int m_Flags;
+		int m_Offset;
+		int m_Size;
+	};
+	struct CWorldOutbox
+	{
+		std::vector<CDeferredPacket> m_vPackets;
+		std::vector<unsigned char> m_vData;
+	};
+	struct CWorldTickStats
+	{
+		int m_Ticks;
+		int64_t m_WallTime;
+		int64_t m_MaxWallTime;
+		int64_t m_aWorldTime[ENGINE_MAX_WORLDS];
+	};
+	CWorldTickPool m_WorldTickPool;
+	CWorldOutbox m_aWorldOutbox[ENGINE_MAX_WORLDS];
+	std::unique_ptr<CSnapshotBuilder> m_apWorldSnapshotBuilder[ENGINE_MAX_WORLDS];
+	std::mutex m_DeferredLock;
+	std::vector<std::pair<int, int>> m_vDeferredChangeWorld;
+	std::vector<std::pair<int, std::string>> m_vDeferredKick;
+	CWorldTickStats m_WorldTickStats {};
+
+	// snapshots are built in client order, delta and compression run on the scheduler
+	struct CSnapJob
+	{
+		int m_ClientID;
+		CSnapshot* m_pSnap;
+		unsigned m_Crc;
+		int m_DeltaTick;
+		int m_Size; // compressed delta, 0 when nothing changed
+		std::vector<char> m_vData; // keeps its capacity between ticks
+	};
+	struct CSnapStageStats
+	{
+		std::atomic<int> m_Snapshots;
+		std::atomic<int64_t> m_Build;
+		std::atomic<int64_t> m_Delta;
+		std::atomic<int64_t> m_Compress;
+		std::atomic<int64_t> m_Encode;
+		std::atomic<int64_t> m_Send;
+	};
+	std::vector<CSnapJob> m_avSnapJobs[ENGINE_MAX_WORLDS];
+	CSnapStageStats m_SnapStageStats {};
+	struct CNetSyscallStats
+	{
+		int m_StartTick;
+		NETSTATS m_Start; // net_stats at the last reset
+		int m_SnapRounds;
+		uint64_t m_SnapPackets;
+		uint64_t m_SnapSyscalls;
+	};
+	CNetSyscallStats m_NetSyscallStats {};
 	CNetServer m_NetServer;
 	CEcon m_Econ;
 
@@ -185,6 +258,7 @@ public:
 
 	void SetClientLanguage(int ClientID, const char* pLanguage) override;
 	const char* GetClientLanguage(int ClientID) const override;
+	int GetClientLanguageIndex(int ClientID) const override;
 	const char* GetWorldName(int WorldID) override;
 	int GetWorldsSize() const override;
 
@@ -224,6 +298,14 @@ public:
 	int SendMsg(CMsgPacker* pMsg, int Flags, int ClientID, int64_t Mask = -1, int WorldID = -1) override;
 
 	void DoSnapshot(int WorldID);
+	void EncodeSnapshots(CSnapJob* pJobs, int NumJobs);
+	void EncodeSnapshot(CSnapJob& Job);
+	void SendSnapshot(const CSnapJob& Job, int WorldID);
+	void NetSend(CNetChunk* pChunk);
+	CSnapshotBuilder* CurrentSnapshotBuilder();
+	void UpdateWorldTickPool();
+	void RunWorlds(bool Snapshot);
+	void ApplyDeferredWorldActions();
 
 	static int NewClientCallback(int ClientID, void* pUser);
 	static int NewClientNoAuthCallback(int ClientID, void* pUser);
@@ -265,6 +347,11 @@ public:
 
 	static void ConKick(IConsole::IResult* pResult, void* pUser);
 	static void ConStatus(IConsole::IResult* pResult, void* pUser);
+	static void ConSqlStatus(IConsole::IResult* pResult, void* pUser);
+	static void ConWorldTickStats(IConsole::IResult* pResult, void* pUser);
+	static void ConSnapStageStats(IConsole::IResult* pResult, void* pUser);
+	static void ConSnapBudgetStats(IConsole::IResult* pResult, void* pUser);
+	static void ConNetSyscallStats(IConsole::IResult* pResult, void* pUser);
 	static void ConShutdown(IConsole::IResult* pResult, void* pUser);
 	static void ConReload(IConsole::IResult* pResult, void* pUser);
 	static void ConLogout(IConsole::IResult* pResult, void* pUser);
@@ -285,6 +372,8 @@ public:
 	void SnapFreeID(int ID) override;
 	void* SnapNewItem(int Type, int ID, int Size) override;
 	void SnapSetStaticsize(int ItemType, int Size) override;
+	void SnapSetCapture(CSnapItemCache* pCache) override;
+	bool SnapOverBudget(int ClientID) const override;
 
 	int* GetIdMap(int ClientID) override;
 
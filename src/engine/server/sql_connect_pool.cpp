@@ -5,24 +5,22 @@
 #include <engine/shared/config.h>
 
 /*
-	I don't see the point in using SELECT operations in the thread,
-	since this will lead to unnecessary code, which may cause confusion,
-	and by calculations if (SQL server / server) = localhost,
-	this will not do any harm (but after the release is complete,
-	it is advisable to use the Thread function with Callback)
-	And in General, you should review the SQL system,
-	it works (and has been tested by time and tests),
-	but this implementation is not very narrowly focused
-	This approach works if the old query is not executed before,
-	 a new query it will create a reserve.
-	 It may seem that it does not use Pool,
-	 but in fact it is and is created as a reserve when running
-	 <tlock>
-	 Usage is performed in turn following synchronously
-	 working running through each request in order
-	 This pool is not asynchronous
+	Synchronous SELECT operations (Execute) take a connection from the
+	reserve list and run on the calling thread.
+	Asynchronous operations (AtExecute) are pushed into a bounded queue
+	and processed by a fixed set of workers, one per pooled connection.
+	Ordered operations (AtExecuteOrdered) share one queue that only one
+	worker at a time takes from, so they run in the order they were
+	queued, for statements that depend on each other.
+	Each worker initializes the driver thread once and keeps its own
+	connection alive for the whole lifetime of the pool.
+	When the queue is full the producer waits (back-pressure), except
+	for callbacks running on a worker, which may always enqueue to
+	avoid deadlocking the pool. On shutdown the queue is drained,
+	including delayed queries, before the connections are closed.
 */
 std::atomic_flag g_atomic_lock;
+static thread_local bool gs_IsSqlWorker = false;
 
 // #####################################################
 // SQL CONNECTION POOL
@@ -32,7 +30,7 @@ void CConectionPool::Initilize()
 {
 	if(m_ptrInstance)
 		m_ptrInstance.reset();
-	m_ptrInstance = std::make_shared<CConectionPool>(std::forward<CConectionPool>({}));
+	m_ptrInstance.reset(new CConectionPool());
 }
 
 std::shared_ptr<CConectionPool> CConectionPool::GetInstance()
@@ -42,17 +40,28 @@ std::shared_ptr<CConectionPool> CConectionPool::GetInstance()
 
 CConectionPool::CConectionPool()
 {
+	m_Stopping = false;
+	m_WorkersGone = false;
+	m_OrderedBusy = false;
+	m_PendingPeak = 0;
+	m_Stalls = 0;
+	m_StallMilliseconds = 0;
+	m_Overflows = 0;
+	m_Executed = 0;
+	m_Failed = 0;
+
 	try
 	{
 		m_pDriver = get_driver_instance();
-		for(int i = 0; i < g_Config.m_SvMySqlPoolSize; ++i)
-			this->CreateConnection();
+		this->CreateConnection();
 	}
 	catch (SQLException& e)
 	{
 		dbg_msg("Sql Exception", "%s", e.what());
 		exit(0);
 	}
+
+	StartWorkers();
 }
 
 CConectionPool::~CConectionPool()
@@ -62,6 +71,8 @@ CConectionPool::~CConectionPool()
 
 void CConectionPool::DisconnectConnectionHeap()
 {
+	StopWorkers();
+
 	g_atomic_lock.test_and_set(std::memory_order_acquire);
 	while(!m_ConnList.empty())
 	{
@@ -85,7 +96,7 @@ void CConectionPool::DisconnectConnectionHeap()
 	g_atomic_lock.clear(std::memory_order_release);
 }
 
-std::shared_ptr<Connection> CConectionPool::CreateConnection()
+std::shared_ptr<Connection> CConectionPool::Connect()
 {
 	std::shared_ptr<Connection> pConnection = nullptr;
 	while (pConnection == nullptr)
@@ -110,6 +121,12 @@ std::shared_ptr<Connection> CConectionPool::CreateConnection()
 			DisconnectConnection(pConnection);
 		}
 	}
+	return pConnection;
+}
+
+std::shared_ptr<Connection> CConectionPool::CreateConnection()
+{
+	std::shared_ptr<Connection> pConnection = Connect();
 
 	g_atomic_lock.test_and_set(std::memory_order_acquire);
 	m_ConnList.push_back(pConnection);
@@ -168,4 +185,271 @@ void CConectionPool::DisconnectConnection(std::shared_ptr<Connection> pConnectio
 	m_ConnList.remove(pConnection);
 	pConnection.reset();
 	g_atomic_lock.clear(std::memory_order_release);
-}
\ No newline at end of file
+}
+
+// #####################################################
+// ASYNCHRONOUS EXECUTOR
+// #####################################################
+void CConectionPool::StartWorkers()
+{
+	for(int i = 0; i < g_Config.m_SvMySqlPoolSize; ++i)
+		m_vWorkers.emplace_back(&CConectionPool::WorkerThread, this);
+}
+
+void CConectionPool::StopWorkers()
+{
+	{
+		std::unique_lock Lock(m_TasksMutex);
+		if(m_Stopping)
+			return;
+		m_Stopping = true;
+	}
+	m_TasksCondition.notify_all();
+	m_TasksSpaceCondition.notify_all();
+
+	// workers leave only when the queue is drained
+	for(std::thread& Worker : m_vWorkers)
+	{
+		if(Worker.joinable())
+			Worker.join();
+	}
+
+	// whatever was queued after the last worker left runs here, later tasks run inline
+	std::deque<CTask> Late;
+	{
+		std::unique_lock Lock(m_TasksMutex);
+		m_vWorkers.clear();
+		m_WorkersGone = true;
+		Late.swap(m_OrderedTasks);
+		for(CTask& Task : m_Tasks)
+			Late.push_back(std::move(Task));
+		m_Tasks.clear();
+		for(auto& [Time, Task] : m_DelayedTasks)
+			Late.push_back(std::move(Task));
+		m_DelayedTasks.clear();
+	}
+	for(const CTask& Task : Late)
+		ExecuteInline(Task);
+	dbg_msg("SQL", "executor stopped, executed %lu queries (%lu failed)", (unsigned long)m_Executed.load(), (unsigned long)m_Failed.load());
+}
+
+void CConectionPool::WorkerThread()
+{
+	gs_IsSqlWorker = true;
+	m_pDriver->threadInit();
+	std::shared_ptr<Connection> pConnection = Connect();
+
+	while(true)
+	{
+		CTask Task;
+		{
+			std::unique_lock Lock(m_TasksMutex);
+			while(true)
+			{
+				// promote due delayed tasks (all of them while draining)
+				const auto Now = TaskClock::now();
+				while(!m_DelayedTasks.empty() && (m_Stopping || m_DelayedTasks.begin()->first <= Now))
+				{
+					m_Tasks.push_back(std::move(m_DelayedTasks.begin()->second));
+					m_DelayedTasks.erase(m_DelayedTasks.begin());
+				}
+
+				const bool OrderedReady = !m_OrderedBusy && !m_OrderedTasks.empty();
+				if(OrderedReady || !m_Tasks.empty() || m_Stopping)
+					break;
+
+				if(m_DelayedTasks.empty())
+					m_TasksCondition.wait(Lock);
+				else
+					m_TasksCondition.wait_until(Lock, m_DelayedTasks.begin()->first);
+			}
+
+			// the ordered queue has one taker at a time, whoever holds it comes back for the rest
+			if(!m_OrderedBusy && !m_OrderedTasks.empty())
+			{
+				Task = std::move(m_OrderedTasks.front());
+				m_OrderedTasks.pop_front();
+				m_OrderedBusy = true;
+			}
+			else if(!m_Tasks.empty())
+			{
+				Task = std::move(m_Tasks.front());
+				m_Tasks.pop_front();
+			}
+			else
+				break;
+		}
+		m_TasksSpaceCondition.notify_one();
+
+		if(!pConnection || pConnection->isClosed())
+			pConnection = Connect();
+
+		if(ExecuteTask(pConnection.get(), Task))
+			m_Executed++;
+		else
+			m_Failed++;
+
+		if(Task.m_Ordered)
+		{
+			{
+				std::unique_lock Lock(m_TasksMutex);
+				m_OrderedBusy = false;
+			}
+			m_TasksCondition.notify_one();
+		}
+	}
+
+	try
+	{
+		if(pConnection)
+			pConnection->close();
+	}
+	catch(SQLException& e)
+	{
+		dbg_msg("Sql Exception", "%s", e.what());
+	}
+	pConnection.reset();
+	m_pDriver->threadEnd();
+}
+
+bool CConectionPool::ExecuteTask(Connection* pConnection, const CTask& Task)
+{
+	try
+	{
+		const std::unique_ptr<Statement> pStmt(pConnection->createStatement());
+		Task.m_pCallback(pStmt.get(), Task.m_Query);
+		pStmt->close();
+	}
+	catch(SQLException& e)
+	{
+		dbg_msg("SQL", "%s", e.what());
+		return false;
+	}
+	return true;
+}
+
+void CConectionPool::ExecuteInline(const CTask& Task)
+{
+	g_SqlThreadRecursiveLock.lock();
+	m_pDriver->threadInit();
+	std::shared_ptr<Connection> pConnection = GetConnection();
+	if(ExecuteTask(pConnection.get(), Task))
+		m_Executed++;
+	else
+		m_Failed++;
+	ReleaseConnection(pConnection);
+	m_pDriver->threadEnd();
+	g_SqlThreadRecursiveLock.unlock();
+}
+
+void CConectionPool::EnqueueTask(std::string Query, CallbackStatementPtr pCallback, int DelayMilliseconds, bool Ordered)
+{
+	CTask Task { std::move(Query), std::move(pCallback), Ordered };
+
+	std::unique_lock Lock(m_TasksMutex);
+
+	// the workers are gone, execute on the calling thread
+	if(m_WorkersGone)
+	{
+		Lock.unlock();
+		ExecuteInline(Task);
+		return;
+	}
+
+	// back-pressure: producers wait for free space, workers never wait on themselves
+	if(PendingTasks() >= g_Config.m_SvMySqlQueueSize)
+	{
+		if(gs_IsSqlWorker || m_Stopping)
+		{
+			m_Overflows++;
+		}
+		else
+		{
+			const auto StallStart = TaskClock::now();
+			m_TasksSpaceCondition.wait(Lock, [this] { return PendingTasks() < g_Config.m_SvMySqlQueueSize || m_Stopping; });
+			m_StallMilliseconds += std::chrono::duration_cast<std::chrono::milliseconds>(TaskClock::now() - StallStart).count();
+			m_Stalls++;
+		}
+	}
+
+	if(Ordered)
+		m_OrderedTasks.push_back(std::move(Task));
+	else if(DelayMilliseconds > 0)
+		m_DelayedTasks.emplace(TaskClock::now() + std::chrono::milliseconds(DelayMilliseconds), std::move(Task));
+	else
+		m_Tasks.push_back(std::move(Task));
+	m_PendingPeak = maximum(m_PendingPeak, PendingTasks());
+
+	Lock.unlock();
+	m_TasksCondition.notify_one();
+}
+
+void CConectionPool::ExecuteBatch(std::vector<std::string> vQueries, const CallbackBatchPtr& pCallback, const CallbackUpdatePtr& pFailure, bool Transaction)
+{
+	auto pQueries = std::make_shared<std::vector<std::string>>(std::move(vQueries));
+	Database->EnqueueTask({}, [pQueries, pCallback, pFailure, Transaction](Statement* pStmt, const std::string&)
+	{
+		std::vector<ResultPtr> vResults;
+		vResults.reserve(pQueries->size());
+		try
+		{
+			if(Transaction)
+				pStmt->execute("START TRANSACTION;");
+
+			// every query gets its own statement, the result sets outlive them
+			for(const std::string& Query : *pQueries)
+			{
+				ResultPtr pResult;
+				if(!Query.empty())
+				{
+					const std::unique_ptr<Statement> pQueryStmt(pStmt->getConnection()->createStatement());
+					if(pQueryStmt->execute(Query.c_str()))
+						pResult.reset(pQueryStmt->getResultSet());
+					pQueryStmt->close();
+				}
+				vResults.push_back(std::move(pResult));
+			}
+
+			if(Transaction)
+				pStmt->execute("COMMIT;");
+		}
+		catch(SQLException&)
+		{
+			if(Transaction)
+			{
+				try
+				{
+					pStmt->execute("ROLLBACK;");
+				}
+				catch(SQLException& e)
+				{
+					dbg_msg("SQL", "%s", e.what());
+				}
+			}
+			RunFailure(pFailure);
+			throw;
+		}
+
+		if(pCallback)
+		{
+			std::lock_guard Lock(g_SqlThreadRecursiveLock);
+			pCallback(std::move(vResults));
+		}
+	});
+}
+
+CConectionPool::CExecutorStats CConectionPool::GetExecutorStats()
+{
+	std::unique_lock Lock(m_TasksMutex);
+
+	CExecutorStats Stats;
+	Stats.m_Workers = (int)m_vWorkers.size();
+	Stats.m_Pending = PendingTasks();
+	Stats.m_PendingPeak = m_PendingPeak;
+	Stats.m_Executed = m_Executed.load();
+	Stats.m_Failed = m_Failed.load();
+	Stats.m_Stalls = m_Stalls;
+	Stats.m_StallMilliseconds = m_StallMilliseconds;
+	Stats.m_Overflows = m_Overflows;
+	return Stats;
+}
@@ -14,7 +14,13 @@
 	#include <cppconn/resultset.h>
 #endif
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
+#include <deque>
+#include <map>
+#include <thread>
 
 using namespace sql;
 
@@ -53,6 +59,8 @@ inline std::recursive_mutex g_SqlThreadRecursiveLock;
 using ResultPtr = std::unique_ptr<ResultSet>;
 using CallbackResultPtr = std::function<void(ResultPtr)>;
 using CallbackUpdatePtr = std::function<void()>;
+using CallbackStatementPtr = std::function<void(Statement*, const std::string&)>;
+using CallbackBatchPtr = std::function<void(std::vector<ResultPtr>)>;
 
 /*
  * class
@@ -65,9 +73,23 @@ public:
 	static void Initilize();
 	static std::shared_ptr<CConectionPool> GetInstance();
 
+	// executor statistics
+	struct CExecutorStats
+	{
+		int m_Workers;
+		int m_Pending;
+		int m_PendingPeak;
+		uint64_t m_Executed;
+		uint64_t m_Failed;
+		uint64_t m_Stalls;
+		uint64_t m_StallMilliseconds;
+		uint64_t m_Overflows;
+	};
+
 private:
 	CConectionPool();
 
+	std::shared_ptr<Connection> Connect();
 	std::shared_ptr<Connection> CreateConnection();
 	std::shared_ptr<Connection> GetConnection();
 	void ReleaseConnection(std::shared_ptr<Connection> pConnection);
@@ -77,20 +99,65 @@ private:
 	std::list<std::shared_ptr<Connection>> m_ConnList;
 	Driver* m_pDriver;
 
+	// asynchronous executor: one long-lived worker per pooled connection
+	struct CTask
+	{
+		std::string m_Query;
+		CallbackStatementPtr m_pCallback;
+		bool m_Ordered;
+	};
+	using TaskClock = std::chrono::steady_clock;
+
+	void StartWorkers();
+	void StopWorkers();
+	void WorkerThread();
+	void EnqueueTask(std::string Query, CallbackStatementPtr pCallback, int DelayMilliseconds = 0, bool Ordered = false);
+	bool ExecuteTask(Connection* pConnection, const CTask& Task);
+	void ExecuteInline(const CTask& Task);
+	int PendingTasks() const { return (int)(m_Tasks.size() + m_OrderedTasks.size() + m_DelayedTasks.size()); }
+
+	std::vector<std::thread> m_vWorkers;
+	std::deque<CTask> m_Tasks;
+	std::deque<CTask> m_OrderedTasks; // run one at a time in queue order
+	bool m_OrderedBusy;
+	std::multimap<TaskClock::time_point, CTask> m_DelayedTasks;
+	std::mutex m_TasksMutex;
+	std::condition_variable m_TasksCondition;
+	std::condition_variable m_TasksSpaceCondition;
+	bool m_Stopping;
+	bool m_WorkersGone;
+	int m_PendingPeak;
+	uint64_t m_Stalls;
+	uint64_t m_StallMilliseconds;
+	uint64_t m_Overflows;
+	std::atomic<uint64_t> m_Executed;
+	std::atomic<uint64_t> m_Failed;
+
 public:
 	~CConectionPool();
 
 	// functions
 	void DisconnectConnectionHeap();
+	CExecutorStats GetExecutorStats();
 
 	// database extraction function
 private:
+	static void RunFailure(const CallbackUpdatePtr& pFailure)
+	{
+		if(pFailure)
+		{
+			std::lock_guard Lock(g_SqlThreadRecursiveLock);
+			pFailure();
+		}
+	}
+
 	class CResultBase
 	{
 	protected:
 		friend class CConectionPool;
 		std::string m_Query;
 		DB m_TypeQuery;
+		CallbackUpdatePtr m_pFailure; // runs on the worker instead of the callback when the query throws
 	public:
 		const char* GetQueryString() const { return m_Query.c_str(); }
 	};
@@ -134,38 +201,32 @@ private:
 			return pResult;
 		}
 
-		void AtExecute(const CallbackResultPtr& pCallbackResult)
+		CResultSelect* OnFailure(const CallbackUpdatePtr& pFailure) { m_pFailure = pFailure; return this; }
+
+		void AtExecute(const CallbackResultPtr& pCallbackResult, bool Ordered = false)
 		{
-			auto Item = [pCallbackResult](const std::string Query)
+			Database->EnqueueTask(m_Query, [pCallbackResult, pFailure = m_pFailure](Statement* pStmt, const std::string& Query)
 			{
-				const char* pError = nullptr;
-
-				g_SqlThreadRecursiveLock.lock();
-				Database->m_pDriver->threadInit();
-				std::shared_ptr<Connection> pConnection = Database->GetConnection();
+				ResultPtr pResult;
 				try
 				{
-					const std::unique_ptr<Statement> pStmt(pConnection->createStatement());
-					ResultPtr pResult(pStmt->executeQuery(Query.c_str()));
-					if(pCallbackResult)
-					{
-						pCallbackResult(std::move(pResult));
-					}
-					pStmt->close();
+					pResult.reset(pStmt->executeQuery(Query.c_str()));
 				}
-				catch (SQLException& e)
+				catch(SQLException&)
 				{
-					pError = e.what();
+					RunFailure(pFailure);
+					throw;
 				}
-				Database->ReleaseConnection(pConnection);
-				Database->m_pDriver->threadEnd();
-				g_SqlThreadRecursiveLock.unlock();
-
-				if (pError != nullptr)
-					dbg_msg("SQL", "%s", pError);
-			};
-			std::thread(Item, m_Query).detach();
+				if(pCallbackResult)
+				{
+					std::lock_guard Lock(g_SqlThreadRecursiveLock);
+					pCallbackResult(std::move(pResult));
+				}
+			}, 0, Ordered);
 		}
+
+		// runs after every ordered query queued before it
+		void AtExecuteOrdered(const CallbackResultPtr& pCallbackResult) { AtExecute(pCallbackResult, true); }
 	};
 
 	class CResultQuery : public CResultBase
@@ -185,42 +246,60 @@ private:
 			return *this;
 		}
 
-		void AtExecute(const CallbackUpdatePtr& pCallbackResult, int DelayMilliseconds = 0)
+		CResultQuery* OnFailure(const CallbackUpdatePtr& pFailure) { m_pFailure = pFailure; return this; }
+
+		void AtExecute(const CallbackUpdatePtr& pCallbackResult, int DelayMilliseconds = 0, bool Ordered = false)
 		{
-			auto Item = [pCallbackResult](const std::string Query, const int Milliseconds)
+			Database->EnqueueTask(m_Query, [pCallbackResult, pFailure = m_pFailure](Statement* pStmt, const std::string& Query)
 			{
-				if (Milliseconds > 0)
-					std::this_thread::sleep_for(std::chrono::milliseconds(Milliseconds));
-
-				const char* pError = nullptr;
-
-				g_SqlThreadRecursiveLock.lock();
-				Database->m_pDriver->threadInit();
-				std::shared_ptr<Connection> pConnection = Database->GetConnection();
 				try
 				{
-					const std::unique_ptr<Statement> pStmt(pConnection->createStatement());
 					pStmt->execute(Query.c_str());
-					if(pCallbackResult)
-					{
-						pCallbackResult();
-					}
-					pStmt->close();
 				}
-				catch (SQLException& e)
+				catch(SQLException&)
+				{
+					RunFailure(pFailure);
+					throw;
+				}
+				if(pCallbackResult)
 				{
-					pError = e.what();
+					std::lock_guard Lock(g_SqlThreadRecursiveLock);
+					pCallbackResult();
 				}
-				Database->ReleaseConnection(pConnection);
-				Database->m_pDriver->threadEnd();
-				g_SqlThreadRecursiveLock.unlock();
-
-				if (pError != nullptr)
-					dbg_msg("SQL", "%s", pError);
-			};
-			std::thread(Item, m_Query, DelayMilliseconds).detach();
+			}, DelayMilliseconds, Ordered);
 		}
 		void Execute(int DelayMilliseconds = 0) { return AtExecute(nullptr, DelayMilliseconds); }
+
+		// runs after every ordered query queued before it
+		void AtExecuteOrdered(const CallbackUpdatePtr& pCallbackResult = nullptr) { AtExecute(pCallbackResult, 0, true); }
+
+		// runs on the calling thread, for schema changes at startup
+		bool ExecuteBlocking() const
+		{
+			const char* pError = nullptr;
+
+			g_SqlThreadRecursiveLock.lock();
+			Database->m_pDriver->threadInit();
+			std::shared_ptr<Connection> pConnection = Database->GetConnection();
+			try
+			{
+				const std::unique_ptr<Statement> pStmt(pConnection->createStatement());
+				pStmt->execute(m_Query.c_str());
+				pStmt->close();
+			}
+			catch (SQLException& e)
+			{
+				pError = e.what();
+			}
+			Database->ReleaseConnection(pConnection);
+			Database->m_pDriver->threadEnd();
+			g_SqlThreadRecursiveLock.unlock();
+
+			if (pError != nullptr)
+				dbg_msg("SQL", "%s", pError);
+
+			return pError == nullptr;
+		}
 	};
 
 	class CResultQueryCustom : public CResultQuery
@@ -340,6 +419,24 @@ public:
 		// checking format query
 		PrepareQueryInsertUpdateDelete(T, pTable, strQuery)->Execute(Milliseconds);
 	}
+
+	template<DB T>
+	static std::enable_if_t<(T == DB::INSERT || T == DB::UPDATE || T == DB::REMOVE), void> ExecuteOrdered(const char* pTable, const char* pBuffer, ...)
+	{
+		std::string strQuery;
+		FORMAT_STRING_ARGS(pBuffer, strQuery, MAX_QUERY_LEN);
+
+		// checking format query
+		PrepareQueryInsertUpdateDelete(T, pTable, strQuery)->AtExecuteOrdered();
+	}
+
+	// - - - - - - - - - - - - - - - -
+	// batch
+	// - - - - - - - - - - - - - - - -
+	// runs the queries one after another on one worker connection and hands over their result sets in query order,
+	// empty queries and statements without a result set leave an empty entry; a transaction batch is rolled back
+	// as a whole when any query fails, the failure callback runs in place of the result callback
+	static void ExecuteBatch(std::vector<std::string> vQueries, const CallbackBatchPtr& pCallback, const CallbackUpdatePtr& pFailure = nullptr, bool Transaction = false);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "world_tick_pool.h"
+
+CWorldTickPool::~CWorldTickPool()
+{
+	Stop();
+}
+
+void CWorldTickPool::Start(int NumThreads)
+{
+	Stop();
+
+	m_Stopping = false;
+	for(int i = 0; i < NumThreads; i++)
+		m_vThreads.emplace_back(&CWorldTickPool::WorkerThread, this);
+}
+
+void CWorldTickPool::Stop()
+{
+	{
+		std::lock_guard Lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_WakeUp.notify_all();
+
+	for(auto& Thread : m_vThreads)
+		Thread.join();
+	m_vThreads.clear();
+}
+
+void CWorldTickPool::RunJobs()
+{
+	// jobs are claimed one by one, so a slow world does not hold back a whole thread's share
+	for(int Job = m_NextJob.fetch_add(1); Job < m_NumJobs; Job = m_NextJob.fetch_add(1))
+		(*m_pJob)(Job);
+}
+
+void CWorldTickPool::WorkerThread()
+{
+	int Generation = 0;
+	while(true)
+	{
+		{
+			std::unique_lock Lock(m_Mutex);
+			m_WakeUp.wait(Lock, [&] { return m_Stopping || m_Generation != Generation; });
+			if(m_Stopping)
+				return;
+
+			Generation = m_Generation;
+			m_Running++;
+		}
+
+		RunJobs();
+
+		{
+			std::lock_guard Lock(m_Mutex);
+			m_Running--;
+		}
+		m_Done.notify_all();
+	}
+}
+
+void CWorldTickPool::Run(int NumJobs, const std::function<void(int)>& Job)
+{
+	if(NumJobs <= 0)
+		return;
+
+	// nothing to share, avoid waking up the threads
+	if(m_vThreads.empty() || NumJobs == 1)
+	{
+		for(int i = 0; i < NumJobs; i++)
+			Job(i);
+		return;
+	}
+
+	{
+		// a thread woken late for the previous batch may still be leaving it
+		std::unique_lock Lock(m_Mutex);
+		m_Done.wait(Lock, [&] { return m_Running == 0; });
+		m_pJob = &Job;
+		m_NumJobs = NumJobs;
+		m_NextJob = 0;
+		m_Generation++;
+	}
+	m_WakeUp.notify_all();
+
+	RunJobs();
+
+	// barrier: wait for the threads that picked up this batch
+	std::unique_lock Lock(m_Mutex);
+	m_Done.wait(Lock, [&] { return m_Running == 0; });
+	m_pJob = nullptr;
+}
@@ -0,0 +1,45 @@
+#ifndef ENGINE_SERVER_WORLD_TICK_POOL_H
+#define ENGINE_SERVER_WORLD_TICK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+	Fixed set of threads that runs one job per world and blocks the
+	caller until every job of the batch has finished (tick barrier).
+	The calling thread takes part in the batch, so a pool with zero
+	threads simply runs the jobs serially.
+*/
+class CWorldTickPool
+{
+	std::vector<std::thread> m_vThreads;
+	std::mutex m_Mutex;
+	std::condition_variable m_WakeUp;
+	std::condition_variable m_Done;
+
+	const std::function<void(int)>* m_pJob {};
+	int m_NumJobs {};
+	int m_Generation {};
+	int m_Running {};
+	bool m_Stopping {};
+	std::atomic<int> m_NextJob {};
+
+	void WorkerThread();
+	void RunJobs();
+
+public:
+	~CWorldTickPool();
+
+	void Start(int NumThreads);
+	void Stop();
+	int NumThreads() const { return (int)m_vThreads.size(); }
+
+	// run Job(0) ... Job(NumJobs - 1), returns once all of them are done
+	void Run(int NumJobs, const std::function<void(int)>& Job);
+};
+
+#endif
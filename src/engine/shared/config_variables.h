@@ -152,6 +152,10 @@ MACRO_CONFIG_INT(SvPort, sv_port, 0, 0, 0, CFGFLAG_SERVER, "Port to use for the
 MACRO_CONFIG_STR(SvMap, sv_map, 128, "Multiworlds", CFGFLAG_SERVER, "Map name to use on the server")
 MACRO_CONFIG_INT(SvMaxClientsPerIP, sv_max_clients_per_ip, 4, 1, MAX_CLIENTS, CFGFLAG_SERVER, "Maximum number of clients with the same IP that can connect to the server")
 MACRO_CONFIG_INT(SvHighBandwidth, sv_high_bandwidth, 0, 0, 1, CFGFLAG_SERVER, "Use high bandwidth mode. Doubles the bandwidth required for the server. LAN use only")
+MACRO_CONFIG_INT(SvParallelWorlds, sv_parallel_worlds, 0, 0, 1, CFGFLAG_SERVER, "Tick and snapshot worlds in parallel (experimental)")
+MACRO_CONFIG_INT(SvParallelWorldsThreads, sv_parallel_worlds_threads, 0, 0, 63, CFGFLAG_SERVER, "Extra threads for parallel worlds (0 = number of cores - 1)")
+MACRO_CONFIG_INT(SvParallelSnapshots, sv_parallel_snapshots, 1, 0, 1, CFGFLAG_SERVER, "Delta and compress the snapshots of a world on the scheduler threads")
+MACRO_CONFIG_INT(SvBatchSend, sv_batch_send, 1, 0, 1, CFGFLAG_SERVER, "Send the snapshot packets of a tick together with as few syscalls as possible (Linux only)")
 MACRO_CONFIG_STR(SvRegister, sv_register, 16, "1", CFGFLAG_SERVER, "Register server with master server for public listing, can also accept a comma-separated list of protocols to register on, like 'ipv4,ipv6'")
 MACRO_CONFIG_STR(SvRegisterExtra, sv_register_extra, 256, "", CFGFLAG_SERVER, "Extra headers to send to the register endpoint, comma separated 'Header: Value' pairs")
 MACRO_CONFIG_STR(SvRegisterUrl, sv_register_url, 128, "https://master1.ddnet.org/ddnet/15/register", CFGFLAG_SERVER, "Masterserver URL to register to")
@@ -8,6 +8,7 @@
 #include <engine/engine.h>
 #include <engine/shared/config.h>
 #include <engine/shared/network.h>
+#include <engine/shared/scheduler.h>
 #include <engine/storage.h>
 
 class CEngine : public IEngine
@@ -43,6 +44,27 @@ public:
 		}
 	}
 
+	static void Con_SchedulerStats(IConsole::IResult *pResult, void *pUserData)
+	{
+		CEngine *pEngine = static_cast<CEngine *>(pUserData);
+		CScheduler &Scheduler = CScheduler::Get();
+
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "threads=%d delayed=%d steals=%llu", Scheduler.NumThreads(), Scheduler.Delayed(), (unsigned long long)Scheduler.Steals());
+		pEngine->m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "scheduler", aBuf);
+
+		// wait is the time from queueing (or being due) until a worker took the task, in microseconds
+		for(int i = 0; i < CScheduler::NUM_PRIORITIES; i++)
+		{
+			const CScheduler::CQueueStats &Stats = Scheduler.Stats(i);
+			str_format(aBuf, sizeof(aBuf), "%s: done=%llu pending=%d wait avg=%.0f p50=%llu p99=%llu max=%llu run avg=%.0f p99=%llu max=%llu",
+				CScheduler::PriorityName(i), (unsigned long long)Stats.m_Wait.Count(), maximum(0, Scheduler.Pending(i)), Stats.m_Wait.Average(),
+				(unsigned long long)Stats.m_Wait.Percentile(0.5), (unsigned long long)Stats.m_Wait.Percentile(0.99), (unsigned long long)Stats.m_Wait.Max(),
+				Stats.m_Run.Average(), (unsigned long long)Stats.m_Run.Percentile(0.99), (unsigned long long)Stats.m_Run.Max());
+			pEngine->m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "scheduler", aBuf);
+		}
+	}
+
 	CEngine(bool Test, const char *pAppname, std::shared_ptr<CFutureLogger> pFutureLogger, int Jobs) :
 		m_pFutureLogger(std::move(pFutureLogger))
 	{
@@ -70,14 +92,14 @@ public:
 			CNetBase::Init();
 		}
 
-		m_JobPool.Init(Jobs);
+		CScheduler::Get().Start(Jobs);
 
 		m_Logging = false;
 	}
 
 	~CEngine() override
 	{
-		m_JobPool.Destroy();
+		CScheduler::Get().Stop();
 	}
 
 	void Init() override
@@ -91,13 +113,14 @@ public:
 		char aFullPath[IO_MAX_PATH_LENGTH];
 		m_pStorage->GetCompletePath(IStorageEngine::TYPE_SAVE, "dumps/", aFullPath, sizeof(aFullPath));
 		m_pConsole->Register("dbg_lognetwork", "", CFGFLAG_SERVER | CFGFLAG_CLIENT, Con_DbgLognetwork, this, "Log the network");
+		m_pConsole->Register("scheduler_stats", "", CFGFLAG_SERVER, Con_SchedulerStats, this, "Show task scheduler queues and latency histograms");
 	}
 
 	void AddJob(std::shared_ptr<IJob> pJob) override
 	{
 		if(g_Config.m_Debug)
 			dbg_msg("engine", "job added");
-		m_JobPool.Add(std::move(pJob));
+		CScheduler::Get().Add(CScheduler::PRIORITY_IO, [pJob = std::move(pJob)]() { RunJobBlocking(pJob.get()); });
 	}
 
 	void SetAdditionalLogger(std::shared_ptr<ILogger> &&pLogger) override
@@ -108,7 +131,9 @@ public:
 
 void IEngine::RunJobBlocking(IJob *pJob)
 {
-	CJobPool::RunBlocking(pJob);
+	pJob->m_Status = IJob::STATE_RUNNING;
+	pJob->Run();
+	pJob->m_Status = IJob::STATE_DONE;
 }
 
 IEngine *CreateEngine(const char *pAppname, std::shared_ptr<CFutureLogger> pFutureLogger, int Jobs) { return new CEngine(false, pAppname, std::move(pFutureLogger), Jobs); }
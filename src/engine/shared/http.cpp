@@ -1,5 +1,6 @@
 #include "http.h"
 
+#include <base/lock.h>
 #include <base/log.h>
 #include <base/math.h>
 #include <base/system.h>
@@ -350,6 +350,10 @@ class CNetServer
 	{
 	public:
 		CNetConnection m_Connection;
+
+		// address hash chain, bucket + 1 and next slot + 1, 0 for none
+		int m_HashBucket;
+		int m_HashNext;
 	};
 
 	struct CSpamConn
@@ -359,10 +363,16 @@ class CNetServer
 		int m_Conns;
 	};
 
+	enum
+	{
+		SLOT_HASH_SIZE = 128,
+	};
+
 	NETADDR m_Address;
 	NETSOCKET m_Socket;
 	CNetBan *m_pNetBan;
 	CSlot m_aSlots[NET_MAX_CLIENTS];
+	int m_aSlotHash[SLOT_HASH_SIZE]; // first slot + 1, 0 for none
 	int m_MaxClients;
 	int m_MaxClientsPerIP;
 
@@ -389,6 +399,9 @@ class CNetServer
 	void OnConnCtrlMsg(NETADDR &Addr, int ClientID, int ControlMsg, const CNetPacketConstruct &Packet);
 	bool ClientExists(const NETADDR &Addr) { return GetClientSlot(Addr) != -1; }
 	int GetClientSlot(const NETADDR &Addr);
+	static unsigned SlotHash(const NETADDR &Addr);
+	void HashSlot(int Slot);
+	void UnhashSlot(int Slot);
 	void SendControl(NETADDR &Addr, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken);
 
 	int TryAcceptClient(NETADDR &Addr, SECURITY_TOKEN SecurityToken, bool VanillaAuth = false, SECURITY_TOKEN Token = 0);
@@ -409,6 +422,10 @@ public:
 	int Send(CNetChunk *pChunk);
 	int Update();
 
+	// queue the packets sent until FlushBatch, returns the syscalls it took
+	void BeginBatch() { net_udp_batch_begin(m_Socket); }
+	int FlushBatch() { return net_udp_batch_flush(m_Socket); }
+
 	//
 	int Drop(int ClientID, const char *pReason);
 
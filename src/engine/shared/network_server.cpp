@@ -105,6 +105,7 @@ int CNetServer::Drop(int ClientID, const char *pReason)
 		m_pfnDelClient(ClientID, pReason, m_pUser);
 
 	m_aSlots[ClientID].m_Connection.Disconnect(pReason);
+	UnhashSlot(ClientID);
 
 	return 0;
 }
@@ -240,6 +241,7 @@ int CNetServer::TryAcceptClient(NETADDR &Addr, SECURITY_TOKEN SecurityToken, boo
 
 	// init connection slot
 	m_aSlots[Slot].m_Connection.DirectInit(Addr, SecurityToken, Token);
+	HashSlot(Slot);
 
 	if(VanillaAuth)
 	{
@@ -535,20 +537,51 @@ void CNetServer::OnTokenCtrlMsg(NETADDR &Addr, int ControlMsg, const CNetPacketC
 
 int CNetServer::GetClientSlot(const NETADDR &Addr)
 {
-	int Slot = -1;
-
-	for(int i = 0; i < MaxClients(); i++)
+	// every packet is looked up here, walk only the slots hashed with the same address
+	for(int i = m_aSlotHash[SlotHash(Addr)] - 1; i != -1; i = m_aSlots[i].m_HashNext - 1)
 	{
 		if(m_aSlots[i].m_Connection.State() != NET_CONNSTATE_OFFLINE &&
 			m_aSlots[i].m_Connection.State() != NET_CONNSTATE_ERROR &&
 			net_addr_comp(m_aSlots[i].m_Connection.PeerAddress(), &Addr) == 0)
-
 		{
-			Slot = i;
+			return i;
 		}
 	}
 
-	return Slot;
+	return -1;
+}
+
+unsigned CNetServer::SlotHash(const NETADDR &Addr)
+{
+	unsigned Hash = 2166136261u;
+	for(unsigned char Byte : Addr.ip)
+		Hash = (Hash ^ Byte) * 16777619u;
+	Hash = (Hash ^ Addr.port) * 16777619u;
+	return (Hash ^ (Hash >> 16)) % SLOT_HASH_SIZE;
+}
+
+void CNetServer::HashSlot(int Slot)
+{
+	UnhashSlot(Slot);
+
+	const unsigned Bucket = SlotHash(*m_aSlots[Slot].m_Connection.PeerAddress());
+	m_aSlots[Slot].m_HashBucket = Bucket + 1;
+	m_aSlots[Slot].m_HashNext = m_aSlotHash[Bucket];
+	m_aSlotHash[Bucket] = Slot + 1;
+}
+
+void CNetServer::UnhashSlot(int Slot)
+{
+	if(!m_aSlots[Slot].m_HashBucket)
+		return;
+
+	int *pLink = &m_aSlotHash[m_aSlots[Slot].m_HashBucket - 1];
+	while(*pLink != Slot + 1)
+		pLink = &m_aSlots[*pLink - 1].m_HashNext;
+	*pLink = m_aSlots[Slot].m_HashNext;
+
+	m_aSlots[Slot].m_HashBucket = 0;
+	m_aSlots[Slot].m_HashNext = 0;
 }
 
 static bool IsDDNetControlMsg(const CNetPacketConstruct *pPacket)
@@ -715,6 +748,8 @@ bool CNetServer::SetTimedOut(int ClientID, int OrigID)
 
 	m_aSlots[ClientID].m_Connection.SetTimedOut(ClientAddr(OrigID), m_aSlots[OrigID].m_Connection.SeqSequence(), m_aSlots[OrigID].m_Connection.AckSequence(), m_aSlots[OrigID].m_Connection.SecurityToken(), m_aSlots[OrigID].m_Connection.ResendBuffer());
 	m_aSlots[OrigID].m_Connection.Reset();
+	UnhashSlot(OrigID);
+	HashSlot(ClientID);
 	return true;
 }
 
@@ -0,0 +1,270 @@
+#include "scheduler.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+static thread_local CScheduler* gs_pWorkerScheduler = nullptr;
+static thread_local int gs_WorkerIndex = -1;
+
+static int64_t ToMicroseconds(int64_t Time)
+{
+	return Time * 1000000 / time_freq();
+}
+
+void CScheduler::CHistogram::Add(int64_t Microseconds)
+{
+	const uint64_t Value = Microseconds > 0 ? (uint64_t)Microseconds : 0;
+	int Bucket = 0;
+	while(Bucket < NUM_LATENCY_BUCKETS - 1 && Value >= ((uint64_t)2 << Bucket))
+		Bucket++;
+
+	m_aBuckets[Bucket]++;
+	m_Count++;
+	m_Total += Value;
+	uint64_t Max = m_Max;
+	while(Value > Max && !m_Max.compare_exchange_weak(Max, Value))
+		;
+}
+
+uint64_t CScheduler::CHistogram::Percentile(double Fraction) const
+{
+	const uint64_t Count = m_Count;
+	if(!Count)
+		return 0;
+
+	const uint64_t Wanted = (uint64_t)(Count * Fraction);
+	uint64_t Seen = 0;
+	for(int i = 0; i < NUM_LATENCY_BUCKETS - 1; i++)
+	{
+		Seen += m_aBuckets[i];
+		if(Seen > Wanted)
+			return (uint64_t)2 << i;
+	}
+	return m_Max;
+}
+
+CScheduler::~CScheduler()
+{
+	Stop();
+}
+
+CScheduler& CScheduler::Get()
+{
+	static CScheduler s_Scheduler;
+	return s_Scheduler;
+}
+
+const char* CScheduler::PriorityName(int Priority)
+{
+	static const char* s_apNames[NUM_PRIORITIES] = { "tick", "io", "background" };
+	return s_apNames[Priority];
+}
+
+void CScheduler::Start(int NumThreads)
+{
+	if(m_Running)
+		return;
+
+	NumThreads = maximum(1, NumThreads);
+	m_Stopping = false;
+	for(int i = 0; i < NumThreads; i++)
+		m_vpWorkers.push_back(std::make_unique<CWorker>());
+
+	m_Running = true;
+	for(int i = 0; i < NumThreads; i++)
+		m_vThreads.emplace_back(&CScheduler::WorkerThread, this, i);
+}
+
+void CScheduler::Stop()
+{
+	if(!m_Running)
+		return;
+
+	// workers leave once the queues and the timer list are drained
+	{
+		std::lock_guard Lock(m_SleepLock);
+		m_Stopping = true;
+	}
+	m_WakeUp.notify_all();
+	for(auto& Thread : m_vThreads)
+		Thread.join();
+
+	m_Running = false;
+	m_vThreads.clear();
+	m_vpWorkers.clear();
+}
+
+void CScheduler::Add(int Priority, TTask Task)
+{
+	if(!m_Running)
+	{
+		Task();
+		return;
+	}
+
+	Push(Priority, std::move(Task), time_get_impl());
+	WakeUp(false);
+}
+
+void CScheduler::AddDelayed(int Priority, int Milliseconds, TTask Task)
+{
+	if(!m_Running)
+	{
+		Task();
+		return;
+	}
+
+	const int64_t Due = time_get_impl() + (int64_t)Milliseconds * time_freq() / 1000;
+	{
+		std::lock_guard Lock(m_SleepLock);
+		m_DelayedTasks.emplace(Due, CDelayedEntry { Priority, std::move(Task) });
+		m_NextDue = m_DelayedTasks.begin()->first;
+	}
+
+	// a sleeping worker has to shorten its wait
+	m_WakeUp.notify_one();
+}
+
+int CScheduler::Delayed()
+{
+	std::lock_guard Lock(m_SleepLock);
+	return (int)m_DelayedTasks.size();
+}
+
+void CScheduler::Push(int Priority, TTask Task, int64_t QueuedTime)
+{
+	// workers keep what they spawn, others spread round robin
+	const int Index = gs_pWorkerScheduler == this ? gs_WorkerIndex : (int)(m_NextWorker++ % m_vpWorkers.size());
+	CWorker* pWorker = m_vpWorkers[Index].get();
+	{
+		std::lock_guard Lock(pWorker->m_Lock);
+		pWorker->m_aQueues[Priority].push_back({ std::move(Task), QueuedTime });
+	}
+	m_aPending[Priority]++;
+}
+
+void CScheduler::WakeUp(bool All)
+{
+	// pass the lock once, a worker that saw no work is then already waiting
+	{
+		std::lock_guard Lock(m_SleepLock);
+	}
+
+	if(All)
+		m_WakeUp.notify_all();
+	else
+		m_WakeUp.notify_one();
+}
+
+bool CScheduler::Pop(int WorkerIndex, CEntry& Entry, int& Priority)
+{
+	const int NumWorkers = (int)m_vpWorkers.size();
+	for(Priority = 0; Priority < NUM_PRIORITIES; Priority++)
+	{
+		if(!m_aPending[Priority])
+			continue;
+
+		// own queue in order, then the newest task of another worker
+		for(int i = 0; i < NumWorkers; i++)
+		{
+			CWorker* pWorker = m_vpWorkers[(WorkerIndex + i) % NumWorkers].get();
+			std::lock_guard Lock(pWorker->m_Lock);
+			std::deque<CEntry>& Queue = pWorker->m_aQueues[Priority];
+			if(Queue.empty())
+				continue;
+
+			if(i == 0)
+			{
+				Entry = std::move(Queue.front());
+				Queue.pop_front();
+			}
+			else
+			{
+				Entry = std::move(Queue.back());
+				Queue.pop_back();
+				m_Steals++;
+			}
+			m_aPending[Priority]--;
+			return true;
+		}
+	}
+	return false;
+}
+
+int CScheduler::PromoteDelayed(int64_t Now, bool All)
+{
+	int Promoted = 0;
+	while(!m_DelayedTasks.empty() && (All || m_DelayedTasks.begin()->first <= Now))
+	{
+		auto Iter = m_DelayedTasks.begin();
+		const int64_t Due = minimum(Iter->first, Now);
+		Push(Iter->second.m_Priority, std::move(Iter->second.m_Task), Due);
+		m_DelayedTasks.erase(Iter);
+		Promoted++;
+	}
+	m_NextDue = m_DelayedTasks.empty() ? INT64_MAX : m_DelayedTasks.begin()->first;
+	return Promoted;
+}
+
+void CScheduler::RunTask(CEntry& Entry, int Priority)
+{
+	const int64_t Start = time_get_impl();
+	Entry.m_Task();
+	const int64_t End = time_get_impl();
+
+	m_aStats[Priority].m_Wait.Add(ToMicroseconds(Start - Entry.m_QueuedTime));
+	m_aStats[Priority].m_Run.Add(ToMicroseconds(End - Start));
+}
+
+int CScheduler::TotalPending() const
+{
+	int Pending = 0;
+	for(const auto& Value : m_aPending)
+		Pending += Value;
+	return Pending;
+}
+
+void CScheduler::WorkerThread(int Index)
+{
+	gs_pWorkerScheduler = this;
+	gs_WorkerIndex = Index;
+
+	while(true)
+	{
+		// busy workers still move due timers
+		if(time_get_impl() >= m_NextDue)
+		{
+			int Promoted;
+			{
+				std::lock_guard Lock(m_SleepLock);
+				Promoted = PromoteDelayed(time_get_impl(), false);
+			}
+			if(Promoted > 1)
+				m_WakeUp.notify_all();
+		}
+
+		CEntry Entry;
+		int Priority;
+		if(Pop(Index, Entry, Priority))
+		{
+			RunTask(Entry, Priority);
+			continue;
+		}
+
+		std::unique_lock Lock(m_SleepLock);
+		if(PromoteDelayed(time_get_impl(), m_Stopping) > 1)
+			m_WakeUp.notify_all();
+		if(TotalPending() > 0)
+			continue;
+		if(m_Stopping)
+			break;
+
+		if(m_DelayedTasks.empty())
+			m_WakeUp.wait(Lock);
+		else
+			m_WakeUp.wait_for(Lock, std::chrono::microseconds(maximum<int64_t>(1, ToMicroseconds(m_DelayedTasks.begin()->first - time_get_impl()))));
+	}
+
+	gs_pWorkerScheduler = nullptr;
+	gs_WorkerIndex = -1;
+}
@@ -0,0 +1,136 @@
+#ifndef ENGINE_SHARED_SCHEDULER_H
+#define ENGINE_SHARED_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+	Class: CScheduler
+		Process wide task scheduler with one deque per worker and priority.
+		Workers take their own tasks first and steal from the others when
+		they run dry, higher priorities are always served first.
+		Delayed tasks wait in a timer list and are moved into a queue
+		when they are due, so no worker has to sleep for them.
+		Before Start and after Stop tasks run on the calling thread.
+*/
+class CScheduler
+{
+public:
+	enum
+	{
+		PRIORITY_TICK = 0, // results are needed by the next game ticks
+		PRIORITY_IO, // network, files, blocking requests
+		PRIORITY_BACKGROUND, // maintenance, nobody waits for it
+		NUM_PRIORITIES,
+
+		// log2 buckets in microseconds, the last one collects everything above ~8 seconds
+		NUM_LATENCY_BUCKETS = 24,
+	};
+
+	using TTask = std::function<void()>;
+
+	class CHistogram
+	{
+		std::atomic<uint64_t> m_aBuckets[NUM_LATENCY_BUCKETS] {};
+		std::atomic<uint64_t> m_Count {};
+		std::atomic<uint64_t> m_Total {};
+		std::atomic<uint64_t> m_Max {};
+
+	public:
+		void Add(int64_t Microseconds);
+		uint64_t Count() const { return m_Count; }
+		uint64_t Max() const { return m_Max; }
+		double Average() const { return m_Count ? (double)m_Total / m_Count : 0.0; }
+
+		// upper bound of the bucket that holds the given fraction of the samples
+		uint64_t Percentile(double Fraction) const;
+	};
+
+	struct CQueueStats
+	{
+		CHistogram m_Wait;
+		CHistogram m_Run;
+	};
+
+	CScheduler() = default;
+	~CScheduler();
+
+	static CScheduler& Get();
+	static const char* PriorityName(int Priority);
+
+	void Start(int NumThreads);
+	void Stop();
+
+	void Add(int Priority, TTask Task);
+	void AddDelayed(int Priority, int Milliseconds, TTask Task);
+
+	template<typename F>
+	auto Submit(int Priority, F&& Fn) -> std::future<std::invoke_result_t<F>>
+	{
+		using TResult = std::invoke_result_t<F>;
+		auto pTask = std::make_shared<std::packaged_task<TResult()>>(std::forward<F>(Fn));
+		std::future<TResult> Future = pTask->get_future();
+		Add(Priority, [pTask]() { (*pTask)(); });
+		return Future;
+	}
+
+	int NumThreads() const { return (int)m_vThreads.size(); }
+	int Pending(int Priority) const { return m_aPending[Priority]; }
+	int Delayed();
+	uint64_t Steals() const { return m_Steals; }
+	const CQueueStats& Stats(int Priority) const { return m_aStats[Priority]; }
+
+private:
+	struct CEntry
+	{
+		TTask m_Task;
+		int64_t m_QueuedTime;
+	};
+
+	struct CWorker
+	{
+		std::mutex m_Lock;
+		std::deque<CEntry> m_aQueues[NUM_PRIORITIES];
+	};
+
+	struct CDelayedEntry
+	{
+		int m_Priority;
+		TTask m_Task;
+	};
+
+	std::vector<std::unique_ptr<CWorker>> m_vpWorkers;
+	std::vector<std::thread> m_vThreads;
+	std::atomic<bool> m_Running {};
+	std::atomic<int> m_aPending[NUM_PRIORITIES] {};
+	std::atomic<unsigned> m_NextWorker {};
+	std::atomic<uint64_t> m_Steals {};
+
+	// guards sleeping workers and the timer list
+	std::mutex m_SleepLock;
+	std::condition_variable m_WakeUp;
+	std::multimap<int64_t, CDelayedEntry> m_DelayedTasks;
+	std::atomic<int64_t> m_NextDue { INT64_MAX };
+	bool m_Stopping {};
+
+	CQueueStats m_aStats[NUM_PRIORITIES];
+
+	void Push(int Priority, TTask Task, int64_t QueuedTime);
+	void WakeUp(bool All);
+	bool Pop(int WorkerIndex, CEntry& Entry, int& Priority);
+	int PromoteDelayed(int64_t Now, bool All);
+	void RunTask(CEntry& Entry, int Priority);
+	void WorkerThread(int Index);
+	int TotalPending() const;
+};
+
+#endif
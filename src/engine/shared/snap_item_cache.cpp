@@ -0,0 +1,85 @@
+#include <base/system.h>
+
+#include "snap_item_cache.h"
+
+void CSnapItemCache::Clear()
+{
+	// capacity is kept, the next tick fills about as much again
+	m_vEntries.clear();
+	m_vItems.clear();
+	m_vData.clear();
+	m_vCellStart.clear();
+	m_vSorted.clear();
+	m_vSpanning.clear();
+	m_Width = 0;
+	m_Height = 0;
+}
+
+void CSnapItemCache::BeginEntry(vec2 Pos, vec2 PosTo, int Priority, bool Detail)
+{
+	m_vEntries.push_back({ Pos, PosTo, (int)m_vItems.size(), 0, Priority, Detail });
+}
+
+void CSnapItemCache::EndEntry()
+{
+	CEntry &Entry = m_vEntries.back();
+	Entry.m_NumItems = (int)m_vItems.size() - Entry.m_FirstItem;
+	if(!Entry.m_NumItems)
+		m_vEntries.pop_back();
+}
+
+void *CSnapItemCache::NewItem(int Type, int ID, int Size)
+{
+	dbg_assert(!m_vEntries.empty(), "snap item outside of an entry");
+	const int Offset = (int)m_vData.size();
+	m_vItems.push_back({ Type, ID, Size, Offset });
+	m_vData.resize(Offset + (Size + (int)sizeof(int) - 1) / (int)sizeof(int), 0);
+	return m_vData.data() + Offset;
+}
+
+void CSnapItemCache::Finish()
+{
+	if(m_vEntries.empty())
+		return;
+
+	vec2 Min = m_vEntries[0].m_Pos;
+	vec2 Max = Min;
+	for(const CEntry &Entry : m_vEntries)
+	{
+		for(vec2 Pos : { Entry.m_Pos, Entry.m_PosTo })
+		{
+			Min = vec2(minimum(Min.x, Pos.x), minimum(Min.y, Pos.y));
+			Max = vec2(maximum(Max.x, Pos.x), maximum(Max.y, Pos.y));
+		}
+	}
+
+	m_Origin = Min;
+	m_Width = clamp((int)((Max.x - Min.x) / CELL_SIZE) + 1, 1, (int)MAX_CELLS_PER_SIDE);
+	m_Height = clamp((int)((Max.y - Min.y) / CELL_SIZE) + 1, 1, (int)MAX_CELLS_PER_SIDE);
+
+	// counting sort of the entries by cell
+	std::vector<int> vCells(m_vEntries.size());
+	m_vCellStart.assign(m_Width * m_Height + 1, 0);
+	for(int i = 0; i < (int)m_vEntries.size(); i++)
+	{
+		const int Cell = CellIndex(m_vEntries[i].m_Pos);
+		if(Cell != CellIndex(m_vEntries[i].m_PosTo))
+		{
+			vCells[i] = -1;
+			m_vSpanning.push_back(i);
+			continue;
+		}
+		vCells[i] = Cell;
+		m_vCellStart[Cell + 1]++;
+	}
+	for(int i = 0; i < m_Width * m_Height; i++)
+		m_vCellStart[i + 1] += m_vCellStart[i];
+
+	std::vector<int> vFill(m_vCellStart.begin(), m_vCellStart.end() - 1);
+	m_vSorted.resize(m_vCellStart.back());
+	for(int i = 0; i < (int)m_vEntries.size(); i++)
+	{
+		if(vCells[i] != -1)
+			m_vSorted[vFill[vCells[i]]++] = i;
+	}
+}
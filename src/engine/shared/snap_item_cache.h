@@ -0,0 +1,109 @@
+#ifndef ENGINE_SHARED_SNAP_ITEM_CACHE_H
+#define ENGINE_SHARED_SNAP_ITEM_CACHE_H
+
+#include <base/vmath.h>
+
+#include <vector>
+
+/*
+	Class: CSnapItemCache
+		Snapshot items of one world that look the same to every client,
+		serialised once per snapshot tick. Items are grouped in entries,
+		one per entity, with the one or two positions the entity is
+		clipped by. Finish buckets the entries by cell so a client only
+		visits the cells around its view, entries reaching over two cells
+		are visited by every query.
+*/
+class CSnapItemCache
+{
+public:
+	enum
+	{
+		CELL_SIZE = 512,
+		MAX_CELLS_PER_SIDE = 256,
+	};
+
+	struct CItem
+	{
+		int m_Type;
+		int m_ID;
+		int m_Size; // in bytes
+		int m_Offset; // in ints
+	};
+
+	struct CEntry
+	{
+		vec2 m_Pos;
+		vec2 m_PosTo;
+		int m_FirstItem;
+		int m_NumItems;
+		int m_Priority;
+		bool m_Detail; // may be left out for far away clients
+	};
+
+	void Clear();
+
+	// items added until EndEntry belong to the entry, entries without items are dropped
+	void BeginEntry(vec2 Pos, vec2 PosTo, int Priority = 0, bool Detail = false);
+	void EndEntry();
+
+	// zeroed like CSnapshotBuilder::NewItem, valid until the next call
+	void *NewItem(int Type, int ID, int Size);
+
+	void Finish();
+
+	// visits the candidates inside the rectangle, the caller does the exact clip test
+	template<typename F>
+	void Query(vec2 Min, vec2 Max, F &&Fn) const
+	{
+		for(int Index : m_vSpanning)
+			Fn(m_vEntries[Index]);
+		if(m_vCellStart.empty())
+			return;
+
+		const int x0 = CellX(Min.x), x1 = CellX(Max.x);
+		const int y0 = CellY(Min.y), y1 = CellY(Max.y);
+		for(int y = y0; y <= y1; y++)
+		{
+			const int Row = y * m_Width;
+			for(int i = m_vCellStart[Row + x0]; i < m_vCellStart[Row + x1 + 1]; i++)
+				Fn(m_vEntries[m_vSorted[i]]);
+		}
+	}
+
+	// sorts the candidates inside the rectangle into one list per priority, Filter(Entry) false skips an entry
+	template<typename F>
+	void Collect(vec2 Min, vec2 Max, std::vector<const CEntry *> *pvByPriority, int NumPriorities, F &&Filter) const
+	{
+		for(int i = 0; i < NumPriorities; i++)
+			pvByPriority[i].clear();
+		Query(Min, Max, [&](const CEntry &Entry) {
+			if(Filter(Entry))
+				pvByPriority[clamp(Entry.m_Priority, 0, NumPriorities - 1)].push_back(&Entry);
+		});
+	}
+
+	const CItem &GetItem(int Index) const { return m_vItems[Index]; }
+	const int *GetItemData(const CItem &Item) const { return m_vData.data() + Item.m_Offset; }
+	int NumEntries() const { return (int)m_vEntries.size(); }
+	int NumItems() const { return (int)m_vItems.size(); }
+
+private:
+	std::vector<CEntry> m_vEntries;
+	std::vector<CItem> m_vItems;
+	std::vector<int> m_vData;
+
+	// entries of a cell are m_vSorted[m_vCellStart[Cell]..m_vCellStart[Cell + 1]]
+	std::vector<int> m_vCellStart;
+	std::vector<int> m_vSorted;
+	std::vector<int> m_vSpanning;
+	vec2 m_Origin;
+	int m_Width = 0;
+	int m_Height = 0;
+
+	int CellX(float Pos) const { return clamp((int)((Pos - m_Origin.x) / CELL_SIZE), 0, m_Width - 1); }
+	int CellY(float Pos) const { return clamp((int)((Pos - m_Origin.y) / CELL_SIZE), 0, m_Height - 1); }
+	int CellIndex(vec2 Pos) const { return CellY(Pos.y) * m_Width + CellX(Pos.x); }
+};
+
+#endif
@@ -147,53 +147,48 @@ bool CSnapshot::IsValid(size_t ActualSize) const
 
 // CSnapshotDelta
 
-enum
-{
-	HASHLIST_SIZE = 256,
-	HASHLIST_BUCKET_SIZE = 64,
-};
-
-struct CItemList
-{
-	int m_Num;
-	int m_aKeys[HASHLIST_BUCKET_SIZE];
-	int m_aIndex[HASHLIST_BUCKET_SIZE];
-};
-
-inline size_t CalcHashID(int Key)
+int CSnapshotDelta::CKeyHash::Bucket(int Key)
 {
 	// djb2 (http://www.cse.yorku.ca/~oz/hash.html)
 	unsigned Hash = 5381;
 	for(unsigned Shift = 0; Shift < sizeof(int); Shift++)
 		Hash = ((Hash << 5) + Hash) + ((Key >> (Shift * 8)) & 0xFF);
-	return Hash % HASHLIST_SIZE;
+	return Hash % NUM_BUCKETS;
 }
 
-static void GenerateHash(CItemList *pHashlist, const CSnapshot *pSnapshot)
+void CSnapshotDelta::CKeyHash::Generate(const CSnapshot *pSnapshot)
 {
-	for(int i = 0; i < HASHLIST_SIZE; i++)
-		pHashlist[i].m_Num = 0;
+	// counting sort by bucket, the keys of a bucket end up next to each other
+	const int NumItems = minimum(pSnapshot->NumItems(), (int)CSnapshot::MAX_ITEMS);
+	int aKeys[CSnapshot::MAX_ITEMS];
+	unsigned char aBuckets[CSnapshot::MAX_ITEMS];
+	mem_zero(m_aBucketStart, sizeof(m_aBucketStart));
+	for(int i = 0; i < NumItems; i++)
+	{
+		aKeys[i] = pSnapshot->GetItem(i)->Key();
+		aBuckets[i] = Bucket(aKeys[i]);
+		m_aBucketStart[aBuckets[i] + 1]++;
+	}
+	for(int i = 0; i < NUM_BUCKETS; i++)
+		m_aBucketStart[i + 1] += m_aBucketStart[i];
 
-	for(int i = 0; i < pSnapshot->NumItems(); i++)
+	short aFill[NUM_BUCKETS];
+	mem_copy(aFill, m_aBucketStart, sizeof(aFill));
+	for(int i = 0; i < NumItems; i++)
 	{
-		int Key = pSnapshot->GetItem(i)->Key();
-		size_t HashID = CalcHashID(Key);
-		if(pHashlist[HashID].m_Num < HASHLIST_BUCKET_SIZE)
-		{
-			pHashlist[HashID].m_aIndex[pHashlist[HashID].m_Num] = i;
-			pHashlist[HashID].m_aKeys[pHashlist[HashID].m_Num] = Key;
-			pHashlist[HashID].m_Num++;
-		}
+		const int Slot = aFill[aBuckets[i]]++;
+		m_aKeys[Slot] = aKeys[i];
+		m_aIndex[Slot] = i;
 	}
 }
 
-static int GetItemIndexHashed(int Key, const CItemList *pHashlist)
+int CSnapshotDelta::CKeyHash::Find(int Key) const
 {
-	size_t HashID = CalcHashID(Key);
-	for(int i = 0; i < pHashlist[HashID].m_Num; i++)
+	const int HashID = Bucket(Key);
+	for(int i = m_aBucketStart[HashID]; i < m_aBucketStart[HashID + 1]; i++)
 	{
-		if(pHashlist[HashID].m_aKeys[i] == Key)
-			return pHashlist[HashID].m_aIndex[i];
+		if(m_aKeys[i] == Key)
+			return m_aIndex[i];
 	}
 
 	return -1;
@@ -267,8 +262,7 @@ const CSnapshotDelta::CData *CSnapshotDelta::EmptyDelta() const
 	return &m_Empty;
 }
 
-// TODO: OPT: this should be made much faster
-int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, CSnapshot *pTo, void *pDstData)
+int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, CSnapshot *pTo, void *pDstData, const CKeyHash *pFromHash)
 {
 	CData *pDelta = (CData *)pDstData;
 	int *pData = (int *)pDelta->m_aData;
@@ -277,14 +271,14 @@ int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, CSnapshot *pTo, void *pD
 	pDelta->m_NumUpdateItems = 0;
 	pDelta->m_NumTempItems = 0;
 
-	CItemList aHashlist[HASHLIST_SIZE];
-	GenerateHash(aHashlist, pTo);
+	CKeyHash ToHash;
+	ToHash.Generate(pTo);
 
 	// pack deleted stuff
 	for(int i = 0; i < pFrom->NumItems(); i++)
 	{
 		const CSnapshotItem *pFromItem = pFrom->GetItem(i);
-		if(GetItemIndexHashed(pFromItem->Key(), aHashlist) == -1)
+		if(ToHash.Find(pFromItem->Key()) == -1)
 		{
 			// deleted
 			pDelta->m_NumDeletedItems++;
@@ -293,7 +287,12 @@ int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, CSnapshot *pTo, void *pD
 		}
 	}
 
-	GenerateHash(aHashlist, pFrom);
+	CKeyHash FromHash;
+	if(!pFromHash)
+	{
+		FromHash.Generate(pFrom);
+		pFromHash = &FromHash;
+	}
 
 	// fetch previous indices
 	// we do this as a separate pass because it helps the cache
@@ -302,7 +301,7 @@ int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, CSnapshot *pTo, void *pD
 	for(int i = 0; i < NumItems; i++)
 	{
 		const CSnapshotItem *pCurItem = pTo->GetItem(i); // O(1) .. O(n)
-		aPastIndices[i] = GetItemIndexHashed(pCurItem->Key(), aHashlist); // O(n) .. O(n^n)
+		aPastIndices[i] = pFromHash->Find(pCurItem->Key());
 	}
 
 	for(int i = 0; i < NumItems; i++)
@@ -475,6 +474,7 @@ void CSnapshotStorage::PurgeAll()
 	while(pHolder)
 	{
 		CHolder *pNext = pHolder->m_pNext;
+		delete pHolder->m_pKeyHash;
 		free(pHolder);
 		pHolder = pNext;
 	}
@@ -493,6 +493,7 @@ void CSnapshotStorage::PurgeUntil(int Tick)
 		CHolder *pNext = pHolder->m_pNext;
 		if(pHolder->m_Tick >= Tick)
 			return; // no more to remove
+		delete pHolder->m_pKeyHash;
 		free(pHolder);
 
 		// did we come to the end of the list?
@@ -526,6 +527,7 @@ void CSnapshotStorage::Add(int Tick, int64_t Tagtime, int DataSize, const void *
 	pHolder->m_Tick = Tick;
 	pHolder->m_Tagtime = Tagtime;
 	pHolder->m_SnapSize = DataSize;
+	pHolder->m_pKeyHash = nullptr;
 	pHolder->m_pSnap = (CSnapshot *)(pHolder + 1);
 	mem_copy(pHolder->m_pSnap, pData, DataSize);
 
@@ -551,7 +553,7 @@ void CSnapshotStorage::Add(int Tick, int64_t Tagtime, int DataSize, const void *
 	m_pLast = pHolder;
 }
 
-int CSnapshotStorage::Get(int Tick, int64_t *pTagtime, const CSnapshot **ppData, const CSnapshot **ppAltData)
+int CSnapshotStorage::Get(int Tick, int64_t *pTagtime, const CSnapshot **ppData, const CSnapshot **ppAltData, const CSnapshotDelta::CKeyHash **ppKeyHash)
 {
 	CHolder *pHolder = m_pFirst;
 
@@ -565,6 +567,15 @@ int CSnapshotStorage::Get(int Tick, int64_t *pTagtime, const CSnapshot **ppData,
 				*ppData = pHolder->m_pSnap;
 			if(ppAltData)
 				*ppAltData = pHolder->m_pAltSnap;
+			if(ppKeyHash)
+			{
+				if(!pHolder->m_pKeyHash)
+				{
+					pHolder->m_pKeyHash = new CSnapshotDelta::CKeyHash;
+					pHolder->m_pKeyHash->Generate(pHolder->m_pSnap);
+				}
+				*ppKeyHash = pHolder->m_pKeyHash;
+			}
 			return pHolder->m_SnapSize;
 		}
 
@@ -584,6 +595,7 @@ void CSnapshotBuilder::Init(bool Sixup)
 {
 	m_DataSize = 0;
 	m_NumItems = 0;
+	m_NumDropped = 0;
 
 	for(int i = 0; i < m_NumExtendedItemTypes; i++)
 	{
@@ -663,6 +675,7 @@ void *CSnapshotBuilder::NewItem(int Type, int ID, int Size)
 	{
 		dbg_assert(m_DataSize < CSnapshot::MAX_SIZE, "too much data");
 		dbg_assert(m_NumItems < CSnapshot::MAX_ITEMS, "too many items");
+		m_NumDropped++;
 		return 0;
 	}
 
@@ -77,6 +77,25 @@ public:
 		int m_aData[1];
 	};
 
+	// key to item index of one snapshot, a snapshot used as delta base more than once keeps it
+	class CKeyHash
+	{
+		enum
+		{
+			NUM_BUCKETS = 256,
+		};
+
+		short m_aBucketStart[NUM_BUCKETS + 1];
+		int m_aKeys[CSnapshot::MAX_ITEMS];
+		short m_aIndex[CSnapshot::MAX_ITEMS];
+
+		static int Bucket(int Key);
+
+	public:
+		void Generate(const CSnapshot *pSnapshot);
+		int Find(int Key) const;
+	};
+
 private:
 	enum
 	{
@@ -97,7 +116,7 @@ public:
 	int GetDataUpdates(int Index) const { return m_aSnapshotDataUpdates[Index]; }
 	void SetStaticsize(int ItemType, int Size);
 	const CData *EmptyDelta() const;
-	int CreateDelta(const class CSnapshot *pFrom, class CSnapshot *pTo, void *pDstData);
+	int CreateDelta(const class CSnapshot *pFrom, class CSnapshot *pTo, void *pDstData, const CKeyHash *pFromHash = nullptr);
 	int UnpackDelta(const class CSnapshot *pFrom, class CSnapshot *pTo, const void *pSrcData, int DataSize);
 };
 
@@ -120,6 +139,7 @@ public:
 
 		CSnapshot *m_pSnap;
 		CSnapshot *m_pAltSnap;
+		CSnapshotDelta::CKeyHash *m_pKeyHash; // built on the first request
 	};
 
 	CHolder *m_pFirst;
@@ -131,7 +151,7 @@ public:
 	void PurgeAll();
 	void PurgeUntil(int Tick);
 	void Add(int Tick, int64_t Tagtime, int DataSize, const void *pData, int AltDataSize, const void *pAltData);
-	int Get(int Tick, int64_t *pTagtime, const CSnapshot **ppData, const CSnapshot **ppAltData);
+	int Get(int Tick, int64_t *pTagtime, const CSnapshot **ppData, const CSnapshot **ppAltData, const CSnapshotDelta::CKeyHash **ppKeyHash = nullptr);
 };
 
 class CSnapshotBuilder
@@ -146,6 +166,7 @@ class CSnapshotBuilder
 
 	int m_aOffsets[CSnapshot::MAX_ITEMS];
 	int m_NumItems;
+	int m_NumDropped;
 
 	int m_aExtendedItemTypes[MAX_EXTENDED_ITEM_TYPES];
 	int m_NumExtendedItemTypes;
@@ -164,6 +185,9 @@ public:
 	CSnapshotItem *GetItem(int Index);
 	int *GetItemData(int Key);
 
+	// items that did not fit anymore since Init
+	int NumDropped() const { return m_NumDropped; }
+
 	int Finish(void *pSnapdata);
 };
 
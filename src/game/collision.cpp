@@ -34,14 +34,23 @@ CCollision::CCollision()
 	m_pLayers = nullptr;
 	m_Width = 0;
 	m_Height = 0;
+	m_SightStride = 0;
+	m_SightGeneration = 1;
+	m_SightRays = 0;
+	m_SightCacheHits = 0;
 }
 
 void CCollision::Init(class CLayers *pLayers)
 {
 	m_pLayers = pLayers;
-	m_Width = m_pLayers->GameLayer()->m_Width;
-	m_Height = m_pLayers->GameLayer()->m_Height;
-	m_pTiles = static_cast<CTile *>(m_pLayers->Map()->GetData(m_pLayers->GameLayer()->m_Data));
+	Init(static_cast<CTile *>(m_pLayers->Map()->GetData(m_pLayers->GameLayer()->m_Data)), m_pLayers->GameLayer()->m_Width, m_pLayers->GameLayer()->m_Height);
+}
+
+void CCollision::Init(class CTile *pTiles, int Width, int Height)
+{
+	m_Width = Width;
+	m_Height = Height;
+	m_pTiles = pTiles;
 
 	for(int i = 0; i < m_Width*m_Height; i++)
 	{
@@ -85,6 +94,25 @@ void CCollision::Init(class CLayers *pLayers)
 			m_pTiles[i].m_Reserved = static_cast< char >(Index);
 		}
 	}
+
+	InitSightMask();
+}
+
+void CCollision::InitSightMask()
+{
+	m_SightStride = (m_Width + 63) / 64;
+	m_vSightMask.assign((size_t)m_SightStride * m_Height, 0);
+	for(int y = 0; y < m_Height; y++)
+	{
+		for(int x = 0; x < m_Width; x++)
+		{
+			if(IsTile(x * 32, y * 32, COLFLAG_SOLID | COLFLAG_DISALLOW_MOVE))
+				m_vSightMask[y * m_SightStride + (x >> 6)] |= (uint64_t)1 << (x & 63);
+		}
+	}
+
+	m_vSightCache.assign(SIGHT_CACHE_SIZE, CSightEntry {0, 0, false});
+	m_SightGeneration = 1;
 }
 
 int CCollision::GetTile(int x, int y) const
@@ -285,6 +313,92 @@ bool CCollision::IntersectLineColFlag(vec2 Pos0, vec2 Pos1, vec2* pOutCollision,
 	return false;
 }
 
+// the tile walk of IntersectLineColFlag against the sight mask, no output positions
+bool CCollision::WalkSight(vec2 Pos0, vec2 Pos1) const
+{
+	const int Tile0X = round_to_int(Pos0.x) / 32;
+	const int Tile0Y = round_to_int(Pos0.y) / 32;
+	const int Tile1X = round_to_int(Pos1.x) / 32;
+	const int Tile1Y = round_to_int(Pos1.y) / 32;
+
+	const float Ratio = (Tile0X == Tile1X) ? 1.f : (Pos1.y - Pos0.y) / (Pos1.x - Pos0.x);
+	const float DetPos = Pos0.x * Pos1.y - Pos0.y * Pos1.x;
+
+	const int DeltaTileX = (Tile0X <= Tile1X) ? 1 : -1;
+	const int DeltaTileY = (Tile0Y <= Tile1Y) ? 1 : -1;
+
+	const float DeltaError = DeltaTileY * DeltaTileX * Ratio;
+
+	int CurTileX = Tile0X;
+	int CurTileY = Tile0Y;
+
+	float Error = 0;
+	if(Tile0Y != Tile1Y && Tile0X != Tile1X)
+	{
+		Error = (CurTileX * Ratio - CurTileY - DetPos / (32 * (Pos1.x - Pos0.x))) * DeltaTileY;
+		if(Tile0X < Tile1X)
+			Error += Ratio * DeltaTileY;
+		if(Tile0Y < Tile1Y)
+			Error -= DeltaTileY;
+	}
+
+	while(CurTileX != Tile1X || CurTileY != Tile1Y)
+	{
+		if(IsSightBlocked(CurTileX, CurTileY))
+			return true;
+		if(CurTileY != Tile1Y && (CurTileX == Tile1X || Error > 0))
+		{
+			CurTileY += DeltaTileY;
+			Error -= 1;
+		}
+		else
+		{
+			CurTileX += DeltaTileX;
+			Error += DeltaError;
+		}
+	}
+	return IsSightBlocked(CurTileX, CurTileY);
+}
+
+bool CCollision::IntersectSight(vec2 Pos0, vec2 Pos1) const
+{
+	bool Blocked;
+	IntersectSight(Pos0, &Pos1, 1, &Blocked);
+	return Blocked;
+}
+
+void CCollision::IntersectSight(vec2 From, const vec2 *pTo, int Num, bool *pBlocked) const
+{
+	if(m_vSightMask.empty())
+	{
+		for(int i = 0; i < Num; i++)
+			pBlocked[i] = false;
+		return;
+	}
+
+	// tile coordinates packed as 16 bits each, positions far outside of the map may alias
+	auto PackTile = [](vec2 Pos) { return (uint32_t)(round_to_int(Pos.y) / 32 & 0xffff) << 16 | (uint32_t)(round_to_int(Pos.x) / 32 & 0xffff); };
+	const uint32_t FromTile = PackTile(From);
+	for(int i = 0; i < Num; i++)
+	{
+		// the pair is stored in one order, so A->B and B->A share an entry
+		const uint32_t ToTile = PackTile(pTo[i]);
+		const uint64_t Key = FromTile < ToTile ? ((uint64_t)FromTile << 32 | ToTile) : ((uint64_t)ToTile << 32 | FromTile);
+		CSightEntry& Entry = m_vSightCache[(Key * 0x9E3779B97F4A7C15ull) >> 52 & (SIGHT_CACHE_SIZE - 1)];
+
+		m_SightRays++;
+		if(Entry.m_Generation == m_SightGeneration && Entry.m_Key == Key)
+		{
+			m_SightCacheHits++;
+			pBlocked[i] = Entry.m_Blocked;
+			continue;
+		}
+
+		pBlocked[i] = WalkSight(From, pTo[i]);
+		Entry = CSightEntry {Key, m_SightGeneration, pBlocked[i]};
+	}
+}
+
 // Cord 'X','x' or 'Y','y' | SumSymbol '+' or '-'
 vec2 CCollision::FindDirCollision(int CheckNum, vec2 SourceVec, char Cord, char SumSymbol) const
 {
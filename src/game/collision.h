@@ -5,6 +5,9 @@
 
 #include <base/vmath.h>
 
+#include <cstdint>
+#include <vector>
+
 enum
 {
 	CANTMOVE_LEFT = 1 << 0,
@@ -28,6 +31,34 @@ class CCollision
 	bool IsTile(int x, int y, int Flag=COLFLAG_SOLID) const;
 	int GetTile(int x, int y) const;
 
+	// line of sight: one bit per tile that blocks sight (solid or invisible wall)
+	struct CSightEntry
+	{
+		uint64_t m_Key;
+		unsigned m_Generation;
+		bool m_Blocked;
+	};
+	enum
+	{
+		SIGHT_CACHE_SIZE = 4096, // power of two
+	};
+	std::vector<uint64_t> m_vSightMask;
+	int m_SightStride;
+	mutable std::vector<CSightEntry> m_vSightCache;
+	mutable unsigned m_SightGeneration;
+	mutable uint64_t m_SightRays;
+	mutable uint64_t m_SightCacheHits;
+
+	void InitSightMask();
+	bool IsSightBlocked(int TileX, int TileY) const
+	{
+		// outside of the map counts as the border tile, like GetTile
+		TileX = clamp(TileX, 0, m_Width - 1);
+		TileY = clamp(TileY, 0, m_Height - 1);
+		return (m_vSightMask[TileY * m_SightStride + (TileX >> 6)] >> (TileX & 63)) & 1;
+	}
+	bool WalkSight(vec2 Pos0, vec2 Pos1) const;
+
 public:
 	enum
 	{
@@ -40,6 +71,7 @@ public:
 
 	CCollision();
 	void Init(class CLayers *pLayers);
+	void Init(class CTile *pTiles, int Width, int Height); // game layer tiles, converted in place
 	bool CheckPoint(float x, float y, int Flag=COLFLAG_SOLID) const { return IsTile(round_to_int(x), round_to_int(y), Flag); }
 	bool CheckPoint(vec2 Pos, int Flag=COLFLAG_SOLID) const { return CheckPoint(Pos.x, Pos.y, Flag); }
 	int GetCollisionAt(float x, float y) const { return GetTile(round_to_int(x), round_to_int(y)); }
@@ -65,6 +97,23 @@ public:
 		return IntersectLineColFlag(Pos0, Pos1, pOutCollision, pOutBeforeCollision, COLFLAG_DISALLOW_MOVE | COLFLAG_SOLID);
 	};
 	bool IntersectLineColFlag(vec2 Pos0, vec2 Pos1, vec2* pOutCollision, vec2* pOutBeforeCollision, int ColFlag) const;
+
+	/*
+		Function: IntersectSight
+			IntersectLineWithInvisible without the output positions. Walks
+			a packed bit grid and memoises the answer for every pair of
+			tiles until ResetSightCache is called, so all lines between
+			the same two tiles share one result within a tick.
+
+		Returns:
+			True if the line is blocked.
+	*/
+	bool IntersectSight(vec2 Pos0, vec2 Pos1) const;
+	void IntersectSight(vec2 From, const vec2 *pTo, int Num, bool *pBlocked) const;
+	void ResetSightCache() { m_SightGeneration++; }
+	uint64_t GetSightRays() const { return m_SightRays; }
+	uint64_t GetSightCacheHits() const { return m_SightCacheHits; }
+
 	void MovePoint(vec2 *pInoutPos, vec2 *pInoutVel, float Elasticity, int *pBounces) const;
 	void MoveBox(vec2 *pInoutPos, vec2 *pInoutVel, vec2 Size, float Elasticity, bool *pDeath=NULL) const;
 	bool TestBox(vec2 Pos, vec2 Size, int Flag=COLFLAG_SOLID) const;
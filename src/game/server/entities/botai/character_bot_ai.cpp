@@ -145,7 +145,7 @@ void CCharacterBotAI::GiveRandomEffects(int ClientID)
 		{
 			const int MobID = m_pBotPlayer->GetBotMobID();
 			if(const CMobBuffDebuff* pBuff = MobBotInfo::ms_aMobBot[MobID].GetRandomEffect())
-				pPlayer->GiveEffect(pBuff->getEffect(), pBuff->getTime(), pBuff->getChance());
+				pPlayer->GiveEffect(pBuff->getEffectID(), pBuff->getTime(), pBuff->getChance());
 		}
 	}
 }
@@ -1096,7 +1096,7 @@ CPlayer* CCharacterBotAI::SearchPlayer(float Distance) const
 			continue;
 
 		// Skip the iteration if there is a collision between the bot and the player's character
-		if(GS()->Collision()->IntersectLineWithInvisible(GS()->m_apPlayers[i]->GetCharacter()->m_Core.m_Pos, m_Pos, nullptr, nullptr))
+		if(GS()->Collision()->IntersectSight(GS()->m_apPlayers[i]->GetCharacter()->m_Core.m_Pos, m_Pos))
 			continue;
 
 		// Skip the iteration if the player is not in the same world as the bot
@@ -1149,9 +1149,13 @@ CPlayer* CCharacterBotAI::SearchTankPlayer(float Distance)
 		return nullptr;
 
 	// throw off the lifetime of a target
-	AI()->GetTarget()->UpdateCollised(GS()->Collision()->IntersectLineWithInvisible(pPlayer->GetCharacter()->GetPos(), m_Pos, nullptr, nullptr));
+	AI()->GetTarget()->UpdateCollised(GS()->Collision()->IntersectSight(pPlayer->GetCharacter()->GetPos(), m_Pos));
 
-	// looking for a stronger
+	// collect the candidates first, their lines of sight are checked in one batch
+	int NumCandidates = 0;
+	CPlayer* apCandidates[MAX_PLAYERS];
+	vec2 aCandidatePos[MAX_PLAYERS];
+	bool aCandidateCollised[MAX_PLAYERS];
 	for(int i = 0; i < MAX_PLAYERS; i++)
 	{
 		// Skip the iteration if the bot is a quest mob type and the player is not active for the bot
@@ -1177,11 +1181,20 @@ CPlayer* CCharacterBotAI::SearchTankPlayer(float Distance)
 			}
 		}
 
+		apCandidates[NumCandidates] = pFinderHard;
+		aCandidatePos[NumCandidates] = pFinderHard->GetCharacter()->m_Core.m_Pos;
+		NumCandidates++;
+	}
+	GS()->Collision()->IntersectSight(m_Core.m_Pos, aCandidatePos, NumCandidates, aCandidateCollised);
+
+	// looking for a stronger
+	for(int c = 0; c < NumCandidates; c++)
+	{
 		// check if the player is tastier for the bot
-		const bool FinderCollised = GS()->Collision()->IntersectLineWithInvisible(pFinderHard->GetCharacter()->m_Core.m_Pos, m_Core.m_Pos, nullptr, nullptr);
-		if(!FinderCollised && pFinderHard->GetAttributeSize(AttributeIdentifier::HP) > pPlayer->GetAttributeSize(AttributeIdentifier::HP))
+		CPlayer* pFinderHard = apCandidates[c];
+		if(!aCandidateCollised[c] && pFinderHard->GetAttributeSize(AttributeIdentifier::HP) > pPlayer->GetAttributeSize(AttributeIdentifier::HP))
 		{
-			AI()->GetTarget()->Set(i, 100);
+			AI()->GetTarget()->Set(pFinderHard->GetCID(), 100);
 			pPlayer = pFinderHard;
 		}
 	}
@@ -1227,7 +1240,7 @@ CPlayerBot* CCharacterBotAI::SearchMob(float Distance) const
 				continue;
 
 			// Check walls and closed lines
-			if(GS()->Collision()->IntersectLineWithInvisible(pSearchBotPlayer->GetCharacter()->m_Core.m_Pos, m_Core.m_Pos, nullptr, nullptr))
+			if(GS()->Collision()->IntersectSight(pSearchBotPlayer->GetCharacter()->m_Core.m_Pos, m_Core.m_Pos))
 				continue;
 
 			pBotPlayer = dynamic_cast<CPlayerBot*>(GS()->m_apPlayers[i]);
@@ -1253,7 +1266,7 @@ bool CCharacterBotAI::SearchPlayersToTalk()
 			continue;
 
 		// check walls and closed lines
-		if(GS()->Collision()->IntersectLineWithInvisible(pPlayer->GetCharacter()->m_Core.m_Pos, m_Core.m_Pos, nullptr, nullptr))
+		if(GS()->Collision()->IntersectSight(pPlayer->GetCharacter()->m_Core.m_Pos, m_Core.m_Pos))
 			continue;
 
 		pPlayer->GetCharacter()->m_SafeAreaForTick = true;
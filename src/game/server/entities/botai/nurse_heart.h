@@ -15,6 +15,7 @@ public:
 
 	// Override the Snap() function from the CEntity class
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared(vec2* pClipTo) const override { return true; }
 
 private:
 	int m_ClientID; // An integer variable to store the ClientID
@@ -642,14 +642,12 @@ void CCharacter::Tick()
 
 	// handle tiles
 	// safe change world data from tick
-	int Index = TILE_AIR;
-	HandleTilesets(&Index);
-	if(GetHelper()->TileEnter(Index, TILE_WORLD_SWAP))
+	HandleTilesets();
+	if(GetHelper()->TileEnter(TILE_WORLD_SWAP))
 	{
 		GS()->GetWorldData()->Move(m_pPlayer);
 		return;
 	}
-	else if(GetHelper()->TileExit(Index, TILE_WORLD_SWAP)) { }
 
 	// handle
 	HandleWeapons();
@@ -969,7 +967,7 @@ bool CCharacter::TakeDamage(vec2 Force, int Dmg, int FromCID, int Weapon)
 		std::for_each(PotionTools::Heal::getList().begin(), PotionTools::Heal::getList().end(), [this](const PotionTools::Heal& p)
 		{
 			CPlayerItem* pPlayerItem = m_pPlayer->GetItem(p.getItemID());
-			if(!m_pPlayer->IsActiveEffect(p.getEffect()) && pPlayerItem->IsEquipped())
+			if(!m_pPlayer->IsActiveEffect(p.getEffectID()) && pPlayerItem->IsEquipped())
 				pPlayerItem->Use(1);
 		});
 	}
@@ -1097,44 +1095,31 @@ void CCharacter::PostSnap()
 	m_TriggeredEvents = 0;
 }
 
-void CCharacter::HandleTilesets(int* pIndex)
+void CCharacter::HandleTilesets()
 {
-	// get index tileset char pos component items
+	// get index tileset char pos, everything else only runs when it changes
 	const int Tile = GS()->Collision()->GetParseTilesAt(m_Core.m_Pos.x, m_Core.m_Pos.y);
-	if(pIndex)
+	if(m_pHelper->Update(Tile))
 	{
-		(*pIndex) = Tile;
+		// component zones
+		if(!m_pPlayer->IsBot())
+			GS()->Mmo()->OnPlayerHandleTile(this, m_pHelper->GetPrevTile(), Tile);
+
+		// next for all bots & players
+		if(Tile >= TILE_CLEAR_EVENTS && Tile <= TILE_EVENT_HEALTH)
+			SetEvent(Tile);
+
+		// water effect enter exit
+		const int ClientID = m_pPlayer->GetCID();
+		if(m_pHelper->TileEnter(TILE_WATER) || m_pHelper->TileExit(TILE_WATER))
+			GS()->CreateDeath(m_Core.m_Pos, ClientID);
+
+		// chairs
+		if(m_pHelper->TileEnter(TILE_CHAIR) || m_pHelper->TileExit(TILE_CHAIR))
+			GS()->CreatePlayerSpawn(m_Core.m_Pos, CmaskOne(ClientID));
 	}
 
-	if(!m_pPlayer->IsBot() && GS()->Mmo()->OnPlayerHandleTile(this, Tile))
-		return;
-
-	// next for all bots & players
-	for(int i = TILE_CLEAR_EVENTS; i <= TILE_EVENT_HEALTH; i++)
-	{
-		if(m_pHelper->TileEnter(Tile, i))
-			SetEvent(i);
-		else if(m_pHelper->TileExit(Tile, i)) { }
-	}
-
-	// water effect enter exit
-	int ClientID = m_pPlayer->GetCID();
-	if(m_pHelper->TileEnter(Tile, TILE_WATER) || m_pHelper->TileExit(Tile, TILE_WATER))
-	{
-		GS()->CreateDeath(m_Core.m_Pos, ClientID);
-	}
-
-	// chairs
-	if(GetHelper()->TileEnter(Tile, TILE_CHAIR))
-	{
-		GS()->CreatePlayerSpawn(m_Core.m_Pos, CmaskOne(ClientID));
-	}
-	else if(GetHelper()->TileExit(Tile, TILE_CHAIR))
-	{
-		GS()->CreatePlayerSpawn(m_Core.m_Pos, CmaskOne(ClientID));
-	}
-
-	if(GetHelper()->BoolIndex(TILE_CHAIR))
+	if(m_pHelper->BoolIndex(TILE_CHAIR))
 		m_pPlayer->Account()->HandleChair();
 }
 
@@ -1232,7 +1217,7 @@ void CCharacter::HandleIndependentTuning()
 
 void CCharacter::HandleBuff(CTuningParams* TuningParams)
 {
-	if(m_pPlayer->IsActiveEffect("Slowdown"))
+	if(m_pPlayer->IsActiveEffect(CEffects::SLOWDOWN))
 	{
 		TuningParams->m_Gravity = 0.35f;
 		TuningParams->m_GroundFriction = 0.45f;
@@ -1249,18 +1234,18 @@ void CCharacter::HandleBuff(CTuningParams* TuningParams)
 	// poisons
 	if(Server()->Tick() % Server()->TickSpeed() == 0)
 	{
-		if(m_pPlayer->IsActiveEffect("Fire"))
+		if(m_pPlayer->IsActiveEffect(CEffects::FIRE))
 		{
 			const int ExplodeDamageSize = translate_to_percent_rest(m_pPlayer->GetStartHealth(), 3);
 			GS()->CreateExplosion(m_Core.m_Pos, m_pPlayer->GetCID(), WEAPON_GRENADE, 0);
 			TakeDamage(vec2(0, 0), ExplodeDamageSize, m_pPlayer->GetCID(), WEAPON_SELF);
 		}
-		if(m_pPlayer->IsActiveEffect("Poison"))
+		if(m_pPlayer->IsActiveEffect(CEffects::POISON))
 		{
 			const int PoisonSize = translate_to_percent_rest(m_pPlayer->GetStartHealth(), 3);
 			TakeDamage(vec2(0, 0), PoisonSize, m_pPlayer->GetCID(), WEAPON_SELF);
 		}
-		if(m_pPlayer->IsActiveEffect("RegenMana"))
+		if(m_pPlayer->IsActiveEffect(CEffects::REGEN_MANA))
 		{
 			const int RestoreMana = translate_to_percent_rest(m_pPlayer->GetStartMana(), 5);
 			IncreaseMana(RestoreMana);
@@ -1269,7 +1254,7 @@ void CCharacter::HandleBuff(CTuningParams* TuningParams)
 		// worker health potions
 		std::for_each(PotionTools::Heal::getList().begin(), PotionTools::Heal::getList().end(), [this](const PotionTools::Heal& p)
 		{
-			if(m_pPlayer->IsActiveEffect(p.getEffect()))
+			if(m_pPlayer->IsActiveEffect(p.getEffectID()))
 				IncreaseHealth(p.getRecovery());
 		});
 	}
@@ -1448,7 +1433,7 @@ bool CCharacter::CheckFailMana(int Mana)
 	}
 
 	m_Mana -= Mana;
-	if(m_Mana <= m_pPlayer->GetStartMana() / 5 && !m_pPlayer->IsActiveEffect("RegenMana") && m_pPlayer->GetItem(itPotionManaRegen)->IsEquipped())
+	if(m_Mana <= m_pPlayer->GetStartMana() / 5 && !m_pPlayer->IsActiveEffect(CEffects::REGEN_MANA) && m_pPlayer->GetItem(itPotionManaRegen)->IsEquipped())
 		m_pPlayer->GetItem(itPotionManaRegen)->Use(1);
 
 	GS()->MarkUpdatedBroadcast(m_pPlayer->GetCID());
@@ -1464,6 +1449,7 @@ void CCharacter::ChangePosition(vec2 NewPos)
 	GS()->CreatePlayerSpawn(NewPos);
 	m_Core.m_Pos = NewPos;
 	m_Pos = NewPos;
+	GameWorld()->UpdateEntityPos(this);
 	ResetHook();
 }
 
@@ -73,7 +73,7 @@ protected:
 
 	void HandleWeapons();
 	void HandleNinja();
-	void HandleTilesets(int *pIndex = nullptr);
+	void HandleTilesets();
 	void HandleEvent();
 	void HandleIndependentTuning();
 
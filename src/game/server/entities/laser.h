@@ -12,6 +12,7 @@ public:
 	virtual void Tick();
 	virtual void TickPaused();
 	virtual void Snap(int SnappingClient);
+	virtual bool IsSnapShared(vec2* pClipTo) const { *pClipTo = m_From; return true; }
 
 protected:
 	bool HitCharacter(vec2 From, vec2 To);
@@ -3,6 +3,8 @@
 #include "entity.h"
 #include "gamecontext.h"
 
+#include <engine/shared/config.h>
+
 CEntity::CEntity(CGameWorld* pGameWorld, int ObjType, vec2 Pos, int ProximityRadius)
 {
 	m_pGameWorld = pGameWorld;
@@ -15,6 +17,7 @@ CEntity::CEntity(CGameWorld* pGameWorld, int ObjType, vec2 Pos, int ProximityRad
 
 	m_ProximityRadius = ProximityRadius;
 	m_MarkedForDestroy = false;
+	m_SnapCached = false;
 
 	m_Pos = Pos;
 	m_PosTo = Pos;
@@ -42,17 +45,35 @@ int CEntity::NetworkClipped(int SnappingClient, vec2 CheckPos, float Radius) con
 		return 0;
 
 	const CPlayer* pPlayer = GS()->m_apPlayers[SnappingClient];
-	const float dx = pPlayer->m_ViewPos.x - CheckPos.x;
-	const float dy = pPlayer->m_ViewPos.y - CheckPos.y;
+	return NetworkClippedView(pPlayer->m_ViewPos, CheckPos, Radius);
+}
+
+bool CEntity::NetworkClippedView(vec2 ViewPos, vec2 CheckPos, float Radius)
+{
+	const float dx = ViewPos.x - CheckPos.x;
+	const float dy = ViewPos.y - CheckPos.y;
 
 	const float radiusOffset = Radius / 2.f;
 	if(absolute(dx) > (1000.0f + radiusOffset) || absolute(dy) > (800.0f + radiusOffset))
-		return 1;
+		return true;
+
+	if(distance(ViewPos, CheckPos) > (1100.0f + radiusOffset))
+		return true;
 
-	if(distance(pPlayer->m_ViewPos, CheckPos) > (1100.0f + radiusOffset))
-		return 1;
+	return false;
+}
 
-	return 0;
+bool CEntity::IsSnapFar(int SnappingClient) const
+{
+	if(SnappingClient == -1 || !Server()->SnapOverBudget(SnappingClient))
+		return false;
+
+	return IsSnapFarView(GS()->m_apPlayers[SnappingClient]->m_ViewPos, m_Pos);
+}
+
+bool CEntity::IsSnapFarView(vec2 ViewPos, vec2 CheckPos)
+{
+	return g_Config.m_SvSnapLodDistance > 0 && distance(ViewPos, CheckPos) > (float)g_Config.m_SvSnapLodDistance;
 }
 
 bool CEntity::GameLayerClipped(vec2 CheckPos) const
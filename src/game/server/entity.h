@@ -23,6 +23,7 @@ private:
 
 	CEntity *m_pPrevTypeEntity;
 	CEntity *m_pNextTypeEntity;
+	CSpatialGridHandle m_GridHandle;
 
 	int m_ID;
 	int m_ObjType;
@@ -35,6 +36,7 @@ private:
 
 	/* State */
 	bool m_MarkedForDestroy;
+	bool m_SnapCached; // snapped into the world's item cache this tick
 
 protected:
 	/* State */
@@ -113,6 +115,24 @@ public:
 	*/
 	virtual void Snap(int SnappingClient) {}
 
+	/*
+		Function: IsSnapShared
+			Whether Snap writes the same items for every client, only
+			clipped by m_Pos and pClipTo. Such entities are snapped once
+			per tick into the world's item cache and copied from there.
+
+		Arguments:
+			pClipTo - Second position the entity is visible from.
+	*/
+	virtual bool IsSnapShared(vec2 *pClipTo) const { return false; }
+
+	/*
+		Function: IsSnapDetail
+			Whether the entity is left out for clients farther away
+			than sv_snap_lod_distance.
+	*/
+	virtual bool IsSnapDetail() const { return false; }
+
 	/*
 		Function: PostSnap
 			Called after all entities Snap(int SnappingClient) function has been called.
@@ -137,6 +157,11 @@ public:
 	int NetworkClipped(int SnappingClient) const;
 	int NetworkClipped(int SnappingClient, vec2 CheckPos) const;
 	int NetworkClipped(int SnappingClient, vec2 CheckPos, float Radius) const;
+	static bool NetworkClippedView(vec2 ViewPos, vec2 CheckPos, float Radius = 0.f);
+
+	// the snapshots of the client overflow and it is far enough away to get a simplified version
+	bool IsSnapFar(int SnappingClient) const;
+	static bool IsSnapFarView(vec2 ViewPos, vec2 CheckPos);
 
 	bool GameLayerClipped(vec2 CheckPos) const;
 };
@@ -5,6 +5,7 @@
 #include <engine/storage.h>
 #include <engine/map.h>
 #include <engine/shared/config.h>
+#include <engine/shared/scheduler.h>
 
 #include <game/gamecore.h>
 #include <game/layers.h>
@@ -12,8 +13,10 @@
 #include "worldmodes/dungeon.h"
 #include "worldmodes/main.h"
 #include "worldmodes/tutorial.h"
+#include "vote_delta.h"
 
 #include "mmocore/CommandProcessor.h"
+#include "mmocore/Leaderboard.h"
 #include "mmocore/PathFinder.h"
 #include "mmocore/GameEntities/loltext.h"
 #include "mmocore/GameEntities/Items/drop_bonuses.h"
@@ -36,7 +39,7 @@
 #include "mmocore/Components/Worlds/WorldData.h"
 
 // static data that have the same value in different objects
-ska::unordered_map < std::string, int > CGS::ms_aEffects[MAX_PLAYERS];
+CEffectTable CGS::ms_aEffects[MAX_PLAYERS];
 int CGS::m_MultiplierExp = 100;
 
 CGS::CGS()
@@ -65,8 +68,8 @@ CGS::CGS()
 CGS::~CGS()
 {
 	m_Events.Clear();
-	for(auto& pEffects : ms_aEffects)
-		pEffects.clear();
+	for(auto& Effects : ms_aEffects)
+		Effects.Clear();
 	for(auto& apPlayer : m_apPlayers)
 	{
 		delete apPlayer;
@@ -355,12 +358,13 @@ void CGS::Chat(int ClientID, const char* pText, ...)
 	va_list VarArgs;
 	va_start(VarArgs, pText);
 
-	dynamic_string Buffer;
+	CLocalization::CBufferScope BufferScope;
+	dynamic_string& Buffer = BufferScope.Get();
 	for(int i = Start; i < End; i++)
 	{
 		if(m_apPlayers[i])
 		{
-			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguage(), pText, VarArgs);
+			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguageIndex(), pText, VarArgs);
 
 			Msg.m_pMessage = Buffer.buffer();
 			Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, i);
@@ -384,8 +388,9 @@ bool CGS::ChatAccount(int AccountID, const char* pText, ...)
 	va_list VarArgs;
 	va_start(VarArgs, pText);
 
-	dynamic_string Buffer;
-	Server()->Localization()->Format_VL(Buffer, pPlayer->GetLanguage(), pText, VarArgs);
+	CLocalization::CBufferScope BufferScope;
+	dynamic_string& Buffer = BufferScope.Get();
+	Server()->Localization()->Format_VL(Buffer, pPlayer->GetLanguageIndex(), pText, VarArgs);
 
 	Msg.m_pMessage = Buffer.buffer();
 	Server()->SendPackMsg(&Msg, MSGFLAG_VITAL, pPlayer->GetCID());
@@ -407,13 +412,14 @@ void CGS::ChatGuild(int GuildID, const char* pText, ...)
 	va_list VarArgs;
 	va_start(VarArgs, pText);
 
-	dynamic_string Buffer;
+	CLocalization::CBufferScope BufferScope;
+	dynamic_string& Buffer = BufferScope.Get();
 	for(int i = 0; i < MAX_PLAYERS; i++)
 	{
 		if(CPlayer* pPlayer = GetPlayer(i, true); pPlayer && pPlayer->Account()->HasGuild() && pPlayer->Account()->GetGuild()->GetID() == GuildID)
 		{
 			Buffer.append("Guild | ");
-			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguage(), pText, VarArgs);
+			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguageIndex(), pText, VarArgs);
 
 			Msg.m_pMessage = Buffer.buffer();
 
@@ -434,7 +440,8 @@ void CGS::ChatWorldID(int WorldID, const char* Suffix, const char* pText, ...)
 	va_list VarArgs;
 	va_start(VarArgs, pText);
 
-	dynamic_string Buffer;
+	CLocalization::CBufferScope BufferScope;
+	dynamic_string& Buffer = BufferScope.Get();
 	for(int i = 0; i < MAX_PLAYERS; i++)
 	{
 		CPlayer* pPlayer = GetPlayer(i, true);
@@ -446,7 +453,7 @@ void CGS::ChatWorldID(int WorldID, const char* Suffix, const char* pText, ...)
 			Buffer.append(Suffix);
 			Buffer.append(" ");
 		}
-		Server()->Localization()->Format_VL(Buffer, pPlayer->GetLanguage(), pText, VarArgs);
+		Server()->Localization()->Format_VL(Buffer, pPlayer->GetLanguageIndex(), pText, VarArgs);
 
 		Msg.m_pMessage = Buffer.buffer();
 
@@ -463,7 +470,8 @@ void CGS::ChatDiscord(int Color, const char* Title, const char* pText, ...)
 	va_list VarArgs;
 	va_start(VarArgs, pText);
 
-	dynamic_string Buffer;
+	CLocalization::CBufferScope BufferScope;
+	dynamic_string& Buffer = BufferScope.Get();
 	Server()->Localization()->Format_VL(Buffer, "en", pText, VarArgs);
 	Server()->SendDiscordMessage(g_Config.m_SvDiscordServerChatChannel, Color, Title, Buffer.buffer());
 	Buffer.clear();
@@ -479,7 +487,8 @@ void CGS::ChatDiscordChannel(const char* pChanel, int Color, const char* Title,
 	va_list VarArgs;
 	va_start(VarArgs, pText);
 
-	dynamic_string Buffer;
+	CLocalization::CBufferScope BufferScope;
+	dynamic_string& Buffer = BufferScope.Get();
 	Server()->Localization()->Format_VL(Buffer, "en", pText, VarArgs);
 	Server()->SendDiscordMessage(pChanel, Color, Title, Buffer.buffer());
 	Buffer.clear();
@@ -497,8 +506,9 @@ void CGS::Motd(int ClientID, const char* Text, ...)
 
 	va_list VarArgs;
 	va_start(VarArgs, Text);
-	dynamic_string Buffer;
-	Server()->Localization()->Format_VL(Buffer, pPlayer->GetLanguage(), Text, VarArgs);
+	CLocalization::CBufferScope BufferScope;
+	dynamic_string& Buffer = BufferScope.Get();
+	Server()->Localization()->Format_VL(Buffer, pPlayer->GetLanguageIndex(), Text, VarArgs);
 
 	CNetMsg_Sv_Motd Msg;
 	Msg.m_pMessage = Buffer.buffer();
@@ -547,8 +557,9 @@ void CGS::Broadcast(int ClientID, BroadcastPriority Priority, int LifeSpan, cons
 	{
 		if(m_apPlayers[i])
 		{
-			dynamic_string Buffer;
-			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguage(), pText, VarArgs);
+			CLocalization::CBufferScope BufferScope;
+			dynamic_string& Buffer = BufferScope.Get();
+			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguageIndex(), pText, VarArgs);
 			AddBroadcast(i, Buffer.buffer(), Priority, LifeSpan);
 			Buffer.clear();
 		}
@@ -565,8 +576,9 @@ void CGS::BroadcastWorldID(int WorldID, BroadcastPriority Priority, int LifeSpan
 	{
 		if(m_apPlayers[i] && IsPlayerEqualWorld(i, WorldID))
 		{
-			dynamic_string Buffer;
-			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguage(), pText, VarArgs);
+			CLocalization::CBufferScope BufferScope;
+			dynamic_string& Buffer = BufferScope.Get();
+			Server()->Localization()->Format_VL(Buffer, m_apPlayers[i]->GetLanguageIndex(), pText, VarArgs);
 			AddBroadcast(i, Buffer.buffer(), Priority, LifeSpan);
 			Buffer.clear();
 		}
@@ -735,6 +747,7 @@ void CGS::OnInit(int WorldID)
 	m_pLayers = new CLayers();
 	m_pLayers->Init(Kernel(), WorldID);
 	m_Collision.Init(m_pLayers);
+	m_World.InitSpatialGrid(m_Collision.GetWidth(), m_Collision.GetHeight());
 	m_pMmoController = new MmoController(this);
 	m_pMmoController->LoadLogicWorld();
 
@@ -785,6 +798,14 @@ void CGS::OnConsoleInit()
 
 	Console()->Register("set_world_time", "i[hour]", CFGFLAG_SERVER, ConSetWorldTime, m_pServer, "Set worlds time.");
 	Console()->Register("itemlist", "", CFGFLAG_SERVER, ConItemList, m_pServer, "items list");
+	Console()->Register("item_save_status", "", CFGFLAG_SERVER, ConItemSaveStatus, m_pServer, "Show pending and written batched item saves");
+	Console()->Register("bot_map_stats", "", CFGFLAG_SERVER, ConBotMapStats, m_pServer, "Show how many bot id map slots change per update in each world");
+	Console()->Register("los_bench", "?i[rays]", CFGFLAG_SERVER, ConSightBenchmark, m_pServer, "Measure line of sight rays per second on the main world map");
+	Console()->Register("path_cache_stats", "", CFGFLAG_SERVER, ConPathCacheStats, m_pServer, "Show path cache hits, misses and search queue depth of every world");
+	Console()->Register("vote_stats", "", CFGFLAG_SERVER, ConVoteStats, m_pServer, "Show vote menu builds and messages and bytes saved by sending changes only");
+	Console()->Register("attribute_stats", "", CFGFLAG_SERVER, ConAttributeStats, m_pServer, "Show attribute lookups per tick and attribute sheet rebuilds since the last call");
+	Console()->Register("quest_store_stats", "", CFGFLAG_SERVER, ConQuestStoreStats, m_pServer, "Show quest progress writes, commits and files written");
+	Console()->Register("path_bench", "?i[queries]", CFGFLAG_SERVER, ConPathBenchmark, m_pServer, "Measure path finder latency between random free tiles of every world");
 	Console()->Register("giveitem", "i[cid]i[itemid]i[count]i[enchant]i[mail]", CFGFLAG_SERVER, ConGiveItem, m_pServer, "Give item <clientid> <itemid> <count> <enchant> <mail 1=yes 0=no>");
 	Console()->Register("removeitem", "i[cid]i[itemid]i[count]", CFGFLAG_SERVER, ConRemItem, m_pServer, "Remove item <clientid> <itemid> <count>");
 	Console()->Register("disband_guild", "r[guildname]", CFGFLAG_SERVER, ConDisbandGuild, m_pServer, "Disband the guild with the name");
@@ -801,6 +822,7 @@ void CGS::OnConsoleInit()
 
 void CGS::OnTick()
 {
+	m_Collision.ResetSightCache();
 	m_World.m_Core.m_Tuning = m_Tuning;
 	m_World.Tick();
 	m_pController->Tick();
@@ -824,6 +846,16 @@ void CGS::OnTick()
 // Here we use functions that can have static data or functions that don't need to be called in all worlds
 void CGS::OnTickGlobal()
 {
+	// top lists are served from memory, the database is read again from time to time
+	CLeaderboard::OnTick();
+
+	// login and registration results change the per-client data of the components
+	CAccountManager::OnTickGlobal();
+
+	// write-behind of changed items, only from here so batches are queued from one thread
+	if(Server()->Tick() % (Server()->TickSpeed() * g_Config.m_SvItemFlushInterval) == 0 || CPlayerItem::GetDirtySize() >= g_Config.m_SvItemFlushSize)
+		CPlayerItem::FlushDirty();
+
 	// Check if the day enum type has changed
 	if(m_DayEnumType != Server()->GetEnumTypeDay())
 	{
@@ -1238,6 +1270,7 @@ void CGS::OnMessage(int MsgID, CUnpacker* pUnpacker, int ClientID)
 
 			// send clear vote options
 			ClearVotes(ClientID);
+			ResetSentVotes(ClientID);
 
 			// client is ready to enter
 			CNetMsg_Sv_ReadyToEnter m;
@@ -1400,7 +1433,9 @@ void CGS::ClearClientData(int ClientID)
 {
 	Mmo()->ResetClientData(ClientID);
 	m_aPlayerVotes[ClientID].clear();
-	ms_aEffects[ClientID].clear();
+	m_aVoteMenuCache[ClientID].clear();
+	InvalidateVotes(ClientID);
+	ms_aEffects[ClientID].Clear();
 
 	// clear active snap bots for player
 	for(auto& pActiveSnap : DataBotInfo::ms_aDataBot)
@@ -1435,6 +1470,230 @@ void CGS::ConItemList(IConsole::IResult* pResult, void* pUserData)
 	}
 }
 
+void CGS::ConItemSaveStatus(IConsole::IResult* pResult, void* pUserData)
+{
+	IServer* pServer = (IServer*)pUserData;
+	CGS* pSelf = (CGS*)pServer->GameServer(MAIN_WORLD_ID);
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "dirty=%d in_flight=%d written_items=%llu written_batches=%llu", CPlayerItem::GetDirtySize(), CPlayerItem::GetBatchesInFlight(),
+		(unsigned long long)CPlayerItem::GetFlushedItems(), (unsigned long long)CPlayerItem::GetFlushedBatches());
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "item_save", aBuf);
+}
+
+void CGS::ConBotMapStats(IConsole::IResult* pResult, void* pUserData)
+{
+	IServer* pServer = (IServer*)pUserData;
+	CGS* pSelf = (CGS*)pServer->GameServer(MAIN_WORLD_ID);
+
+	char aBuf[256];
+	for(int i = 0; i < pServer->GetWorldsSize(); i++)
+	{
+		const CGameWorld& World = ((CGS*)pServer->GameServer(i))->m_World;
+		const double Average = World.GetMapUpdates() ? (double)World.GetMapSlotChanges() / World.GetMapUpdates() : 0.0;
+		str_format(aBuf, sizeof(aBuf), "%s: updates=%lld slot_changes=%lld last=%d avg=%.2f", pServer->GetWorldName(i), (long long)World.GetMapUpdates(),
+			(long long)World.GetMapSlotChanges(), World.GetLastMapSlotChanges(), Average);
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "bot_map", aBuf);
+	}
+}
+
+void CGS::ConSightBenchmark(IConsole::IResult* pResult, void* pUserData)
+{
+	IServer* pServer = (IServer*)pUserData;
+	CGS* pSelf = (CGS*)pServer->GameServer(MAIN_WORLD_ID);
+	const CCollision* pCollision = pSelf->Collision();
+	const int NumRays = clamp(pResult->NumArguments() > 0 ? pResult->GetInteger(0) : 100000, 1000, 10000000);
+
+	// random rays up to the bot search distance, every pair is asked twice like bots and players do
+	const float Width = pCollision->GetWidth() * 32.0f;
+	const float Height = pCollision->GetHeight() * 32.0f;
+	std::vector<vec2> vFrom(NumRays), vTo(NumRays);
+	for(int i = 0; i < NumRays; i++)
+	{
+		vFrom[i] = vec2(random_float() * Width, random_float() * Height);
+		vTo[i] = vFrom[i] + random_direction() * (random_float() * 800.0f);
+	}
+
+	std::vector<char> vBlocked(NumRays), vSight(NumRays);
+	int64_t Start = time_get_impl();
+	for(int i = 0; i < NumRays; i++)
+		vBlocked[i] = pCollision->IntersectLineWithInvisible(vFrom[i], vTo[i], nullptr, nullptr);
+	const int64_t ScalarTime = time_get_impl() - Start;
+
+	// a new generation per ray, so every ray walks the bit grid
+	Start = time_get_impl();
+	for(int i = 0; i < NumRays; i++)
+	{
+		pSelf->m_Collision.ResetSightCache();
+		vSight[i] = pCollision->IntersectSight(vFrom[i], vTo[i]);
+	}
+	const int64_t GridTime = time_get_impl() - Start;
+
+	// compared ray by ray, so errors in both directions are counted
+	int Blocked = 0;
+	int Mismatches = 0;
+	for(int i = 0; i < NumRays; i++)
+	{
+		Blocked += vBlocked[i];
+		Mismatches += vBlocked[i] != vSight[i];
+	}
+
+	Start = time_get_impl();
+	pSelf->m_Collision.ResetSightCache();
+	for(int i = 0; i < NumRays; i++)
+	{
+		pCollision->IntersectSight(vFrom[i], vTo[i]);
+		pCollision->IntersectSight(vTo[i], vFrom[i]);
+	}
+	const int64_t CachedTime = time_get_impl() - Start;
+	pSelf->m_Collision.ResetSightCache();
+
+	auto RaysPerSecond = [](int64_t Rays, int64_t Time) { return Time > 0 ? (double)Rays * time_freq() / Time / 1000000.0 : 0.0; };
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "rays=%d blocked=%d mismatches=%d scalar=%.2fM/s bitgrid=%.2fM/s cached=%.2fM/s", NumRays, Blocked, Mismatches,
+		RaysPerSecond(NumRays, ScalarTime), RaysPerSecond(NumRays, GridTime), RaysPerSecond(NumRays * 2, CachedTime));
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "los", aBuf);
+	str_format(aBuf, sizeof(aBuf), "live: rays=%llu cache_hits=%llu", (unsigned long long)pCollision->GetSightRays(), (unsigned long long)pCollision->GetSightCacheHits());
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "los", aBuf);
+}
+
+void CGS::ConPathCacheStats(IConsole::IResult* pResult, void* pUserData)
+{
+	IServer* pServer = (IServer*)pUserData;
+	CGS* pSelf = (CGS*)pServer->GameServer(MAIN_WORLD_ID);
+
+	char aBuf[256];
+	for(int i = 0; i < pServer->GetWorldsSize(); i++)
+	{
+		CGS* pGS = (CGS*)pServer->GameServer(i);
+		if(!pGS->PathFinder())
+			continue;
+
+		auto* pHandler = pGS->PathFinder()->Handle();
+		const uint64_t Requests = pHandler->GetCacheHits() + pHandler->GetCacheMisses() + pHandler->GetCoalesced();
+		str_format(aBuf, sizeof(aBuf), "%s: hits=%llu misses=%llu coalesced=%llu hit_rate=%.1f%% cached=%d queue=%d max_queue=%d", pServer->GetWorldName(i),
+			(unsigned long long)pHandler->GetCacheHits(), (unsigned long long)pHandler->GetCacheMisses(), (unsigned long long)pHandler->GetCoalesced(),
+			Requests ? (double)(Requests - pHandler->GetCacheMisses()) * 100.0 / Requests : 0.0, pHandler->GetCachedPaths(), pHandler->GetQueueDepth(),
+			pHandler->GetMaxQueueDepth());
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "path", aBuf);
+	}
+}
+
+void CGS::ConVoteStats(IConsole::IResult* pResult, void* pUserData)
+{
+	IServer* pServer = (IServer*)pUserData;
+	CGS* pSelf = (CGS*)pServer->GameServer(MAIN_WORLD_ID);
+
+	const uint64_t Refreshes = ms_VoteRefreshes;
+	const uint64_t Messages = ms_VoteMessages;
+	const uint64_t MessagesFull = ms_VoteMessagesFull;
+	const uint64_t Bytes = ms_VoteBytes;
+	const uint64_t BytesFull = ms_VoteBytesFull;
+	const uint64_t Hits = ms_VoteMenuHits;
+	const uint64_t Builds = ms_VoteMenuBuilds;
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "refreshes=%llu messages=%llu (full resend %llu, saved %.1f/refresh) bytes=%llu (full resend %llu, saved %.1f/refresh)",
+		(unsigned long long)Refreshes, (unsigned long long)Messages, (unsigned long long)MessagesFull, Refreshes ? (double)(MessagesFull - Messages) / Refreshes : 0.0,
+		(unsigned long long)Bytes, (unsigned long long)BytesFull, Refreshes ? (double)(BytesFull - Bytes) / Refreshes : 0.0);
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "votes", aBuf);
+
+	str_format(aBuf, sizeof(aBuf), "menus built=%llu reused=%llu (%.1f%%)", (unsigned long long)Builds, (unsigned long long)Hits,
+		Builds + Hits ? Hits * 100.0 / (Builds + Hits) : 0.0);
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "votes", aBuf);
+}
+
+void CGS::ConAttributeStats(IConsole::IResult* pResult, void* pUserData)
+{
+	IServer* pServer = (IServer*)pUserData;
+	CGS* pSelf = (CGS*)pServer->GameServer(MAIN_WORLD_ID);
+
+	// counted from the previous call
+	static uint64_t s_LastLookups = 0;
+	static uint64_t s_LastRebuilds = 0;
+	static int s_LastTick = 0;
+	const uint64_t Lookups = CPlayer::ms_AttributeLookups;
+	const uint64_t Rebuilds = CPlayer::ms_AttributeRebuilds;
+	const int Ticks = maximum(1, pServer->Tick() - s_LastTick);
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "lookups=%llu (%.1f/tick) rebuilds=%llu over %d ticks", (unsigned long long)(Lookups - s_LastLookups),
+		(double)(Lookups - s_LastLookups) / Ticks, (unsigned long long)(Rebuilds - s_LastRebuilds), Ticks);
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "attributes", aBuf);
+
+	s_LastLookups = Lookups;
+	s_LastRebuilds = Rebuilds;
+	s_LastTick = pServer->Tick();
+}
+
+void CGS::ConQuestStoreStats(IConsole::IResult* pResult, void* pUserData)
+{
+	IServer* pServer = (IServer*)pUserData;
+	CGS* pSelf = (CGS*)pServer->GameServer(MAIN_WORLD_ID);
+
+	const CQuestProgressStore::CStats Stats = CQuestProgressStore::Get().GetStats();
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "writes=%llu coalesced=%llu commits=%llu files=%llu failed=%llu", (unsigned long long)Stats.m_Writes,
+		(unsigned long long)Stats.m_Coalesced, (unsigned long long)Stats.m_Commits, (unsigned long long)Stats.m_Files, (unsigned long long)Stats.m_Failed);
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "quests", aBuf);
+}
+
+void CGS::ConPathBenchmark(IConsole::IResult* pResult, void* pUserData)
+{
+	IServer* pServer = (IServer*)pUserData;
+	CGS* pSelf = (CGS*)pServer->GameServer(MAIN_WORLD_ID);
+	const int NumQueries = clamp(pResult->NumArguments() > 0 ? pResult->GetInteger(0) : 200, 1, 100000);
+
+	char aBuf[256];
+	std::vector<vec2> vPath;
+	for(int i = 0; i < pServer->GetWorldsSize(); i++)
+	{
+		CGS* pGS = (CGS*)pServer->GameServer(i);
+		const CPathFinder* pPathFinder = pGS->PathFinder();
+		if(!pPathFinder)
+			continue;
+
+		// random free tiles, the same way bots pick their waypoints
+		auto RandomFreePos = [&]()
+		{
+			for(int Try = 0; Try < 1000; Try++)
+			{
+				const vec2 Pos = vec2((float)(secure_rand() % pPathFinder->GetWidth()), (float)(secure_rand() % pPathFinder->GetHeight())) * 32.0f + vec2(16.0f, 16.0f);
+				if(!pGS->Collision()->CheckPoint(Pos))
+					return Pos;
+			}
+			return vec2(16.0f, 16.0f);
+		};
+
+		int Found = 0;
+		int64_t TotalLength = 0;
+		int64_t TotalTime = 0;
+		int64_t MaxTime = 0;
+		for(int q = 0; q < NumQueries; q++)
+		{
+			const vec2 From = RandomFreePos();
+			const vec2 To = RandomFreePos();
+
+			const int64_t Start = time_get_impl();
+			const bool Reached = pPathFinder->FindPath(From, To, vPath);
+			const int64_t Time = time_get_impl() - Start;
+
+			TotalTime += Time;
+			MaxTime = maximum(MaxTime, Time);
+			if(Reached)
+			{
+				Found++;
+				TotalLength += (int64_t)vPath.size();
+			}
+		}
+
+		auto Micro = [](int64_t Time) { return (double)Time * 1000000.0 / time_freq(); };
+		str_format(aBuf, sizeof(aBuf), "%s (%dx%d): queries=%d found=%d avg=%.1fus max=%.1fus avg_len=%.1f", pServer->GetWorldName(i), pPathFinder->GetWidth(),
+			pPathFinder->GetHeight(), NumQueries, Found, Micro(TotalTime) / NumQueries, Micro(MaxTime), Found ? (double)TotalLength / Found : 0.0);
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "path", aBuf);
+	}
+}
+
 // give the item to the player
 void CGS::ConGiveItem(IConsole::IResult* pResult, void* pUserData)
 {
@@ -1524,7 +1783,8 @@ void CGS::ConSyncLinesForTranslate(IConsole::IResult* pResult, void* pUserData)
 	CGS* pSelf = (CGS*)pServer->GameServer();
 
 	// dump
-	std::thread(&MmoController::ConAsyncLinesForTranslate, pSelf->m_pMmoController).detach();
+	MmoController* pMmoController = pSelf->m_pMmoController;
+	CScheduler::Get().Add(CScheduler::PRIORITY_BACKGROUND, [pMmoController]() { pMmoController->ConAsyncLinesForTranslate(); });
 }
 
 void CGS::ConListAfk(IConsole::IResult* pResult, void* pUserData)
@@ -1661,12 +1921,101 @@ void CGS::ConchainGameinfoUpdate(IConsole::IResult* pResult, void* pUserData, IC
 void CGS::ClearVotes(int ClientID)
 {
 	m_aPlayerVotes[ClientID].clear();
+}
+
+void CGS::ResetSentVotes(int ClientID)
+{
+	m_aSentVotes[ClientID].clear();
+	m_aVoteMenuCache[ClientID].clear();
 
 	// send vote options
 	CNetMsg_Sv_VoteClearOptions ClearMsg;
 	Server()->SendPackMsg(&ClearMsg, MSGFLAG_VITAL, ClientID);
 }
 
+// sends only what changed against the options the client already has
+void CGS::SendVotes(int ClientID)
+{
+	std::vector<std::string>& vSent = m_aSentVotes[ClientID];
+	const std::deque<CVoteOptions>& vVotes = m_aPlayerVotes[ClientID];
+	const int NumVotes = (int)vVotes.size();
+	const auto GetDesc = [&vVotes](int Index) { return std::string_view(vVotes[Index].m_aDescription); };
+
+	// the old transport, a clear and one message per option
+	int FullBytes = 1;
+	for(const auto& Vote : vVotes)
+		FullBytes += 1 + str_length(Vote.m_aDescription) + 1;
+	const int FullMessages = 1 + NumVotes;
+
+	// size of the delta against a clear followed by batched options
+	const int Keep = CVoteDelta::KeepPrefix(vSent, NumVotes, GetDesc);
+	const auto AddBytes = [&](int From)
+	{
+		int Bytes = 0;
+		for(int i = From; i < NumVotes; i += CVoteDelta::MAX_OPTIONS_PER_MESSAGE)
+		{
+			const int Num = minimum((int)CVoteDelta::MAX_OPTIONS_PER_MESSAGE, NumVotes - i);
+			int DescBytes = 0;
+			for(int j = i; j < i + Num; j++)
+				DescBytes += str_length(vVotes[j].m_aDescription);
+			Bytes += CVoteDelta::ListAddBytes(Num, DescBytes);
+		}
+		return Bytes;
+	};
+
+	int DeltaBytes = AddBytes(Keep);
+	for(int i = Keep; i < (int)vSent.size(); i++)
+		DeltaBytes += CVoteDelta::RemoveBytes(vSent[i]);
+	const int ResendBytes = 1 + AddBytes(0);
+
+	int From = Keep;
+	int Messages;
+	int Bytes;
+	if(ResendBytes < DeltaBytes)
+	{
+		ResetSentVotes(ClientID);
+		From = 0;
+		Messages = 1 + CVoteDelta::ListAddMessages(NumVotes);
+		Bytes = ResendBytes;
+	}
+	else
+	{
+		for(int i = Keep; i < (int)vSent.size(); i++)
+		{
+			CNetMsg_Sv_VoteOptionRemove RemoveMsg;
+			RemoveMsg.m_pDescription = vSent[i].c_str();
+			Server()->SendPackMsg(&RemoveMsg, MSGFLAG_VITAL, ClientID);
+		}
+		Messages = ((int)vSent.size() - Keep) + CVoteDelta::ListAddMessages(NumVotes - Keep);
+		Bytes = DeltaBytes;
+		vSent.resize(Keep);
+	}
+
+	// batched options
+	for(int i = From; i < NumVotes; i += CVoteDelta::MAX_OPTIONS_PER_MESSAGE)
+	{
+		CNetMsg_Sv_VoteOptionListAdd OptionMsg;
+		const char** apDescriptions[CVoteDelta::MAX_OPTIONS_PER_MESSAGE] = {
+			&OptionMsg.m_pDescription0, &OptionMsg.m_pDescription1, &OptionMsg.m_pDescription2, &OptionMsg.m_pDescription3, &OptionMsg.m_pDescription4,
+			&OptionMsg.m_pDescription5, &OptionMsg.m_pDescription6, &OptionMsg.m_pDescription7, &OptionMsg.m_pDescription8, &OptionMsg.m_pDescription9,
+			&OptionMsg.m_pDescription10, &OptionMsg.m_pDescription11, &OptionMsg.m_pDescription12, &OptionMsg.m_pDescription13, &OptionMsg.m_pDescription14 };
+
+		OptionMsg.m_NumOptions = minimum((int)CVoteDelta::MAX_OPTIONS_PER_MESSAGE, NumVotes - i);
+		for(int j = 0; j < CVoteDelta::MAX_OPTIONS_PER_MESSAGE; j++)
+			*apDescriptions[j] = j < OptionMsg.m_NumOptions ? vVotes[i + j].m_aDescription : "";
+		Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, ClientID);
+
+		for(int j = 0; j < OptionMsg.m_NumOptions; j++)
+			vSent.emplace_back(vVotes[i + j].m_aDescription);
+	}
+
+	ms_VoteRefreshes++;
+	ms_VoteMessages += Messages;
+	ms_VoteMessagesFull += FullMessages;
+	ms_VoteBytes += Bytes;
+	ms_VoteBytesFull += FullBytes;
+}
+
 // add a vote
 void CGS::AV(int ClientID, const char* pCmd, const char* pDesc, const int TempInt, const int TempInt2)
 {
@@ -1699,11 +2048,12 @@ void CGS::AVL(int ClientID, const char* pCmd, const char* pText, ...)
 		va_list VarArgs;
 		va_start(VarArgs, pText);
 
-		dynamic_string Buffer;
+		CLocalization::CBufferScope BufferScope;
+		dynamic_string& Buffer = BufferScope.Get();
 		if(str_comp(pCmd, "null") != 0)
 			Buffer.append("- ");
 
-		Server()->Localization()->Format_VL(Buffer, m_apPlayers[ClientID]->GetLanguage(), pText, VarArgs);
+		Server()->Localization()->Format_VL(Buffer, m_apPlayers[ClientID]->GetLanguageIndex(), pText, VarArgs);
 		AV(ClientID, pCmd, Buffer.buffer());
 		Buffer.clear();
 
@@ -1722,10 +2072,11 @@ void CGS::AVH(int ClientID, const int HiddenID, const char* pText, ...)
 		const bool HiddenTab = (HiddenID >= TAB_STAT) ? m_apPlayers[ClientID]->GetHiddenMenu(HiddenID) : false;
 		const char* pSymbols = HiddenTab ? "\u21BA " : "\u27A4 ";
 
-		dynamic_string Buffer;
+		CLocalization::CBufferScope BufferScope;
+		dynamic_string& Buffer = BufferScope.Get();
 
 		Buffer.append(pSymbols);
-		Server()->Localization()->Format_VL(Buffer, m_apPlayers[ClientID]->GetLanguage(), pText, VarArgs);
+		Server()->Localization()->Format_VL(Buffer, m_apPlayers[ClientID]->GetLanguageIndex(), pText, VarArgs);
 		if(HiddenID > TAB_SETTINGS_MODULES && HiddenID < NUM_TAB_MENU) { Buffer.append(" (Press me for help)"); }
 
 		AV(ClientID, "HIDDEN", Buffer.buffer(), HiddenID, -1);
@@ -1747,10 +2098,11 @@ void CGS::AVM(int ClientID, const char* pCmd, const int TempInt, const int Hidde
 		va_list VarArgs;
 		va_start(VarArgs, pText);
 
-		dynamic_string Buffer;
+		CLocalization::CBufferScope BufferScope;
+		dynamic_string& Buffer = BufferScope.Get();
 		if(TempInt != NOPE) { Buffer.append("- "); }
 
-		Server()->Localization()->Format_VL(Buffer, m_apPlayers[ClientID]->GetLanguage(), pText, VarArgs);
+		Server()->Localization()->Format_VL(Buffer, m_apPlayers[ClientID]->GetLanguageIndex(), pText, VarArgs);
 		AV(ClientID, pCmd, Buffer.buffer(), TempInt);
 		Buffer.clear();
 		va_end(VarArgs);
@@ -1769,10 +2121,11 @@ void CGS::AVD(int ClientID, const char* pCmd, const int TempInt, const int TempI
 		va_list VarArgs;
 		va_start(VarArgs, pText);
 
-		dynamic_string Buffer;
+		CLocalization::CBufferScope BufferScope;
+		dynamic_string& Buffer = BufferScope.Get();
 		if(TempInt != NOPE) { Buffer.append("- "); }
 
-		Server()->Localization()->Format_VL(Buffer, m_apPlayers[ClientID]->GetLanguage(), pText, VarArgs);
+		Server()->Localization()->Format_VL(Buffer, m_apPlayers[ClientID]->GetLanguageIndex(), pText, VarArgs);
 		AV(ClientID, pCmd, Buffer.buffer(), TempInt, TempInt2);
 		Buffer.clear();
 		va_end(VarArgs);
@@ -1801,31 +2154,68 @@ void CGS::CallbackUpdateVotes(CGS* pGS, int ClientID, int Menulist, bool Prepare
 	if(!pPlayer)
 		return;
 
-	std::this_thread::sleep_for(std::chrono::milliseconds(3));
 	if(Menulist == CUSTOM_MENU && PrepareCustom)
 	{
 		// send parsed votes
-		for(auto& p : pGS->m_aPlayerVotes[ClientID])
-		{
-			CNetMsg_Sv_VoteOptionAdd OptionMsg;
-			OptionMsg.m_pDescription = p.m_aDescription;
-			pGS->Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, ClientID);
-		}
+		pGS->SendVotes(ClientID);
 		return;
 	}
 
-	// parse votes
-	pPlayer->m_CurrentVoteMenu = Menulist;
-	pGS->ClearVotes(ClientID);
-	pGS->Mmo()->OnPlayerHandleMainMenu(ClientID, Menulist);
+	// refreshing the menu that is open means its data has changed
+	if(pPlayer->m_CurrentVoteMenu == Menulist)
+		InvalidateVotes(ClientID);
 
-	// send parsed votes
-	for(auto& p : pGS->m_aPlayerVotes[ClientID])
+	// parse votes, unless nothing changed since the last build
+	pPlayer->m_CurrentVoteMenu = Menulist;
+	if(!pGS->RestoreVoteMenu(pPlayer, Menulist))
 	{
-		CNetMsg_Sv_VoteOptionAdd OptionMsg;
-		OptionMsg.m_pDescription = p.m_aDescription;
-		pGS->Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, ClientID);
+		const int TempMenuValue = pPlayer->m_TempMenuValue;
+		pGS->ClearVotes(ClientID);
+		pGS->Mmo()->OnPlayerHandleMainMenu(ClientID, Menulist);
+		pGS->StoreVoteMenu(pPlayer, Menulist, TempMenuValue);
 	}
+
+	// send parsed votes
+	pGS->SendVotes(ClientID);
+}
+
+bool CGS::RestoreVoteMenu(CPlayer* pPlayer, int Menulist)
+{
+	const int ClientID = pPlayer->GetCID();
+	const auto Iter = m_aVoteMenuCache[ClientID].find(Menulist);
+	if(Iter == m_aVoteMenuCache[ClientID].end())
+		return false;
+
+	// time dependent text and the data of other players are covered by the lifetime
+	const CVoteMenuCache& Cache = Iter->second;
+	if(Cache.m_Version != ms_aVotesVersion[ClientID] || Cache.m_GlobalVersion != ms_VotesGlobalVersion
+		|| Cache.m_TempMenuValue != pPlayer->m_TempMenuValue || Cache.m_ZoneInvertMenu != pPlayer->m_ZoneInvertMenu
+		|| time_get() > Cache.m_BuildTime + time_freq() * g_Config.m_SvVoteMenuCacheTime)
+		return false;
+
+	m_aPlayerVotes[ClientID] = Cache.m_vVotes;
+	pPlayer->m_LastVoteMenu = Cache.m_LastVoteMenu;
+	pPlayer->m_TempMenuValue = Cache.m_ResultTempMenuValue;
+	ms_VoteMenuHits++;
+	return true;
+}
+
+void CGS::StoreVoteMenu(CPlayer* pPlayer, int Menulist, int TempMenuValue)
+{
+	ms_VoteMenuBuilds++;
+	if(g_Config.m_SvVoteMenuCacheTime <= 0)
+		return;
+
+	const int ClientID = pPlayer->GetCID();
+	CVoteMenuCache& Cache = m_aVoteMenuCache[ClientID][Menulist];
+	Cache.m_Version = ms_aVotesVersion[ClientID];
+	Cache.m_GlobalVersion = ms_VotesGlobalVersion;
+	Cache.m_TempMenuValue = TempMenuValue;
+	Cache.m_ZoneInvertMenu = pPlayer->m_ZoneInvertMenu;
+	Cache.m_BuildTime = time_get();
+	Cache.m_LastVoteMenu = pPlayer->m_LastVoteMenu;
+	Cache.m_ResultTempMenuValue = pPlayer->m_TempMenuValue;
+	Cache.m_vVotes = m_aPlayerVotes[ClientID];
 }
 
 void CGS::UpdateVotes(int ClientID, int MenuList)
@@ -1884,6 +2274,7 @@ void CGS::StrongUpdateVotes(int ClientID, int MenuList)
 // strong update votes variability of the data
 void CGS::StrongUpdateVotesForAll(int MenuList)
 {
+	InvalidateAllVotes();
 	for(int i = 0; i < MAX_PLAYERS; i++)
 	{
 		if(m_apPlayers[i] && m_apPlayers[i]->m_CurrentVoteMenu == MenuList)
@@ -1979,6 +2370,8 @@ bool CGS::ParsingVoteCommands(int ClientID, const char* CMD, const int VoteID, c
 		StrongUpdateVotes(ClientID, MENU_GUIDE_GRINDING);
 		return true;
 	}
+	// anything past plain navigation may change what the menus show
+	InvalidateVotes(ClientID);
 	if(pPlayer->ParseVoteUpgrades(CMD, VoteID, VoteID2, Get))
 		return true;
 
@@ -68,7 +68,7 @@ public:
 		dbg_assert(ClientID >= 0 && ClientID < MAX_PLAYERS, "CVoteEventOptionalContainer out of bounds");
 		return m_Optionals[ClientID];
 	}
-	static ska::unordered_map < std::string /* effect */, int /* seconds */ > ms_aEffects[MAX_PLAYERS];
+	static CEffectTable ms_aEffects[MAX_PLAYERS];
 	// - - - - - - - - - - - -
 
 	/* #########################################################################
@@ -190,6 +190,14 @@ public:
 private:
 	static void ConSetWorldTime(IConsole::IResult *pResult, void *pUserData);
 	static void ConItemList(IConsole::IResult *pResult, void *pUserData);
+	static void ConItemSaveStatus(IConsole::IResult *pResult, void *pUserData);
+	static void ConBotMapStats(IConsole::IResult *pResult, void *pUserData);
+	static void ConSightBenchmark(IConsole::IResult *pResult, void *pUserData);
+	static void ConPathCacheStats(IConsole::IResult *pResult, void *pUserData);
+	static void ConPathBenchmark(IConsole::IResult *pResult, void *pUserData);
+	static void ConVoteStats(IConsole::IResult *pResult, void *pUserData);
+	static void ConAttributeStats(IConsole::IResult *pResult, void *pUserData);
+	static void ConQuestStoreStats(IConsole::IResult *pResult, void *pUserData);
 	static void ConGiveItem(IConsole::IResult *pResult, void *pUserData);
 	static void ConRemItem(IConsole::IResult* pResult, void* pUserData);
 	static void ConDisbandGuild(IConsole::IResult* pResult, void* pUserData);
@@ -208,8 +216,38 @@ private:
 		VOTING MMO GAMECONTEXT TODO: rework fully
 	######################################################################### */
 	std::deque<CVoteOptions> m_aPlayerVotes[MAX_PLAYERS];
+	std::vector<std::string> m_aSentVotes[MAX_PLAYERS]; // options the client has right now
 	static void CallbackUpdateVotes(CGS* pGS, int ClientID, int Menulist, bool PrepareCustom);
 
+	// vote menu transport compared with clearing and resending every option
+	static inline std::atomic<uint64_t> ms_VoteRefreshes {};
+	static inline std::atomic<uint64_t> ms_VoteMessages {};
+	static inline std::atomic<uint64_t> ms_VoteMessagesFull {};
+	static inline std::atomic<uint64_t> ms_VoteBytes {};
+	static inline std::atomic<uint64_t> ms_VoteBytesFull {};
+	static inline std::atomic<uint64_t> ms_VoteMenuHits {};
+	static inline std::atomic<uint64_t> ms_VoteMenuBuilds {};
+
+	// built menus are reused until the data they show changes
+	struct CVoteMenuCache
+	{
+		uint32_t m_Version;
+		uint32_t m_GlobalVersion;
+		int m_TempMenuValue;
+		bool m_ZoneInvertMenu;
+		int64_t m_BuildTime;
+
+		// what the build left in the player
+		int m_LastVoteMenu;
+		int m_ResultTempMenuValue;
+		std::deque<CVoteOptions> m_vVotes;
+	};
+	std::map<int, CVoteMenuCache> m_aVoteMenuCache[MAX_PLAYERS];
+	static inline std::atomic<uint32_t> ms_aVotesVersion[MAX_PLAYERS] {};
+	static inline std::atomic<uint32_t> ms_VotesGlobalVersion {};
+	bool RestoreVoteMenu(CPlayer* pPlayer, int Menulist);
+	void StoreVoteMenu(CPlayer* pPlayer, int Menulist, int TempMenuValue);
+
 public:
 	void AV(int ClientID , const char *pCmd, const char *pDesc = "\0", int TempInt = -1, int TempInt2 = -1);
 	void AVL(int ClientID, const char *pCmd, const char *pText, ...);
@@ -219,6 +257,8 @@ public:
 
 private:
 	void ClearVotes(int ClientID);
+	void ResetSentVotes(int ClientID);
+	void SendVotes(int ClientID);
 	void ShowVotesNewbieInformation(int ClientID);
 
 public:
@@ -227,6 +267,9 @@ public:
 	void UpdateVotes(int ClientID, int MenuList);
 	void StrongUpdateVotes(int ClientID, int MenuList);
 	void StrongUpdateVotesForAll(int MenuList);
+	static void InvalidateVotes(int ClientID) { if(ClientID >= 0 && ClientID < MAX_PLAYERS) ms_aVotesVersion[ClientID]++; }
+	// data shown to every player changed, others are covered by the lifetime of the cached menus
+	static void InvalidateAllVotes() { ms_VotesGlobalVersion++; }
 	void AddVotesBackpage(int ClientID);
 	void ShowVotesPlayerStats(CPlayer *pPlayer);
 	void AddVoteItemValue(int ClientID, ItemIdentifier ItemID = itGold, int HideID = NOPE);
@@ -15,10 +15,20 @@ CGameWorld::CGameWorld() : m_pNextTraverseEntity(nullptr), m_Paused(false)
 	m_pServer = nullptr;
 
 	for(int i = 0; i < NUM_ENTTYPES; i++)
+	{
 		m_apFirstEntityTypes[i] = nullptr;
+		m_aMaxProximityRadius[i] = 0.0f;
+	}
 
-	m_aMarkedBotsActive.reserve(MAX_PLAYERS);
-	m_aBotsActive.reserve(MAX_PLAYERS);
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		m_aBotSlot[i] = i;
+		m_aBotsActive[i] = false;
+	}
+	m_MapUpdates = 0;
+	m_MapSlotChanges = 0;
+	m_LastMapSlotChanges = 0;
+	m_SnapCacheTick = -1;
 }
 
 CGameWorld::~CGameWorld()
@@ -35,6 +45,46 @@ void CGameWorld::SetGameServer(CGS* pGS)
 	m_pServer = m_pGS->Server();
 }
 
+void CGameWorld::InitSpatialGrid(int Width, int Height)
+{
+	// width and height are in tiles
+	for(auto& Grid : m_aSpatialGrid)
+		Grid.Init((float)Width * 32.0f, (float)Height * 32.0f, (float)SPATIAL_CELL_SIZE);
+	m_BotGrid.Init((float)Width * 32.0f, (float)Height * 32.0f, (float)SPATIAL_CELL_SIZE * 2);
+}
+
+float CGameWorld::QueryMargin(int Type) const
+{
+	// entities are re-bucketed after their own tick, one extra cell covers what others moved since then
+	return m_aMaxProximityRadius[Type] + (float)SPATIAL_CELL_SIZE;
+}
+
+void CGameWorld::SyncSpatialGrid()
+{
+	for(int i = 0; i < NUM_ENTTYPES; i++)
+	{
+		for(CEntity* pEnt = m_apFirstEntityTypes[i]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+			m_aSpatialGrid[i].Move(pEnt->m_GridHandle, pEnt->m_Pos);
+	}
+}
+
+template<typename F>
+void CGameWorld::QueryEntities(int Type, vec2 Min, vec2 Max, F&& Fn) const
+{
+	const CSpatialGrid<CEntity>& Grid = m_aSpatialGrid[Type];
+	if(Grid.CellsInRect(Min, Max) < Grid.Size())
+	{
+		Grid.Query(Min, Max, Fn);
+		return;
+	}
+
+	for(CEntity* pEnt = m_apFirstEntityTypes[Type]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+	{
+		if(!Fn(pEnt))
+			return;
+	}
+}
+
 CEntity* CGameWorld::FindFirst(int Type)
 {
 	return Type < 0 || Type >= NUM_ENTTYPES ? nullptr : m_apFirstEntityTypes[Type];
@@ -46,17 +96,17 @@ int CGameWorld::FindEntities(vec2 Pos, float Radius, CEntity** ppEnts, int Max,
 		return 0;
 
 	int Num = 0;
-	for(CEntity* pEnt = m_apFirstEntityTypes[Type]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+	const vec2 Margin = vec2(Radius, Radius) + vec2(QueryMargin(Type), QueryMargin(Type));
+	QueryEntities(Type, Pos - Margin, Pos + Margin, [&](CEntity* pEnt)
 	{
 		if(distance(pEnt->m_Pos, Pos) < Radius + pEnt->m_ProximityRadius)
 		{
 			if(ppEnts)
 				ppEnts[Num] = pEnt;
 			Num++;
-			if(Num == Max)
-				break;
 		}
-	}
+		return Num != Max;
+	});
 	return Num;
 }
 
@@ -65,16 +115,16 @@ std::vector<CEntity*> CGameWorld::FindEntities(vec2 Pos, float Radius, int Max,
 	if(Type < 0 || Type >= NUM_ENTTYPES)
 		return {};
 
-	std::vector<CEntity*> vEnts(Max);
-	for(CEntity* pEnt = m_apFirstEntityTypes[Type]; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+	std::vector<CEntity*> vEnts;
+	vEnts.reserve(Max);
+
+	const vec2 Margin = vec2(Radius, Radius) + vec2(QueryMargin(Type), QueryMargin(Type));
+	QueryEntities(Type, Pos - Margin, Pos + Margin, [&](CEntity* pEnt)
 	{
 		if(distance(pEnt->m_Pos, Pos) < Radius + pEnt->m_ProximityRadius)
-		{
 			vEnts.push_back(pEnt);
-			if(vEnts.size() == std::size_t(Max))
-				break;
-		}
-	}
+		return vEnts.size() != std::size_t(Max);
+	});
 	return vEnts;
 }
 
@@ -91,6 +141,15 @@ void CGameWorld::InsertEntity(CEntity* pEnt)
 	pEnt->m_pNextTypeEntity = m_apFirstEntityTypes[pEnt->m_ObjType];
 	pEnt->m_pPrevTypeEntity = nullptr;
 	m_apFirstEntityTypes[pEnt->m_ObjType] = pEnt;
+
+	// index it
+	m_aSpatialGrid[pEnt->m_ObjType].Insert(pEnt, pEnt->m_GridHandle, pEnt->m_Pos);
+	m_aMaxProximityRadius[pEnt->m_ObjType] = maximum(m_aMaxProximityRadius[pEnt->m_ObjType], pEnt->m_ProximityRadius);
+}
+
+void CGameWorld::UpdateEntityPos(CEntity* pEnt)
+{
+	m_aSpatialGrid[pEnt->m_ObjType].Move(pEnt->m_GridHandle, pEnt->m_Pos);
 }
 
 void CGameWorld::DestroyEntity(CEntity* pEnt)
@@ -100,6 +159,8 @@ void CGameWorld::DestroyEntity(CEntity* pEnt)
 
 void CGameWorld::RemoveEntity(CEntity* pEnt)
 {
+	m_aSpatialGrid[pEnt->m_ObjType].Remove(pEnt->m_GridHandle);
+
 	// not in the list
 	if(!pEnt->m_pNextTypeEntity && !pEnt->m_pPrevTypeEntity && m_apFirstEntityTypes[pEnt->m_ObjType] != pEnt)
 		return;
@@ -121,15 +182,116 @@ void CGameWorld::RemoveEntity(CEntity* pEnt)
 }
 
 //
-void CGameWorld::Snap(int SnappingClient)
+int CGameWorld::SnapPriority(int Type)
 {
+	switch(Type)
+	{
+		// the game is not playable without them
+		case ENTTYPE_CHARACTER:
+		case ENTTYPE_FLAG:
+		case ENTTYPE_DUNGEON_DOOR:
+		case ENTTYPE_DUNGEON_PROGRESS_DOOR:
+		case ENTTYPE_GUILD_HOUSE_DOOR:
+		case ENTTYPE_PLAYER_HOUSE_DOOR:
+		case ENTTYPE_NPC_DOOR:
+			return SNAP_PRIORITY_HIGH;
+
+		// decoration, dropped first when the snapshot is full
+		case ENTTYPE_WORLD_TEXT:
+		case ENTTYPE_SNAPEFFECT:
+		case ENTTYPE_EYES:
+		case ENTTYPE_EYESWALL:
+		case ENTTYPE_DECOHOUSE:
+		case ENTTYPE_EVENTS:
+		case ENTYPE_LASER_ORBITE:
+			return SNAP_PRIORITY_LOW;
+
+		default:
+			return SNAP_PRIORITY_NORMAL;
+	}
+}
+
+void CGameWorld::BuildSnapCache()
+{
+	if(m_SnapCacheTick == Server()->Tick())
+		return;
+
+	m_SnapCacheTick = Server()->Tick();
+	m_SnapCache.Clear();
+	Server()->SnapSetCapture(&m_SnapCache);
 	for(int i = 0; i < NUM_ENTTYPES; i++)
 		for(CEntity* pEnt = m_apFirstEntityTypes[i]; pEnt; )
 		{
 			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-			pEnt->Snap(SnappingClient);
+			vec2 ClipTo = pEnt->m_Pos;
+			pEnt->m_SnapCached = pEnt->IsSnapShared(&ClipTo);
+			if(pEnt->m_SnapCached)
+			{
+				m_SnapCache.BeginEntry(pEnt->m_Pos, ClipTo, SnapPriority(i), pEnt->IsSnapDetail());
+				pEnt->Snap(-1);
+				m_SnapCache.EndEntry();
+			}
 			pEnt = m_pNextTraverseEntity;
 		}
+	Server()->SnapSetCapture(nullptr);
+	m_SnapCache.Finish();
+}
+
+void CGameWorld::Snap(int SnappingClient)
+{
+	// a complete snapshot takes everything from the entities
+	if(SnappingClient == -1)
+	{
+		for(int i = 0; i < NUM_ENTTYPES; i++)
+			for(CEntity* pEnt = m_apFirstEntityTypes[i]; pEnt; )
+			{
+				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
+				pEnt->Snap(SnappingClient);
+				pEnt = m_pNextTraverseEntity;
+			}
+		return;
+	}
+
+	// shared items are copied from the cache, only the per-client ones are snapped
+	BuildSnapCache();
+	const vec2 ViewPos = GS()->m_apPlayers[SnappingClient]->m_ViewPos;
+	const vec2 ViewRange = vec2(1000.0f, 800.0f);
+	const bool OverBudget = Server()->SnapOverBudget(SnappingClient);
+	m_SnapCache.Collect(ViewPos - ViewRange, ViewPos + ViewRange, m_avSnapEntries, NUM_SNAP_PRIORITIES, [&](const CSnapItemCache::CEntry& Entry)
+	{
+		if(CEntity::NetworkClippedView(ViewPos, Entry.m_Pos) && CEntity::NetworkClippedView(ViewPos, Entry.m_PosTo))
+			return false;
+		return !(OverBudget && Entry.m_Detail && CEntity::IsSnapFarView(ViewPos, Entry.m_Pos));
+	});
+
+	// by priority, whatever does not fit into the snapshot anymore is the least important
+	for(int Priority = 0; Priority < NUM_SNAP_PRIORITIES; Priority++)
+	{
+		for(const CSnapItemCache::CEntry* pEntry : m_avSnapEntries[Priority])
+		{
+			for(int i = pEntry->m_FirstItem; i < pEntry->m_FirstItem + pEntry->m_NumItems; i++)
+			{
+				const CSnapItemCache::CItem& Item = m_SnapCache.GetItem(i);
+				void* pData = Server()->SnapNewItem(Item.m_Type, Item.m_ID, Item.m_Size);
+				if(pData)
+					mem_copy(pData, m_SnapCache.GetItemData(Item), Item.m_Size);
+			}
+		}
+
+		for(int i = 0; i < NUM_ENTTYPES; i++)
+		{
+			if(SnapPriority(i) != Priority)
+				continue;
+
+			for(CEntity* pEnt = m_apFirstEntityTypes[i]; pEnt; )
+			{
+				m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
+				if(!pEnt->m_SnapCached)
+					pEnt->Snap(SnappingClient);
+				pEnt = m_pNextTraverseEntity;
+			}
+		}
+	}
 }
 
 //
@@ -163,12 +325,16 @@ void CGameWorld::RemoveEntities()
 
 void CGameWorld::Tick()
 {
+	// positions set between the ticks
+	SyncSpatialGrid();
+
 	// update all objects
 	for(int i = 0; i < NUM_ENTTYPES; i++)
 		for(CEntity* pEnt = m_apFirstEntityTypes[i]; pEnt; )
 		{
 			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
 			pEnt->Tick();
+			UpdateEntityPos(pEnt);
 			pEnt = m_pNextTraverseEntity;
 		}
 
@@ -177,6 +343,7 @@ void CGameWorld::Tick()
 		{
 			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
 			pEnt->TickDeferred();
+			UpdateEntityPos(pEnt);
 			pEnt = m_pNextTraverseEntity;
 		}
 
@@ -193,28 +360,32 @@ CCharacter* CGameWorld::IntersectCharacter(vec2 Pos0, vec2 Pos1, float Radius, v
 	float ClosestLen = distance(Pos0, Pos1) * 100.0f;
 	CCharacter* pClosest = nullptr;
 
-	CCharacter* p = (CCharacter*)FindFirst(ENTTYPE_CHARACTER);
-	for(; p; p = (CCharacter*)p->TypeNext())
+	// only the cells around the segment can hold a hit
+	const float Margin = Radius + QueryMargin(ENTTYPE_CHARACTER);
+	const vec2 Min = vec2(minimum(Pos0.x, Pos1.x), minimum(Pos0.y, Pos1.y)) - vec2(Margin, Margin);
+	const vec2 Max = vec2(maximum(Pos0.x, Pos1.x), maximum(Pos0.y, Pos1.y)) + vec2(Margin, Margin);
+	QueryEntities(ENTTYPE_CHARACTER, Min, Max, [&](CEntity* pEnt)
 	{
-		if(p == pNotThis)
-			continue;
+		if(pEnt == pNotThis)
+			return true;
 
 		vec2 IntersectPos;
-		if(closest_point_on_line(Pos0, Pos1, p->m_Pos, IntersectPos))
+		if(closest_point_on_line(Pos0, Pos1, pEnt->m_Pos, IntersectPos))
 		{
-			float Len = distance(p->m_Pos, IntersectPos);
-			if(Len < p->m_ProximityRadius + Radius)
+			float Len = distance(pEnt->m_Pos, IntersectPos);
+			if(Len < pEnt->m_ProximityRadius + Radius)
 			{
 				Len = distance(Pos0, IntersectPos);
 				if(Len < ClosestLen)
 				{
 					NewPos = IntersectPos;
 					ClosestLen = Len;
-					pClosest = p;
+					pClosest = (CCharacter*)pEnt;
 				}
 			}
 		}
-	}
+		return true;
+	});
 
 	return pClosest;
 }
@@ -250,30 +421,48 @@ CEntity* CGameWorld::ClosestEntity(vec2 Pos, float Radius, int Type, CEntity* pN
 	// Find other players
 	float ClosestRange = Radius * 2;
 	CEntity* pClosest = nullptr;
+	if(Type < 0 || Type >= NUM_ENTTYPES)
+		return nullptr;
 
-	CEntity* p = GS()->m_World.FindFirst(Type);
-	for(; p; p = p->TypeNext())
+	const vec2 Margin = vec2(Radius, Radius) + vec2(QueryMargin(Type), QueryMargin(Type));
+	QueryEntities(Type, Pos - Margin, Pos + Margin, [&](CEntity* pEnt)
 	{
-		if(p == pNotThis)
-			continue;
+		if(pEnt == pNotThis)
+			return true;
 
-		const float Len = distance(Pos, p->m_Pos);
-		if(Len < p->m_ProximityRadius + Radius)
+		const float Len = distance(Pos, pEnt->m_Pos);
+		if(Len < pEnt->m_ProximityRadius + Radius)
 		{
 			if(Len < ClosestRange)
 			{
 				ClosestRange = Len;
-				pClosest = p;
+				pClosest = pEnt;
 			}
 		}
-	}
+		return true;
+	});
 
 	return pClosest;
 }
 
-bool distCompare(std::pair<float, int> a, std::pair<float, int> b)
+void CGameWorld::UpdateBotGrid()
 {
-	return (a.first < b.first);
+	for(int ClientID = MAX_PLAYERS; ClientID < MAX_CLIENTS; ClientID++)
+	{
+		// only bots with a character in this world can be seen
+		const CPlayer* pPlayer = GS()->m_apPlayers[ClientID];
+		const CCharacter* pChr = pPlayer && pPlayer->IsBot() && Server()->ClientIngame(ClientID) ? pPlayer->GetCharacter() : nullptr;
+		if(!pChr)
+		{
+			m_BotGrid.Remove(m_aBotGridHandle[ClientID]);
+			continue;
+		}
+
+		if(m_aBotGridHandle[ClientID].IsLinked())
+			m_BotGrid.Move(m_aBotGridHandle[ClientID], pChr->m_Core.m_Pos);
+		else
+			m_BotGrid.Insert(&m_aBotSlot[ClientID], m_aBotGridHandle[ClientID], pChr->m_Core.m_Pos);
+	}
 }
 
 void CGameWorld::UpdatePlayerMaps()
@@ -281,7 +470,17 @@ void CGameWorld::UpdatePlayerMaps()
 	if(Server()->Tick() % g_Config.m_SvMapUpdateRate != 0)
 		return;
 
-	std::pair<float, int> Dist[MAX_CLIENTS];
+	UpdateBotGrid();
+	mem_zero(m_aBotsActive, sizeof(m_aBotsActive));
+
+	// bot slots of the vanilla map, the last one is kept for chat messages
+	constexpr int NumMapSlots = VANILLA_MAX_CLIENTS - 1 - MAX_PLAYERS;
+	const float MaxDistance = (float)g_Config.m_SvMapDistanceActveBot;
+
+	int SlotChanges = 0;
+	float aDist[MAX_CLIENTS];
+	std::vector<std::pair<float, int>> vVisible;
+	vVisible.reserve(MAX_CLIENTS - MAX_PLAYERS);
 	for(int ClientID = 0; ClientID < MAX_PLAYERS; ClientID++)
 	{
 		CPlayer* pPlayer = GS()->m_apPlayers[ClientID];
@@ -291,50 +490,31 @@ void CGameWorld::UpdatePlayerMaps()
 
 		int* pMap = Server()->GetIdMap(ClientID);
 
-		// compute distances
-		for(int j = MAX_PLAYERS; j < MAX_CLIENTS; j++)
-		{
-			Dist[j].second = j;
+		// compute distances, only bots from the cells around the view position are checked
+		for(float& Dist : aDist)
+			Dist = 1e10f;
+		vVisible.clear();
 
-			// Check if the player is a bot and is currently in game
-			CPlayerBot* pBotPlayer = dynamic_cast<CPlayerBot*>(GS()->m_apPlayers[j]);
-			if(!Server()->ClientIngame(j) || !pBotPlayer || !pBotPlayer->GetCharacter())
-			{
-				// If not, set the distance to a very large value and skip to the next player
-				Dist[j].first = 1e10;
-				continue;
-			}
+		const vec2 ViewPos = pPlayer->m_ViewPos;
+		m_BotGrid.Query(ViewPos - vec2(MaxDistance, MaxDistance), ViewPos + vec2(MaxDistance, MaxDistance), [&](int* pBotClientID)
+		{
+			const int BotClientID = *pBotClientID;
+			const CPlayerBot* pBotPlayer = static_cast<CPlayerBot*>(GS()->m_apPlayers[BotClientID]);
 
 			// Calculate the distance between the player's view position and the bot's position
-			float Distance = distance(pPlayer->m_ViewPos, pBotPlayer->GetCharacter()->m_Core.m_Pos);
-			if(Distance > (float)g_Config.m_SvMapDistanceActveBot)
-			{
-				// If the distance is greater
-				Dist[j].first = 1e10;
-				continue;
-			}
+			const float Distance = distance(ViewPos, pBotPlayer->GetCharacter()->m_Core.m_Pos);
+			if(Distance > MaxDistance || !pBotPlayer->IsActiveForClient(ClientID))
+				return true;
 
-			// Check if the bot player is not visible for the client
-			if(!pBotPlayer->IsActiveForClient(ClientID))
-			{
-				// Set the distance to a very large value to indicate that the bot is not visible
-				Dist[j].first = 1e10;
-			}
-			else
-			{
-				// Set the distance to 0 and add the actual distance
-				Dist[j].first = 0;
-				Dist[j].first += Distance;
+			aDist[BotClientID] = Distance;
+			vVisible.emplace_back(Distance, BotClientID);
 
-				// marked active bots
-				m_aMarkedBotsActive.insert(j);
-			}
-		}
-
-		// always send the player themselves
-		Dist[ClientID].first = 0;
+			// marked active bots
+			m_aBotsActive[BotClientID] = true;
+			return true;
+		});
 
-		// compute reverse map
+		// compute reverse map, free the slots of bots that are no longer visible
 		int aReverseMap[MAX_CLIENTS];
 		memset(aReverseMap, -1, sizeof(int) * MAX_CLIENTS);
 		for(int j = MAX_PLAYERS; j < VANILLA_MAX_CLIENTS; j++)
@@ -342,50 +522,56 @@ void CGameWorld::UpdatePlayerMaps()
 			if(pMap[j] == -1)
 				continue;
 
-			if(Dist[pMap[j]].first > 5e9f)
+			if(aDist[pMap[j]] > 5e9f)
+			{
 				pMap[j] = -1;
+				SlotChanges++;
+			}
 			else
 				aReverseMap[pMap[j]] = j;
 		}
 
-		std::nth_element(&Dist[MAX_PLAYERS], &Dist[VANILLA_MAX_CLIENTS - 1], &Dist[MAX_CLIENTS], distCompare);
+		// the closest bots get the slots
+		const int NumClosest = minimum((int)vVisible.size(), NumMapSlots);
+		if((int)vVisible.size() > NumMapSlots)
+			std::nth_element(vVisible.begin(), vVisible.begin() + NumMapSlots, vVisible.end());
 
 		int Mapc = MAX_PLAYERS;
 		int Demand = 0;
-		for(int j = MAX_PLAYERS; j < VANILLA_MAX_CLIENTS - 1; j++)
+		for(int j = 0; j < NumClosest; j++)
 		{
-			int k = Dist[j].second;
-
-			if(aReverseMap[k] != -1 || Dist[j].first > 5e9f)
+			const int k = vVisible[j].second;
+			if(aReverseMap[k] != -1)
 				continue;
 
 			while(Mapc < VANILLA_MAX_CLIENTS && pMap[Mapc] != -1)
 				Mapc++;
 
 			if(Mapc < VANILLA_MAX_CLIENTS - 1)
+			{
 				pMap[Mapc] = k;
+				SlotChanges++;
+			}
 			else
 				Demand++;
 		}
 
-		for(int j = MAX_CLIENTS - 1; j > VANILLA_MAX_CLIENTS - 2; j--)
+		// make room for them by dropping the farthest mapped bots
+		for(int j = (int)vVisible.size() - 1; j >= NumClosest && Demand > 0; j--)
 		{
-			int k = Dist[j].second;
-
-			if(aReverseMap[k] != -1 && Demand-- > 0)
+			const int k = vVisible[j].second;
+			if(aReverseMap[k] != -1)
+			{
 				pMap[aReverseMap[k]] = -1;
+				SlotChanges++;
+				Demand--;
+			}
 		}
 
 		pMap[VANILLA_MAX_CLIENTS - 1] = -1; // player with empty name to say chat msgs
 	}
 
-	// Loop through each marked ID in the m_aMarkedBotsActive array
-	m_aBotsActive.clear();
-	for(auto markedID : m_aMarkedBotsActive)
-	{
-		m_aBotsActive[markedID] = true;
-	}
-
-	// Clear the list of marked active bots.
-	m_aMarkedBotsActive.clear();
-}
\ No newline at end of file
+	m_MapUpdates++;
+	m_MapSlotChanges += SlotChanges;
+	m_LastMapSlotChanges = SlotChanges;
+}
@@ -5,6 +5,10 @@
 
 #include <game/gamecore.h>
 
+#include <engine/shared/snap_item_cache.h>
+
+#include "spatial_grid.h"
+
 class CEntity;
 class CCharacter;
 
@@ -60,12 +64,51 @@ public:
 	};
 
 private:
+	enum
+	{
+		// size of a spatial grid cell in world units
+		SPATIAL_CELL_SIZE = 256,
+	};
+
 	void RemoveEntities();
+	void SyncSpatialGrid();
+	float QueryMargin(int Type) const;
+
+	// visits the candidates of a type inside the rectangle, sparse types are walked as a list
+	template<typename F>
+	void QueryEntities(int Type, vec2 Min, vec2 Max, F&& Fn) const;
 
 	CEntity *m_pNextTraverseEntity;
 	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
-	ska::unordered_set<int> m_aMarkedBotsActive;
-	ska::unordered_map<int, bool> m_aBotsActive;
+	CSpatialGrid<CEntity> m_aSpatialGrid[NUM_ENTTYPES];
+	float m_aMaxProximityRadius[NUM_ENTTYPES];
+
+	// bot visibility: bots with a character are bucketed by position
+	CSpatialGrid<int> m_BotGrid;
+	CSpatialGridHandle m_aBotGridHandle[MAX_CLIENTS];
+	int m_aBotSlot[MAX_CLIENTS];
+	bool m_aBotsActive[MAX_CLIENTS];
+	int64_t m_MapUpdates;
+	int64_t m_MapSlotChanges;
+	int m_LastMapSlotChanges;
+
+	void UpdateBotGrid();
+
+	// items every client sees alike, serialised by the first snap of a tick
+	CSnapItemCache m_SnapCache;
+	int m_SnapCacheTick;
+	void BuildSnapCache();
+
+	// snapshots only hold CSnapshot::MAX_ITEMS, the important items are added first
+	enum
+	{
+		SNAP_PRIORITY_HIGH = 0,
+		SNAP_PRIORITY_NORMAL,
+		SNAP_PRIORITY_LOW,
+		NUM_SNAP_PRIORITIES,
+	};
+	static int SnapPriority(int Type);
+	std::vector<const CSnapItemCache::CEntry*> m_avSnapEntries[NUM_SNAP_PRIORITIES];
 
 	class CGS *m_pGS;
 	class IServer *m_pServer;
@@ -82,8 +125,12 @@ public:
 	~CGameWorld();
 
 	void SetGameServer(CGS *pGS);
+	void InitSpatialGrid(int Width, int Height);
 	void UpdatePlayerMaps();
-	bool IsBotActive(int ClientID) { return m_aBotsActive[ClientID]; }
+	bool IsBotActive(int ClientID) const { return ClientID >= 0 && ClientID < MAX_CLIENTS && m_aBotsActive[ClientID]; }
+	int64_t GetMapUpdates() const { return m_MapUpdates; }
+	int64_t GetMapSlotChanges() const { return m_MapSlotChanges; }
+	int GetLastMapSlotChanges() const { return m_LastMapSlotChanges; }
 
 	CEntity *FindFirst(int Type);
 
@@ -177,6 +224,13 @@ public:
 	*/
 	void RemoveEntity(CEntity *pEntity);
 
+	/*
+		Function: UpdateEntityPos
+			Re-buckets an entity after its position was set from outside
+			its own tick, e.g. a teleport.
+	*/
+	void UpdateEntityPos(CEntity *pEntity);
+
 	/*
 		Function: destroy_entity
 			Destroys an entity in the world.
@@ -10,8 +10,8 @@
 
 #include <game/server/mmocore/Components/Guilds/GuildManager.h>
 
-std::map < int, CAccountData > CAccountData::ms_aData;
-std::map < int, CAccountTempData > CAccountTempData::ms_aPlayerTempData;
+CClientDataMap < CAccountData > CAccountData::ms_aData;
+CClientDataMap < CAccountTempData > CAccountTempData::ms_aPlayerTempData;
 
 CGS* CAccountData::GS() const
 {
@@ -57,6 +57,7 @@ void CAccountData::Init(int ID, CPlayer* pPlayer, const char* pLogin, std::strin
 		if(pAttribute->HasDatabaseField())
 			m_aStats[AttrbiteID] = pResult->getInt(pAttribute->GetFieldName());
 	}
+	m_pPlayer->MarkAttributesDirty();
 
 	pServer->SetClientLanguage(ClientID, Language.c_str());
 	pServer->SetClientScore(ClientID, m_Level);
@@ -245,6 +246,7 @@ void CAccountData::AddExperience(int Value)
 
 	// Increase the experience value
 	m_Exp += Value;
+	CGS::InvalidateVotes(m_ClientID);
 
 	// Check if the experience is enough to level up
 	while(m_Exp >= (int)computeExperience(m_Level))
@@ -124,7 +124,7 @@ public:
 		{ CFieldData<int>(JOB_UPGRADES, "Upgrade", "Farmer upgrades") }
 	};
 
-	static std::map < int, CAccountData > ms_aData;
+	static CClientDataMap < CAccountData > ms_aData;
 };
 
 struct CAccountTempData
@@ -158,7 +158,7 @@ struct CAccountTempData
 	vec2 GetTeleportPosition() const { return m_TempTeleportPos; }
 	void ClearTeleportPosition() { m_TempTeleportPos = { -1, -1 }; }
 
-	static std::map < int, CAccountTempData > ms_aPlayerTempData;
+	static CClientDataMap < CAccountTempData > ms_aPlayerTempData;
 
 private:
 	vec2 m_TempTeleportPos{};
@@ -41,66 +41,95 @@ int CAccountManager::GetHistoryLatestCorrectWorldID(CPlayer* pPlayer) const
 }
 
 // Register an account for a client with the given parameters
-AccountCodeResult CAccountManager::RegisterAccount(int ClientID, const char* Login, const char* Password)
+void CAccountManager::RegisterAccount(int ClientID, const char* Login, const char* Password)
 {
+	// Check if a previous login or registration is still being processed
+	if(IsLoginPending(ClientID))
+	{
+		GS()->Chat(ClientID, "Your request is being processed, please wait.");
+		return;
+	}
+
 	// Check if the length of the login and password is between 4 and 12 characters
 	if(str_length(Login) > 12 || str_length(Login) < 4 || str_length(Password) > 12 || str_length(Password) < 4)
 	{
 		GS()->Chat(ClientID, "The username and password must each contain 4 - 12 characters.");
-		return AccountCodeResult::AOP_MISMATCH_LENGTH_SYMBOLS; // Return mismatch length symbols error
+		return;
 	}
 
 	// Get the client's clear nickname
 	const CSqlString<32> cClearNick = CSqlString<32>(Server()->ClientName(ClientID));
 
-	// Check if the client's nickname is already registered
-	ResultPtr pRes = Database->Execute<DB::SELECT>("ID", "tw_accounts_data", "WHERE Nick = '%s'", cClearNick.cstr());
-	if(pRes->next())
-	{
-		GS()->Chat(ClientID, "Sorry, but that game nickname is already taken by another player. To regain access, reach out to the support team or alter your nickname.");
-		GS()->Chat(ClientID, "Discord: \"{STR}\".", g_Config.m_SvDiscordInviteLink);
-		return AccountCodeResult::AOP_NICKNAME_ALREADY_EXIST; // Return nickname already exists error
-	}
-
-	// Get the highest ID from the tw_accounts table
-	ResultPtr pResID = Database->Execute<DB::SELECT>("ID", "tw_accounts", "ORDER BY ID DESC LIMIT 1");
-	const int InitID = pResID->next() ? pResID->getInt("ID") + 1 : 1; // Get the next available ID
-
-	// Convert the login and password to CSqlString objects
-	const CSqlString<32> cClearLogin = CSqlString<32>(Login);
-	const CSqlString<32> cClearPass = CSqlString<32>(Password);
+	// Prepare the completion, the rest is filled in on the SQL worker
+	auto pCompletion = std::make_shared<CAccountCompletion>();
+	pCompletion->m_ClientID = ClientID;
+	pCompletion->m_Session = ms_aSession[ClientID];
+	pCompletion->m_Login = CSqlString<32>(Login).cstr();
+	pCompletion->m_Password = CSqlString<32>(Password).cstr();
+	pCompletion->m_Nickname = cClearNick.cstr();
 
 	// Get and store the client's IP address
 	char aAddrStr[64];
 	Server()->GetClientAddr(ClientID, aAddrStr, sizeof(aAddrStr));
+	std::string ClientAddr = aAddrStr;
 
-	// Generate a random password salt
-	char aSalt[32] = { 0 };
-	secure_random_password(aSalt, sizeof(aSalt), 24);
+	// Check the nickname off the tick, a failed query is reported like any other result
+	ms_aPendingSince[ClientID] = time_get();
+	Database->Prepare<DB::SELECT>("ID", "tw_accounts_data", "WHERE Nick = '%s' LIMIT 1", cClearNick.cstr())
+		->OnFailure([pCompletion]() { PushFailure(pCompletion); })->AtExecute([pCompletion, ClientAddr](ResultPtr pRes)
+	{
+		CAccountCompletion& Completion = *pCompletion;
 
-	// Insert the account into the tw_accounts table with the values
-	Database->Execute<DB::INSERT>("tw_accounts", "(ID, Username, Password, PasswordSalt, RegisterDate, RegisteredIP) VALUES ('%d', '%s', '%s', '%s', UTC_TIMESTAMP(), '%s')", InitID, cClearLogin.cstr(), HashPassword(cClearPass.cstr(), aSalt).c_str(), aSalt, aAddrStr);
-	// Insert the account into the tw_accounts_data table with the ID and nickname values
-	Database->Execute<DB::INSERT, 100>("tw_accounts_data", "(ID, Nick) VALUES ('%d', '%s')", InitID, cClearNick.cstr());
+		// Check if the client's nickname is already registered
+		if(pRes->next())
+		{
+			Completion.m_Code = AccountCodeResult::AOP_NICKNAME_ALREADY_EXIST;
+			PushCompletion(std::move(Completion));
+			return;
+		}
 
-	Server()->AddAccountNickname(InitID, cClearNick.cstr());
-	GS()->Chat(ClientID, "- Registration complete! Don't forget to save your data.");
-	GS()->Chat(ClientID, "# Your nickname is a unique identifier.");
-	GS()->Chat(ClientID, "# Log in: \"/login {STR} {STR}\"", cClearLogin.cstr(), cClearPass.cstr());
-	return AccountCodeResult::AOP_REGISTER_OK; // Return registration success
+		// Generate a random password salt and hash the password off the tick
+		char aSalt[32] = { 0 };
+		secure_random_password(aSalt, sizeof(aSalt), 24);
+		const std::string PasswordHash = HashPassword(Completion.m_Password, aSalt);
+
+		// The account takes its ID from AUTO_INCREMENT and its data row is inserted in the same transaction,
+		// so parallel registrations never share an ID and a failed data row leaves no account behind
+		std::vector<std::string> vQueries = {
+			Database->Prepare<DB::INSERT>("tw_accounts", "(Username, Password, PasswordSalt, RegisterDate, RegisteredIP) VALUES ('%s', '%s', '%s', UTC_TIMESTAMP(), '%s')",
+				Completion.m_Login.c_str(), PasswordHash.c_str(), aSalt, ClientAddr.c_str())->GetQueryString(),
+			Database->Prepare<DB::INSERT>("tw_accounts_data", "(ID, Nick) VALUES (LAST_INSERT_ID(), '%s')", Completion.m_Nickname.c_str())->GetQueryString(),
+			"SELECT LAST_INSERT_ID() AS ID;"
+		};
+		Database->ExecuteBatch(std::move(vQueries), [pCompletion](std::vector<ResultPtr> vResults)
+		{
+			ResultPtr& pResID = vResults.back();
+			if(!pResID || !pResID->next())
+			{
+				PushFailure(pCompletion);
+				return;
+			}
+
+			pCompletion->m_Code = AccountCodeResult::AOP_REGISTER_OK;
+			pCompletion->m_AccountID = pResID->getInt("ID");
+			PushCompletion(std::move(*pCompletion));
+		}, [pCompletion]() { PushFailure(pCompletion); }, true);
+	});
 }
 
 // Function to log in to an account
-AccountCodeResult CAccountManager::LoginAccount(int ClientID, const char* Login, const char* Password)
+void CAccountManager::LoginAccount(int ClientID, const char* Login, const char* Password)
 {
-	// Get the player associated with the client ID
-	CPlayer* pPlayer = GS()->GetPlayer(ClientID, false);
-
 	// Check if the player exists
+	CPlayer* pPlayer = GS()->GetPlayer(ClientID, false);
 	if(!pPlayer)
+		return;
+
+	// Check if a previous login or registration is still being processed
+	if(IsLoginPending(ClientID))
 	{
-		// If player does not exist, return unknown error
-		return AccountCodeResult::AOP_UNKNOWN;
+		GS()->Chat(ClientID, "Your request is being processed, please wait.");
+		return;
 	}
 
 	// Check if the length of the login is less than 4 or greater than 12, or if the length of the password is less than 4 or greater than 12
@@ -110,7 +139,7 @@ AccountCodeResult CAccountManager::LoginAccount(int ClientID, const char* Login,
 	{
 		// Send error message to the client
 		GS()->Chat(ClientID, "The username and password must each contain 4 - 12 characters.");
-		return AccountCodeResult::AOP_MISMATCH_LENGTH_SYMBOLS; // Return mismatch length symbols error
+		return;
 	}
 
 	// Create a SQL strings
@@ -118,52 +147,188 @@ AccountCodeResult CAccountManager::LoginAccount(int ClientID, const char* Login,
 	const auto sqlStrPass = CSqlString<32>(Password);
 	const auto sqlStrNick = CSqlString<32>(Server()->ClientName(ClientID));
 
-	// Check if the nickname exists in the database
-	ResultPtr pResAccount = Database->Execute<DB::SELECT>("*", "tw_accounts_data", "WHERE Nick = '%s'", sqlStrNick.cstr());
-	if(!pResAccount->next())
+	// Prepare the completion, the rest is filled in on the SQL worker
+	auto pCompletion = std::make_shared<CAccountCompletion>();
+	pCompletion->m_ClientID = ClientID;
+	pCompletion->m_Session = ms_aSession[ClientID];
+	pCompletion->m_Login = sqlStrLogin.cstr();
+	pCompletion->m_Password = sqlStrPass.cstr();
+
+	// Fetch account data, credentials, active ban and rank in one round-trip
+	ms_aPendingSince[ClientID] = time_get();
+	Database->Prepare<DB::SELECT>("d.*, a.Password, a.PasswordSalt, a.Language, a.LoginDate, b.BannedUntil, b.Reason, "
+		"(SELECT COUNT(*) + 1 FROM tw_accounts_data r WHERE r.Level > d.Level OR (r.Level = d.Level AND r.Exp > d.Exp)) AS AccountRank", "tw_accounts_data d",
+		"LEFT JOIN tw_accounts a ON a.ID = d.ID AND a.Username = '%s' "
+		"LEFT JOIN tw_accounts_bans b ON b.AccountId = d.ID AND current_timestamp() < b.BannedUntil "
+		"WHERE d.Nick = '%s' LIMIT 1", sqlStrLogin.cstr(), sqlStrNick.cstr())
+		->OnFailure([pCompletion]() { PushFailure(pCompletion); })->AtExecute([pCompletion, pJob = Job()](ResultPtr pRes)
 	{
-		// Send error message to the client
-		GS()->Chat(ClientID, "Sorry, we couldn't locate your username in our system.");
-		return AccountCodeResult::AOP_NICKNAME_NOT_EXIST; // Return nickname not found error
+		CAccountCompletion& Completion = *pCompletion;
+
+		// Check if the nickname exists in the database
+		if(!pRes->next())
+		{
+			Completion.m_Code = AccountCodeResult::AOP_NICKNAME_NOT_EXIST;
+			PushCompletion(std::move(Completion));
+			return;
+		}
+
+		// Check if the wrong login or password error, the hash is computed off the tick
+		if(pRes->isNull("Password") || str_comp(pRes->getString("Password").c_str(), HashPassword(Completion.m_Password, pRes->getString("PasswordSalt").c_str()).c_str()) != 0)
+		{
+			Completion.m_Code = AccountCodeResult::AOP_LOGIN_WRONG;
+			PushCompletion(std::move(Completion));
+			return;
+		}
+
+		// Check if the account is banned
+		if(!pRes->isNull("BannedUntil"))
+		{
+			Completion.m_Code = AccountCodeResult::AOP_ACCOUNT_BANNED;
+			Completion.m_BannedUntil = pRes->getString("BannedUntil").c_str();
+			Completion.m_BanReason = pRes->getString("Reason").c_str();
+			PushCompletion(std::move(Completion));
+			return;
+		}
+
+		Completion.m_Code = AccountCodeResult::AOP_LOGIN_OK;
+		Completion.m_AccountID = pRes->getInt("ID");
+		Completion.m_Rank = pRes->getInt("AccountRank");
+		Completion.m_Language = pRes->getString("Language").c_str();
+		Completion.m_LoginDate = pRes->getString("LoginDate").c_str();
+		Completion.m_pResult = std::move(pRes);
+
+		// Fetch the rows of every component before the result reaches the tick
+		Database->ExecuteBatch(pJob->PrepareAccountQueries(Completion.m_AccountID), [pCompletion](std::vector<ResultPtr> vResults)
+		{
+			pCompletion->m_vAccountResults = std::move(vResults);
+			PushCompletion(std::move(*pCompletion));
+		}, [pCompletion]() { PushFailure(pCompletion); });
+	});
+}
+
+void CAccountManager::PushCompletion(CAccountCompletion&& Completion)
+{
+	std::lock_guard Lock(ms_CompletionsMutex);
+	ms_aCompletions.push_back(std::move(Completion));
+}
+
+void CAccountManager::PushFailure(const std::shared_ptr<CAccountCompletion>& pCompletion)
+{
+	pCompletion->m_Code = AccountCodeResult::AOP_DB_INTERNAL_ERROR;
+	PushCompletion(std::move(*pCompletion));
+}
+
+void CAccountManager::OnTick()
+{
+	// Failed queries report back, this only releases players of this world behind a stalled database
+	for(int ClientID = 0; ClientID < MAX_PLAYERS; ClientID++)
+	{
+		if(!GS()->GetPlayer(ClientID, false))
+			continue;
+
+		int64_t PendingSince = ms_aPendingSince[ClientID];
+		if(PendingSince > 0 && time_get() > PendingSince + time_freq() * 10 && ms_aPendingSince[ClientID].compare_exchange_strong(PendingSince, 0))
+			GS()->Chat(ClientID, "Something went wrong, please try again later.");
 	}
+}
 
-	// Check if the wrong login or password error
-	int UserID = pResAccount->getInt("ID"); // Get the ID from the account result
-	ResultPtr pResCheck = Database->Execute<DB::SELECT>("ID, LoginDate, Language, Password, PasswordSalt", "tw_accounts", "WHERE Username = '%s' AND ID = '%d'", sqlStrLogin.cstr(), UserID);
-	if(!pResCheck->next() || str_comp(pResCheck->getString("Password").c_str(), HashPassword(sqlStrPass.cstr(), pResCheck->getString("PasswordSalt").c_str()).c_str()) != 0)
+void CAccountManager::OnTickGlobal()
+{
+	// Results are applied from the global tick while no world ticks, logging in fills the per-client data of every component
+	std::deque<CAccountCompletion> aCompletions;
 	{
-		// Send error message to the client
-		GS()->Chat(ClientID, "Oops, that doesn't seem to be the right login or password");
-		return AccountCodeResult::AOP_LOGIN_WRONG; // Return wrong login or password error
+		std::lock_guard Lock(ms_CompletionsMutex);
+		aCompletions.swap(ms_aCompletions);
 	}
 
-	// Check if the account is banned
-	ResultPtr pResBan = Database->Execute<DB::SELECT>("BannedUntil, Reason", "tw_accounts_bans", "WHERE AccountId = '%d' AND current_timestamp() < `BannedUntil`", UserID);
-	if(pResBan->next())
+	std::deque<CAccountCompletion> aWaiting;
+	for(auto& Completion : aCompletions)
+	{
+		// The client has left in the meantime, the result is stale
+		const int ClientID = Completion.m_ClientID;
+		if(Completion.m_Session != ms_aSession[ClientID])
+			continue;
+
+		// The client is between worlds, keep the result until it has arrived
+		CGS* pGS = (CGS*)Instance::GetServer()->GameServerPlayer(ClientID);
+		if(!pGS || !pGS->GetPlayer(ClientID, false))
+		{
+			aWaiting.push_back(std::move(Completion));
+			continue;
+		}
+
+		ms_aPendingSince[ClientID] = 0;
+		if(Completion.m_Code == AccountCodeResult::AOP_REGISTER_OK || Completion.m_Code == AccountCodeResult::AOP_NICKNAME_ALREADY_EXIST)
+			pGS->Mmo()->Account()->HandleRegisterCompletion(Completion);
+		else
+			pGS->Mmo()->Account()->HandleLoginCompletion(Completion);
+	}
+
+	if(!aWaiting.empty())
+	{
+		std::lock_guard Lock(ms_CompletionsMutex);
+		ms_aCompletions.insert(ms_aCompletions.begin(), std::make_move_iterator(aWaiting.begin()), std::make_move_iterator(aWaiting.end()));
+	}
+}
+
+void CAccountManager::HandleRegisterCompletion(CAccountCompletion& Completion)
+{
+	const int ClientID = Completion.m_ClientID;
+	if(Completion.m_Code == AccountCodeResult::AOP_NICKNAME_ALREADY_EXIST)
 	{
-		// Send error message to the client with the ban information
-		GS()->Chat(ClientID, "You account was suspended until \"{STR}\" with the reason of \"{STR}\"", pResBan->getString("BannedUntil").c_str(), pResBan->getString("Reason").c_str());
-		return AccountCodeResult::AOP_ACCOUNT_BANNED; // Return account banned error
+		GS()->Chat(ClientID, "Sorry, but that game nickname is already taken by another player. To regain access, reach out to the support team or alter your nickname.");
+		GS()->Chat(ClientID, "Discord: \"{STR}\".", g_Config.m_SvDiscordInviteLink);
+		return;
+	}
+
+	Server()->AddAccountNickname(Completion.m_AccountID, Completion.m_Nickname.c_str());
+	GS()->Chat(ClientID, "- Registration complete! Don't forget to save your data.");
+	GS()->Chat(ClientID, "# Your nickname is a unique identifier.");
+	GS()->Chat(ClientID, "# Log in: \"/login {STR} {STR}\"", Completion.m_Login.c_str(), Completion.m_Password.c_str());
+}
+
+void CAccountManager::HandleLoginCompletion(CAccountCompletion& Completion)
+{
+	const int ClientID = Completion.m_ClientID;
+	CPlayer* pPlayer = GS()->GetPlayer(ClientID, false);
+	if(!pPlayer || pPlayer->IsAuthed())
+		return;
+
+	switch(Completion.m_Code)
+	{
+		case AccountCodeResult::AOP_NICKNAME_NOT_EXIST:
+			GS()->Chat(ClientID, "Sorry, we couldn't locate your username in our system.");
+			return;
+		case AccountCodeResult::AOP_LOGIN_WRONG:
+			GS()->Chat(ClientID, "Oops, that doesn't seem to be the right login or password");
+			return;
+		case AccountCodeResult::AOP_ACCOUNT_BANNED:
+			GS()->Chat(ClientID, "You account was suspended until \"{STR}\" with the reason of \"{STR}\"", Completion.m_BannedUntil.c_str(), Completion.m_BanReason.c_str());
+			return;
+		case AccountCodeResult::AOP_LOGIN_OK:
+			break;
+		default:
+			GS()->Chat(ClientID, "Something went wrong, please try again later.");
+			return;
 	}
 
 	// Check if a player with the given UserID exists in the game state
-	if(GS()->GetPlayerByUserID(UserID) != nullptr)
+	if(GS()->GetPlayerByUserID(Completion.m_AccountID) != nullptr)
 	{
-		// Send error message to the client
 		GS()->Chat(ClientID, "The account is already in the game.");
-		return AccountCodeResult::AOP_ALREADY_IN_GAME; // Return already in game error
+		return;
 	}
 
 	// Update player account information from the database
-	std::string Language = pResCheck->getString("Language").c_str();
-	std::string LoginDate = pResCheck->getString("LoginDate").c_str();
-	pPlayer->Account()->Init(UserID, pPlayer, sqlStrLogin.cstr(), Language, LoginDate, std::move(pResAccount));
+	pPlayer->Account()->Init(Completion.m_AccountID, pPlayer, Completion.m_Login.c_str(), Completion.m_Language, Completion.m_LoginDate, std::move(Completion.m_pResult));
+	Job()->OnInitAccount(ClientID, Completion.m_vAccountResults);
 
 	// Send success messages to the client
 	GS()->Chat(ClientID, "- Welcome! You've successfully logged in!");
+	GS()->Chat(-1, "{STR} logged to account. Rank #{INT}", Server()->ClientName(ClientID), Completion.m_Rank);
 	GS()->m_pController->DoTeamChange(pPlayer, false);
 	LoadAccount(pPlayer, true);
-	return AccountCodeResult::AOP_LOGIN_OK;
 }
 
 void CAccountManager::LoadAccount(CPlayer* pPlayer, bool FirstInitilize)
@@ -185,7 +350,7 @@ void CAccountManager::LoadAccount(CPlayer* pPlayer, bool FirstInitilize)
 	{
 		// Get the number of unread letters in the player's inbox
 		// Send a chat message to the player informing them about their unread letters
-		if(const int Letters = Job()->Inbox()->GetMailLettersSize(pPlayer->Account()->GetID()); Letters > 0)
+		if(const int Letters = Job()->Inbox()->GetUnreadLettersSize(pPlayer->Account()->GetID()); Letters > 0)
 			GS()->Chat(ClientID, "You have {INT} unread letters!", Letters);
 
 		// Update the player's votes and show the main menu
@@ -193,12 +358,7 @@ void CAccountManager::LoadAccount(CPlayer* pPlayer, bool FirstInitilize)
 		return;
 	}
 
-	// If it is the first initialization, initialize the player's job account
-	Job()->OnInitAccount(ClientID);
-
 	// Send information about log in
-	const int Rank = GetRank(pPlayer->Account()->GetID());
-	GS()->Chat(-1, "{STR} logged to account. Rank #{INT}", Server()->ClientName(ClientID), Rank);
 #ifdef CONF_DISCORD
 	char aLoginBuf[64];
 	str_format(aLoginBuf, sizeof(aLoginBuf), "%s logged in Account ID %d", Server()->ClientName(ClientID), pPlayer->Account()->GetID());
@@ -306,19 +466,20 @@ bool CAccountManager::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool Repl
 		// game settings
 		GS()->AVH(ClientID, TAB_SETTINGS, "\u2692 Some of the settings become valid after death.");
 		GS()->AVM(ClientID, "MENU", MENU_SELECT_LANGUAGE, TAB_SETTINGS, "Settings language");
-		for(const auto& [ItemID, ItemData] : CPlayerItem::Data()[ClientID])
+		for(const auto* pItem : CPlayerItem::Data()[ClientID].GetSideIndex())
 		{
+			const CPlayerItem& ItemData = *pItem;
 			if(ItemData.Info()->IsType(ItemType::TYPE_SETTINGS) && ItemData.HasItem())
-				GS()->AVM(ClientID, "ISETTINGS", ItemID, TAB_SETTINGS, "[{STR}] {STR}", (ItemData.GetSettings() ? "Enabled" : "Disabled"), ItemData.Info()->GetName());
+				GS()->AVM(ClientID, "ISETTINGS", ItemData.GetID(), TAB_SETTINGS, "[{STR}] {STR}", (ItemData.GetSettings() ? "Enabled" : "Disabled"), ItemData.Info()->GetName());
 		}
 
 		// equipment modules
 		bool IsFoundModules = false;
 		GS()->AV(ClientID, "null");
 		GS()->AVH(ClientID, TAB_SETTINGS_MODULES, "\u2694 Modules settings");
-		for(const auto& it : CPlayerItem::Data()[ClientID])
+		for(const auto* pItem : CPlayerItem::Data()[ClientID].GetSideIndex())
 		{
-			const CPlayerItem ItemData = it.second;
+			const CPlayerItem& ItemData = *pItem;
 			if(ItemData.Info()->IsType(ItemType::TYPE_MODULE) && ItemData.GetValue() > 0)
 			{
 				char aAttributesInfo[128];
@@ -331,7 +492,7 @@ bool CAccountManager::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool Repl
 					str_copy(aAttributesInfo, ItemData.Info()->GetDescription(), sizeof(aAttributesInfo));
 				}
 
-				GS()->AVM(ClientID, "ISETTINGS", it.first, TAB_SETTINGS_MODULES, "{STR}{STR} * {STR}", (ItemData.GetSettings() ? "✔" : "\0"), ItemData.Info()->GetName(), aAttributesInfo);
+				GS()->AVM(ClientID, "ISETTINGS", ItemData.GetID(), TAB_SETTINGS_MODULES, "{STR}{STR} * {STR}", (ItemData.GetSettings() ? "✔" : "\0"), ItemData.Info()->GetName(), aAttributesInfo);
 				IsFoundModules = true;
 			}
 		}
@@ -412,6 +573,13 @@ bool CAccountManager::OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, co
 
 void CAccountManager::OnResetClient(int ClientID)
 {
+	// Invalidate in-flight login and registration results for this slot
+	if(ClientID >= 0 && ClientID < MAX_PLAYERS)
+	{
+		ms_aSession[ClientID]++;
+		ms_aPendingSince[ClientID] = 0;
+	}
+
 	CAccountTempData::ms_aPlayerTempData.erase(ClientID);
 	CAccountData::ms_aData.erase(ClientID);
 }
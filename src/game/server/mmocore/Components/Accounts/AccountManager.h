@@ -15,9 +15,40 @@ class CAccountManager : public MmoComponent
 		CAccountTempData::ms_aPlayerTempData.clear();
 	};
 
+	void OnTick() override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
 	bool OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu) override;
 	void OnResetClient(int ClientID) override;
+
+	// result of an asynchronous login or registration, produced on a SQL worker and consumed on the tick
+	struct CAccountCompletion
+	{
+		int m_ClientID {};
+		int m_Session {};
+		AccountCodeResult m_Code {};
+		int m_AccountID {};
+		int m_Rank {};
+		std::string m_Login {};
+		std::string m_Password {};
+		std::string m_Nickname {};
+		std::string m_Language {};
+		std::string m_LoginDate {};
+		std::string m_BannedUntil {};
+		std::string m_BanReason {};
+		ResultPtr m_pResult {};
+		std::vector<ResultPtr> m_vAccountResults {}; // rows of the component account queries
+	};
+
+	inline static std::mutex ms_CompletionsMutex {};
+	inline static std::deque<CAccountCompletion> ms_aCompletions {};
+	// per slot, read by every world tick while the owning world writes them
+	inline static std::atomic<int> ms_aSession[MAX_PLAYERS] {};
+	inline static std::atomic<int64_t> ms_aPendingSince[MAX_PLAYERS] {};
+
+	static void PushCompletion(CAccountCompletion&& Completion);
+	static void PushFailure(const std::shared_ptr<CAccountCompletion>& pCompletion);
+	void HandleRegisterCompletion(CAccountCompletion& Completion);
+	void HandleLoginCompletion(CAccountCompletion& Completion);
 	void OnPlayerHandleTimePeriod(CPlayer* pPlayer, TIME_PERIOD Period) override;
 
     struct AccBan
@@ -29,8 +60,10 @@ class CAccountManager : public MmoComponent
     };
 
 public:
-	AccountCodeResult RegisterAccount(int ClientID, const char *Login, const char *Password);
-	AccountCodeResult LoginAccount(int ClientID, const char *Login, const char *Password);
+	void RegisterAccount(int ClientID, const char *Login, const char *Password);
+	void LoginAccount(int ClientID, const char *Login, const char *Password);
+	static void OnTickGlobal();
+	static bool IsLoginPending(int ClientID) { return ClientID >= 0 && ClientID < MAX_PLAYERS && ms_aPendingSince[ClientID] > 0; }
 	void LoadAccount(CPlayer *pPlayer, bool FirstInitilize = false);
 	void DiscordConnect(int ClientID, const char *pDID) const;
 	bool ChangeNickname(int ClientID);
@@ -43,7 +76,7 @@ public:
 	static int GetRank(int AccountID);
 	static bool IsActive(int ClientID)
 	{
-		return CAccountData::ms_aData.find(ClientID) != CAccountData::ms_aData.end();
+		return CAccountData::ms_aData.contains(ClientID);
 	}
 
 	static std::string HashPassword(const std::string& Password, const std::string& Salt);
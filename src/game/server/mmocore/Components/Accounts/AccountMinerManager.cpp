@@ -22,9 +22,13 @@ void CAccountMinerManager::OnInitWorld(const char* pWhereLocalWorld)
 	}
 }
 
-void CAccountMinerManager::OnInitAccount(CPlayer* pPlayer)
+std::string CAccountMinerManager::OnAccountQuery(int AccountID) const
+{
+	return Database->Prepare<DB::SELECT>("*", "tw_accounts_mining", "WHERE UserID = '%d'", AccountID)->GetQueryString();
+}
+
+void CAccountMinerManager::OnInitAccount(CPlayer* pPlayer, ResultPtr pRes)
 {
-	ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_accounts_mining", "WHERE UserID = '%d'", pPlayer->Account()->GetID());
 	if (pRes->next())
 	{
 		pPlayer->Account()->m_MiningData.initFields(&pRes);
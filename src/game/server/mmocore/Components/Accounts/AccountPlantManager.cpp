@@ -24,9 +24,13 @@ void CAccountPlantManager::OnInitWorld(const char* pWhereLocalWorld)
 	}
 }
 
-void CAccountPlantManager::OnInitAccount(CPlayer *pPlayer)
+std::string CAccountPlantManager::OnAccountQuery(int AccountID) const
+{
+	return Database->Prepare<DB::SELECT>("*", "tw_accounts_farming", "WHERE UserID = '%d'", AccountID)->GetQueryString();
+}
+
+void CAccountPlantManager::OnInitAccount(CPlayer *pPlayer, ResultPtr pRes)
 {
-	ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_accounts_farming", "WHERE UserID = '%d'", pPlayer->Account()->GetID());
 	if(pRes->next())
 	{
 		pPlayer->Account()->m_FarmingData.initFields(&pRes);
@@ -23,7 +23,8 @@ class CAccountPlantManager : public MmoComponent
 	static std::map < int, StructPlants > ms_aPlants;
 
 	void OnInitWorld(const char* pWhereLocalWorld) override;
-	void OnInitAccount(CPlayer* pPlayer) override;
+	std::string OnAccountQuery(int AccountID) const override;
+	void OnInitAccount(CPlayer* pPlayer, ResultPtr pRes) override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
 
 public:
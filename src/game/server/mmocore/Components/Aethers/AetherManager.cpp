@@ -25,9 +25,13 @@ void CAetherManager::OnInit()
 	});
 }
 
-void CAetherManager::OnInitAccount(CPlayer *pPlayer)
+std::string CAetherManager::OnAccountQuery(int AccountID) const
+{
+	return Database->Prepare<DB::SELECT>("*", "tw_accounts_aethers", "WHERE UserID = '%d'", AccountID)->GetQueryString();
+}
+
+void CAetherManager::OnInitAccount(CPlayer *pPlayer, ResultPtr pRes)
 {
-	ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_accounts_aethers", "WHERE UserID = '%d'", pPlayer->Account()->GetID());
 	while(pRes->next())
 	{
 		const int TeleportID = pRes->getInt("AetherID");
@@ -64,26 +68,24 @@ bool CAetherManager::OnHandleVoteCommands(CPlayer *pPlayer, const char *CMD, con
 	return false;
 }
 
-bool CAetherManager::OnHandleTile(CCharacter* pChr, int IndexCollision)
+void CAetherManager::OnRegisterTiles()
 {
-	CPlayer* pPlayer = pChr->GetPlayer();
-	const int ClientID = pPlayer->GetCID();
+	Job()->RegisterTile(TILE_AETHER_TELEPORT, this);
+}
 
-	if (pChr->GetHelper()->TileEnter(IndexCollision, TILE_AETHER_TELEPORT))
-	{
-		_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
-		UnlockLocation(pChr->GetPlayer(), pChr->m_Core.m_Pos);
-		GS()->StrongUpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
-	else if (pChr->GetHelper()->TileExit(IndexCollision, TILE_AETHER_TELEPORT))
-	{
-		_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->StrongUpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
+void CAetherManager::OnHandleTileEnter(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
+	UnlockLocation(pPlayer, pChr->m_Core.m_Pos);
+	GS()->StrongUpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
+}
 
-	return false;
+void CAetherManager::OnHandleTileExit(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->StrongUpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
 }
 
 bool CAetherManager::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu)
@@ -7,4 +7,81 @@
 int CAuctionSlot::GetTaxPrice() const
 {
 	return maximum(1, translate_to_percent_rest(m_Price, g_Config.m_SvAuctionSlotTaxPrice));
-}
\ No newline at end of file
+}
+
+void CAuctionOrderBook::Link(const CAuctionSlot& Slot)
+{
+	const PriceKey Key { Slot.GetPrice(), Slot.GetID() };
+	ms_Slots[Slot.GetID()] = Slot;
+	ms_ByPrice.insert(Key);
+	ms_ByItem[Slot.GetItem()->GetID()].insert(Key);
+	ms_SellerSlots[Slot.GetUserID()]++;
+	ms_LastID = maximum(ms_LastID, Slot.GetID());
+}
+
+void CAuctionOrderBook::Insert(const CAuctionSlot& Slot)
+{
+	std::lock_guard Lock(ms_Lock);
+	if(!ms_Slots.count(Slot.GetID()))
+		Link(Slot);
+}
+
+void CAuctionOrderBook::ReserveID(int ID)
+{
+	std::lock_guard Lock(ms_Lock);
+	ms_LastID = maximum(ms_LastID, ID);
+}
+
+CAuctionSlot CAuctionOrderBook::Create(int UserID, const CItem& Item, int Price)
+{
+	std::lock_guard Lock(ms_Lock);
+	CAuctionSlot Slot(ms_LastID + 1, UserID, Item, Price);
+	Link(Slot);
+	return Slot;
+}
+
+bool CAuctionOrderBook::Take(int ID, CAuctionSlot* pSlot)
+{
+	std::lock_guard Lock(ms_Lock);
+	auto Iter = ms_Slots.find(ID);
+	if(Iter == ms_Slots.end())
+		return false;
+
+	const CAuctionSlot& Slot = Iter->second;
+	const PriceKey Key { Slot.GetPrice(), Slot.GetID() };
+	ms_ByPrice.erase(Key);
+
+	auto ItemIter = ms_ByItem.find(Slot.GetItem()->GetID());
+	ItemIter->second.erase(Key);
+	if(ItemIter->second.empty())
+		ms_ByItem.erase(ItemIter);
+
+	auto SellerIter = ms_SellerSlots.find(Slot.GetUserID());
+	if(--SellerIter->second <= 0)
+		ms_SellerSlots.erase(SellerIter);
+
+	if(pSlot)
+		*pSlot = Slot;
+	ms_Slots.erase(Iter);
+	return true;
+}
+
+int CAuctionOrderBook::Size()
+{
+	std::lock_guard Lock(ms_Lock);
+	return (int)ms_Slots.size();
+}
+
+int CAuctionOrderBook::SellerSlots(int UserID)
+{
+	std::lock_guard Lock(ms_Lock);
+	const auto Iter = ms_SellerSlots.find(UserID);
+	return Iter != ms_SellerSlots.end() ? Iter->second : 0;
+}
+
+int CAuctionOrderBook::LowestPrice(ItemIdentifier ItemID)
+{
+	std::lock_guard Lock(ms_Lock);
+	const auto Iter = ms_ByItem.find(ItemID);
+	return Iter != ms_ByItem.end() ? Iter->second.begin()->first : -1;
+}
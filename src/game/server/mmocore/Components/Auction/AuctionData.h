@@ -5,10 +5,15 @@
 
 #include <game/server/mmocore/Components/Inventory/ItemData.h>
 
+#include <mutex>
+#include <set>
+
 class CAuctionSlot
 {
 	CItem m_Item {};
 	int m_Price {};
+	int m_ID {};
+	int m_UserID {};
 
 public:
 	// Default constructor
@@ -16,6 +21,7 @@ public:
 
 	// Parameterized constructor
 	CAuctionSlot(CItem Item, int Price) : m_Item(std::move(Item)), m_Price(Price) {}
+	CAuctionSlot(int ID, int UserID, CItem Item, int Price) : m_Item(std::move(Item)), m_Price(Price), m_ID(ID), m_UserID(UserID) {}
 
 	// Setter methods for item and price
 	void SetItem(CItem Item) { m_Item = std::move(Item); }
@@ -26,6 +32,57 @@ public:
 	const CItem* GetItem() const { return &m_Item; }               // Return a const pointer to the item (for const objects)
 	int GetPrice() const { return m_Price; }                       // Return the price
 	int GetTaxPrice() const;                                       // Declaration for a function to calculate the tax price
+	int GetID() const { return m_ID; }                             // Return the slot id, 0 while the slot is not listed
+	int GetUserID() const { return m_UserID; }                     // Return the account id of the seller
+};
+
+/*
+	Class: CAuctionOrderBook
+		All listed slots, loaded once on start. The book is authoritative,
+		the database only follows it. Slots are ordered by price overall
+		and per item, sellers keep a slot counter. All access goes through
+		one lock, so parallel worlds cannot sell one slot twice.
+*/
+class CAuctionOrderBook
+{
+	using PriceKey = std::pair<int, int>; // price, slot id
+
+	static inline std::mutex ms_Lock;
+	static inline ska::unordered_map<int, CAuctionSlot> ms_Slots;
+	static inline std::set<PriceKey> ms_ByPrice;
+	static inline ska::unordered_map<ItemIdentifier, std::set<PriceKey>> ms_ByItem;
+	static inline ska::unordered_map<int, int> ms_SellerSlots;
+	static inline int ms_LastID;
+
+	static void Link(const CAuctionSlot& Slot);
+
+public:
+	// Insert a slot that is already stored in the database
+	static void Insert(const CAuctionSlot& Slot);
+
+	// New slots get ids above every id used by the table
+	static void ReserveID(int ID);
+
+	// List a new slot, returns it with the id it got
+	static CAuctionSlot Create(int UserID, const CItem& Item, int Price);
+
+	// Remove the slot from the book, false if it was sold or closed meanwhile
+	static bool Take(int ID, CAuctionSlot* pSlot);
+
+	static int Size();
+	static int SellerSlots(int UserID);
+
+	// Cheapest price of the item, or -1 if nobody sells it
+	static int LowestPrice(ItemIdentifier ItemID);
+
+	// Calls Fn(const CAuctionSlot&) from the cheapest to the most expensive slot
+	template<typename F>
+	static void ForEachByPrice(F&& Fn)
+	{
+		std::lock_guard Lock(ms_Lock);
+		for(const auto& [Price, ID] : ms_ByPrice)
+			Fn(ms_Slots.at(ID));
+	}
 };
 #endif
 
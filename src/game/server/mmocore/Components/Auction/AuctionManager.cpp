@@ -1,6 +1,7 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include "AuctionManager.h"
+#include "AuctionData.h"
 
 #include <engine/shared/config.h>
 #include <game/server/gamecontext.h>
@@ -9,29 +10,44 @@
 
 constexpr auto TW_AUCTION_TABLE = "tw_auction_items";
 
+void CAuctionManager::OnInit()
+{
+	// the order book is loaded once before the first tick, afterwards every change is written through
+	ResultPtr pRes = Database->Execute<DB::SELECT>("*", TW_AUCTION_TABLE);
+	while(pRes->next())
+	{
+		CAuctionOrderBook::ReserveID(pRes->getInt("ID"));
+		if(pRes->getInt("UserID") <= 0)
+			continue;
+
+		const CItem Item(pRes->getInt("ItemID"), pRes->getInt("ItemValue"), pRes->getInt("Enchant"));
+		CAuctionOrderBook::Insert({ pRes->getInt("ID"), pRes->getInt("UserID"), Item, pRes->getInt("Price") });
+	}
+
+	Job()->ShowLoadingProgress("Auction slots", CAuctionOrderBook::Size());
+}
+
 void CAuctionManager::OnTick()
 {
 }
 
-bool CAuctionManager::OnHandleTile(CCharacter* pChr, int IndexCollision)
+void CAuctionManager::OnRegisterTiles()
 {
-	CPlayer* pPlayer = pChr->GetPlayer();
-	const int ClientID = pPlayer->GetCID();
-	if (pChr->GetHelper()->TileEnter(IndexCollision, TILE_AUCTION))
-	{
-		_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
+	Job()->RegisterTile(TILE_AUCTION, this);
+}
 
-	if (pChr->GetHelper()->TileExit(IndexCollision, TILE_AUCTION))
-	{
-		_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
+void CAuctionManager::OnHandleTileEnter(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
+}
 
-	return false;
+void CAuctionManager::OnHandleTileExit(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
 }
 
 bool CAuctionManager::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu)
@@ -161,16 +177,14 @@ void CAuctionManager::CreateAuctionSlot(CPlayer* pPlayer, CAuctionSlot* pAuction
 	const int ClientID = pPlayer->GetCID();
 
 	// check the number of slots whether everything is occupied or not
-	ResultPtr pResCheck = Database->Execute<DB::SELECT>("ID", "tw_auction_items", "WHERE UserID > '0' LIMIT %d", g_Config.m_SvMaxAuctionSlots);
-	if((int)pResCheck->rowsCount() >= g_Config.m_SvMaxAuctionSlots)
+	if(CAuctionOrderBook::Size() >= g_Config.m_SvMaxAuctionSlots)
 	{
 		GS()->Chat(ClientID, "Auction has run out of slots, wait for the release of slots!");
 		return;
 	}
 
 	// check your slots
-	ResultPtr pResCheck2 = Database->Execute<DB::SELECT>("ID", "tw_auction_items", "WHERE UserID = '%d' LIMIT %d", pPlayer->Account()->GetID(), g_Config.m_SvMaxAuctionPlayerSlots);
-	const int ValueSlot = (int)pResCheck2->rowsCount();
+	const int ValueSlot = CAuctionOrderBook::SellerSlots(pPlayer->Account()->GetID());
 	if(ValueSlot >= g_Config.m_SvMaxAuctionPlayerSlots)
 	{
 		GS()->Chat(ClientID, "You use all open the slots in your auction!");
@@ -186,8 +200,10 @@ void CAuctionManager::CreateAuctionSlot(CPlayer* pPlayer, CAuctionSlot* pAuction
 	CPlayerItem* pPlayerItem = pPlayer->GetItem(pAuctionItem->GetID());
 	if(pPlayerItem->GetValue() >= pAuctionItem->GetValue() && pPlayerItem->Remove(pAuctionItem->GetValue()))
 	{
-		Database->Execute<DB::INSERT>(TW_AUCTION_TABLE, "(ItemID, Price, ItemValue, UserID, Enchant) VALUES ('%d', '%d', '%d', '%d', '%d')",
-			pAuctionItem->GetID(), pAuctionData->GetPrice(), pAuctionItem->GetValue(), pPlayer->Account()->GetID(), pAuctionItem->GetEnchant());
+		const CAuctionSlot Slot = CAuctionOrderBook::Create(pPlayer->Account()->GetID(), *pAuctionItem, pAuctionData->GetPrice());
+		Database->ExecuteOrdered<DB::INSERT>(TW_AUCTION_TABLE, "(ID, ItemID, Price, ItemValue, UserID, Enchant) VALUES ('%d', '%d', '%d', '%d', '%d', '%d')",
+			Slot.GetID(), pAuctionItem->GetID(), Slot.GetPrice(), pAuctionItem->GetValue(), Slot.GetUserID(), pAuctionItem->GetEnchant());
+		CGS::InvalidateVotes(ClientID);
 
 		const int AvailableSlot = (g_Config.m_SvMaxAuctionPlayerSlots - ValueSlot) - 1;
 		GS()->Chat(-1, "{STR} created a slot [{STR}x{VAL}] auction.", Server()->ClientName(ClientID), pPlayerItem->Info()->GetName(), pAuctionItem->GetValue());
@@ -197,26 +213,36 @@ void CAuctionManager::CreateAuctionSlot(CPlayer* pPlayer, CAuctionSlot* pAuction
 
 bool CAuctionManager::BuyItem(CPlayer* pPlayer, int ID)
 {
+	// the slot leaves the book first, so nobody else can buy it meanwhile
 	const int ClientID = pPlayer->GetCID();
-	ResultPtr pRes = Database->Execute<DB::SELECT>("*", TW_AUCTION_TABLE, "WHERE ID = '%d'", ID);
-	if(!pRes->next())
+	CAuctionSlot Slot;
+	if(!CAuctionOrderBook::Take(ID, &Slot))
 		return false;
 
 	// checking for enchanted items
-	const ItemIdentifier ItemID = pRes->getInt("ItemID");
+	const ItemIdentifier ItemID = Slot.GetItem()->GetID();
 	CPlayerItem* pPlayerItem = pPlayer->GetItem(ItemID);
 
-	const int UserID = pRes->getInt("UserID");
-	const int Price = pRes->getInt("Price");
-	const int Value = pRes->getInt("ItemValue");
-	const int Enchant = pRes->getInt("Enchant");
+	const int UserID = Slot.GetUserID();
+	const int Price = Slot.GetPrice();
+	const int Value = Slot.GetItem()->GetValue();
+	const int Enchant = Slot.GetItem()->GetEnchant();
+
+	// ordered after the insert of the slot
+	auto RemoveSlotRow = [this, ID, ClientID, UserID]()
+	{
+		Database->ExecuteOrdered<DB::REMOVE>(TW_AUCTION_TABLE, "WHERE ID = '%d'", ID);
+		CGS::InvalidateVotes(ClientID);
+		if(CPlayer* pSeller = GS()->GetPlayerByUserID(UserID))
+			CGS::InvalidateVotes(pSeller->GetCID());
+	};
 
 	// if it is a player slot then close the slot
 	if(UserID == pPlayer->Account()->GetID())
 	{
 		GS()->Chat(ClientID, "You closed auction slot!");
 		GS()->SendInbox("Auctionist", pPlayer, "Auction Alert", "You have bought a item, or canceled your slot", ItemID, Value, Enchant);
-		Database->Execute<DB::REMOVE>(TW_AUCTION_TABLE, "WHERE ItemID = '%d' AND UserID = '%d'", ItemID, UserID);
+		RemoveSlotRow();
 		return true;
 	}
 
@@ -224,18 +250,22 @@ bool CAuctionManager::BuyItem(CPlayer* pPlayer, int ID)
 	if(pPlayerItem->HasItem() && pPlayerItem->Info()->IsEnchantable())
 	{
 		GS()->Chat(ClientID, "Enchant item maximal count x1 in a backpack!");
+		CAuctionOrderBook::Insert(Slot);
 		return false;
 	}
 
 	// player purchasing
 	if(!pPlayer->Account()->SpendCurrency(Price))
+	{
+		CAuctionOrderBook::Insert(Slot);
 		return false;
+	}
 
 	// information & exchange item
 	char aBuf[128];
 	str_format(aBuf, sizeof(aBuf), "Your [Slot %sx%d] was sold!", pPlayerItem->Info()->GetName(), Value);
 	GS()->SendInbox("Auctionist", UserID, "Auction Sell", aBuf, itGold, Price, 0);
-	Database->Execute<DB::REMOVE>(TW_AUCTION_TABLE, "WHERE ItemID = '%d' AND UserID = '%d'", ItemID, UserID);
+	RemoveSlotRow();
 
 	pPlayerItem->Add(Value, 0, Enchant);
 	GS()->Chat(ClientID, "You buy {STR}x{VAL}.", pPlayerItem->Info()->GetName(), Value);
@@ -253,15 +283,14 @@ void CAuctionManager::ShowAuction(CPlayer* pPlayer)
 
 	bool FoundItems = false;
 	int HideID = (int)(NUM_TAB_MENU + CItemDescription::Data().size() + 400);
-	ResultPtr pRes = Database->Execute<DB::SELECT>("*", TW_AUCTION_TABLE, "WHERE UserID > 0 ORDER BY Price");
-	while(pRes->next())
+	CAuctionOrderBook::ForEachByPrice([&](const CAuctionSlot& Slot)
 	{
-		const int ID = pRes->getInt("ID");
-		const ItemIdentifier ItemID = pRes->getInt("ItemID");
-		const int Price = pRes->getInt("Price");
-		const int Enchant = pRes->getInt("Enchant");
-		const int ItemValue = pRes->getInt("ItemValue");
-		const int UserID = pRes->getInt("UserID");
+		const int ID = Slot.GetID();
+		const ItemIdentifier ItemID = Slot.GetItem()->GetID();
+		const int Price = Slot.GetPrice();
+		const int Enchant = Slot.GetItem()->GetEnchant();
+		const int ItemValue = Slot.GetItem()->GetValue();
+		const int UserID = Slot.GetUserID();
 		CItemDescription* pItemInfo = GS()->GetItemInfo(ItemID);
 
 		if(pItemInfo->IsEnchantable())
@@ -285,7 +314,7 @@ void CAuctionManager::ShowAuction(CPlayer* pPlayer)
 		GS()->AVM(ClientID, "null", NOPE, HideID, "\0");
 		FoundItems = true;
 		++HideID;
-	}
+	});
 	if(!FoundItems)
 		GS()->AVL(ClientID, "null", "Currently there are no products.");
 
@@ -9,8 +9,11 @@ class CAuctionManager : public MmoComponent
 {
 	~CAuctionManager() override = default;
 
+	void OnInit() override;
 	void OnTick() override;
-	bool OnHandleTile(CCharacter* pChr, int IndexCollision) override;
+	void OnRegisterTiles() override;
+	void OnHandleTileEnter(CCharacter* pChr, int Tile) override;
+	void OnHandleTileExit(CCharacter* pChr, int Tile) override;
 	bool OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu) override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
 
@@ -157,11 +157,12 @@ class CMobBuffDebuff
 {
 	float m_Chance {};
 	std::string m_Effect {};
+	int m_EffectID { -1 };
 	std::tuple<int, int> m_Time {};
 
 public:
 	CMobBuffDebuff() = default;
-	CMobBuffDebuff(float Chance, std::string Effect, std::tuple<int, int> Time) : m_Chance(Chance), m_Effect(Effect), m_Time(Time) {}
+	CMobBuffDebuff(float Chance, std::string Effect, std::tuple<int, int> Time) : m_Chance(Chance), m_Effect(Effect), m_EffectID(CEffects::Register(m_Effect.c_str())), m_Time(Time) {}
 
 	enum
 	{
@@ -170,6 +171,7 @@ public:
 	};
 
 	const char* getEffect() const { return m_Effect.c_str(); }
+	int getEffectID() const { return m_EffectID; }
 	int getTime() const
 	{
 		int Range = std::get<RANGE>(m_Time);
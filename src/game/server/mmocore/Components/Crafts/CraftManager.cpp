@@ -29,24 +29,23 @@ void CCraftManager::OnInit()
 	Job()->ShowLoadingProgress("Crafts", (int)CCraftItem::Data().size());
 }
 
-bool CCraftManager::OnHandleTile(CCharacter* pChr, int IndexCollision)
+void CCraftManager::OnRegisterTiles()
+{
+	Job()->RegisterTile(TILE_CRAFT_ZONE, this);
+}
+
+void CCraftManager::OnHandleTileEnter(CCharacter* pChr, int Tile)
 {
 	CPlayer* pPlayer = pChr->GetPlayer();
-	const int ClientID = pPlayer->GetCID();
+	_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
+}
 
-	if (pChr->GetHelper()->TileEnter(IndexCollision, TILE_CRAFT_ZONE))
-	{
-		_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
-	else if (pChr->GetHelper()->TileExit(IndexCollision, TILE_CRAFT_ZONE))
-	{
-		_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
-	return false;
+void CCraftManager::OnHandleTileExit(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
 }
 
 void CCraftManager::ShowCraftList(CPlayer* pPlayer, const char* TypeName, ItemType Type) const
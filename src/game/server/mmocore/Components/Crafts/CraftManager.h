@@ -14,7 +14,9 @@ class CCraftManager : public MmoComponent
 	};
 
 	void OnInit() override;
-	bool OnHandleTile(CCharacter* pChr, int IndexCollision) override;
+	void OnRegisterTiles() override;
+	void OnHandleTileEnter(CCharacter* pChr, int Tile) override;
+	void OnHandleTileExit(CCharacter* pChr, int Tile) override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
 	bool OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu) override;
 	CCraftItem* GetCraftByID(CraftIdentifier ID) const;
@@ -89,12 +89,11 @@ std::pair<int, int> CEidolonManager::GetEidolonsSize(int ClientID) const
 	int Collect = 0;
 	int Max = static_cast<int>(CEidolonInfoData::Data().size());
 
-	if(CPlayerItem::Data().find(ClientID) != CPlayerItem::Data().end())
+	if(CPlayerItem::Data().contains(ClientID))
 	{
-		for(auto& p : CPlayerItem::Data()[ClientID])
+		for(const auto* pItem : CPlayerItem::Data()[ClientID].GetSideIndex())
 		{
-			if(p.second.HasItem() && p.second.Info()->IsType(ItemType::TYPE_EQUIP) && p.second.Info()->IsFunctional(
-				EQUIP_EIDOLON))
+			if(pItem->HasItem() && pItem->Info()->IsType(ItemType::TYPE_EQUIP) && pItem->Info()->IsFunctional(EQUIP_EIDOLON))
 				Collect++;
 		}
 	}
@@ -91,6 +91,7 @@ bool GroupData::Remove(int AccountID)
 		if(pPlayer)
 		{
 			pPlayer->Account()->ReinitializeGroup();
+			CGS::InvalidateVotes(pPlayer->GetCID());
 		}
 
 		// If m_AccountIds is empty, disband the group
@@ -133,6 +134,7 @@ void GroupData::Disband()
 		{
 			// Reinitialize the player's group
 			pPlayer->Account()->ReinitializeGroup();
+			CGS::InvalidateVotes(pPlayer->GetCID());
 		}
 	}
 
@@ -195,4 +197,12 @@ void GroupData::Save() const
 	// Update the "AccountIDs" column in the TW_GROUPS_TABLE table of the database with the updated StrAccountIDs string
 	// for the group with the specified ID (m_ID)
 	Database->Execute<DB::UPDATE>(TW_GROUPS_TABLE, "AccountIDs = '%s', OwnerUID = '%d', Color = '%d' WHERE ID = '%d'", StrAccountIds.c_str(), m_OwnerUID, m_TeamColor, m_ID);
+
+	// Invalidate the cached vote menus of the online group members
+	CGS* pGS = (CGS*)Instance::GetServer()->GameServer();
+	for(const int& AID : m_AccountIds)
+	{
+		if(CPlayer* pPlayer = pGS->GetPlayerByUserID(AID))
+			CGS::InvalidateVotes(pPlayer->GetCID());
+	}
 }
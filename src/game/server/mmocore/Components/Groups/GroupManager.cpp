@@ -27,7 +27,7 @@ void CGroupManager::OnInit()
 // This code is a method within a class called CGroupManager
 // The purpose of this method is to initialize the group data for a player's account
 // The method takes a pointer to a CPlayer object as a parameter
-void CGroupManager::OnInitAccount(CPlayer* pPlayer)
+void CGroupManager::OnInitAccount(CPlayer* pPlayer, ResultPtr pRes)
 {
 	// Call the ReinitializeGroup() method of the player's account object 
 	// to initialize the group data for the account
@@ -61,6 +61,7 @@ GroupData* CGroupManager::CreateGroup(CPlayer* pPlayer) const
 
 	// Insert the new group into the database
 	Database->Execute<DB::INSERT>("tw_groups", "(ID, OwnerUID, Color, AccountIDs) VALUES ('%d', '%d', '%d', '%s')", InitID, OwnerUID, Color, StrAccountIDs.c_str());
+	CGS::InvalidateVotes(pPlayer->GetCID());
 
 	// Initialize the group data
 	GroupData(InitID).Init(OwnerUID, Color, StrAccountIDs);
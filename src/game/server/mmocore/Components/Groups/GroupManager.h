@@ -14,7 +14,7 @@ class CGroupManager : public MmoComponent
 	}
 
 	void OnInit() override;
-	void OnInitAccount(CPlayer* pPlayer) override;
+	void OnInitAccount(CPlayer* pPlayer, ResultPtr pRes) override;
 	void ShowGroupMenu(CPlayer* pPlayer);
 	bool OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu) override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, const int VoteID, const int VoteID2, int Get, const char* GetText) override;
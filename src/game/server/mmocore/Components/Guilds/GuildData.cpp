@@ -4,6 +4,7 @@
 
 #include <engine/shared/config.h>
 #include <game/server/gamecontext.h>
+#include <game/server/mmocore/Leaderboard.h>
 
 CGS* CGuildData::GS() const { return (CGS*)Instance::GetServer()->GameServer(m_pHouse != nullptr ? m_pHouse->GetWorldID() : MAIN_WORLD_ID); }
 
@@ -31,6 +32,7 @@ bool CGuildData::Upgrade(int Type)
 		// Increase the value of the upgrade by 1
 		pUpgradeData->m_Value += 1;
 		Database->Execute<DB::UPDATE>(TW_GUILDS_TABLE, "%s = '%d' WHERE ID = '%d'", pUpgradeData->getFieldName(), pUpgradeData->m_Value, m_ID);
+		m_pMembers->InvalidateVotes();
 
 		// Add and send a history entry for the upgrade
 		m_pLogger->Add(LOGFLAG_UPGRADES_CHANGES, "'%s' upgraded to %d level", pUpgradeData->getDescription(), pUpgradeData->m_Value);
@@ -72,6 +74,7 @@ void CGuildData::AddExperience(int Experience)
 	if(rand() % 10 == 2 || UpdateTable)
 	{
 		Database->Execute<DB::UPDATE>("tw_guilds", "Level = '%d', Experience = '%d' WHERE ID = '%d'", m_Level, m_Experience, m_ID);
+		CLeaderboard::Update(ToplistType::GUILDS_LEVELING, m_ID, GetName(), m_Level, m_Experience);
 	}
 }
 
@@ -92,6 +95,7 @@ GUILD_RESULT CGuildData::SetNewLeader(int AccountID)
 	// Update data
 	m_LeaderUID = AccountID;
 	Database->Execute<DB::UPDATE>(TW_GUILDS_TABLE, "LeaderUID = '%d' WHERE ID = '%d'", m_LeaderUID, m_ID);
+	m_pMembers->InvalidateVotes();
 
 	// Get the nickname of the new guild leader
 	const char* pNickNewLeader = Instance::GetServer()->GetAccountNickname(m_LeaderUID);
@@ -146,6 +150,7 @@ GUILD_RESULT CGuildData::BuyHouse(int HouseID)
 
 		// Update the GuildID of the house in the database
 		Database->Execute<DB::UPDATE>(TW_GUILDS_HOUSES, "GuildID = '%d' WHERE ID = '%d'", m_ID, HouseID);
+		m_pMembers->InvalidateVotes();
 		return GUILD_RESULT::SUCCESSFUL; // Return success code
 	}
 
@@ -167,6 +172,7 @@ bool CGuildData::SellHouse()
 
 		// Update the database to remove the guild ID from the guild house
 		Database->Execute<DB::UPDATE>(TW_GUILDS_HOUSES, "GuildID = NULL WHERE ID = '%d'", m_pHouse->GetID());
+		m_pMembers->InvalidateVotes();
 
 		// Reset house pointers
 		m_pHouse->GetDoors()->CloseAll();
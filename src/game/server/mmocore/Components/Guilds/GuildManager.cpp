@@ -67,48 +67,23 @@ void CGuildManager::OnTick()
 	}
 }
 
-bool CGuildManager::OnHandleTile(CCharacter* pChr, int IndexCollision)
+void CGuildManager::OnRegisterTiles()
 {
-	CPlayer* pPlayer = pChr->GetPlayer();
-	const int ClientID = pPlayer->GetCID();
-
-	if(pChr->GetHelper()->TileEnter(IndexCollision, TILE_GUILD_HOUSE))
-	{
-		_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, MENU_MAIN);
-		return true;
-	}
-	if(pChr->GetHelper()->TileExit(IndexCollision, TILE_GUILD_HOUSE))
-	{
-		_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, MENU_MAIN);
-		return true;
-	}
-
-	if(pChr->GetHelper()->TileEnter(IndexCollision, TILE_GUILD_CHAIR))
-	{
-		return true;
-	}
-	else if(pChr->GetHelper()->TileExit(IndexCollision, TILE_GUILD_CHAIR))
-	{
-		return true;
-	}
-	if(pChr->GetHelper()->BoolIndex(TILE_GUILD_CHAIR))
-	{
-		if(Server()->Tick() % (Server()->TickSpeed() * 5) == 0)
-		{
-			//const int HouseID = GetPosHouseID(pChr->m_Core.m_Pos);
-			//const int GuildID = GetHouseGuildID(HouseID);
-			//if(HouseID <= 0 || GuildID <= 0)
-			//	return true;
+	Job()->RegisterTile(TILE_GUILD_HOUSE, this);
+}
 
-			//const int Exp = CGuildData::ms_aGuild[GuildID].m_UpgradesData(CGuildData::CHAIR_EXPERIENCE, 0).m_Value;
-			//pPlayer->Account()->AddExperience(Exp);
-		}
-		return true;
-	}
+void CGuildManager::OnHandleTileEnter(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), MENU_MAIN);
+}
 
-	return false;
+void CGuildManager::OnHandleTileExit(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), MENU_MAIN);
 }
 
 bool CGuildManager::OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText)
@@ -886,6 +861,7 @@ void CGuildManager::Create(CPlayer* pPlayer, const char* pGuildName) const
 	// we create a guild in the table
 	Database->Execute<DB::INSERT>(TW_GUILDS_TABLE, "(ID, Name, LeaderUID, Members) VALUES ('%d', '%s', '%d', '%s')",
 		InitID, GuildName.cstr(), pPlayer->Account()->GetID(), MembersData.c_str());
+	CGS::InvalidateVotes(ClientID);
 	GS()->Chat(-1, "New guilds [{STR}] have been created!", GuildName.cstr());
 	GS()->StrongUpdateVotes(ClientID, MENU_MAIN);
 }
@@ -916,6 +892,7 @@ void CGuildManager::Disband(GuildIdentifier ID) const
 	Database->Execute<DB::REMOVE>(TW_GUILDS_HISTORY_TABLE, "WHERE GuildID = '%d'", pGuild->GetID());
 	Database->Execute<DB::REMOVE>(TW_GUILDS_RANKS_TABLE, "WHERE GuildID = '%d'", pGuild->GetID());
 	Database->Execute<DB::REMOVE>(TW_GUILDS_TABLE, "WHERE ID = '%d'", pGuild->GetID());
+	pGuild->GetMembers()->InvalidateVotes();
 
 	// Delete the guild object and remove it from the guild data container
 	if(pIterGuild != CGuildData::Data().end())
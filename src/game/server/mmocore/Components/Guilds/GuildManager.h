@@ -24,7 +24,9 @@ class CGuildManager : public MmoComponent
 	void OnInit() override;
 	void OnInitWorld(const char* pWhereLocalWorld) override;
 	void OnTick() override;
-	bool OnHandleTile(CCharacter* pChr, int IndexCollision) override;
+	void OnRegisterTiles() override;
+	void OnHandleTileEnter(CCharacter* pChr, int Tile) override;
+	void OnHandleTileExit(CCharacter* pChr, int Tile) override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
 	bool OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu) override;
 
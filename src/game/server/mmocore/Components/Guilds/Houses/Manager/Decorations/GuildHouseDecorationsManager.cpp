@@ -4,7 +4,7 @@
 #include <game/server/gamecontext.h>
 
 #include "game/server/mmocore/GameEntities/decoration_houses.h"
-#include <game/server/mmocore/Components/Guilds/Houses/GuildHouseData.h>
+#include <game/server/mmocore/Components/Guilds/GuildData.h>
 
 CGS* CGuildHouseDecorationManager::GS() const { return m_pHouse->GS(); }
 
@@ -104,6 +104,8 @@ bool CGuildHouseDecorationManager::Add(CEntityHouseDecoration* pEntity)
 		const int InitID = pRes2->next() ? pRes2->getInt("ID") + 1 : 1;
 		Database->Execute<DB::INSERT>(TW_GUILD_HOUSES_DECORATION_TABLE, "(ID, ItemID, HouseID, PosX, PosY, WorldID) VALUES ('%d', '%d', '%d', '%d', '%d', '%d')",
 			InitID, ItemID, m_pHouse->GetID(), (int)EntityPos.x, (int)EntityPos.y, GS()->GetWorldID());
+		if(CGuildData* pGuild = m_pHouse->GetGuild())
+			pGuild->GetMembers()->InvalidateVotes();
 
 		// Create new decoration on gameworld
 		pEntity->SetUniqueID(InitID);
@@ -142,6 +144,8 @@ bool CGuildHouseDecorationManager::Remove(CEntityHouseDecoration* pEntity)
 
 		// Remove the decoration from the database
 		Database->Execute<DB::REMOVE>(TW_GUILD_HOUSES_DECORATION_TABLE, "WHERE ID = '%d'", UniqueID);
+		if(CGuildData* pGuild = m_pHouse->GetGuild())
+			pGuild->GetMembers()->InvalidateVotes();
 		return true;
 	}
 
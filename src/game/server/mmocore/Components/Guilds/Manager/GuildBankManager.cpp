@@ -3,6 +3,7 @@
 #include "GuildBankManager.h"
 
 #include <game/server/gamecontext.h>
+#include <game/server/mmocore/Leaderboard.h>
 #include "../GuildData.h"
 
 CGS* CGuildBankManager::GS() const { return m_pGuild->GS(); }
@@ -12,6 +13,8 @@ void CGuildBankManager::Set(int Value)
 {
 	m_Bank = Value;
 	Database->Execute<DB::UPDATE>(TW_GUILDS_TABLE, "Bank = '%d' WHERE ID = '%d'", m_Bank, m_pGuild->GetID());
+	m_pGuild->GetMembers()->InvalidateVotes();
+	CLeaderboard::Update(ToplistType::GUILDS_WEALTHY, m_pGuild->GetID(), m_pGuild->GetName(), m_Bank);
 }
 
 // Spend the given Value from the guild's bank
@@ -27,6 +30,8 @@ bool CGuildBankManager::Spend(int Value)
 			// Update the bank value and update the database
 			m_Bank = Bank - Value;
 			Database->Execute<DB::UPDATE>(TW_GUILDS_TABLE, "Bank = '%d' WHERE ID = '%d'", m_Bank, m_pGuild->GetID());
+			m_pGuild->GetMembers()->InvalidateVotes();
+			CLeaderboard::Update(ToplistType::GUILDS_WEALTHY, m_pGuild->GetID(), m_pGuild->GetName(), m_Bank);
 			return true;
 		}
 	}
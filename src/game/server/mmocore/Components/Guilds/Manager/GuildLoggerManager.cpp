@@ -23,6 +23,7 @@ void CGuildLoggerManager::SetActivityFlag(int64_t Flag)
 
 	// Update the log flag in the database for the guild
 	Database->Execute<DB::UPDATE>(TW_GUILDS_TABLE, "LogFlag = '%d' WHERE ID = '%d'", m_Logflag, m_pGuild->GetID());
+	m_pGuild->GetMembers()->InvalidateVotes();
 }
 
 // Check if the given flag is set in the log flag
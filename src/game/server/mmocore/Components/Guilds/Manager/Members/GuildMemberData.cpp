@@ -82,6 +82,7 @@ bool CGuildMemberData::DepositInBank(int Golds)
 			m_Deposit += Golds;
 			m_pGuild->GetBank()->Set(pRes->getInt("Bank") + Golds);
 			Database->Execute<DB::UPDATE>(TW_GUILDS_TABLE, "Bank = '%d' WHERE ID = '%d'", m_pGuild->GetBank()->Get(), m_pGuild->GetID());
+			m_pGuild->GetMembers()->InvalidateVotes();
 
 			// Send a chat message to the player indicating the successful deposit and the new bank value
 			const char* pNickname = Instance::GetServer()->GetAccountNickname(m_AccountID);
@@ -86,6 +86,7 @@ GUILD_MEMBER_RESULT CGuildMembersManager::Kick(int AccountID)
 		if(CPlayer* pPlayer = GS()->GetPlayerByUserID(AccountID))
 		{
 			pPlayer->Account()->ReinitializeGuild();
+			CGS::InvalidateVotes(pPlayer->GetCID());
 			GS()->UpdateVotes(pPlayer->GetCID(), MENU_MAIN);
 		}
 
@@ -157,6 +158,17 @@ void CGuildMembersManager::Save() const
 	// Update the guild data in the database
 	Database->Execute<DB::UPDATE, 300>(TW_GUILDS_TABLE, "DefaultRankID = '%d', Members = '%s' WHERE ID = '%d'",
 		m_pGuild->GetRanks()->GetDefaultRank()->GetID(), MembersData.dump().c_str(), m_pGuild->GetID());
+	InvalidateVotes();
+}
+
+// Invalidate the cached vote menus of the online guild members
+void CGuildMembersManager::InvalidateVotes() const
+{
+	for(const auto& [AccountID, pMember] : m_apMembers)
+	{
+		if(CPlayer* pPlayer = GS()->GetPlayerByUserID(AccountID))
+			CGS::InvalidateVotes(pPlayer->GetCID());
+	}
 }
 
 // Get a member by account ID
@@ -57,6 +57,9 @@ public:
 	// Save the guild members data
 	void Save() const;
 
+	// Invalidate the cached vote menus of the online guild members
+	void InvalidateVotes() const;
+
 private:
 	// Initialize the guild members controller
 	void Init(std::string&& MembersData);
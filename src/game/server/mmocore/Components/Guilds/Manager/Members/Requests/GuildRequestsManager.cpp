@@ -58,6 +58,9 @@ GUILD_MEMBER_RESULT CGuildRequestsManager::Request(int FromUID)
 
 	// Insert the invite into the database
 	Database->Execute<DB::INSERT>(TW_GUILDS_INVITES_TABLE, "(GuildID, UserID) VALUES ('%d', '%d')", m_pGuild->GetID(), FromUID);
+	m_pGuild->GetMembers()->InvalidateVotes();
+	if(CPlayer* pPlayer = GS()->GetPlayerByUserID(FromUID))
+		CGS::InvalidateVotes(pPlayer->GetCID());
 	return GUILD_MEMBER_RESULT::SUCCESSFUL;
 }
 
@@ -77,6 +80,7 @@ GUILD_MEMBER_RESULT CGuildRequestsManager::Accept(int UserID, const CGuildMember
 
 	// Remove the request from the database and delete it from memory
 	Database->Execute<DB::REMOVE>(TW_GUILDS_INVITES_TABLE, "WHERE GuildID = '%d' AND UserID = '%d'", m_pGuild->GetID(), (*Iter)->GetFromUID());
+	m_pGuild->GetMembers()->InvalidateVotes();
 	delete (*Iter);
 	m_aRequestsJoin.erase(Iter);
 
@@ -107,6 +111,9 @@ void CGuildRequestsManager::Deny(int UserID, const CGuildMemberData* pFromMember
 
 	// Remove the request from the database
 	Database->Execute<DB::REMOVE>(TW_GUILDS_INVITES_TABLE, "WHERE GuildID = '%d' AND UserID = '%d'", m_pGuild->GetID(), (*Iter)->GetFromUID());
+	m_pGuild->GetMembers()->InvalidateVotes();
+	if(CPlayer* pPlayer = GS()->GetPlayerByUserID(UserID))
+		CGS::InvalidateVotes(pPlayer->GetCID());
 
 	// If the request was found
 	if(Iter != m_aRequestsJoin.end())
@@ -39,6 +39,7 @@ GUILD_RANK_RESULT CGuildRankData::Rename(std::string NewRank)
 	// Update the name of the guild rank
 	m_pGuild->GetLogger()->Add(LOGFLAG_RANKS_CHANGES, "renamed rank '%s' to '%s'", m_Rank.c_str(), cstrNewRank.cstr());
 	Database->Execute<DB::UPDATE>(TW_GUILDS_RANKS_TABLE, "Name = '%s' WHERE ID = '%d'", cstrNewRank.cstr(), m_ID);
+	m_pGuild->GetMembers()->InvalidateVotes();
 	m_Rank = cstrNewRank.cstr();
 	return GUILD_RANK_RESULT::SUCCESSFUL;
 }
@@ -61,6 +62,7 @@ void CGuildRankData::SetAccess(GuildRankAccess Access)
 	// Save the updated access level in the database
 	GuildIdentifier GuildID = m_pGuild->GetID();
 	Database->Execute<DB::UPDATE>(TW_GUILDS_RANKS_TABLE, "Access = '%d' WHERE ID = '%d'", m_Access, m_ID);
+	m_pGuild->GetMembers()->InvalidateVotes();
 
 	// Send a chat message to the guild with the updated access level
 	GS()->ChatGuild(GuildID, "Rank '{STR}' new rights '{STR}'!", m_Rank.c_str(), GetAccessName());
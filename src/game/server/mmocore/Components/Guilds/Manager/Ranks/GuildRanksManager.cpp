@@ -121,6 +121,7 @@ GUILD_RANK_RESULT CGuildRanksManager::Add(const std::string& Rank)
 	// Insert the new rank into the database
 	GuildIdentifier GuildID = m_pGuild->GetID();
 	Database->Execute<DB::INSERT>("tw_guilds_ranks", "(ID, Access, GuildID, Name) VALUES ('%d', '%d', '%d', '%s')", InitID, (int)RIGHTS_DEFAULT, GuildID, cstrRank.cstr());
+	m_pGuild->GetMembers()->InvalidateVotes();
 	m_aRanks.emplace_back(new CGuildRankData(InitID, cstrRank.cstr(), RIGHTS_DEFAULT, m_pGuild));
 
 	// Send information to the game server and update the guild history
@@ -165,6 +166,7 @@ GUILD_RANK_RESULT CGuildRanksManager::Remove(const std::string& Rank)
 
 	// Remove the rank from the database and delete the rank data object
 	Database->Execute<DB::REMOVE>("tw_guilds_ranks", "WHERE ID = '%d'", (*Iter)->GetID());
+	m_pGuild->GetMembers()->InvalidateVotes();
 	delete (*Iter);
 	m_aRanks.erase(Iter);
 
@@ -32,6 +32,7 @@ void CHouseBankData::Add(int Value)
 			// Update the value of the HouseBank column in the TW_HOUSES_TABLE by adding the specified value to the current value
 			m_Bank = pRes->getInt("HouseBank") + Value;
 			Database->Execute<DB::UPDATE>(TW_HOUSES_TABLE, "HouseBank = '%d' WHERE ID = '%d'", m_Bank, HouseID);
+			CGS::InvalidateVotes(pPlayer->GetCID());
 
 			// Send a chat message to the player indicating the amount of gold they have put in the safe
 			int ClientID = pPlayer->GetCID();
@@ -73,6 +74,7 @@ void CHouseBankData::Take(int Value)
 
 			// Execute an UPDATE query on the database to update the HouseBank column of the TW_HOUSES_TABLE table where the ID matches HouseID
 			Database->Execute<DB::UPDATE>(TW_HOUSES_TABLE, "HouseBank = '%d' WHERE ID = '%d'", m_Bank, HouseID);
+			CGS::InvalidateVotes(pPlayer->GetCID());
 
 			// Send a message to the client with the updated information
 			m_pGS->Chat(ClientID, "You take {VAL} gold in the safe {VAL}!", Value, m_Bank);
@@ -71,6 +71,7 @@ bool CHouseData::AddDecoration(CEntityHouseDecoration* pEntity)
 			ResultPtr pRes2 = Database->Execute<DB::SELECT>("ID", TW_HOUSES_DECORATION_TABLE, "ORDER BY ID DESC LIMIT 1");
 			const int InitID = pRes2->next() ? pRes2->getInt("ID") + 1 : 1;
 			Database->Execute<DB::INSERT>(TW_HOUSES_DECORATION_TABLE, "(ID, ItemID, HouseID, PosX, PosY, WorldID) VALUES ('%d', '%d', '%d', '%d', '%d', '%d')", InitID, ItemID, m_ID, (int)EntityPos.x, (int)EntityPos.y, GS()->GetWorldID());
+			CGS::InvalidateVotes(GetPlayer()->GetCID());
 
 			// Create new decoration on gameworld
 			pEntity->SetUniqueID(InitID);
@@ -97,6 +98,8 @@ bool CHouseData::RemoveDecoration(HouseDecorationIdentifier DecoID)
 
 			// Remove from database
 			Database->Execute<DB::REMOVE>(TW_HOUSES_DECORATION_TABLE, "WHERE ID = '%d'", DecoID);
+			if(CPlayer* pPlayer = GetPlayer())
+				CGS::InvalidateVotes(pPlayer->GetCID());
 			return true;
 		}
 	}
@@ -132,6 +135,7 @@ void CHouseData::Buy(CPlayer* pPlayer)
 		m_pBank->Reset();
 		pPlayer->Account()->ReinitializeHouse();
 		Database->Execute<DB::UPDATE>(TW_HOUSES_TABLE, "UserID = '%d', HouseBank = '0', AccessData = NULL WHERE ID = '%d'", m_AccountID, m_ID);
+		CGS::InvalidateVotes(pPlayer->GetCID());
 
 		// send information
 		GS()->Chat(-1, "{STR} becomes the owner of the house class {STR}", Server()->ClientName(ClientID), GetClassName());
@@ -161,6 +165,7 @@ void CHouseData::Sell()
 	if(pPlayer)
 	{
 		pPlayer->Account()->ReinitializeHouse();
+		CGS::InvalidateVotes(pPlayer->GetCID());
 	}
 	Database->Execute<DB::UPDATE>(TW_HOUSES_TABLE, "UserID = NULL, HouseBank = '0', AccessData = NULL WHERE ID = '%d'", m_ID);
 
@@ -197,6 +202,8 @@ void CHouseData::SetPlantItemID(ItemIdentifier ItemID)
 	{
 		m_PlantedItem.SetID(ItemID);
 		Database->Execute<DB::UPDATE>(TW_HOUSES_TABLE, "PlantID = '%d' WHERE ID = '%d'", ItemID, m_ID);
+		if(CPlayer* pPlayer = GetPlayer())
+			CGS::InvalidateVotes(pPlayer->GetCID());
 	}
 }
 
@@ -181,4 +181,6 @@ void CHouseDoorsController::SaveAccessList() const
 
 	// Execute an update query on the Database object
 	Database->Execute<DB::UPDATE>(TW_HOUSES_TABLE, "AccessData = '%s' WHERE ID = '%d'", AccessData.c_str(), m_pHouse->GetID());
+	if(CPlayer* pPlayer = m_pGS->GetPlayerByUserID(m_pHouse->GetAccountID()))
+		CGS::InvalidateVotes(pPlayer->GetCID());
 }
\ No newline at end of file
@@ -52,25 +52,23 @@ void CHouseManager::OnTick()
 	}
 }
 
-bool CHouseManager::OnHandleTile(CCharacter* pChr, int IndexCollision)
+void CHouseManager::OnRegisterTiles()
 {
-	CPlayer* pPlayer = pChr->GetPlayer();
-	const int ClientID = pPlayer->GetCID();
+	Job()->RegisterTile(TILE_PLAYER_HOUSE, this);
+}
 
-	if(pChr->GetHelper()->TileEnter(IndexCollision, TILE_PLAYER_HOUSE))
-	{
-		_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
-	if(pChr->GetHelper()->TileExit(IndexCollision, TILE_PLAYER_HOUSE))
-	{
-		_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
+void CHouseManager::OnHandleTileEnter(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
+}
 
-	return false;
+void CHouseManager::OnHandleTileExit(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
 }
 
 bool CHouseManager::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu)
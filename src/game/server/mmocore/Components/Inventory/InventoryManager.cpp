@@ -2,6 +2,7 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include "InventoryManager.h"
 
+#include <engine/shared/config.h>
 #include <engine/shared/datafile.h>
 #include <game/server/gamecontext.h>
 
@@ -9,10 +10,10 @@
 #include <game/server/mmocore/Components/Quests/QuestManager.h>
 
 template < typename T >
-bool ExecuteTemplateItemsTypes(T Type, std::map < int, CPlayerItem >& paItems, const std::function<void(const CPlayerItem&)> pFunc)
+bool ExecuteTemplateItemsTypes(T Type, const CPlayerItemsTable& paItems, const std::function<void(const CPlayerItem&)> pFunc)
 {
 	bool Found = false;
-	for(const auto& [ItemID, ItemData] : paItems)
+	for(const auto& ItemData : paItems)
 	{
 		bool ActivateCallback = false;
 		if constexpr(std::is_same_v<T, ItemType>)
@@ -32,6 +33,18 @@ bool ExecuteTemplateItemsTypes(T Type, std::map < int, CPlayerItem >& paItems, c
 using namespace sqlstr;
 void CInventoryManager::OnInit()
 {
+	// the batched item upserts need the (UserID, ItemID) key, databases created before it may hold duplicates
+	ResultPtr pResKey = Database->Execute<DB::SELECT>("COUNT(*) AS Num", "information_schema.STATISTICS",
+		"WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'tw_accounts_items' AND INDEX_NAME = 'UserItem'");
+	if(pResKey && pResKey->next() && pResKey->getInt("Num") == 0)
+	{
+		// the newest row of a pair is the one the inventory loaded last
+		dbg_msg("inventory", "adding the UserItem key to tw_accounts_items");
+		Database->Prepare<DB::OTHER>("DELETE a FROM tw_accounts_items a JOIN tw_accounts_items b ON a.UserID = b.UserID AND a.ItemID = b.ItemID AND a.ID < b.ID")->ExecuteBlocking();
+		if(!Database->Prepare<DB::OTHER>("ALTER TABLE tw_accounts_items ADD UNIQUE KEY UserItem (UserID, ItemID)")->ExecuteBlocking())
+			dbg_assert(false, "tw_accounts_items needs a unique (UserID, ItemID) key");
+	}
+
 	const auto InitItemsList = Database->Prepare<DB::SELECT>("*", "tw_items_list");
 	InitItemsList->AtExecute([](ResultPtr pRes)
 	{
@@ -81,10 +94,14 @@ void CInventoryManager::OnInit()
 	});
 }
 
-void CInventoryManager::OnInitAccount(CPlayer* pPlayer)
+std::string CInventoryManager::OnAccountQuery(int AccountID) const
+{
+	return Database->Prepare<DB::SELECT>("*", "tw_accounts_items", "WHERE UserID = '%d'", AccountID)->GetQueryString();
+}
+
+void CInventoryManager::OnInitAccount(CPlayer* pPlayer, ResultPtr pRes)
 {
 	const int ClientID = pPlayer->GetCID();
-	ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_accounts_items", "WHERE UserID = '%d'", pPlayer->Account()->GetID());
 	while(pRes->next())
 	{
 		ItemIdentifier ItemID = pRes->getInt("ItemID");
@@ -95,10 +112,36 @@ void CInventoryManager::OnInitAccount(CPlayer* pPlayer)
 
 		CPlayerItem(ItemID, ClientID).Init(Value, Enchant, Durability, Settings);
 	}
+	pPlayer->MarkAttributesDirty();
+}
+
+void CInventoryManager::OnTick()
+{
+	if(m_vSleepItems.empty())
+		return;
+
+	// the items are changed from the tick only, never from a worker
+	const int64_t Tick = Server()->Tick();
+	auto Due = std::stable_partition(m_vSleepItems.begin(), m_vSleepItems.end(), [Tick](const CSleepItem& Item) { return Item.m_Tick > Tick; });
+	std::vector<CSleepItem> vDue(std::make_move_iterator(Due), std::make_move_iterator(m_vSleepItems.end()));
+	m_vSleepItems.erase(Due, m_vSleepItems.end());
+
+	for(const auto& Item : vDue)
+	{
+		if(CPlayer* pPlayer = GS()->GetPlayerByUserID(Item.m_AccountID))
+		{
+			pPlayer->GetItem(Item.m_ItemID)->Add(Item.m_Value);
+			continue;
+		}
+
+		// ordered behind the absolute values the logout flush writes, so the increment is never overwritten
+		Database->ExecuteOrdered<DB::INSERT>("tw_accounts_items", "(ItemID, UserID, Value, Settings, Enchant) VALUES ('%d', '%d', '%d', '0', '0') ON DUPLICATE KEY UPDATE Value = Value + VALUES(Value)", Item.m_ItemID, Item.m_AccountID, Item.m_Value);
+	}
 }
 
 void CInventoryManager::OnResetClient(int ClientID)
 {
+	CPlayerItem::FlushDirty(ClientID);
 	CPlayerItem::Data().erase(ClientID);
 }
 
@@ -276,7 +319,7 @@ void CInventoryManager::RepairDurabilityItems(CPlayer* pPlayer)
 {
 	const int ClientID = pPlayer->GetCID();
 	Database->Execute<DB::UPDATE>("tw_accounts_items", "Durability = '100' WHERE UserID = '%d'", pPlayer->Account()->GetID());
-	for(auto& [ID, Item] : CPlayerItem::Data()[ClientID])
+	for(auto& Item : CPlayerItem::Data()[ClientID])
 		Item.m_Durability = 100;
 }
 
@@ -440,41 +483,17 @@ void CInventoryManager::ItemSelected(CPlayer* pPlayer, const CPlayerItem& pItemP
 
 int CInventoryManager::GetCountItemsType(CPlayer* pPlayer, ItemType Type) const
 {
-	const int ClientID = pPlayer->GetCID();
-	return (int)std::count_if(CPlayerItem::Data()[ClientID].begin(), CPlayerItem::Data()[ClientID].end(), [Type](auto& pItem)
+	int Count = 0;
+	for(const auto& Item : CPlayerItem::Data()[pPlayer->GetCID()])
 	{
-		return pItem.second.HasItem() && pItem.second.Info()->IsType(Type);
-	});
+		if(Item.HasItem() && Item.Info()->IsType(Type))
+			Count++;
+	}
+	return Count;
 }
 
-// TODO: FIX IT (lock .. unlock)
-std::mutex lock_sleep;
 void CInventoryManager::AddItemSleep(int AccountID, ItemIdentifier ItemID, int Value, int Milliseconds)
 {
-	std::thread Thread([this, AccountID, ItemID, Value, Milliseconds]()
-	{
-		if(Milliseconds > 0)
-			std::this_thread::sleep_for(std::chrono::milliseconds(Milliseconds));
-
-		lock_sleep.lock();
-		CPlayer* pPlayer = GS()->GetPlayerByUserID(AccountID);
-		if(pPlayer)
-		{
-			pPlayer->GetItem(ItemID)->Add(Value);
-			lock_sleep.unlock();
-			return;
-		}
-
-		ResultPtr pRes = Database->Execute<DB::SELECT>("Value", "tw_accounts_items", "WHERE ItemID = '%d' AND UserID = '%d'", ItemID, AccountID);
-		if(pRes->next())
-		{
-			const int ReallyValue = pRes->getInt("Value") + Value;
-			Database->Execute<DB::UPDATE>("tw_accounts_items", "Value = '%d' WHERE UserID = '%d' AND ItemID = '%d'", ReallyValue, AccountID, ItemID);
-			lock_sleep.unlock();
-			return;
-		}
-		Database->Execute<DB::INSERT>("tw_accounts_items", "(ItemID, UserID, Value, Settings, Enchant) VALUES ('%d', '%d', '%d', '0', '0')", ItemID, AccountID, Value);
-		lock_sleep.unlock();
-	});
-	Thread.detach();
+	const int64_t Tick = Server()->Tick() + maximum(0, Milliseconds) * Server()->TickSpeed() / 1000;
+	m_vSleepItems.push_back({ Tick, AccountID, ItemID, Value });
 }
\ No newline at end of file
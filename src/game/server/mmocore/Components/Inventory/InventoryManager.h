@@ -10,13 +10,26 @@ class CInventoryManager : public MmoComponent
 {
 	~CInventoryManager() override
 	{
+		CPlayerItem::FlushDirty();
 		CAttributeDescription::Data().clear();
 		CItemDescription::Data().clear();
 		CPlayerItem::Data().clear();
 	}
 
+	// items given with a delay, applied by the tick of this world
+	struct CSleepItem
+	{
+		int64_t m_Tick;
+		int m_AccountID;
+		ItemIdentifier m_ItemID;
+		int m_Value;
+	};
+	std::vector<CSleepItem> m_vSleepItems {};
+
 	void OnInit() override;
-	void OnInitAccount(class CPlayer* pPlayer) override;
+	void OnTick() override;
+	std::string OnAccountQuery(int AccountID) const override;
+	void OnInitAccount(class CPlayer* pPlayer, ResultPtr pRes) override;
 	void OnResetClient(int ClientID) override;
 	bool OnHandleVoteCommands(class CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
 	bool OnHandleMenulist(class CPlayer* pPlayer, int Menulist, bool ReplaceMenu) override;
@@ -2,10 +2,18 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include "ItemData.h"
 
+#include <engine/shared/config.h>
 #include <game/server/gamecontext.h>
+#include <game/server/mmocore/Leaderboard.h>
 
 #include "game/server/mmocore/Components/Eidolons/EidolonManager.h"
 
+bool CEquippableItem::Check(const CPlayerItem& Item)
+{
+	return Item.Info()->IsType(ItemType::TYPE_POTION) || Item.Info()->IsType(ItemType::TYPE_SETTINGS)
+		|| Item.Info()->IsType(ItemType::TYPE_MODULE) || Item.Info()->IsType(ItemType::TYPE_EQUIP);
+}
+
 CGS* CPlayerItem::GS() const
 {
 	return (CGS*)Server()->GameServerPlayer(m_ClientID);
@@ -88,6 +96,7 @@ bool CPlayerItem::Add(int Value, int StartSettings, int StartEnchant, bool Messa
 	{
 		m_Enchant = StartEnchant;
 		m_Settings = StartSettings;
+		m_Durability = 100;
 	}
 	m_Value += Value;
 
@@ -139,6 +148,7 @@ bool CPlayerItem::Equip(bool SaveItem)
 		return false;
 
 	m_Settings ^= true;
+	GetPlayer()->MarkAttributesDirty();
 
 	if(Info()->IsType(ItemType::TYPE_EQUIP))
 	{
@@ -170,7 +180,7 @@ bool CPlayerItem::Use(int Value)
 	// potion mana regen
 	if(m_ID == itPotionManaRegen && Remove(Value))
 	{
-		GetPlayer()->GiveEffect("RegenMana", 15);
+		GetPlayer()->GiveEffect(CEffects::REGEN_MANA, 15);
 		GS()->Chat(ClientID, "You used {STR}x{VAL}", Info()->GetName(), Value);
 		return true;
 	}
@@ -259,7 +269,7 @@ bool CPlayerItem::Use(int Value)
 		if(Remove(Value))
 		{
 			int PotionTime = pHeal->getTime();
-			GetPlayer()->GiveEffect(pHeal->getEffect(), PotionTime);
+			GetPlayer()->GiveEffect(pHeal->getEffectID(), PotionTime);
 			GetPlayer()->m_aPlayerTick[PotionRecast] = Server()->Tick() + ((PotionTime + POTION_RECAST_APPEND_TIME) * Server()->TickSpeed());
 
 			GS()->Chat(ClientID, "You used {STR}x{VAL}", Info()->GetName(), Value);
@@ -303,38 +313,92 @@ bool CPlayerItem::Save()
 {
 	if(GetPlayer() && GetPlayer()->IsAuthed())
 	{
-		int UserID = GetPlayer()->Account()->GetID();
-		const auto pResCheck = Database->Prepare<DB::SELECT>("ItemID, UserID", "tw_accounts_items", "WHERE ItemID = '%d' AND UserID = '%d'", m_ID, UserID);
-		pResCheck->AtExecute([this, UserID](ResultPtr pRes)
+		// only mark the item as dirty, the latest state is written by the next batch
+		const int UserID = GetPlayer()->Account()->GetID();
 		{
-			// check database value
-			if(pRes->next())
-			{
-				// remove item
-				if(!m_Value)
-				{
-					Database->Execute<DB::REMOVE>("tw_accounts_items", "WHERE ItemID = '%d' AND UserID = '%d'", m_ID, UserID);
-					return;
-				}
-
-				// update an item
-				Database->Execute<DB::UPDATE>("tw_accounts_items", "Value = '%d', Settings = '%d', Enchant = '%d', Durability = '%d' WHERE UserID = '%d' AND ItemID = '%d'",
-					m_Value, m_Settings, m_Enchant, m_Durability, GetPlayer()->Account()->GetID(), m_ID);
-				return;
-			}
+			std::lock_guard Lock(ms_DirtyMutex);
+			ms_aDirty[{ UserID, m_ID }] = { m_ClientID, m_Value, m_Settings, m_Enchant, m_Durability };
+		}
+		CGS::InvalidateVotes(m_ClientID);
+		GetPlayer()->MarkAttributesDirty();
 
-			// insert item
-			if(m_Value)
-			{
-				m_Durability = 100;
-				Database->Execute<DB::INSERT>("tw_accounts_items", "(ItemID, UserID, Value, Settings, Enchant) VALUES ('%d', '%d', '%d', '%d', '%d')", m_ID, UserID, m_Value, m_Settings, m_Enchant);
-			}
-		});
+		if(m_ID == itGold)
+			CLeaderboard::Update(ToplistType::PLAYERS_WEALTHY, UserID, Server()->ClientName(m_ClientID), m_Value);
 		return true;
 	}
 	return false;
 }
 
+int CPlayerItem::GetDirtySize()
+{
+	std::lock_guard Lock(ms_DirtyMutex);
+	return (int)ms_aDirty.size();
+}
+
+void CPlayerItem::FlushDirty(int ClientID)
+{
+	// collect the dirty items, -1 flushes all players
+	std::vector<std::pair<std::pair<int, int>, CDirtyItem>> aItems;
+	{
+		std::lock_guard Lock(ms_DirtyMutex);
+		for(auto Iter = ms_aDirty.begin(); Iter != ms_aDirty.end();)
+		{
+			if(ClientID != -1 && Iter->second.m_ClientID != ClientID)
+			{
+				++Iter;
+				continue;
+			}
+
+			aItems.emplace_back(Iter->first, Iter->second);
+			Iter = ms_aDirty.erase(Iter);
+		}
+	}
+
+	// one upsert per batch, removed items are stored with zero value and deleted after the upsert
+	// batches go through the ordered queue, so an older state of an item never lands after a newer one
+	std::string Values;
+	std::string Removed;
+	int BatchSize = 0;
+	auto SendBatch = [&Values, &Removed, &BatchSize]()
+	{
+		if(Values.empty())
+			return;
+
+		ms_FlushedItems += BatchSize;
+		ms_FlushedBatches++;
+		ms_BatchesInFlight++;
+		Database->Prepare<DB::OTHER>("INSERT INTO tw_accounts_items (ItemID, UserID, Value, Settings, Enchant, Durability) VALUES %s "
+			"ON DUPLICATE KEY UPDATE Value = VALUES(Value), Settings = VALUES(Settings), Enchant = VALUES(Enchant), Durability = VALUES(Durability)", Values.c_str())
+			->AtExecuteOrdered([]() { ms_BatchesInFlight--; });
+		if(!Removed.empty())
+			Database->ExecuteOrdered<DB::REMOVE>("tw_accounts_items", "WHERE Value <= 0 AND (UserID, ItemID) IN (%s)", Removed.c_str());
+
+		Values.clear();
+		Removed.clear();
+		BatchSize = 0;
+	};
+
+	for(const auto& [Key, Item] : aItems)
+	{
+		const auto& [UserID, ItemID] = Key;
+
+		char aBuf[128];
+		str_format(aBuf, sizeof(aBuf), "%s('%d', '%d', '%d', '%d', '%d', '%d')", Values.empty() ? "" : ", ", ItemID, UserID, maximum(0, Item.m_Value), Item.m_Settings, Item.m_Enchant, Item.m_Durability);
+		Values += aBuf;
+		if(Item.m_Value <= 0)
+		{
+			str_format(aBuf, sizeof(aBuf), "%s(%d, %d)", Removed.empty() ? "" : ", ", UserID, ItemID);
+			Removed += aBuf;
+		}
+		BatchSize++;
+
+		// keep the statement below MAX_QUERY_LEN
+		if(Values.length() > 1500 || Removed.length() > 1500)
+			SendBatch();
+	}
+	SendBatch();
+}
+
 // helper functions
 CItem CItem::FromJSON(const nlohmann::json& json)
 {
@@ -5,6 +5,8 @@
 
 #include "ItemInfoData.h"
 
+#include <game/server/mmocore/Utils/DenseTable.h>
+
 class CItem;
 using CItemsContainer = std::deque<CItem>;
 
@@ -48,7 +50,16 @@ public:
 	[[nodiscard]] static CItemsContainer FromArrayJSON(const nlohmann::json& json, const char* pField);
 };
 
-class CPlayerItem : public CItem, public MultiworldIdentifiableStaticData< std::map < int, std::map < int, CPlayerItem > > >
+class CPlayerItem;
+
+// items that can be equipped are listed apart, equipment lookups only walk those
+struct CEquippableItem
+{
+	static bool Check(const CPlayerItem& Item);
+};
+using CPlayerItemsTable = CDenseTable<CPlayerItem, CEquippableItem>;
+
+class CPlayerItem : public CItem, public MultiworldIdentifiableStaticData< CClientDataMap < CPlayerItemsTable > >
 {
 	friend class CInventoryManager;
 	int m_ClientID {};
@@ -56,6 +67,21 @@ class CPlayerItem : public CItem, public MultiworldIdentifiableStaticData< std::
 	class CGS* GS() const;
 	class CPlayer* GetPlayer() const;
 
+	// write-behind state of a changed item, keyed by (UserID, ItemID)
+	struct CDirtyItem
+	{
+		int m_ClientID;
+		int m_Value;
+		int m_Settings;
+		int m_Enchant;
+		int m_Durability;
+	};
+	inline static std::mutex ms_DirtyMutex {};
+	inline static std::map<std::pair<int, int>, CDirtyItem> ms_aDirty {};
+	inline static std::atomic<uint64_t> ms_FlushedItems {};
+	inline static std::atomic<uint64_t> ms_FlushedBatches {};
+	inline static std::atomic<int> ms_BatchesInFlight {};
+
 public:
 	CPlayerItem() = default;
 	CPlayerItem(ItemIdentifier ID, int ClientID) : m_ClientID(ClientID) { m_ID = ID; }
@@ -67,7 +93,7 @@ public:
 		m_Enchant = Enchant;
 		m_Durability = Durability;
 		m_Settings = Settings;
-		CPlayerItem::m_pData[m_ClientID][m_ID] = *this;
+		CPlayerItem::m_pData[m_ClientID].Insert(m_ID, *this);
 	}
 	
 	// getters
@@ -91,6 +117,13 @@ public:
 	void StrFormatAttributes(CPlayer* pPlayer, char* pBuffer, int Size) const { Info()->StrFormatAttributes(pPlayer, pBuffer, Size, m_Enchant); }
 	bool Save();
 
+	// write-behind persistence
+	static void FlushDirty(int ClientID = -1);
+	static int GetDirtySize();
+	static uint64_t GetFlushedItems() { return ms_FlushedItems.load(); }
+	static uint64_t GetFlushedBatches() { return ms_FlushedBatches.load(); }
+	static int GetBatchesInFlight() { return ms_BatchesInFlight.load(); }
+
 	// override functions
 	bool SetValue(int Value) override;
 	bool SetEnchant(int Enchant) override;
@@ -0,0 +1,48 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "MailBoxData.h"
+
+void CMailBox::ReserveLetterID(int ID)
+{
+	int LastID = ms_LastLetterID;
+	while(ID > LastID && !ms_LastLetterID.compare_exchange_weak(LastID, ID))
+		;
+}
+
+void CMailBox::Add(CMailLetter Letter)
+{
+	if(!Letter.m_Read)
+		m_Unread++;
+	m_aLetters.push_back(std::move(Letter));
+}
+
+bool CMailBox::Remove(int LetterID, CMailLetter* pLetter)
+{
+	auto Iter = std::find_if(m_aLetters.begin(), m_aLetters.end(), [LetterID](const CMailLetter& Letter) { return Letter.m_ID == LetterID; });
+	if(Iter == m_aLetters.end())
+		return false;
+
+	if(!Iter->m_Read)
+		m_Unread--;
+	if(pLetter)
+		*pLetter = std::move(*Iter);
+	m_aLetters.erase(Iter);
+	return true;
+}
+
+const CMailLetter* CMailBox::Get(int LetterID) const
+{
+	auto Iter = std::find_if(m_aLetters.begin(), m_aLetters.end(), [LetterID](const CMailLetter& Letter) { return Letter.m_ID == LetterID; });
+	return Iter != m_aLetters.end() ? &(*Iter) : nullptr;
+}
+
+bool CMailBox::MarkAllRead()
+{
+	if(!m_Unread)
+		return false;
+
+	for(auto& Letter : m_aLetters)
+		Letter.m_Read = true;
+	m_Unread = 0;
+	return true;
+}
@@ -0,0 +1,57 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_COMPONENT_MAIL_DATA_H
+#define GAME_SERVER_COMPONENT_MAIL_DATA_H
+
+#include <deque>
+#include <mutex>
+
+class CMailLetter
+{
+public:
+	int m_ID {};
+	std::string m_Name {};
+	std::string m_Description {};
+	std::string m_From {};
+	int m_ItemID {};
+	int m_Value {};
+	int m_Enchant {};
+	bool m_Read {};
+
+	bool HasItem() const { return m_ItemID > 0 && m_Value > 0; }
+};
+
+/*
+	Class: CMailBox
+		Letters of an online account by client id, loaded on login and
+		changed in place when letters arrive, get accepted or deleted.
+		The database follows with asynchronous queries.
+*/
+class CMailBox : public MultiworldIdentifiableStaticData< std::map< int, CMailBox > >
+{
+	std::deque<CMailLetter> m_aLetters {};
+	int m_Unread {};
+
+	static inline std::atomic<int> ms_LastLetterID {};
+
+public:
+	// worlds can tick in parallel and send letters to each other's players
+	static inline std::mutex ms_Lock {};
+
+	// New letters get ids above every id used by the table
+	static void ReserveLetterID(int ID);
+	static int NextLetterID() { return ++ms_LastLetterID; }
+
+	void Add(CMailLetter Letter);
+	bool Remove(int LetterID, CMailLetter* pLetter = nullptr);
+	const CMailLetter* Get(int LetterID) const;
+
+	// Returns true if there were unread letters
+	bool MarkAllRead();
+
+	const std::deque<CMailLetter>& GetLetters() const { return m_aLetters; }
+	int GetSize() const { return (int)m_aLetters.size(); }
+	int GetUnread() const { return m_Unread; }
+};
+
+#endif
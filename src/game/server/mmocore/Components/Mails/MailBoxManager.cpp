@@ -4,8 +4,56 @@
 
 #include <game/server/gamecontext.h>
 
+#include "MailBoxData.h"
+
 using namespace sqlstr;
 
+void CMailBoxManager::OnInit()
+{
+	// letter ids are given out by the server, so cached letters know them before the insert ran
+	ResultPtr pRes = Database->Execute<DB::SELECT>("MAX(ID) AS MaxID", "tw_accounts_mailbox");
+	if(pRes->next())
+		CMailBox::ReserveLetterID(pRes->getInt("MaxID"));
+}
+
+std::string CMailBoxManager::OnAccountQuery(int AccountID) const
+{
+	return Database->Prepare<DB::SELECT>("*", "tw_accounts_mailbox", "WHERE UserID = '%d' ORDER BY ID", AccountID)->GetQueryString();
+}
+
+void CMailBoxManager::OnInitAccount(CPlayer* pPlayer, ResultPtr pRes)
+{
+	std::deque<CMailLetter> aLetters;
+	while(pRes->next())
+	{
+		CMailLetter Letter;
+		Letter.m_ID = pRes->getInt("ID");
+		Letter.m_Name = pRes->getString("Name").c_str();
+		Letter.m_Description = pRes->getString("Description").c_str();
+		Letter.m_From = pRes->getString("FromSend").c_str();
+		Letter.m_ItemID = pRes->getInt("ItemID");
+		Letter.m_Value = pRes->getInt("ItemValue");
+		Letter.m_Enchant = pRes->getInt("Enchant");
+		Letter.m_Read = pRes->getBoolean("IsRead");
+		aLetters.push_back(std::move(Letter));
+	}
+
+	// letters sent while the query ran are kept behind the loaded ones
+	std::lock_guard Lock(CMailBox::ms_Lock);
+	CMailBox& MailBox = CMailBox::Data()[pPlayer->GetCID()];
+	for(auto& Letter : aLetters)
+	{
+		if(!MailBox.Get(Letter.m_ID))
+			MailBox.Add(std::move(Letter));
+	}
+}
+
+void CMailBoxManager::OnResetClient(int ClientID)
+{
+	std::lock_guard Lock(CMailBox::ms_Lock);
+	CMailBox::Data().erase(ClientID);
+}
+
 bool CMailBoxManager::OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText)
 {
 	const int ClientID = pPlayer->GetCID();
@@ -18,7 +66,7 @@ bool CMailBoxManager::OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, in
 
 	if(PPSTR(CMD, "DELETE_MAIL") == 0)
 	{
-		DeleteMailLetter(VoteID);
+		DeleteMailLetter(pPlayer, VoteID);
 		GS()->StrongUpdateVotes(ClientID, MenuList::MENU_INBOX);
 		return true;
 	}
@@ -48,48 +96,70 @@ bool CMailBoxManager::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool Repl
 // check whether messages are available
 int CMailBoxManager::GetMailLettersSize(int AccountID)
 {
-	ResultPtr pRes = Database->Execute<DB::SELECT>("ID", "tw_accounts_mailbox", "WHERE UserID = '%d'", AccountID);
-	const int MailValue = pRes->rowsCount();
-	return MailValue;
+	// offline accounts have no cached mailbox
+	CPlayer* pPlayer = GS()->GetPlayerByUserID(AccountID);
+	if(!pPlayer)
+	{
+		ResultPtr pRes = Database->Execute<DB::SELECT>("COUNT(*) AS Num", "tw_accounts_mailbox", "WHERE UserID = '%d'", AccountID);
+		return pRes->next() ? pRes->getInt("Num") : 0;
+	}
+
+	std::lock_guard Lock(CMailBox::ms_Lock);
+	const auto Iter = CMailBox::Data().find(pPlayer->GetCID());
+	return Iter != CMailBox::Data().end() ? Iter->second.GetSize() : 0;
+}
+
+int CMailBoxManager::GetUnreadLettersSize(int AccountID)
+{
+	CPlayer* pPlayer = GS()->GetPlayerByUserID(AccountID);
+	if(!pPlayer)
+		return 0;
+
+	std::lock_guard Lock(CMailBox::ms_Lock);
+	const auto Iter = CMailBox::Data().find(pPlayer->GetCID());
+	return Iter != CMailBox::Data().end() ? Iter->second.GetUnread() : 0;
 }
 
 // show a list of mails
 void CMailBoxManager::GetInformationInbox(CPlayer *pPlayer)
 {
 	int ShowLetterID = 0;
-	bool EmptyMailBox = true;
 	const int ClientID = pPlayer->GetCID();
 	int HideID = (int)(NUM_TAB_MENU + CItemDescription::Data().size() + 200);
-	ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_accounts_mailbox", "WHERE UserID = '%d' LIMIT %d", pPlayer->Account()->GetID(), MAILLETTER_MAX_CAPACITY);
-	while(pRes->next())
+
+	std::unique_lock Lock(CMailBox::ms_Lock);
+	CMailBox& MailBox = CMailBox::Data()[ClientID];
+	for(const CMailLetter& Letter : MailBox.GetLetters())
 	{
-		// get the information to create an object
-		const int MailLetterID = pRes->getInt("ID");
-		const int ItemID = pRes->getInt("ItemID");
-		const int ItemValue = pRes->getInt("ItemValue");
-		const int Enchant = pRes->getInt("Enchant");
-		EmptyMailBox = false;
+		if(ShowLetterID >= (int)MAILLETTER_MAX_CAPACITY)
+			break;
+
 		ShowLetterID++;
 		HideID++;
 
 		// add vote menu
-		CItemDescription* pItemAttach = GS()->GetItemInfo(ItemID);
-		GS()->AVH(ClientID, HideID, "✉ Letter({INT}) {STR}", ShowLetterID, pRes->getString("Name").c_str());
-		GS()->AVM(ClientID, "null", NOPE, HideID, "{STR}", pRes->getString("Description").c_str());
-		if(ItemID <= 0 || ItemValue <= 0)
-			GS()->AVM(ClientID, "MAIL", MailLetterID, HideID, "Accept (L{INT})", ShowLetterID);
-		else if(pItemAttach->IsEnchantable())
+		GS()->AVH(ClientID, HideID, "✉ Letter({INT}) {STR}", ShowLetterID, Letter.m_Name.c_str());
+		GS()->AVM(ClientID, "null", NOPE, HideID, "{STR}", Letter.m_Description.c_str());
+		if(!Letter.HasItem())
+			GS()->AVM(ClientID, "MAIL", Letter.m_ID, HideID, "Accept (L{INT})", ShowLetterID);
+		else if(CItemDescription* pItemAttach = GS()->GetItemInfo(Letter.m_ItemID); pItemAttach->IsEnchantable())
 		{
-			GS()->AVM(ClientID, "MAIL", MailLetterID, HideID, "Receive {STR} {STR} (L{INT})",
-				pItemAttach->GetName(), pItemAttach->StringEnchantLevel(Enchant).c_str(), ShowLetterID);
+			GS()->AVM(ClientID, "MAIL", Letter.m_ID, HideID, "Receive {STR} {STR} (L{INT})",
+				pItemAttach->GetName(), pItemAttach->StringEnchantLevel(Letter.m_Enchant).c_str(), ShowLetterID);
 		}
 		else
-			GS()->AVM(ClientID, "MAIL", MailLetterID, HideID, "Receive {STR}x{VAL} (L{INT})", pItemAttach->GetName(), ItemValue, ShowLetterID);
+			GS()->AVM(ClientID, "MAIL", Letter.m_ID, HideID, "Receive {STR}x{VAL} (L{INT})", pItemAttach->GetName(), Letter.m_Value, ShowLetterID);
 
-		GS()->AVM(ClientID, "DELETE_MAIL", MailLetterID, HideID, "Delete (L{INT})", ShowLetterID);
+		GS()->AVM(ClientID, "DELETE_MAIL", Letter.m_ID, HideID, "Delete (L{INT})", ShowLetterID);
 	}
 
-	if(EmptyMailBox)
+	// opened letters are read, one update for all of them
+	const bool HadUnread = MailBox.MarkAllRead();
+	Lock.unlock();
+	if(HadUnread)
+		Database->ExecuteOrdered<DB::UPDATE>("tw_accounts_mailbox", "IsRead = '1' WHERE UserID = '%d' AND IsRead = '0'", pPlayer->Account()->GetID());
+
+	if(!ShowLetterID)
 		GS()->AVL(ClientID, "null", "Your mailbox is empty");
 }
 
@@ -101,11 +171,29 @@ void CMailBoxManager::SendInbox(const char* pFrom, int AccountID, const char* pN
 	const CSqlString<64> cDesc = CSqlString<64>(pDesc);
 	const CSqlString<64> cFrom = CSqlString<64>(pFrom);
 
-	// send information about new message
-	if(GS()->ChatAccount(AccountID, "[Mailbox] New letter ({STR})!", cName.cstr()))
+	CMailLetter Letter;
+	Letter.m_ID = CMailBox::NextLetterID();
+	Letter.m_Name = cName.cstr();
+	Letter.m_Description = cDesc.cstr();
+	Letter.m_From = cFrom.cstr();
+	Letter.m_ItemID = ItemID > 0 ? ItemID : 0;
+	Letter.m_Value = ItemID > 0 ? Value : 0;
+	Letter.m_Enchant = ItemID > 0 ? Enchant : 0;
+
+	// online recipients get the letter into their cached mailbox right away
+	if(CPlayer* pPlayer = GS()->GetPlayerByUserID(AccountID))
 	{
-		const int MailLettersSize = GetMailLettersSize(AccountID);
-		if(MailLettersSize >= (int)MAILLETTER_MAX_CAPACITY)
+		int MailLettersSize;
+		{
+			std::lock_guard Lock(CMailBox::ms_Lock);
+			CMailBox& MailBox = CMailBox::Data()[pPlayer->GetCID()];
+			MailBox.Add(Letter);
+			MailLettersSize = MailBox.GetSize();
+		}
+		CGS::InvalidateVotes(pPlayer->GetCID());
+
+		GS()->ChatAccount(AccountID, "[Mailbox] New letter ({STR})!", cName.cstr());
+		if(MailLettersSize > (int)MAILLETTER_MAX_CAPACITY)
 		{
 			GS()->ChatAccount(AccountID, "[Mailbox] Your mailbox is full you can't get.");
 			GS()->ChatAccount(AccountID, "[Mailbox] It will come after you clear your mailbox.");
@@ -113,13 +201,14 @@ void CMailBoxManager::SendInbox(const char* pFrom, int AccountID, const char* pN
 	}
 
 	// send new message
-	if (ItemID <= 0)
+	if(!Letter.HasItem())
 	{
-		Database->Execute<DB::INSERT>("tw_accounts_mailbox", "(Name, Description, UserID, FromSend) VALUES ('%s', '%s', '%d', '%s');", cName.cstr(), cDesc.cstr(), AccountID, cFrom.cstr());
+		Database->ExecuteOrdered<DB::INSERT>("tw_accounts_mailbox", "(ID, Name, Description, UserID, FromSend) VALUES ('%d', '%s', '%s', '%d', '%s');",
+			Letter.m_ID, cName.cstr(), cDesc.cstr(), AccountID, cFrom.cstr());
 		return;
 	}
-	Database->Execute<DB::INSERT>("tw_accounts_mailbox", "(Name, Description, ItemID, ItemValue, Enchant, UserID, FromSend) VALUES ('%s', '%s', '%d', '%d', '%d', '%d', '%s');",
-		 cName.cstr(), cDesc.cstr(), ItemID, Value, Enchant, AccountID, cFrom.cstr());
+	Database->ExecuteOrdered<DB::INSERT>("tw_accounts_mailbox", "(ID, Name, Description, ItemID, ItemValue, Enchant, UserID, FromSend) VALUES ('%d', '%s', '%s', '%d', '%d', '%d', '%d', '%s');",
+		Letter.m_ID, cName.cstr(), cDesc.cstr(), ItemID, Value, Enchant, AccountID, cFrom.cstr());
 }
 
 bool CMailBoxManager::SendInbox(const char* pFrom, const char* pNickname, const char* pName, const char* pDesc, int ItemID, int Value, int Enchant)
@@ -137,38 +226,40 @@ bool CMailBoxManager::SendInbox(const char* pFrom, const char* pNickname, const
 
 void CMailBoxManager::AcceptMailLetter(CPlayer* pPlayer, int MailLetterID)
 {
-	ResultPtr pRes = Database->Execute<DB::SELECT>("ItemID, ItemValue, Enchant", "tw_accounts_mailbox", "WHERE ID = '%d'", MailLetterID);
-	if(pRes->next())
+	// taken out first, so the attachment can only be received once
+	CMailLetter Letter;
 	{
-		// get informed about the mail
-		const int ItemID = pRes->getInt("ItemID");
-		const int ItemValue = pRes->getInt("ItemValue");
-		if(ItemID <= 0 || ItemValue <= 0)
-		{
-			DeleteMailLetter(MailLetterID);
+		std::lock_guard Lock(CMailBox::ms_Lock);
+		if(!CMailBox::Data()[pPlayer->GetCID()].Remove(MailLetterID, &Letter))
 			return;
-		}
+	}
 
-		// recieve
-		if(GS()->GetItemInfo(ItemID)->IsEnchantable() && pPlayer->GetItem(ItemID)->HasItem())
+	// recieve
+	if(Letter.HasItem())
+	{
+		if(GS()->GetItemInfo(Letter.m_ItemID)->IsEnchantable() && pPlayer->GetItem(Letter.m_ItemID)->HasItem())
 		{
+			std::lock_guard Lock(CMailBox::ms_Lock);
+			CMailBox::Data()[pPlayer->GetCID()].Add(std::move(Letter));
 			GS()->Chat(pPlayer->GetCID(), "Enchant item maximal count x1 in a backpack!");
 			return;
 		}
 
-		const int Enchant = pRes->getInt("Enchant");
-		pPlayer->GetItem(ItemID)->Add(ItemValue, 0, Enchant);
-		GS()->Chat(pPlayer->GetCID(), "You received an attached item [{STR}].", GS()->GetItemInfo(ItemID)->GetName());
-		DeleteMailLetter(MailLetterID);
+		pPlayer->GetItem(Letter.m_ItemID)->Add(Letter.m_Value, 0, Letter.m_Enchant);
+		GS()->Chat(pPlayer->GetCID(), "You received an attached item [{STR}].", GS()->GetItemInfo(Letter.m_ItemID)->GetName());
 	}
-}
 
-void CMailBoxManager::DeleteMailLetter(int MailLetterID)
-{
-	Database->Execute<DB::REMOVE>("tw_accounts_mailbox", "WHERE ID = '%d'", MailLetterID);
+	// ordered after the insert of the letter
+	Database->ExecuteOrdered<DB::REMOVE>("tw_accounts_mailbox", "WHERE ID = '%d'", MailLetterID);
 }
 
-void CMailBoxManager::SetReadState(int MailLetterID, bool State)
+void CMailBoxManager::DeleteMailLetter(CPlayer* pPlayer, int MailLetterID)
 {
-	Database->Execute<DB::UPDATE>("tw_accounts_mailbox", "IsRead='%d' WHERE ID = '%d'", State, MailLetterID);
-}
\ No newline at end of file
+	{
+		std::lock_guard Lock(CMailBox::ms_Lock);
+		if(!CMailBox::Data()[pPlayer->GetCID()].Remove(MailLetterID))
+			return;
+	}
+
+	Database->ExecuteOrdered<DB::REMOVE>("tw_accounts_mailbox", "WHERE ID = '%d'", MailLetterID);
+}
@@ -6,19 +6,25 @@
 
 class CMailBoxManager : public MmoComponent
 {
+	void OnInit() override;
+	std::string OnAccountQuery(int AccountID) const override;
+	void OnInitAccount(CPlayer* pPlayer, ResultPtr pRes) override;
+	void OnResetClient(int ClientID) override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
 	bool OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu) override;
 
 public:
+	// cached for online accounts, offline accounts are counted in the database
 	int GetMailLettersSize(int AccountID);
+	// cached for online accounts only, offline accounts have 0
+	int GetUnreadLettersSize(int AccountID);
 	void GetInformationInbox(CPlayer *pPlayer);
 	void SendInbox(const char* pFrom, int AccountID, const char* pName, const char* pDesc, int ItemID = -1, int Value = -1, int Enchant = -1);
 	bool SendInbox(const char* pFrom, const char* pNickname, const char* pName, const char* pDesc, int ItemID = -1, int Value = -1, int Enchant = -1);
 
 private:
-	void DeleteMailLetter(int MailLetterID);
+	void DeleteMailLetter(CPlayer* pPlayer, int MailLetterID);
 	void AcceptMailLetter(CPlayer* pPlayer, int MailLetterID);
-	void SetReadState(int MailLetterID, bool State);
 };
 
 #endif
\ No newline at end of file
@@ -7,7 +7,13 @@
 #include <game/server/mmocore/Components/Dungeons/DungeonManager.h>
 #include <game/server/mmocore/Components/Worlds/WorldManager.h>
 
+#include <engine/shared/packer.h>
+
 #include "Entities/quest_mob_path_finder.h"
+#include "QuestProgressStore.h"
+
+// version of the progress records, older ones are reinitialized
+static constexpr int QUEST_STEPS_VERSION = 1;
 
 // Return the game server object associated with the player's client ID
 CGS* CPlayerQuest::GS() const
@@ -59,72 +65,22 @@ std::string CPlayerQuest::GetJsonFileName() const
 	return Info()->GetJsonFileName(GetPlayer()->Account()->GetID());
 }
 
+// Return the progress file name for the player quest based on the player's account ID
+std::string CPlayerQuest::GetDataFileName() const
+{
+	return Info()->GetDataFileName(GetPlayer()->Account()->GetID());
+}
+
 void CPlayerQuest::InitSteps()
 {
 	// check if the quest state is not ACCEPT or if the player does not exist
 	if(m_State != QuestState::ACCEPT || !GetPlayer())
 		return;
 
-	// check if the "quest_tmp" directory does not exist
-	if(!fs_is_dir("server_data/quest_tmp"))
-	{
-		// create the directories if it does not exist
-		fs_makedir("server_data");
-		fs_makedir("server_data/quest_tmp");
-	}
-
 	// initialize the quest steps
 	m_Step = 1;
 	Info()->InitPlayerDefaultSteps(m_ClientID, m_aPlayerSteps);
 
-	// json structuring
-	nlohmann::json JsonQuestData;
-	JsonQuestData["current_step"] = m_Step;
-	for(auto& pStep : m_aPlayerSteps)
-	{
-		if(pStep.second.m_Bot.m_HasAction)
-		{
-			// Create a JSON object called StepData
-			nlohmann::json StepData;
-
-			// Add values to the StepData object
-			StepData["subbotid"] = pStep.second.m_Bot.m_SubBotID;
-			StepData["state"] = pStep.second.m_StepComplete;
-
-			// Check if the RequiredDefeat vector is not empty
-			if(!pStep.second.m_Bot.m_RequiredDefeat.empty())
-			{
-				// Iterate through each element in the RequiredDefeat vector
-				for(auto& p : pStep.second.m_Bot.m_RequiredDefeat)
-				{
-					// Create a JSON object for each required defeat
-					StepData["defeat"].push_back({
-						{"id", p.m_BotID},
-						{"count", 0},
-						{"complete", false}
-						});
-				}
-			}
-
-			// Check if the RequiredMoveTo vector is not empty
-			if(!pStep.second.m_Bot.m_RequiredMoveTo.empty())
-			{
-				// Iterate through each element in the RequiredMoveTo vector
-				for(size_t i = 0; i < pStep.second.m_Bot.m_RequiredMoveTo.size(); i++)
-				{
-					// Create a JSON object for each required move
-					StepData["move_to"].push_back({
-						{"complete", false}
-						});
-				}
-			}
-
-			// Add the StepData object to the "steps" array in the JsonQuestData object
-			JsonQuestData["steps"].push_back(StepData);
-		}
-
-	}
-
 	// Loop through each player step
 	for(auto& pStep : m_aPlayerSteps)
 	{
@@ -140,17 +96,16 @@ void CPlayerQuest::InitSteps()
 			}
 		}
 
-		// Initialize the size of the MoveToProgress array based on the number of required move-to elements
+		// Initialize the MoveToProgress array based on the number of required move-to elements
 		int MoveToElementsSize = pStep.second.m_Bot.m_RequiredMoveTo.size();
-		pStep.second.m_aMoveToProgress.resize(MoveToElementsSize, false);
+		pStep.second.m_aMoveToProgress.assign(MoveToElementsSize, false);
 
 		// Update the player step
 		pStep.second.Update();
 	}
 
 	// save file
-	std::string Data = JsonQuestData.dump();
-	Tools::Files::saveFile(GetJsonFileName().c_str(), Data.data(), (unsigned)Data.size());
+	SaveSteps();
 }
 
 void CPlayerQuest::LoadSteps()
@@ -159,14 +114,99 @@ void CPlayerQuest::LoadSteps()
 	if(m_State != QuestState::ACCEPT)
 		return;
 
-	// loading file is not open pereinitilized steps
-	ByteArray RawData;
-	if(!Tools::Files::loadFile(GetJsonFileName().c_str(), &RawData))
+	// the store returns progress that is still waiting for its commit
+	std::vector<unsigned char> vData;
+	if(!CQuestProgressStore::Get().Read(GetDataFileName(), &vData))
+	{
+		// progress saved by older versions is converted once
+		if(!LoadJsonSteps())
+			InitSteps();
+		return;
+	}
+
+	// init steps
+	Info()->InitPlayerDefaultSteps(m_ClientID, m_aPlayerSteps);
+
+	// loading steps
+	CUnpacker Unpacker;
+	Unpacker.Reset(vData.data(), (int)vData.size());
+	if(Unpacker.GetInt() != QUEST_STEPS_VERSION || Unpacker.Error())
 	{
+		dbg_msg(QUEST_PREFIX_DEBUG, "Reinitialization called... Unknown progress record '%s'!", GetDataFileName().c_str());
 		InitSteps();
 		return;
 	}
 
+	m_Step = Unpacker.GetInt();
+	const int NumSteps = Unpacker.GetInt();
+	for(int i = 0; i < NumSteps && !Unpacker.Error(); i++)
+	{
+		const int SubBotID = Unpacker.GetInt();
+		CPlayerQuestStep& Step = m_aPlayerSteps[SubBotID];
+		Step.m_StepComplete = Unpacker.GetInt() != 0;
+
+		// completed steps keep the default progress, the record is only read past
+		const int NumDefeat = Unpacker.GetInt();
+		for(int d = 0; d < NumDefeat && !Unpacker.Error(); d++)
+		{
+			const int BotID = Unpacker.GetInt();
+			const int Count = Unpacker.GetInt();
+			const bool Complete = Unpacker.GetInt() != 0;
+			if(!Step.m_StepComplete)
+			{
+				Step.m_aMobProgress[BotID].m_Count = Count;
+				Step.m_aMobProgress[BotID].m_Complete = Complete;
+			}
+		}
+
+		const int NumMoveTo = Unpacker.GetInt();
+		const int MoveToElementsSize = (int)Step.m_Bot.m_RequiredMoveTo.size();
+		if(!Step.m_StepComplete && NumMoveTo > 0)
+		{
+			if(MoveToElementsSize < NumMoveTo)
+			{
+				dbg_msg("quest system", "Reinitialization called... Player save file has a MoveTo value, but it is not present in the data!");
+				InitSteps();
+				return;
+			}
+			Step.m_aMoveToProgress.resize(MoveToElementsSize, false);
+		}
+		for(int m = 0; m < NumMoveTo && !Unpacker.Error(); m++)
+		{
+			const bool Complete = Unpacker.GetInt() != 0;
+			if(!Step.m_StepComplete)
+				Step.m_aMoveToProgress[m] = Complete;
+		}
+
+		if(!Step.m_StepComplete)
+			Step.m_ClientQuitting = false;
+	}
+
+	if(Unpacker.Error())
+	{
+		dbg_msg(QUEST_PREFIX_DEBUG, "Reinitialization called... Broken progress record '%s'!", GetDataFileName().c_str());
+		InitSteps();
+		return;
+	}
+
+	// Update the steps of the bot
+	for(auto& pStep : m_aPlayerSteps)
+	{
+		// If the current step is not complete
+		if(!pStep.second.m_StepComplete)
+		{
+			// Update the current step
+			pStep.second.Update();
+		}
+	}
+}
+
+bool CPlayerQuest::LoadJsonSteps()
+{
+	ByteArray RawData;
+	if(!Tools::Files::loadFile(GetJsonFileName().c_str(), &RawData))
+		return false;
+
 	// init steps
 	Info()->InitPlayerDefaultSteps(m_ClientID, m_aPlayerSteps);
 
@@ -210,7 +250,8 @@ void CPlayerQuest::LoadSteps()
 				// Print a debug message andd call InitSteps
 				dbg_msg("quest system", "Reinitialization called... Player save file has a MoveTo value, but it is not present in the data!");
 				InitSteps();
-				return;
+				CQuestProgressStore::Get().Remove(GetJsonFileName());
+				return true;
 			}
 
 			// Initialize the size of the MoveToProgress array based on the number of required move-to elements
@@ -238,6 +279,11 @@ void CPlayerQuest::LoadSteps()
 			pStep.second.Update();
 		}
 	}
+
+	// keep it in the new format from now on
+	SaveSteps();
+	CQuestProgressStore::Get().Remove(GetJsonFileName());
+	return true;
 }
 
 bool CPlayerQuest::SaveSteps()
@@ -246,54 +292,42 @@ bool CPlayerQuest::SaveSteps()
 	if(m_State != QuestState::ACCEPT)
 		return false;
 
-	// json structuring
-	nlohmann::json JsonQuestData;
-	JsonQuestData["current_step"] = m_Step;
-	for(auto& pStep : m_aPlayerSteps)
+	// compact record of the steps with an action
+	CPacker Packer;
+	Packer.Reset();
+	Packer.AddInt(QUEST_STEPS_VERSION);
+	Packer.AddInt(m_Step);
+	Packer.AddInt((int)std::count_if(m_aPlayerSteps.begin(), m_aPlayerSteps.end(), [](const std::pair<const int, CPlayerQuestStep>& p) { return p.second.m_Bot.m_HasAction; }));
+	for(auto& [SubBotID, Step] : m_aPlayerSteps)
 	{
-		if(pStep.second.m_Bot.m_HasAction)
-		{
-			// Creating a json object called stepData
-			nlohmann::json stepData;
-
-			// Assigning the value of m_SubBotID to the key "subbotid" in the stepData object
-			stepData["subbotid"] = pStep.second.m_Bot.m_SubBotID;
+		if(!Step.m_Bot.m_HasAction)
+			continue;
 
-			// Assigning the value of m_StepComplete to the key "state" in the stepData object
-			stepData["state"] = pStep.second.m_StepComplete;
+		Packer.AddInt(Step.m_Bot.m_SubBotID);
+		Packer.AddInt(Step.m_StepComplete);
 
-			// Looping through each key-value pair in the m_aMobProgress map of the pStep.second object
-			for(auto& p : pStep.second.m_aMobProgress)
-			{
-				// Creating a json object for each map entry in the m_aMobProgress map
-				// and adding it to the "defeat" array in the stepData object
-				stepData["defeat"].push_back(
-					{
-						{ "id", p.first }, // Assigning the key "id" with the value of p.first (key from the map)
-						{ "count", p.second.m_Count }, // Assigning the key "count" with the value of p.second.m_Count (value from the map value)
-						{ "complete", p.second.m_Complete } // Assigning the key "complete" with the value of p.second.m_Complete (value from the map value)
-					});
-			}
+		Packer.AddInt((int)Step.m_aMobProgress.size());
+		for(auto& [BotID, Progress] : Step.m_aMobProgress)
+		{
+			Packer.AddInt(BotID);
+			Packer.AddInt(Progress.m_Count);
+			Packer.AddInt(Progress.m_Complete);
+		}
 
-			// Looping through each value in the m_aMoveToProgress vector of the pStep.second object
-			for(auto& p : pStep.second.m_aMoveToProgress)
-			{
-				// Creating a json object for each value in the m_aMoveToProgress vector
-				// and adding it to the "move_to" array in the stepData object
-				stepData["move_to"].push_back(
-					{
-						{ "complete", p }, // Assigning the key "complete" with the value of p (value from the vector element)
-					});
-			}
+		Packer.AddInt((int)Step.m_aMoveToProgress.size());
+		for(bool Complete : Step.m_aMoveToProgress)
+			Packer.AddInt(Complete);
+	}
 
-			// Adding the stepData object to the "steps" array in the JsonQuestData object
-			JsonQuestData["steps"].push_back(stepData);
-		}
+	if(Packer.Error())
+	{
+		dbg_msg(QUEST_PREFIX_DEBUG, "Progress of quest %d does not fit into a record.", m_ID);
+		return false;
 	}
 
-	// replace file
-	std::string Data = JsonQuestData.dump();
-	Tools::Files::saveFile(GetJsonFileName().c_str(), Data.data(), (unsigned)Data.size());
+	// no file access here, the store writes it behind the tick
+	CQuestProgressStore::Get().Write(GetDataFileName(), Packer.Data(), Packer.Size());
+	CGS::InvalidateVotes(m_ClientID);
 	return true;
 }
 
@@ -310,8 +344,8 @@ void CPlayerQuest::ClearSteps()
 	m_aPlayerSteps.clear();
 
 	// Remove the temporary user quest data file
-	Tools::Files::deleteFile(GetJsonFileName().c_str());
-	fs_remove(GetJsonFileName().c_str());
+	CQuestProgressStore::Get().Remove(GetDataFileName());
+	CGS::InvalidateVotes(m_ClientID);
 }
 
 // Function to handle accepting a quest by the player
@@ -333,6 +367,7 @@ bool CPlayerQuest::Accept()
 
 	// Initialize the quest steps
 	InitSteps();
+	CGS::InvalidateVotes(ClientID);
 
 	// Retrieve information about the quest
 	const int QuestsSize = Info()->GetQuestStorySize();
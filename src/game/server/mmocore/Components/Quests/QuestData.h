@@ -36,6 +36,7 @@ public:
 
 	CQuestDescription* Info() const;
 	std::string GetJsonFileName() const;
+	std::string GetDataFileName() const;
 	QuestIdentifier GetID() const { return m_ID; }
 	QuestState GetState() const { return m_State; }
 	bool IsCompleted() const { return m_State == QuestState::FINISHED; }
@@ -60,6 +61,7 @@ public:
 	void Reset();
 
 private:
+	bool LoadJsonSteps();
 	void Finish();
 };
 
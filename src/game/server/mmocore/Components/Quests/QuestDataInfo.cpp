@@ -5,6 +5,7 @@
 #include <algorithm>
 
 std::string CQuestDescription::GetJsonFileName(int AccountID) const { return "server_data/quest_tmp/" + std::to_string(m_ID) + "-" + std::to_string(AccountID) + ".json"; }
+std::string CQuestDescription::GetDataFileName(int AccountID) const { return "server_data/quest_tmp/" + std::to_string(m_ID) + "-" + std::to_string(AccountID) + ".dat"; }
 
 int CQuestDescription::GetQuestStoryPosition() const
 {
@@ -38,6 +38,7 @@ public:
 
 	QuestIdentifier GetID() const { return m_ID; }
 	std::string GetJsonFileName(int AccountID) const;
+	std::string GetDataFileName(int AccountID) const;
 	const char* GetName() const { return m_aName; }
 	const char* GetStory() const { return m_aStoryLine; }
 	int GetQuestStoryPosition() const;
@@ -62,16 +62,25 @@ void CQuestManager::OnInit()
 	{
 		CQuestsDailyBoard::Data()[BoardID].m_DailyQuestsInfoList = DataContainer;
 	}
+
+	// the progress store writes behind the tick and expects the directory to exist
+	fs_makedir("server_data");
+	fs_makedir("server_data/quest_tmp");
+	CQuestProgressStore::Get().SetCommitInterval(g_Config.m_SvQuestCommitInterval);
 }
 
 // This method is called when a player's account is initialized.
-void CQuestManager::OnInitAccount(CPlayer* pPlayer)
+// Fetch all rows from the "tw_accounts_quests" table where UserID is equal to the ID of the player's account
+std::string CQuestManager::OnAccountQuery(int AccountID) const
+{
+	return Database->Prepare<DB::SELECT>("*", "tw_accounts_quests", "WHERE UserID = '%d'", AccountID)->GetQueryString();
+}
+
+void CQuestManager::OnInitAccount(CPlayer* pPlayer, ResultPtr pRes)
 {
 	// Get the client ID of the player
 	const int ClientID = pPlayer->GetCID();
 
-	// Execute a select query to fetch all rows from the "tw_accounts_quests" table where UserID is equal to the ID of the player's account
-	ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_accounts_quests", "WHERE UserID = '%d'", pPlayer->Account()->GetID());
 	while(pRes->next())
 	{
 		// Get the QuestID and Type values from the current row
@@ -88,30 +97,23 @@ void CQuestManager::OnResetClient(int ClientID)
 	CPlayerQuest::Data().erase(ClientID);
 }
 
-bool CQuestManager::OnHandleTile(CCharacter* pChr, int IndexCollision)
+void CQuestManager::OnRegisterTiles()
 {
-	// Get the player object client ID associated with the character object
-	CPlayer* pPlayer = pChr->GetPlayer();
-	const int ClientID = pPlayer->GetCID();
+	Job()->RegisterTile(TILE_DAILY_BOARD, this);
+}
 
-	// Check if the player entered the shop zone
-	if(pChr->GetHelper()->TileEnter(IndexCollision, TILE_DAILY_BOARD))
-	{
-		// Send message about entering the shop zone to the player
-		_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
-	// Check if the player exited the shop zone
-	else if(pChr->GetHelper()->TileExit(IndexCollision, TILE_DAILY_BOARD))
-	{
-		// Send message about exiting the shop zone to the player
-		_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
+void CQuestManager::OnHandleTileEnter(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
+}
 
-	return false;
+void CQuestManager::OnHandleTileExit(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
 }
 
 bool CQuestManager::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu)
@@ -6,6 +6,7 @@
 
 #include "QuestDailyBoardData.h"
 #include "QuestData.h"
+#include "QuestProgressStore.h"
 
 /*
  * CQuestManager class is a subclass of MmoComponent class.
@@ -22,19 +23,25 @@ class CQuestManager : public MmoComponent
 
 		// Clear the data in CPlayerQuest
 		CPlayerQuest::Data().clear();
+
+		// Write the progress that is still waiting for its commit
+		CQuestProgressStore::Get().Flush();
 	}
 
 	// This function is called when the module is initialized
 	void OnInit() override;
 
 	// This function is called when the player's account is initialized
-	void OnInitAccount(CPlayer* pPlayer) override;
+	std::string OnAccountQuery(int AccountID) const override;
+	void OnInitAccount(CPlayer* pPlayer, ResultPtr pRes) override;
 
 	// This function is called when the client is reset
 	void OnResetClient(int ClientID) override;
 
-	// This function is called when a tile collision is handled by a character
-	bool OnHandleTile(CCharacter* pChr, int IndexCollision) override;
+	// These functions are called when a character enters or leaves the daily board
+	void OnRegisterTiles() override;
+	void OnHandleTileEnter(CCharacter* pChr, int Tile) override;
+	void OnHandleTileExit(CCharacter* pChr, int Tile) override;
 
 	// This function is called when a menu list is handled by a player
 	bool OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu) override;
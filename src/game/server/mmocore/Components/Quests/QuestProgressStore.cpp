@@ -0,0 +1,136 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "QuestProgressStore.h"
+
+#include <base/system.h>
+#include <engine/shared/scheduler.h>
+
+CQuestProgressStore::CQuestProgressStore(CScheduler* pScheduler) : m_pScheduler(pScheduler)
+{
+}
+
+CQuestProgressStore::~CQuestProgressStore()
+{
+	// the scheduler is stopped by now, whatever is left goes out here
+	Commit();
+}
+
+CQuestProgressStore& CQuestProgressStore::Get()
+{
+	static CQuestProgressStore s_Store(&CScheduler::Get());
+	return s_Store;
+}
+
+void CQuestProgressStore::Write(const std::string& Path, const void* pData, int Size)
+{
+	const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+	Queue(Path, CRecord { false, std::vector<unsigned char>(pBytes, pBytes + Size) });
+}
+
+void CQuestProgressStore::Remove(const std::string& Path)
+{
+	Queue(Path, CRecord { true, {} });
+}
+
+void CQuestProgressStore::Queue(const std::string& Path, CRecord Record)
+{
+	bool StartCommit = false;
+	{
+		std::lock_guard Lock(m_Lock);
+		auto [Iter, Inserted] = m_Pending.insert_or_assign(Path, std::move(Record));
+		if(!Inserted)
+			m_Coalesced++;
+
+		StartCommit = !m_CommitQueued;
+		m_CommitQueued = true;
+	}
+	m_Writes++;
+
+	// one commit for everything written until it runs
+	if(StartCommit)
+		m_pScheduler->AddDelayed(CScheduler::PRIORITY_IO, m_CommitInterval, [this]() { Commit(); });
+}
+
+bool CQuestProgressStore::Read(const std::string& Path, std::vector<unsigned char>* pData)
+{
+	{
+		std::lock_guard Lock(m_Lock);
+		for(const auto* pRecords : { &m_Pending, &m_Committing })
+		{
+			auto Iter = pRecords->find(Path);
+			if(Iter == pRecords->end())
+				continue;
+
+			if(Iter->second.m_Remove)
+				return false;
+			*pData = Iter->second.m_Data;
+			return true;
+		}
+	}
+
+	IOHANDLE File = io_open(Path.c_str(), IOFLAG_READ);
+	if(!File)
+		return false;
+
+	pData->resize((unsigned)io_length(File));
+	const bool Result = io_read(File, pData->data(), (unsigned)pData->size()) == pData->size();
+	io_close(File);
+	return Result;
+}
+
+void CQuestProgressStore::Commit()
+{
+	// commits run one after another, so a file never sees an older record after a newer one
+	std::lock_guard CommitLock(m_CommitLock);
+	{
+		std::lock_guard Lock(m_Lock);
+		m_Committing.swap(m_Pending);
+		m_CommitQueued = false;
+	}
+	if(m_Committing.empty())
+		return;
+
+	for(const auto& [Path, Record] : m_Committing)
+	{
+		bool Result = true;
+		if(Record.m_Remove)
+			fs_remove(Path.c_str());
+		else
+			Result = WriteFile(Path, Record.m_Data);
+
+		if(Result)
+			m_Files++;
+		else
+			m_Failed++;
+	}
+	m_Commits++;
+
+	std::lock_guard Lock(m_Lock);
+	m_Committing.clear();
+}
+
+bool CQuestProgressStore::WriteFile(const std::string& Path, const std::vector<unsigned char>& vData)
+{
+	const std::string TempPath = Path + ".tmp";
+	IOHANDLE File = io_open(TempPath.c_str(), IOFLAG_WRITE);
+	if(!File)
+	{
+		dbg_msg("quest_store", "failed to open '%s'", TempPath.c_str());
+		return false;
+	}
+
+	const bool Written = io_write(File, vData.data(), (unsigned)vData.size()) == vData.size() && io_sync(File) == 0;
+	io_close(File);
+	if(!Written || fs_rename(TempPath.c_str(), Path.c_str()) != 0)
+	{
+		dbg_msg("quest_store", "failed to write '%s'", Path.c_str());
+		fs_remove(TempPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+CQuestProgressStore::CStats CQuestProgressStore::GetStats() const
+{
+	return CStats { m_Writes, m_Coalesced, m_Commits, m_Files, m_Failed };
+}
@@ -0,0 +1,83 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_COMPONENT_QUEST_PROGRESS_STORE_H
+#define GAME_SERVER_COMPONENT_QUEST_PROGRESS_STORE_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class CScheduler;
+
+/*
+	Class: CQuestProgressStore
+		Quest progress files written behind the game tick. Writes only
+		replace the record of the file in memory, a commit task on the
+		scheduler puts all of them on disk together a few milliseconds
+		later. Every file is written next to its place and renamed over
+		it, so a crash leaves either the old or the new progress.
+*/
+class CQuestProgressStore
+{
+public:
+	enum
+	{
+		DEFAULT_COMMIT_INTERVAL = 500,
+	};
+
+	struct CStats
+	{
+		uint64_t m_Writes;
+		uint64_t m_Coalesced;
+		uint64_t m_Commits;
+		uint64_t m_Files;
+		uint64_t m_Failed;
+	};
+
+	explicit CQuestProgressStore(CScheduler* pScheduler);
+	~CQuestProgressStore();
+
+	static CQuestProgressStore& Get();
+
+	void SetCommitInterval(int Milliseconds) { m_CommitInterval = Milliseconds; }
+	void Write(const std::string& Path, const void* pData, int Size);
+	void Remove(const std::string& Path);
+
+	// the record waiting for a commit if there is one, otherwise the file
+	bool Read(const std::string& Path, std::vector<unsigned char>* pData);
+
+	// commits everything queued on the calling thread
+	void Flush() { Commit(); }
+	CStats GetStats() const;
+
+private:
+	struct CRecord
+	{
+		bool m_Remove;
+		std::vector<unsigned char> m_Data;
+	};
+
+	CScheduler* m_pScheduler;
+	std::atomic<int> m_CommitInterval { DEFAULT_COMMIT_INTERVAL };
+
+	// m_Committing holds the records of the running commit until they are on disk
+	std::mutex m_Lock;
+	std::mutex m_CommitLock;
+	std::map<std::string, CRecord> m_Pending;
+	std::map<std::string, CRecord> m_Committing;
+	bool m_CommitQueued {};
+
+	std::atomic<uint64_t> m_Writes {};
+	std::atomic<uint64_t> m_Coalesced {};
+	std::atomic<uint64_t> m_Commits {};
+	std::atomic<uint64_t> m_Files {};
+	std::atomic<uint64_t> m_Failed {};
+
+	void Queue(const std::string& Path, CRecord Record);
+	void Commit();
+	static bool WriteFile(const std::string& Path, const std::vector<unsigned char>& vData);
+};
+
+#endif
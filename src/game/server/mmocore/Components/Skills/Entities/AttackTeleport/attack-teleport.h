@@ -11,6 +11,7 @@ public:
 	~CAttackTeleport() override;
 
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared(vec2* pClipTo) const override { return true; }
 	void Tick() override;
 
 private:
@@ -19,6 +19,7 @@ public:
 	~CHealthHealer() override;
 
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared(vec2* pClipTo) const override { return true; }
 	void Tick() override;
 
 private:
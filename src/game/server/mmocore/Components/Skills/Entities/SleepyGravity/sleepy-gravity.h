@@ -18,6 +18,7 @@ public:
 	~CSleepyGravity() override;
 
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared(vec2* pClipTo) const override { return true; }
 	void Tick() override;
 
 private:
@@ -24,10 +24,14 @@ void CSkillManager::OnInit()
 	}
 }
 
-void CSkillManager::OnInitAccount(CPlayer *pPlayer)
+std::string CSkillManager::OnAccountQuery(int AccountID) const
+{
+	return Database->Prepare<DB::SELECT>("*", "tw_accounts_skills", "WHERE UserID = '%d'", AccountID)->GetQueryString();
+}
+
+void CSkillManager::OnInitAccount(CPlayer *pPlayer, ResultPtr pRes)
 {
 	const int ClientID = pPlayer->GetCID();
-	ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_accounts_skills", "WHERE UserID = '%d'", pPlayer->Account()->GetID());
 	while(pRes->next())
 	{
 		int Level = pRes->getInt("Level");
@@ -72,24 +76,23 @@ bool CSkillManager::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool Replac
 	return false;
 }
 
-bool CSkillManager::OnHandleTile(CCharacter* pChr, int IndexCollision)
+void CSkillManager::OnRegisterTiles()
+{
+	Job()->RegisterTile(TILE_SKILL_ZONE, this);
+}
+
+void CSkillManager::OnHandleTileEnter(CCharacter* pChr, int Tile)
 {
 	CPlayer* pPlayer = pChr->GetPlayer();
-	const int ClientID = pPlayer->GetCID();
+	_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
+}
 
-	if (pChr->GetHelper()->TileEnter(IndexCollision, TILE_SKILL_ZONE))
-	{
-		_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
-	else if (pChr->GetHelper()->TileExit(IndexCollision, TILE_SKILL_ZONE))
-	{
-		_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
-	return false;
+void CSkillManager::OnHandleTileExit(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
 }
 
 bool CSkillManager::OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, const int VoteID, const int VoteID2, int Get, const char* GetText)
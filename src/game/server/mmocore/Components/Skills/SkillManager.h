@@ -15,9 +15,12 @@ class CSkillManager : public MmoComponent
 	};
 
 	void OnInit() override;
-	void OnInitAccount(CPlayer* pPlayer) override;
+	std::string OnAccountQuery(int AccountID) const override;
+	void OnInitAccount(CPlayer* pPlayer, ResultPtr pRes) override;
 	void OnResetClient(int ClientID) override;
-	bool OnHandleTile(CCharacter* pChr, int IndexCollision) override;
+	void OnRegisterTiles() override;
+	void OnHandleTileEnter(CCharacter* pChr, int Tile) override;
+	void OnHandleTileExit(CCharacter* pChr, int Tile) override;
 	bool OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu) override;
 	bool OnHandleVoteCommands(CPlayer* pPlayer, const char* CMD, int VoteID, int VoteID2, int Get, const char* GetText) override;
 
@@ -51,40 +51,25 @@ void CWarehouseManager::OnInit()
 		CWarehouse::Data()[WarehouseID].m_aTradingSlots = DataContainer;
 }
 
-bool CWarehouseManager::OnHandleTile(CCharacter* pChr, int IndexCollision)
+void CWarehouseManager::OnRegisterTiles()
 {
-	CPlayer* pPlayer = pChr->GetPlayer();
-	const int ClientID = pPlayer->GetCID();
-
-	// shop zone
-	if(pChr->GetHelper()->TileEnter(IndexCollision, TILE_SHOP_ZONE))
-	{
-		_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
-	else if(pChr->GetHelper()->TileExit(IndexCollision, TILE_SHOP_ZONE))
-	{
-		_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
+	Job()->RegisterTile(TILE_SHOP_ZONE, this);
+	Job()->RegisterTile(TILE_ORE_SELL, this);
+	Job()->RegisterTile(TILE_PLANT_SELL, this);
+}
 
-	// selling zone
-	if(pChr->GetHelper()->TileEnter(IndexCollision, TILE_ORE_SELL) || pChr->GetHelper()->TileEnter(IndexCollision, TILE_PLANT_SELL))
-	{
-		_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
-	else if(pChr->GetHelper()->TileExit(IndexCollision, TILE_ORE_SELL) || pChr->GetHelper()->TileExit(IndexCollision, TILE_PLANT_SELL))
-	{
-		_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
-		GS()->UpdateVotes(ClientID, pPlayer->m_CurrentVoteMenu);
-		return true;
-	}
+void CWarehouseManager::OnHandleTileEnter(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_ENTER_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
+}
 
-	return false;
+void CWarehouseManager::OnHandleTileExit(CCharacter* pChr, int Tile)
+{
+	CPlayer* pPlayer = pChr->GetPlayer();
+	_DEF_TILE_EXIT_ZONE_SEND_MSG_INFO(pPlayer);
+	GS()->UpdateVotes(pPlayer->GetCID(), pPlayer->m_CurrentVoteMenu);
 }
 
 bool CWarehouseManager::OnHandleMenulist(CPlayer* pPlayer, int Menulist, bool ReplaceMenu)
@@ -0,0 +1,47 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "Effects.h"
+
+#include <base/system.h>
+
+CEffects::CRegistry::CRegistry()
+{
+	m_aNames[SLOWDOWN] = "Slowdown";
+	m_aNames[FIRE] = "Fire";
+	m_aNames[POISON] = "Poison";
+	m_aNames[REGEN_MANA] = "RegenMana";
+	m_NumEffects = NUM_BUILTIN;
+}
+
+CEffects::CRegistry& CEffects::Registry()
+{
+	static CRegistry s_Registry;
+	return s_Registry;
+}
+
+int CEffects::Register(const char* pName)
+{
+	CRegistry& Reg = Registry();
+	std::lock_guard Lock(Reg.m_Lock);
+	for(int i = 0; i < Reg.m_NumEffects; i++)
+	{
+		if(Reg.m_aNames[i] == pName)
+			return i;
+	}
+
+	if(Reg.m_NumEffects >= MAX_EFFECTS)
+	{
+		dbg_msg("effects", "too many effects, '%s' is ignored", pName);
+		return -1;
+	}
+
+	Reg.m_aNames[Reg.m_NumEffects] = pName;
+	return Reg.m_NumEffects++;
+}
+
+const char* CEffects::GetName(int EffectID)
+{
+	CRegistry& Reg = Registry();
+	std::lock_guard Lock(Reg.m_Lock);
+	return EffectID >= 0 && EffectID < Reg.m_NumEffects ? Reg.m_aNames[EffectID].c_str() : "unknown";
+}
@@ -0,0 +1,124 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_MMOCORE_EFFECTS_H
+#define GAME_SERVER_MMOCORE_EFFECTS_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/*
+	Class: CEffects
+		Effect names from potions, mobs, dialogs and commands are
+		registered once and handled by their integer ID afterwards.
+		The effects that the game code checks itself have fixed IDs.
+*/
+class CEffects
+{
+public:
+	enum
+	{
+		SLOWDOWN = 0,
+		FIRE,
+		POISON,
+		REGEN_MANA,
+		NUM_BUILTIN,
+
+		// IDs are bits of CEffectTable::m_ActiveMask
+		MAX_EFFECTS = 64,
+	};
+
+	// returns the ID of the name, -1 when no more effects fit
+	static int Register(const char* pName);
+	static const char* GetName(int EffectID);
+
+private:
+	// created on first use, names may be registered from static data of other files
+	struct CRegistry
+	{
+		CRegistry();
+
+		std::mutex m_Lock;
+		std::string m_aNames[MAX_EFFECTS];
+		int m_NumEffects;
+	};
+	static CRegistry& Registry();
+};
+
+/*
+	Class: CEffectTable
+		Active effects of one player or bot with their seconds left.
+*/
+class CEffectTable
+{
+public:
+	enum
+	{
+		MAX_SLOTS = 16,
+	};
+
+	void Give(int EffectID, int Seconds)
+	{
+		if(EffectID < 0 || EffectID >= CEffects::MAX_EFFECTS || Seconds <= 0)
+			return;
+
+		if(IsActive(EffectID))
+		{
+			for(int i = 0; i < m_NumSlots; i++)
+			{
+				if(m_aSlots[i].m_EffectID == EffectID)
+					m_aSlots[i].m_Seconds = Seconds;
+			}
+			return;
+		}
+
+		if(m_NumSlots >= MAX_SLOTS)
+			return;
+		m_aSlots[m_NumSlots++] = { EffectID, Seconds };
+		m_ActiveMask |= Bit(EffectID);
+	}
+
+	bool IsActive(int EffectID) const { return EffectID >= 0 && EffectID < CEffects::MAX_EFFECTS && (m_ActiveMask & Bit(EffectID)); }
+	bool IsEmpty() const { return m_NumSlots == 0; }
+	int GetSize() const { return m_NumSlots; }
+
+	void Clear()
+	{
+		m_NumSlots = 0;
+		m_ActiveMask = 0;
+	}
+
+	// counts every effect down by a second, calls OnExpire(EffectID) for the ones that ran out
+	template<typename TOnExpire>
+	void Tick(TOnExpire OnExpire)
+	{
+		for(int i = 0; i < m_NumSlots;)
+		{
+			if(--m_aSlots[i].m_Seconds > 0)
+			{
+				i++;
+				continue;
+			}
+
+			const int EffectID = m_aSlots[i].m_EffectID;
+			m_ActiveMask &= ~Bit(EffectID);
+			m_aSlots[i] = m_aSlots[--m_NumSlots];
+			OnExpire(EffectID);
+		}
+	}
+
+private:
+	struct CSlot
+	{
+		int m_EffectID;
+		int m_Seconds;
+	};
+
+	static uint64_t Bit(int EffectID) { return (uint64_t)1 << EffectID; }
+
+	uint64_t m_ActiveMask {};
+	int m_NumSlots {};
+	CSlot m_aSlots[MAX_SLOTS] {};
+};
+
+#endif
@@ -3,6 +3,9 @@
 #ifndef GAME_ENUM_CONTEXT_H
 #define GAME_ENUM_CONTEXT_H
 
+#include <map>
+#include <shared_mutex>
+
 #define GRAY_COLOR vec3(40, 42, 45)
 #define LIGHT_GRAY_COLOR vec3(15, 15, 16)
 #define SMALL_LIGHT_GRAY_COLOR vec3(10, 11, 11)
@@ -363,12 +366,13 @@ public:
 	{
 		int m_ItemID {};
 		std::string m_Effect {};
+		int m_EffectID {};
 		int m_Recovery {};
 		int m_Time {};
 
 	public:
 		Heal() = delete;
-		Heal(int ItemID, std::string Effect, int Recovery, int Time) : m_ItemID(ItemID), m_Effect(Effect), m_Recovery(Recovery), m_Time(Time) {}
+		Heal(int ItemID, std::string Effect, int Recovery, int Time) : m_ItemID(ItemID), m_Effect(Effect), m_EffectID(CEffects::Register(Effect.c_str())), m_Recovery(Recovery), m_Time(Time) {}
 
 		static const Heal* getHealInfo(int ItemID)
 		{
@@ -379,6 +383,7 @@ public:
 
 		int getItemID() const { return m_ItemID; }
 		const char* getEffect() const { return m_Effect.c_str(); }
+		int getEffectID() const { return m_EffectID; }
 		int getRecovery() const { return m_Recovery; }
 		int getTime() const { return m_Time; }
 	};
@@ -666,4 +671,45 @@ public:
 	static T& Data() { return m_pData; }
 };
 
+// Per client data shared by all worlds. Worlds can tick in parallel, so the map itself is
+// locked, while an entry is only used by the world of its client. Map nodes never move,
+// the returned reference stays valid until the client's entry is erased.
+template < typename T >
+class CClientDataMap
+{
+	std::map < int, T > m_Data;
+	mutable std::shared_mutex m_Lock;
+
+public:
+	T& operator[](int ClientID)
+	{
+		{
+			std::shared_lock Lock(m_Lock);
+			if(auto Iter = m_Data.find(ClientID); Iter != m_Data.end())
+				return Iter->second;
+		}
+
+		std::unique_lock Lock(m_Lock);
+		return m_Data[ClientID];
+	}
+
+	bool contains(int ClientID) const
+	{
+		std::shared_lock Lock(m_Lock);
+		return m_Data.find(ClientID) != m_Data.end();
+	}
+
+	void erase(int ClientID)
+	{
+		std::unique_lock Lock(m_Lock);
+		m_Data.erase(ClientID);
+	}
+
+	void clear()
+	{
+		std::unique_lock Lock(m_Lock);
+		m_Data.clear();
+	}
+};
+
 #endif
@@ -54,6 +54,7 @@ public:
 
 	void Tick() override;
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared(vec2* pClipTo) const override { return true; }
 	CEntityHouseDecoration* FindByGroupID(int GroupID);
 
 private:
@@ -23,6 +23,7 @@ public:
 	void Tick() override;
 	virtual void TickPaused();
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared(vec2* pClipTo) const override { return true; }
 
 	void SetSpawn(int Sec);
 	void Work(int ClientID);
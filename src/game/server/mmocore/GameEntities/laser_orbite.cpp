@@ -93,8 +93,10 @@ void CLaserOrbite::Snap(int SnappingClient)
 	if(const CPlayer* pPlayer = GS()->GetPlayer(m_ClientID); pPlayer && pPlayer->IsActiveForClient(SnappingClient) != 2)
 		return;
 
-	vec2 LastPosition = m_Pos + UtilityOrbitePos(m_IDs.size() - 1);
-	for(int i = 0; i < m_IDs.size(); i++)
+	// far away clients get a ring of half the segments
+	const int Step = (m_IDs.size() >= 6 && IsSnapFar(SnappingClient)) ? 2 : 1;
+	vec2 LastPosition = m_Pos + UtilityOrbitePos(((m_IDs.size() - 1) / Step) * Step);
+	for(int i = 0; i < m_IDs.size(); i += Step)
 	{
 		vec2 PosStart = m_Pos + UtilityOrbitePos(i);
 
@@ -3,7 +3,7 @@
 #include <engine/server.h>
 #include <engine/shared/config.h>
 
-CLolPlasma::CLolPlasma(CGameWorld* pGameWorld, CEntity* pParent, vec2 Pos, vec2 Vel, int Lifespan)
+CLolPlasma::CLolPlasma(CGameWorld* pGameWorld, CEntity* pParent, vec2 Pos, vec2 Vel, int Lifespan, bool Detail)
 	: CEntity(pGameWorld, CGameWorld::ENTTYPE_WORLD_TEXT, Pos)
 {
 	m_LocalPos = vec2(0.0f, 0.0f);
@@ -13,6 +13,7 @@ CLolPlasma::CLolPlasma(CGameWorld* pGameWorld, CEntity* pParent, vec2 Pos, vec2
 	m_Life = Lifespan;
 	m_StartTick = Server()->Tick();
 	m_pParent = pParent;
+	m_Detail = Detail;
 	GameWorld()->InsertEntity(this);
 }
 
@@ -350,7 +351,7 @@ void CLoltext::Create(CGameWorld* pGameWorld, CEntity* pParent, vec2 Pos, vec2 V
 		for(int y = 0; y < 5/*XXX*/; ++y)
 			for(int x = 0; x < 3/*XXX*/; ++x)
 				if(s_aaaChars[(unsigned)c][y][x])
-					new CLolPlasma(pGameWorld, pParent, CurPos + vec2(x * g_Config.m_SvLoltextHspace, y * g_Config.m_SvLoltextVspace), Vel, Lifespan);
+					new CLolPlasma(pGameWorld, pParent, CurPos + vec2(x * g_Config.m_SvLoltextHspace, y * g_Config.m_SvLoltextVspace), Vel, Lifespan, (x + y) % 2 != 0);
 		CurPos.x += 4 * g_Config.m_SvLoltextHspace;
 	}
 }
\ No newline at end of file
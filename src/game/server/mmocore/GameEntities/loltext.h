@@ -10,12 +10,15 @@ class CLolPlasma : public CEntity
 	int m_StartTick; // tick created
 	vec2 m_StartOff; // initial offset from parent, for proper following
 	CEntity* m_pParent;
+	bool m_Detail; // far away clients see every other pixel
 
 public:
-	CLolPlasma(CGameWorld* pGameWorld, CEntity* pParent, vec2 Pos, vec2 Vel, int Lifespan);
+	CLolPlasma(CGameWorld* pGameWorld, CEntity* pParent, vec2 Pos, vec2 Vel, int Lifespan, bool Detail = false);
 
 	void Tick() override;
 	void Snap(int SnappingClient) override;
+	bool IsSnapShared(vec2* pClipTo) const override { return true; }
+	bool IsSnapDetail() const override { return m_Detail; }
 };
 
 class CLoltext
@@ -0,0 +1,108 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "Leaderboard.h"
+
+#include <engine/shared/config.h>
+#include <game/server/gamecontext.h>
+
+void CLeaderboard::OnTick()
+{
+	if(time_get() < ms_NextReconcile)
+		return;
+
+	ms_NextReconcile = time_get() + time_freq() * g_Config.m_SvLeaderboardReconcileTime;
+	Reconcile();
+}
+
+void CLeaderboard::Reconcile()
+{
+	const auto Load = [](ToplistType Type, const char* pName, const char* pValue, const char* pSubValue)
+	{
+		return [Type, pName, pValue, pSubValue](ResultPtr pRes)
+		{
+			std::vector<CEntry> vEntries;
+			while(pRes->next())
+				vEntries.push_back({ pRes->getInt("ID"), pRes->getString(pName).c_str(), pRes->getInt(pValue), pSubValue ? pRes->getInt(pSubValue) : 0 });
+			Replace(Type, std::move(vEntries));
+		};
+	};
+
+	Database->Prepare<DB::SELECT>("ID, Name, Level, Experience", "tw_guilds", "ORDER BY Level DESC, Experience DESC LIMIT %d", (int)MAX_ENTRIES)
+		->AtExecute(Load(ToplistType::GUILDS_LEVELING, "Name", "Level", "Experience"));
+	Database->Prepare<DB::SELECT>("ID, Name, Bank", "tw_guilds", "ORDER BY Bank DESC LIMIT %d", (int)MAX_ENTRIES)
+		->AtExecute(Load(ToplistType::GUILDS_WEALTHY, "Name", "Bank", nullptr));
+	Database->Prepare<DB::SELECT>("ID, Nick, Level, Exp", "tw_accounts_data", "ORDER BY Level DESC, Exp DESC LIMIT %d", (int)MAX_ENTRIES)
+		->AtExecute(Load(ToplistType::PLAYERS_LEVELING, "Nick", "Level", "Exp"));
+	Database->Prepare<DB::SELECT>("a.ID, a.Nick, i.Value", "tw_accounts_items AS i JOIN tw_accounts_data AS a ON a.ID = i.UserID",
+		"WHERE i.ItemID = '%d' ORDER BY i.Value DESC LIMIT %d", (ItemIdentifier)itGold, (int)MAX_ENTRIES)
+		->AtExecute(Load(ToplistType::PLAYERS_WEALTHY, "Nick", "Value", nullptr));
+}
+
+void CLeaderboard::Update(ToplistType Type, int ID, const char* pName, int Value, int SubValue)
+{
+	std::lock_guard Lock(ms_Lock);
+	std::vector<CEntry>& vEntries = ms_aTops[(int)Type];
+
+	// an entry that drops stays listed until the next reconcile, someone outside the list
+	// who is now ahead of it only takes its place by saving or by that reconcile
+	auto Iter = std::find_if(vEntries.begin(), vEntries.end(), [ID](const CEntry& Entry) { return Entry.m_ID == ID; });
+	if(Iter != vEntries.end())
+	{
+		Iter->m_Value = Value;
+		Iter->m_SubValue = SubValue;
+		Iter->m_Updated = time_get();
+	}
+	else
+	{
+		// outside of the list unless it beats the last entry
+		if((int)vEntries.size() >= MAX_ENTRIES)
+		{
+			const CEntry& Last = vEntries.back();
+			if(Value < Last.m_Value || (Value == Last.m_Value && SubValue <= Last.m_SubValue))
+				return;
+			vEntries.pop_back();
+		}
+		vEntries.push_back({ ID, pName, Value, SubValue, time_get() });
+	}
+	Sort(vEntries);
+}
+
+std::vector<CLeaderboard::CEntry> CLeaderboard::Get(ToplistType Type, int Limit)
+{
+	std::lock_guard Lock(ms_Lock);
+	const std::vector<CEntry>& vEntries = ms_aTops[(int)Type];
+	return std::vector<CEntry>(vEntries.begin(), vEntries.begin() + minimum(Limit, (int)vEntries.size()));
+}
+
+void CLeaderboard::Sort(std::vector<CEntry>& vEntries)
+{
+	std::stable_sort(vEntries.begin(), vEntries.end(), [](const CEntry& A, const CEntry& B)
+	{
+		return A.m_Value != B.m_Value ? A.m_Value > B.m_Value : A.m_SubValue > B.m_SubValue;
+	});
+}
+
+void CLeaderboard::Replace(ToplistType Type, std::vector<CEntry> vEntries)
+{
+	std::lock_guard Lock(ms_Lock);
+
+	// the rows can be older than the write-behind data of online players,
+	// entries they saved since the last reconcile keep their in-memory values
+	for(const CEntry& Entry : ms_aTops[(int)Type])
+	{
+		if(Entry.m_Updated <= ms_aReconciled[(int)Type])
+			continue;
+
+		auto Iter = std::find_if(vEntries.begin(), vEntries.end(), [&Entry](const CEntry& Row) { return Row.m_ID == Entry.m_ID; });
+		if(Iter != vEntries.end())
+			*Iter = Entry;
+		else
+			vEntries.push_back(Entry);
+	}
+
+	Sort(vEntries);
+	if((int)vEntries.size() > MAX_ENTRIES)
+		vEntries.resize(MAX_ENTRIES);
+	ms_aTops[(int)Type] = std::move(vEntries);
+	ms_aReconciled[(int)Type] = time_get();
+}
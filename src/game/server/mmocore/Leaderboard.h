@@ -0,0 +1,48 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_MMOCORE_LEADERBOARD_H
+#define GAME_SERVER_MMOCORE_LEADERBOARD_H
+
+#include <mutex>
+
+/*
+	Class: CLeaderboard
+		Top lists of every ToplistType kept in memory for all worlds.
+		Online players and guilds update their entries when they save,
+		the database is read again asynchronously from time to time to
+		pick up everything that changed offline.
+*/
+class CLeaderboard
+{
+public:
+	enum
+	{
+		// more entries than any list shows, so an entry that drops out is replaced without a query
+		MAX_ENTRIES = 32,
+	};
+
+	struct CEntry
+	{
+		int m_ID;
+		std::string m_Name;
+		int m_Value;
+		int m_SubValue;
+		int64_t m_Updated {};
+	};
+
+	static void OnTick();
+	static void Reconcile();
+	static void Update(ToplistType Type, int ID, const char* pName, int Value, int SubValue = 0);
+	static std::vector<CEntry> Get(ToplistType Type, int Limit);
+
+private:
+	static inline std::mutex ms_Lock {};
+	static inline std::vector<CEntry> ms_aTops[(int)ToplistType::NUM_TOPLIST_TYPES] {};
+	static inline int64_t ms_NextReconcile {};
+	static inline int64_t ms_aReconciled[(int)ToplistType::NUM_TOPLIST_TYPES] {};
+
+	static void Sort(std::vector<CEntry>& vEntries);
+	static void Replace(ToplistType Type, std::vector<CEntry> vEntries);
+};
+
+#endif
@@ -32,11 +32,16 @@ public:
 private:
 	virtual void OnInitWorld(const char* pWhereLocalWorld) {};
 	virtual void OnInit() {};
-	virtual void OnInitAccount(class CPlayer* pPlayer) {};
+	// the rows of OnAccountQuery are fetched on a SQL worker during the login and handed to OnInitAccount,
+	// it is called off the tick and must only format the query
+	virtual std::string OnAccountQuery(int AccountID) const { return {}; }
+	virtual void OnInitAccount(class CPlayer* pPlayer, ResultPtr pRes) {};
 	virtual void OnTick() {};
 	virtual void OnResetClient(int ClientID) {};
 	virtual bool OnMessage(int MsgID, void* pRawMsg, int ClientID) { return false; };
-	virtual bool OnHandleTile(class CCharacter* pChr, int IndexCollision) { return false; };
+	virtual void OnRegisterTiles() {};
+	virtual void OnHandleTileEnter(class CCharacter* pChr, int Tile) {};
+	virtual void OnHandleTileExit(class CCharacter* pChr, int Tile) {};
 	virtual bool OnHandleMenulist(class CPlayer* pPlayer, int Menulist, bool ReplaceMenu) { return false; };
 	virtual bool OnHandleVoteCommands(class CPlayer* pPlayer, const char* CMD, const int VoteID, const int VoteID2, int Get, const char* GetText) { return false; }
 	virtual void OnPlayerHandleTimePeriod(class CPlayer* pPlayer, TIME_PERIOD Period) { return; }
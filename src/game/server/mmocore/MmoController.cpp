@@ -6,6 +6,8 @@
 #include <game/server/gamecontext.h>
 #include <teeother/system/string.h>
 
+#include "Leaderboard.h"
+
 #include "Components/Accounts/AccountManager.h"
 #include "Components/Accounts/AccountMinerManager.h"
 #include "Components/Accounts/AccountPlantManager.h"
@@ -62,6 +64,7 @@ MmoController::MmoController(CGS* pGameServer) : m_pGameServer(pGameServer)
 		char aLocalSelect[64];
 		str_format(aLocalSelect, sizeof(aLocalSelect), "WHERE WorldID = '%d'", m_pGameServer->GetWorldID());
 		pComponent->OnInitWorld(aLocalSelect);
+		pComponent->OnRegisterTiles();
 	}
 }
 
@@ -90,14 +93,29 @@ bool MmoController::OnMessage(int MsgID, void* pRawMsg, int ClientID)
 	return false;
 }
 
-void MmoController::OnInitAccount(int ClientID)
+// one query per component in component order, called from a SQL worker
+std::vector<std::string> MmoController::PrepareAccountQueries(int AccountID) const
+{
+	std::vector<std::string> vQueries;
+	vQueries.reserve(m_Components.m_paComponents.size());
+	for(const auto* pComponent : m_Components.m_paComponents)
+		vQueries.push_back(pComponent->OnAccountQuery(AccountID));
+	return vQueries;
+}
+
+void MmoController::OnInitAccount(int ClientID, std::vector<ResultPtr>& vResults)
 {
 	CPlayer* pPlayer = GS()->GetPlayer(ClientID);
 	if(!pPlayer || !pPlayer->IsAuthed())
 		return;
 
+	size_t Index = 0;
 	for(auto& pComponent : m_Components.m_paComponents)
-		pComponent->OnInitAccount(pPlayer);
+	{
+		ResultPtr pRes = Index < vResults.size() ? std::move(vResults[Index]) : nullptr;
+		pComponent->OnInitAccount(pPlayer, std::move(pRes));
+		Index++;
+	}
 }
 
 bool MmoController::OnPlayerHandleMainMenu(int ClientID, int Menulist)
@@ -305,17 +323,28 @@ bool MmoController::OnPlayerHandleMainMenu(int ClientID, int Menulist)
 	return false;
 }
 
-bool MmoController::OnPlayerHandleTile(CCharacter* pChr, int IndexCollision)
+void MmoController::RegisterTile(int Index, MmoComponent* pComponent)
+{
+	dbg_assert(Index >= 0 && Index < MAX_TILES, "tile index out of range");
+	m_apTileHandlers[Index].push_back(pComponent);
+}
+
+void MmoController::OnPlayerHandleTile(CCharacter* pChr, int PrevTile, int Tile)
 {
 	if(!pChr || !pChr->IsAlive())
-		return true;
+		return;
 
-	for(auto& pComponent : m_Components.m_paComponents)
+	// maps may hold indices past the known tiles
+	if(PrevTile >= 0 && PrevTile < MAX_TILES)
 	{
-		if(pComponent->OnHandleTile(pChr, IndexCollision))
-			return true;
+		for(auto& pComponent : m_apTileHandlers[PrevTile])
+			pComponent->OnHandleTileExit(pChr, PrevTile);
+	}
+	if(Tile >= 0 && Tile < MAX_TILES)
+	{
+		for(auto& pComponent : m_apTileHandlers[Tile])
+			pComponent->OnHandleTileEnter(pChr, Tile);
 	}
-	return false;
 }
 
 bool MmoController::OnParsingVoteCommands(CPlayer* pPlayer, const char* CMD, const int VoteID, const int VoteID2, int Get, const char* GetText)
@@ -394,9 +423,12 @@ void MmoController::SaveAccount(CPlayer* pPlayer, int Table) const
 	if(Table == SAVE_STATS)
 	{
 		Database->Execute<DB::UPDATE>("tw_accounts_data", "Level = '%d', Exp = '%d' WHERE ID = '%d'", pAcc->GetLevel(), pAcc->GetExperience(), pAcc->GetID());
+		CLeaderboard::Update(ToplistType::PLAYERS_LEVELING, pAcc->GetID(), GS()->Server()->ClientName(pPlayer->GetCID()), pAcc->GetLevel(), pAcc->GetExperience());
 	}
 	else if(Table == SAVE_UPGRADES)
 	{
+		pPlayer->MarkAttributesDirty();
+
 		dynamic_string Buffer;
 		for(const auto& [ID, pAttribute] : CAttributeDescription::Data())
 		{
@@ -472,72 +504,24 @@ void MmoController::ShowLoadingProgress(const char* pLoading, int Size) const
 
 void MmoController::ShowTopList(int ClientID, ToplistType Type, bool ChatGlobalMode, int Limit) const
 {
-	if(Type == ToplistType::GUILDS_LEVELING)
+	int Rank = 0;
+	const bool LevelList = Type == ToplistType::GUILDS_LEVELING || Type == ToplistType::PLAYERS_LEVELING;
+	for(const CLeaderboard::CEntry& Entry : CLeaderboard::Get(Type, Limit))
 	{
-		ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_guilds", "ORDER BY Level DESC, Experience DESC LIMIT %d", Limit);
-		while(pRes->next())
+		Rank++;
+		if(LevelList)
 		{
-			char NameGuild[64];
-			const int Rank = pRes->getRow();
-			const int Level = pRes->getInt("Level");
-			const int Experience = pRes->getInt("Experience");
-			str_copy(NameGuild, pRes->getString("Name").c_str(), sizeof(NameGuild));
-
 			if(ChatGlobalMode)
-				GS()->Chat(-1, "{INT}. {STR} :: Level {INT} : Exp {INT}", Rank, NameGuild, Level, Experience);
+				GS()->Chat(-1, "{INT}. {STR} :: Level {INT} : Exp {INT}", Rank, Entry.m_Name.c_str(), Entry.m_Value, Entry.m_SubValue);
 			else
-				GS()->AVL(ClientID, "null", "{INT}. {STR} :: Level {INT} : Exp {INT}", Rank, NameGuild, Level, Experience);
+				GS()->AVL(ClientID, "null", "{INT}. {STR} :: Level {INT} : Exp {INT}", Rank, Entry.m_Name.c_str(), Entry.m_Value, Entry.m_SubValue);
 		}
-	}
-	else if(Type == ToplistType::GUILDS_WEALTHY)
-	{
-		ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_guilds", "ORDER BY Bank DESC LIMIT %d", Limit);
-		while(pRes->next())
-		{
-			char NameGuild[64];
-			const int Rank = pRes->getRow();
-			const int Gold = pRes->getInt("Bank");
-			str_copy(NameGuild, pRes->getString("Name").c_str(), sizeof(NameGuild));
-
-			if(ChatGlobalMode)
-				GS()->Chat(-1, "{INT}. {STR} :: Gold {VAL}", Rank, NameGuild, Gold);
-			else
-				GS()->AVL(ClientID, "null", "{INT}. {STR} :: Gold {VAL}", Rank, NameGuild, Gold);
-		}
-	}
-	else if(Type == ToplistType::PLAYERS_LEVELING)
-	{
-		ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_accounts_data", "ORDER BY Level DESC, Exp DESC LIMIT %d", Limit);
-		while(pRes->next())
-		{
-			char Nick[64];
-			const int Rank = pRes->getRow();
-			const int Level = pRes->getInt("Level");
-			const int Experience = pRes->getInt("Exp");
-			str_copy(Nick, pRes->getString("Nick").c_str(), sizeof(Nick));
-
-			if(ChatGlobalMode)
-				GS()->Chat(-1, "{INT}. {STR} :: Level {INT} : Exp {INT}", Rank, Nick, Level, Experience);
-			else
-				GS()->AVL(ClientID, "null", "{INT}. {STR} :: Level {INT} : Exp {INT}", Rank, Nick, Level, Experience);
-
-		}
-	}
-	else if(Type == ToplistType::PLAYERS_WEALTHY)
-	{
-		ResultPtr pRes = Database->Execute<DB::SELECT>("*", "tw_accounts_items", "WHERE ItemID = '%d' ORDER BY Value DESC LIMIT %d", (ItemIdentifier)itGold, Limit);
-		while(pRes->next())
+		else
 		{
-			char Nick[64];
-			const int Rank = pRes->getRow();
-			const int Gold = pRes->getInt("Value");
-			const int UserID = pRes->getInt("UserID");
-			str_copy(Nick, Instance::GetServer()->GetAccountNickname(UserID), sizeof(Nick));
-
 			if(ChatGlobalMode)
-				GS()->Chat(-1, "{INT}. {STR} :: Gold {VAL}", Rank, Nick, Gold);
+				GS()->Chat(-1, "{INT}. {STR} :: Gold {VAL}", Rank, Entry.m_Name.c_str(), Entry.m_Value);
 			else
-				GS()->AVL(ClientID, "null", "{INT}. {STR} :: Gold {VAL}", Rank, Nick, Gold);
+				GS()->AVL(ClientID, "null", "{INT}. {STR} :: Gold {VAL}", Rank, Entry.m_Name.c_str(), Entry.m_Value);
 		}
 	}
 }
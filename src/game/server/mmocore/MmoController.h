@@ -10,6 +10,9 @@
 */
 #include "MmoComponent.h"
 
+#include <game/mapitems.h>
+#include <vector>
+
 class MmoController
 {
 	class CStack
@@ -30,6 +33,7 @@ class MmoController
 		std::list < class MmoComponent *> m_paComponents;
 	};
 	CStack m_Components;
+	std::vector<class MmoComponent*> m_apTileHandlers[MAX_TILES];
 
 	class CAccountManager*m_pAccMain;
 	class CBotManager *m_pBotsInfo;
@@ -75,12 +79,16 @@ public:
 	CSkillManager* Skills() const { return m_pSkill; }
 	CWorldManager *WorldSwap() const { return m_pWorldSwap; }
 
+	// the component gets the enter and exit of the tile, called from OnRegisterTiles
+	void RegisterTile(int Index, MmoComponent* pComponent);
+
 	// global systems
 	void OnTick();
 	bool OnMessage(int MsgID, void* pRawMsg, int ClientID);
-	bool OnPlayerHandleTile(CCharacter *pChr, int IndexCollision);
+	void OnPlayerHandleTile(CCharacter *pChr, int PrevTile, int Tile);
 	bool OnPlayerHandleMainMenu(int ClientID, int Menulist);
-	void OnInitAccount(int ClientID);
+	std::vector<std::string> PrepareAccountQueries(int AccountID) const;
+	void OnInitAccount(int ClientID, std::vector<ResultPtr>& vResults);
 	bool OnParsingVoteCommands(CPlayer *pPlayer, const char *CMD, int VoteID, int VoteID2, int Get, const char *GetText);
 	void ResetClientData(int ClientID);
 	void HandlePlayerTimePeriod(CPlayer* pPlayer);
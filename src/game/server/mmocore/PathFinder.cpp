@@ -5,45 +5,67 @@
 #include <game/layers.h>
 #include <game/mapitems.h>
 
-CPathFinder::CPathFinder(CLayers* Layers, CCollision* Collision) : m_pLayers(Layers), m_pCollision(Collision)
+/*
+	Jump point search for a 4-connected grid. Straight runs are skipped
+	with word-wise scans over the blocked bit grid, only tiles where a
+	turn can be required (jump points) reach the open list.
+	The scratch buffers of a search are owned by the calling thread and
+	reset through a stamp, so several searches can run on the same map
+	at once without copying it.
+*/
+namespace
 {
-	m_ClosedNodes = 0;
-	m_FinalSize = 0;
-	m_StartIndex = -1;
-	m_EndIndex = -1;
+	struct CPathScratch
+	{
+		std::vector<unsigned> m_vStamp;
+		std::vector<unsigned> m_vClosed;
+		std::vector<int> m_vG;
+		std::vector<int> m_vParent;
+		std::vector<std::pair<int64_t, int>> m_vOpen;
+		unsigned m_Stamp = 0;
+
+		void Begin(int NumTiles)
+		{
+			if((int)m_vStamp.size() < NumTiles)
+			{
+				m_vStamp.resize(NumTiles, 0);
+				m_vClosed.resize(NumTiles, 0);
+				m_vG.resize(NumTiles);
+				m_vParent.resize(NumTiles);
+			}
 
-	m_LayerWidth = m_pLayers->GameLayer()->m_Width;
-	m_LayerHeight = m_pLayers->GameLayer()->m_Height;
+			// on wrap around, old stamps would look current
+			if(++m_Stamp == 0)
+			{
+				std::fill(m_vStamp.begin(), m_vStamp.end(), 0);
+				std::fill(m_vClosed.begin(), m_vClosed.end(), 0);
+				m_Stamp = 1;
+			}
+			m_vOpen.clear();
+		}
+	};
+
+	thread_local CPathScratch gs_PathScratch;
 
-	// set size for array
-	m_lMap.set_size(m_LayerWidth * m_LayerHeight);
-	m_lNodes.set_size(m_LayerWidth * m_LayerHeight);
-	m_lFinalPath.set_size(MAX_WAY_CALC);
+	inline int CountTrailingZeros(uint64_t Value) { return __builtin_ctzll(Value); }
+	inline int HighestBit(uint64_t Value) { return 63 - __builtin_clzll(Value); }
+}
 
-	// init size for heap
-	m_Open.SetSize(4 * MAX_WAY_CALC);
+CPathFinder::CPathFinder(CLayers* Layers, CCollision* Collision) : m_pLayers(Layers), m_pCollision(Collision)
+{
+	m_LayerWidth = m_pLayers->GameLayer()->m_Width;
+	m_LayerHeight = m_pLayers->GameLayer()->m_Height;
+	m_RowWords = (m_LayerWidth + 63) / 64;
 
-	int ID = 0;
+	// padding bits after the last column count as blocked, scans always stop there
+	m_vBlocked.assign((size_t)m_RowWords * m_LayerHeight, 0);
 	for(int i = 0; i < m_LayerHeight; i++)
 	{
-		for(int j = 0; j < m_LayerWidth; j++)
+		uint64_t* pRow = &m_vBlocked[(size_t)i * m_RowWords];
+		for(int j = 0; j < m_RowWords * 64; j++)
 		{
-			CNode Node;
-			Node.m_Pos = vec2(j, i);
-			Node.m_Parent = -1;
-			Node.m_ID = ID;
-			Node.m_G = 0;
-			Node.m_H = 0;
-			Node.m_F = 0;
-			Node.m_IsOpen = false;
-			if(m_pCollision->CheckPoint((float)j * 32.f + 16.f, (float)i * 32.f + 16.f))
-				Node.m_IsClosed = true;
-			else
-				Node.m_IsClosed = false;
-
-			// add the node to the list
-			m_lMap[i * m_LayerWidth + j] = Node;
-			ID++;
+			if(j >= m_LayerWidth || m_pCollision->CheckPoint((float)j * 32.f + 16.f, (float)i * 32.f + 16.f))
+				pRow[j >> 6] |= (uint64_t)1 << (j & 63);
 		}
 	}
 
@@ -53,40 +75,11 @@ CPathFinder::CPathFinder(CLayers* Layers, CCollision* Collision) : m_pLayers(Lay
 
 CPathFinder::~CPathFinder()
 {
-	m_lMap.clear();
-	m_lFinalPath.clear();
-	m_lNodes.clear();
-
 	// delete handler
 	delete m_pHandler;
 	m_pHandler = nullptr;
 }
 
-void CPathFinder::Init()
-{
-	m_ClosedNodes = 0;
-	m_FinalSize = 0;
-	m_Open.MakeEmpty();
-	m_lNodes = m_lMap;
-}
-
-void CPathFinder::SetStart(vec2 Pos)
-{
-	int Index = GetIndex(Pos.x, Pos.y);
-	m_lNodes[Index].m_Parent = START;
-	m_lNodes[Index].m_IsClosed = true;
-	m_ClosedNodes++;
-	m_StartIndex = Index;
-}
-
-void CPathFinder::SetEnd(vec2 Pos)
-{
-	int Index = GetIndex(Pos.x, Pos.y);
-	m_lNodes[Index].m_Parent = END;
-	m_EndIndex = Index;
-}
-
-
 int CPathFinder::GetIndex(int x, int y) const
 {
 	int Nx = clamp(x / 32, 0, m_LayerWidth - 1);
@@ -94,94 +87,227 @@ int CPathFinder::GetIndex(int x, int y) const
 	return Ny * m_LayerWidth + Nx;
 }
 
-void CPathFinder::FindPath()
+// scans the row from x in Dir, returns the x of the jump point or -1
+int CPathFinder::JumpHorizontal(int x, int y, int Dir, int GoalX, int GoalY) const
 {
-	int CurrentIndex = m_StartIndex;
-	if(m_StartIndex > -1 && m_EndIndex > -1)
+	if(x < 0 || x >= m_LayerWidth)
+		return -1;
+
+	// a tile is a jump point if a vertical neighbour opens up that was blocked one step back
+	int Stop;
+	if(Dir > 0)
 	{
-		while(m_ClosedNodes < MAX_WAY_CALC && m_lNodes[CurrentIndex].m_ID != m_EndIndex)
+		Stop = m_RowWords * 64;
+		for(int w = x >> 6; w < m_RowWords; w++)
 		{
-			// TODO ADD: offset by dist for corrects working with direction
-
-			const int neighborOffsets[/*8*/4] = { 1, -1, m_LayerWidth, -m_LayerWidth/*, m_LayerWidth + 1, -m_LayerWidth + 1, m_LayerWidth - 1, -m_LayerWidth - 1*/ };
-			for (const int neighborOffset : neighborOffsets)
+			const uint64_t Up = GetBlockedWord(y - 1, w);
+			const uint64_t Down = GetBlockedWord(y + 1, w);
+			const uint64_t UpBack = (Up << 1) | (GetBlockedWord(y - 1, w - 1) >> 63);
+			const uint64_t DownBack = (Down << 1) | (GetBlockedWord(y + 1, w - 1) >> 63);
+
+			uint64_t Mask = GetBlockedWord(y, w) | (~Up & UpBack) | (~Down & DownBack);
+			if(w == x >> 6)
+				Mask &= ~(uint64_t)0 << (x & 63);
+			if(Mask)
 			{
-				int WorkingIndex = CurrentIndex + neighborOffset;
-				if(WorkingIndex >= 0 && !m_lNodes[WorkingIndex].m_IsClosed)
-				{
-					CNode& WorkingNode = m_lNodes[WorkingIndex];
-					if(!WorkingNode.m_IsOpen)
-					{
-						WorkingNode.m_Parent = CurrentIndex;
-						WorkingNode.m_G = m_lNodes[CurrentIndex].m_G + 1;
-						WorkingNode.m_H = std::abs(WorkingNode.m_Pos.x - m_lNodes[m_EndIndex].m_Pos.x) + std::abs(WorkingNode.m_Pos.y - m_lNodes[m_EndIndex].m_Pos.y);
-						WorkingNode.m_F = WorkingNode.m_G + WorkingNode.m_H;
-						WorkingNode.m_IsOpen = true;
-
-						m_Open.Insert(WorkingNode);
-					}
-					else if(WorkingNode.m_G > m_lNodes[CurrentIndex].m_G + 1)
-					{
-						WorkingNode.m_Parent = CurrentIndex;
-						WorkingNode.m_G = m_lNodes[CurrentIndex].m_G + 1;
-						WorkingNode.m_F = WorkingNode.m_G + WorkingNode.m_H;
-
-						m_Open.Replace(WorkingNode);
-					}
-				}
+				Stop = w * 64 + CountTrailingZeros(Mask);
+				break;
 			}
+		}
 
-			if(m_Open.GetSize() < 1)
+		if(GoalY == y && GoalX >= x && GoalX < Stop)
+			return GoalX;
+	}
+	else
+	{
+		Stop = -1;
+		for(int w = x >> 6; w >= 0; w--)
+		{
+			const uint64_t Up = GetBlockedWord(y - 1, w);
+			const uint64_t Down = GetBlockedWord(y + 1, w);
+			const uint64_t UpBack = (Up >> 1) | (GetBlockedWord(y - 1, w + 1) << 63);
+			const uint64_t DownBack = (Down >> 1) | (GetBlockedWord(y + 1, w + 1) << 63);
+
+			uint64_t Mask = GetBlockedWord(y, w) | (~Up & UpBack) | (~Down & DownBack);
+			if(w == x >> 6 && (x & 63) != 63)
+				Mask &= ((uint64_t)1 << ((x & 63) + 1)) - 1;
+			if(Mask)
+			{
+				Stop = w * 64 + HighestBit(Mask);
 				break;
+			}
+		}
+
+		if(GoalY == y && GoalX <= x && GoalX > Stop)
+			return GoalX;
+	}
+
+	// outside of the map behaves like a wall
+	if(IsBlocked(Stop, y))
+		return -1;
+	return Stop;
+}
+
+// walks the column from y in Dir, returns the y of the jump point or -1
+int CPathFinder::JumpVertical(int x, int y, int Dir, int GoalX, int GoalY) const
+{
+	for(; !IsBlocked(x, y); y += Dir)
+	{
+		if(x == GoalX && y == GoalY)
+			return y;
+
+		// forced neighbours
+		if((!IsBlocked(x - 1, y) && IsBlocked(x - 1, y - Dir)) || (!IsBlocked(x + 1, y) && IsBlocked(x + 1, y - Dir)))
+			return y;
+
+		// a horizontal run from here leads to a jump point
+		if(JumpHorizontal(x + 1, y, 1, GoalX, GoalY) != -1 || JumpHorizontal(x - 1, y, -1, GoalX, GoalY) != -1)
+			return y;
+	}
+	return -1;
+}
+
+bool CPathFinder::FindPath(vec2 StartPos, vec2 EndPos, std::vector<vec2>& vPath) const
+{
+	vPath.clear();
+
+	const int StartIndex = GetIndex((int)StartPos.x, (int)StartPos.y);
+	const int EndIndex = GetIndex((int)EndPos.x, (int)EndPos.y);
+	const int GoalX = EndIndex % m_LayerWidth;
+	const int GoalY = EndIndex / m_LayerWidth;
+	if(StartIndex == EndIndex)
+		return true;
 
-			// get Lowest F from heap and set new CurrentIndex
-			CurrentIndex = m_Open.GetMin()->m_ID;
+	CPathScratch& Scratch = gs_PathScratch;
+	Scratch.Begin(m_LayerWidth * m_LayerHeight);
+	const unsigned Stamp = Scratch.m_Stamp;
 
-			// delete it \o/
-			m_Open.RemoveMin();
+	auto Heuristic = [&](int Index) { return absolute(Index % m_LayerWidth - GoalX) + absolute(Index / m_LayerWidth - GoalY); };
+	auto Push = [&](int Index, int G, int Parent)
+	{
+		if(Scratch.m_vStamp[Index] == Stamp && Scratch.m_vG[Index] <= G)
+			return;
+
+		Scratch.m_vStamp[Index] = Stamp;
+		Scratch.m_vG[Index] = G;
+		Scratch.m_vParent[Index] = Parent;
+
+		// lowest F first, on ties the one closer to the goal
+		const int H = Heuristic(Index);
+		Scratch.m_vOpen.emplace_back((int64_t)(G + H) << 32 | (uint32_t)H, Index);
+		std::push_heap(Scratch.m_vOpen.begin(), Scratch.m_vOpen.end(), std::greater<>());
+	};
+
+	Push(StartIndex, 0, -1);
+
+	int BestIndex = StartIndex;
+	int BestH = Heuristic(StartIndex);
+	int Expanded = 0;
+	bool Found = false;
+	while(!Scratch.m_vOpen.empty() && Expanded < MAX_WAY_CALC)
+	{
+		std::pop_heap(Scratch.m_vOpen.begin(), Scratch.m_vOpen.end(), std::greater<>());
+		const int Index = Scratch.m_vOpen.back().second;
+		Scratch.m_vOpen.pop_back();
+		if(Scratch.m_vClosed[Index] == Stamp)
+			continue;
 
-			// set the one with lowest score to closed list and begin new from there
-			m_lNodes[CurrentIndex].m_IsClosed = true;
-			m_ClosedNodes++;
+		Scratch.m_vClosed[Index] = Stamp;
+		Expanded++;
+
+		const int H = Heuristic(Index);
+		if(H < BestH)
+		{
+			BestH = H;
+			BestIndex = Index;
 		}
+		if(Index == EndIndex)
+		{
+			Found = true;
+			break;
+		}
+
+		// the neighbours to jump from depend on the direction we came from
+		const int x = Index % m_LayerWidth;
+		const int y = Index / m_LayerWidth;
+		const int Parent = Scratch.m_vParent[Index];
+		const int DirX = Parent < 0 ? 0 : clamp(x - Parent % m_LayerWidth, -1, 1);
+		const int DirY = Parent < 0 ? 0 : clamp(y - Parent / m_LayerWidth, -1, 1);
+		const int G = Scratch.m_vG[Index];
 
-		// go backwards and return final path :-O
-		while(m_lNodes[CurrentIndex].m_ID != m_StartIndex)
+		auto TryHorizontal = [&](int Dir)
+		{
+			const int JumpX = JumpHorizontal(x + Dir, y, Dir, GoalX, GoalY);
+			if(JumpX != -1)
+				Push(y * m_LayerWidth + JumpX, G + absolute(JumpX - x), Index);
+		};
+		auto TryVertical = [&](int Dir)
 		{
-			m_lFinalPath[m_FinalSize] = m_lNodes[CurrentIndex];
-			m_FinalSize++;
+			const int JumpY = JumpVertical(x, y + Dir, Dir, GoalX, GoalY);
+			if(JumpY != -1)
+				Push(JumpY * m_LayerWidth + x, G + absolute(JumpY - y), Index);
+		};
 
-			// get next node
-			CurrentIndex = m_lNodes[CurrentIndex].m_Parent;
+		if(DirX != 0)
+		{
+			TryHorizontal(DirX);
+			TryVertical(-1);
+			TryVertical(1);
+		}
+		else if(DirY != 0)
+		{
+			TryVertical(DirY);
+			TryHorizontal(-1);
+			TryHorizontal(1);
+		}
+		else
+		{
+			TryHorizontal(-1);
+			TryHorizontal(1);
+			TryVertical(-1);
+			TryVertical(1);
 		}
 	}
+
+	// go backwards over the jump points and fill in the straight runs between them
+	for(int Index = Found ? EndIndex : BestIndex; Index != StartIndex;)
+	{
+		const int Parent = Scratch.m_vParent[Index];
+		const int StepX = clamp(Parent % m_LayerWidth - Index % m_LayerWidth, -1, 1);
+		const int StepY = clamp(Parent / m_LayerWidth - Index / m_LayerWidth, -1, 1);
+		for(int Tile = Index; Tile != Parent; Tile += StepY * m_LayerWidth + StepX)
+			vPath.emplace_back((float)(Tile % m_LayerWidth) * 32.f + 16.f, (float)(Tile / m_LayerWidth) * 32.f + 16.f);
+		Index = Parent;
+	}
+	std::reverse(vPath.begin(), vPath.end());
+	return Found;
 }
 
-vec2 CPathFinder::GetRandomWaypoint()
+vec2 CPathFinder::GetRandomWaypoint() const
 {
-	array<vec2> lPossibleWaypoints;
+	std::vector<vec2> vPossibleWaypoints;
 	for(int i = 0; i < m_LayerHeight; i++)
 	{
 		for(int j = 0; j < m_LayerWidth; j++)
 		{
-			if(m_lMap[i * m_LayerWidth + j].m_IsClosed)
+			if(IsBlocked(j, i))
 				continue;
 
-			lPossibleWaypoints.add(m_lMap[i * m_LayerWidth + j].m_Pos);
+			vPossibleWaypoints.emplace_back(j, i);
 		}
 	}
 
-	if(lPossibleWaypoints.size())
+	if(!vPossibleWaypoints.empty())
 	{
-		int Rand = secure_rand() % lPossibleWaypoints.size();
-		return lPossibleWaypoints[Rand];
+		int Rand = secure_rand() % (int)vPossibleWaypoints.size();
+		return vPossibleWaypoints[Rand];
 	}
 	return vec2(0, 0);
 }
 
-vec2 CPathFinder::GetRandomWaypointRadius(vec2 Pos, float Radius)
+vec2 CPathFinder::GetRandomWaypointRadius(vec2 Pos, float Radius) const
 {
-	array<vec2> lPossibleWaypoints;
+	std::vector<vec2> vPossibleWaypoints;
 	float Range = (Radius / 2.0f);
 	int StartX = clamp((int)((Pos.x - Range) / 32.0f), 0, m_LayerWidth - 1);
 	int StartY = clamp((int)((Pos.y - Range) / 32.0f), 0, m_LayerHeight - 1);
@@ -192,69 +318,125 @@ vec2 CPathFinder::GetRandomWaypointRadius(vec2 Pos, float Radius)
 	{
 		for(int j = StartX; j < EndX; j++)
 		{
-			if(m_lMap[i * m_LayerWidth + j].m_IsClosed)
+			if(IsBlocked(j, i))
 				continue;
 
-			lPossibleWaypoints.add(m_lMap[i * m_LayerWidth + j].m_Pos);
+			vPossibleWaypoints.emplace_back(j, i);
 		}
 	}
 
-	if(lPossibleWaypoints.size())
+	if(!vPossibleWaypoints.empty())
 	{
-		int Rand = secure_rand() % lPossibleWaypoints.size();
-		return lPossibleWaypoints[Rand];
+		int Rand = secure_rand() % (int)vPossibleWaypoints.size();
+		return vPossibleWaypoints[Rand];
 	}
 	return vec2(0, 0);
 }
 
 /*
  * CHandler
- * - Synchronized path search in a separate thread pool
+ * - Synchronized path search on the scheduler workers
  */
 
 CPathFinderPrepared::CData CPathFinder::CHandler::CallbackFindPath(const std::shared_ptr<HandleArgsPack>& pHandleData)
 {
 	HandleArgsPack* pHandle = pHandleData.get();
+	CHandler* pHandler = pHandle->m_PathFinder->m_pHandler;
+	pHandler->m_QueueDepth--;
 
-	if(pHandle && pHandle->IsValid() && !is_negative_vec(pHandle->m_StartFrom) && !is_negative_vec(pHandle->m_Search))
+	if(pHandle->IsValid() && !is_negative_vec(pHandle->m_StartFrom) && !is_negative_vec(pHandle->m_Search))
 	{
-		// guard element, path finder working only with one item TODO: rework
-		std::lock_guard QueueLock { pHandle->m_PathFinder->m_mtxLimitedOnceUse };
-
-		const vec2 StartPos = pHandle->m_StartFrom;
-		const vec2 SearchPos = pHandle->m_Search;
-		CPathFinder* pPathFinder = pHandle->m_PathFinder;
-
-		// path finder working
-		pPathFinder->Init();
-		pPathFinder->SetStart(StartPos);
-		pPathFinder->SetEnd(SearchPos);
-		pPathFinder->FindPath();
+		// path finder working, searches on the same map may run at the same time
+		std::vector<vec2> vPath;
+		pHandle->m_PathFinder->FindPath(pHandle->m_StartFrom, pHandle->m_Search, vPath);
 
 		// initilize for future data
 		CPathFinderPrepared::CData Data;
 		Data.m_Type = CPathFinderPrepared::DEFAULT;
-		Data.m_Points.reserve(pPathFinder->m_FinalSize);
-		for(int i = pPathFinder->m_FinalSize - 1, j = 0; i >= 0; i--, j++)
-		{
-			Data.m_Points[j] = vec2(pPathFinder->m_lFinalPath[i].m_Pos.x * 32 + 16, pPathFinder->m_lFinalPath[i].m_Pos.y * 32 + 16);
-		}
+		Data.m_Points.reserve(vPath.size());
+		for(int i = 0; i < (int)vPath.size(); i++)
+			Data.m_Points[i] = vPath[i];
 
+		pHandler->StorePath(pHandle->m_Key, Data);
 		return Data;
 	}
 
 	return {};
 }
 
+std::shared_future<CPathFinderPrepared::CData> CPathFinder::CHandler::PrepareFindPath(vec2 StartPos, vec2 SearchPos)
+{
+	if(is_negative_vec(StartPos) || is_negative_vec(SearchPos))
+	{
+		std::promise<CPathFinderPrepared::CData> Empty;
+		Empty.set_value({});
+		return Empty.get_future().share();
+	}
+
+	const int StartIndex = m_pPathFinder->GetIndex((int)StartPos.x, (int)StartPos.y);
+	const int EndIndex = m_pPathFinder->GetIndex((int)SearchPos.x, (int)SearchPos.y);
+	const uint64_t Key = (uint64_t)StartIndex << 32 | (uint32_t)EndIndex;
+
+	std::lock_guard Lock(m_CacheLock);
+
+	// finished before, the entry moves to the front
+	if(auto Iter = m_CacheIndex.find(Key); Iter != m_CacheIndex.end())
+	{
+		m_lCache.splice(m_lCache.begin(), m_lCache, Iter->second);
+		m_Hits++;
+
+		std::promise<CPathFinderPrepared::CData> Cached;
+		Cached.set_value(Iter->second->m_Data);
+		return Cached.get_future().share();
+	}
+
+	// the same search is still in the pool
+	if(auto Iter = m_InFlight.find(Key); Iter != m_InFlight.end())
+	{
+		m_Coalesced++;
+		return Iter->second;
+	}
+
+	m_Misses++;
+	auto Handle = std::make_shared<HandleArgsPack>(HandleArgsPack({ m_pPathFinder, StartPos, SearchPos, 0.0f, Key }));
+	const int Depth = ++m_QueueDepth;
+	if(Depth > m_MaxQueueDepth)
+		m_MaxQueueDepth = Depth;
+
+	auto Future = CScheduler::Get().Submit(CScheduler::PRIORITY_TICK, [Handle]() { return CallbackFindPath(Handle); }).share();
+	m_InFlight[Key] = Future;
+	return Future;
+}
+
+void CPathFinder::CHandler::StorePath(uint64_t Key, const CPathFinderPrepared::CData& Data)
+{
+	std::lock_guard Lock(m_CacheLock);
+	m_InFlight.erase(Key);
+
+	if(m_CacheIndex.count(Key))
+		return;
+
+	m_lCache.push_front({ Key, Data });
+	m_CacheIndex[Key] = m_lCache.begin();
+	if((int)m_lCache.size() > MAX_CACHED_PATHS)
+	{
+		m_CacheIndex.erase(m_lCache.back().m_Key);
+		m_lCache.pop_back();
+	}
+}
+
+int CPathFinder::CHandler::GetCachedPaths()
+{
+	std::lock_guard Lock(m_CacheLock);
+	return (int)m_lCache.size();
+}
+
 CPathFinderPrepared::CData CPathFinder::CHandler::CallbackRandomRadiusWaypoint(const std::shared_ptr<HandleArgsPack>& pHandleData)
 {
 	HandleArgsPack* pHandle = pHandleData.get();
 
 	if(pHandle && pHandle->IsValid() && !is_negative_vec(pHandle->m_StartFrom))
 	{
-		// guard element, path finder working only with one item TODO: rework
-		std::lock_guard QueueLock { pHandle->m_PathFinder->m_mtxLimitedOnceUse };
-
 		const vec2 StartPos = pHandle->m_StartFrom;
 
 		// path finder working
@@ -1,8 +1,8 @@
 #ifndef GAME_PATHFIND_H
 #define GAME_PATHFIND_H
 
+#include <engine/shared/scheduler.h>
 #include <game/layers.h>
-#include "BinaryHeap.h"
 
 #include "PathFinderData.h"
 
@@ -11,7 +11,7 @@
 /*
  * Example:
  * The handler works in sync while not restricting the main thread
- * Handler has its own pool with the number of threads, threads are static regardless of the number of instances of the class
+ * Handler runs the searches as tick priority tasks of the engine scheduler, shared by all instances of the class
  * To use it, first set the task with Prepare, when ready TryGetPrepared will return the data that can be worked with.
  * There is no danger of working with unprepared data.
  */
@@ -22,7 +22,6 @@ class CPathFinder
 	// handler
 	class CHandler
 	{
-		inline static ThreadPool m_Pool { 4 };
 		CPathFinder* m_pPathFinder;
 
 		struct HandleArgsPack
@@ -31,6 +30,7 @@ class CPathFinder
 			vec2 m_StartFrom {};
 			vec2 m_Search {};
 			float m_Radius {};
+			uint64_t m_Key {};
 
 			[[nodiscard]] bool IsValid() const
 			{
@@ -41,6 +41,31 @@ class CPathFinder
 		static CPathFinderPrepared::CData CallbackFindPath(const ::std::shared_ptr<HandleArgsPack>& pHandleData);
 		static CPathFinderPrepared::CData CallbackRandomRadiusWaypoint(const ::std::shared_ptr<HandleArgsPack>& pHandleData);
 
+		// finished paths by (start tile, goal tile), the front of the list is the most recently used,
+		// the collision of a world never changes after it is loaded so the entries never go stale
+		enum
+		{
+			MAX_CACHED_PATHS = 512,
+		};
+		struct CCachedPath
+		{
+			uint64_t m_Key;
+			CPathFinderPrepared::CData m_Data;
+		};
+		std::mutex m_CacheLock;
+		std::list<CCachedPath> m_lCache;
+		ska::unordered_map<uint64_t, std::list<CCachedPath>::iterator> m_CacheIndex;
+		ska::unordered_map<uint64_t, std::shared_future<CPathFinderPrepared::CData>> m_InFlight;
+
+		std::atomic<uint64_t> m_Hits {};
+		std::atomic<uint64_t> m_Misses {};
+		std::atomic<uint64_t> m_Coalesced {};
+		std::atomic<int> m_QueueDepth {};
+		std::atomic<int> m_MaxQueueDepth {};
+
+		std::shared_future<CPathFinderPrepared::CData> PrepareFindPath(vec2 StartPos, vec2 SearchPos);
+		void StorePath(uint64_t Key, const CPathFinderPrepared::CData& Data);
+
 	public:
 		explicit CHandler(CPathFinder* pPathFinder) : m_pPathFinder(pPathFinder) {}
 
@@ -48,31 +73,38 @@ class CPathFinder
 		// The type template parameter determines the type of search to be performed.
 		// The function returns true if the preparation is starting, meaning that a new future task is created.
 		// Otherwise, it returns false, indicating that the preparation is already in progress.
+		// Paths are answered from the cache when possible, equal searches already in the pool are shared.
 		template<CPathFinderPrepared::Type type>
-		bool Prepare(CPathFinderPrepared* pPrepare, vec2 StartPos, vec2 SearchPos, float Radius = 800.0f) const
+		bool Prepare(CPathFinderPrepared* pPrepare, vec2 StartPos, vec2 SearchPos, float Radius = 800.0f)
 		{
 			bool StartingPrepare = !pPrepare->m_FutureData.valid();
 
 			// Check if the preparation is starting
 			if(StartingPrepare)
 			{
-				// Create a shared pointer to a HandleArgsPack object with the necessary arguments for the callback function
-				auto Handle = std::make_shared<HandleArgsPack>(HandleArgsPack({ m_pPathFinder, StartPos, SearchPos, Radius }));
-
 				// Enqueue a future task based on the type of search
 				if constexpr(type == CPathFinderPrepared::Type::RANDOM)
 				{
-					pPrepare->m_FutureData = m_Pool.enqueue(&CallbackRandomRadiusWaypoint, Handle);
+					// Create a shared pointer to a HandleArgsPack object with the necessary arguments for the callback function
+					auto Handle = std::make_shared<HandleArgsPack>(HandleArgsPack({ m_pPathFinder, StartPos, SearchPos, Radius }));
+					pPrepare->m_FutureData = CScheduler::Get().Submit(CScheduler::PRIORITY_TICK, [Handle]() { return CallbackRandomRadiusWaypoint(Handle); }).share();
 				}
 				else
 				{
-					pPrepare->m_FutureData = m_Pool.enqueue(&CallbackFindPath, Handle);
+					pPrepare->m_FutureData = PrepareFindPath(StartPos, SearchPos);
 				}
 			}
 
 			return StartingPrepare;
 		}
 
+		uint64_t GetCacheHits() const { return m_Hits; }
+		uint64_t GetCacheMisses() const { return m_Misses; }
+		uint64_t GetCoalesced() const { return m_Coalesced; }
+		int GetQueueDepth() const { return m_QueueDepth; }
+		int GetMaxQueueDepth() const { return m_MaxQueueDepth; }
+		int GetCachedPaths();
+
 		// Function: TryGetPreparedData
 		// Returns: bool
 		// Parameters:
@@ -94,68 +126,47 @@ public:
 	CPathFinder(CLayers* Layers, class CCollision* Collision);
 	~CPathFinder();
 
-	struct CNode
-	{
-		vec2 m_Pos;
-		int m_Parent;
-		int m_ID;
-
-		// Declare a variable to store the cost from the start node to the current node (G value)
-		int m_G;
-
-		// Declare a variable to store the estimated cost from the current node to the goal node (H value)
-		int m_H;
-
-		// Declare a variable to store the total cost of the node (F value)
-		int m_F;
-
-		bool m_IsClosed;
-		bool m_IsOpen;
-
-		bool operator<(const CNode& Other) const { return (this->m_F < Other.m_F); }
-		bool operator==(const CNode& Other) const { return (this->m_ID == Other.m_ID); }
-	};
-
-	void Init();
-	void SetStart(vec2 Pos);
-	void SetEnd(vec2 Pos);
-
-	std::mutex m_mtxLimitedOnceUse;
 	int GetIndex(int x, int y) const;
 	CHandler* Handle() const { return m_pHandler; }
+	int GetWidth() const { return m_LayerWidth; }
+	int GetHeight() const { return m_LayerHeight; }
 
-	vec2 GetRandomWaypoint();
-	vec2 GetRandomWaypointRadius(vec2 Pos, float Radius);
-
-	void FindPath();
+	vec2 GetRandomWaypoint() const;
+	vec2 GetRandomWaypointRadius(vec2 Pos, float Radius) const;
 
-	array<CNode> m_lMap;
-	array<CNode> m_lFinalPath;
+	// Function: FindPath
+	// Jump point search over the blocked tiles bit grid, safe to call from several threads at once.
+	// Fills vPath with the tile centers after StartPos up to EndPos. If EndPos can not be reached
+	// within MAX_WAY_CALC expanded jump points, the path leads to the closest tile that was reached.
+	// Returns true if EndPos was reached.
+	bool FindPath(vec2 StartPos, vec2 EndPos, std::vector<vec2>& vPath) const;
 
-	int m_FinalSize;
 private:
-	enum
-	{
-		START = -3,
-		END = -4,
-	};
-
 	CLayers* m_pLayers;
 	CCollision* m_pCollision;
 
-	array<CNode> m_lNodes;
-
-	// binary heap for open nodes
-	CBinaryHeap<CNode> m_Open;
-
-	int m_StartIndex;
-	int m_EndIndex;
-
 	int m_LayerWidth;
 	int m_LayerHeight;
 
-	// fake array sizes
-	int m_ClosedNodes;
+	// one bit per tile, padding bits after the last column are blocked
+	int m_RowWords;
+	std::vector<uint64_t> m_vBlocked;
+
+	bool IsBlocked(int x, int y) const
+	{
+		if(x < 0 || y < 0 || x >= m_LayerWidth || y >= m_LayerHeight)
+			return true;
+		return (m_vBlocked[y * m_RowWords + (x >> 6)] >> (x & 63)) & 1;
+	}
+	uint64_t GetBlockedWord(int y, int Word) const
+	{
+		if(y < 0 || y >= m_LayerHeight || Word < 0 || Word >= m_RowWords)
+			return ~(uint64_t)0;
+		return m_vBlocked[y * m_RowWords + Word];
+	}
+
+	int JumpHorizontal(int x, int y, int Dir, int GoalX, int GoalY) const;
+	int JumpVertical(int x, int y, int Dir, int GoalX, int GoalY) const;
 };
 
 #endif
@@ -103,7 +103,7 @@ public:
 
 private:
 	CData m_Data {};
-	std::future<CData> m_FutureData {};
+	std::shared_future<CData> m_FutureData {};
 };
 
 #endif
\ No newline at end of file
@@ -2,21 +2,13 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include "TileHandle.h"
 
-bool TileHandle::TileEnter(int IndexPlayer, int IndexNeed)
+bool TileHandle::Update(int Tile)
 {
-	if(IndexPlayer == IndexNeed && !m_Collide[IndexNeed])
+	m_Changed = Tile != m_Tile;
+	if(m_Changed)
 	{
-		m_Collide[IndexNeed] = true;
-		return true;
+		m_PrevTile = m_Tile;
+		m_Tile = Tile;
 	}
-	return false;
+	return m_Changed;
 }
-bool TileHandle::TileExit(int IndexPlayer, int IndexNeed)
-{
-	if(IndexPlayer != IndexNeed && m_Collide[IndexNeed])
-	{
-		m_Collide[IndexNeed] = false;
-		return true;
-	}
-	return false;
-}
\ No newline at end of file
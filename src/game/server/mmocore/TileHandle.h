@@ -12,15 +12,22 @@
 
 class TileHandle
 {
-	bool m_Collide[MAX_TILES]{};
+	int m_Tile { TILE_AIR };
+	int m_PrevTile { TILE_AIR };
+	bool m_Changed {};
 
 public:
 	TileHandle() = default;
 
-	// tiles
-	bool TileEnter(int IndexPlayer, int IndexNeed);
-	bool TileExit(int IndexPlayer, int IndexNeed);
-	bool BoolIndex(int Index) const { return m_Collide[Index]; }
+	// takes the tile under the character once per tick, returns true when it differs from the last one
+	bool Update(int Tile);
+	int GetTile() const { return m_Tile; }
+	int GetPrevTile() const { return m_PrevTile; }
+
+	// tiles, enter and exit are only true on the tick the tile changed
+	bool TileEnter(int Index) const { return m_Changed && m_Tile == Index; }
+	bool TileExit(int Index) const { return m_Changed && m_PrevTile == Index; }
+	bool BoolIndex(int Index) const { return m_Tile == Index; }
 };
 
 #endif
@@ -0,0 +1,102 @@
+#ifndef GAME_SERVER_MMOCORE_UTILS_DENSE_TABLE_H
+#define GAME_SERVER_MMOCORE_UTILS_DENSE_TABLE_H
+
+#include <deque>
+#include <type_traits>
+#include <vector>
+
+/*
+	Class: CDenseTable
+		Per-player records addressed by a small integer ID. Records are
+		stored back to back and never move, so pointers to them stay
+		valid. The ID index is a flat array and iteration walks an
+		ID-ordered array of pointers.
+
+		TSideIndex, when given, has a static Check(const T&) that picks the
+		records also listed by GetSideIndex(). It is checked when a record
+		is first inserted.
+*/
+template<typename T, typename TSideIndex = void>
+class CDenseTable
+{
+	std::deque<T> m_Storage {};
+	std::vector<int> m_aIndex {}; // ID -> position in m_Storage + 1, 0 for none
+	std::vector<T*> m_vOrdered {};
+	std::vector<T*> m_vSideIndex {};
+
+	static void InsertOrdered(std::vector<T*>& vList, T* pRecord)
+	{
+		// records mostly arrive in ascending order
+		auto Iter = vList.end();
+		while(Iter != vList.begin() && (*(Iter - 1))->GetID() > pRecord->GetID())
+			--Iter;
+		vList.insert(Iter, pRecord);
+	}
+
+public:
+	template<typename TValue>
+	class CIterator
+	{
+		typename std::vector<T*>::const_iterator m_Iter;
+
+	public:
+		explicit CIterator(typename std::vector<T*>::const_iterator Iter) : m_Iter(Iter) {}
+		TValue& operator*() const { return **m_Iter; }
+		TValue* operator->() const { return *m_Iter; }
+		CIterator& operator++() { ++m_Iter; return *this; }
+		bool operator!=(const CIterator& Other) const { return m_Iter != Other.m_Iter; }
+		bool operator==(const CIterator& Other) const { return m_Iter == Other.m_Iter; }
+	};
+
+	T* Find(int ID)
+	{
+		if(ID < 0 || ID >= (int)m_aIndex.size() || !m_aIndex[ID])
+			return nullptr;
+		return &m_Storage[m_aIndex[ID] - 1];
+	}
+
+	const T* Find(int ID) const { return const_cast<CDenseTable*>(this)->Find(ID); }
+
+	// copies the record in, the existing one keeps its address
+	T& Insert(int ID, const T& Record)
+	{
+		if(T* pRecord = Find(ID))
+		{
+			*pRecord = Record;
+			return *pRecord;
+		}
+
+		if(ID >= (int)m_aIndex.size())
+			m_aIndex.resize(ID + 1, 0);
+		T& NewRecord = m_Storage.emplace_back(Record);
+		m_aIndex[ID] = (int)m_Storage.size();
+
+		InsertOrdered(m_vOrdered, &NewRecord);
+		if constexpr(!std::is_void_v<TSideIndex>)
+		{
+			if(TSideIndex::Check(NewRecord))
+				InsertOrdered(m_vSideIndex, &NewRecord);
+		}
+		return NewRecord;
+	}
+
+	const std::vector<T*>& GetSideIndex() const { return m_vSideIndex; }
+	int size() const { return (int)m_Storage.size(); }
+	bool empty() const { return m_Storage.empty(); }
+
+	void clear()
+	{
+		m_vSideIndex.clear();
+		m_vOrdered.clear();
+		m_aIndex.clear();
+		m_Storage.clear();
+	}
+
+	// ascending IDs
+	CIterator<T> begin() { return CIterator<T>(m_vOrdered.cbegin()); }
+	CIterator<T> end() { return CIterator<T>(m_vOrdered.cend()); }
+	CIterator<const T> begin() const { return CIterator<const T>(m_vOrdered.cbegin()); }
+	CIterator<const T> end() const { return CIterator<const T>(m_vOrdered.cend()); }
+};
+
+#endif
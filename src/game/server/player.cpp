@@ -23,7 +23,7 @@ MACRO_ALLOC_POOL_ID_IMPL(CPlayer, MAX_CLIENTS* ENGINE_MAX_WORLDS + MAX_CLIENTS)
 
 IServer* CPlayer::Server() const { return m_pGS->Server(); };
 
-CPlayer::CPlayer(CGS* pGS, int ClientID) : m_pGS(pGS), m_ClientID(ClientID)
+CPlayer::CPlayer(CGS* pGS, int ClientID) : m_pGS(pGS), m_ClientID(ClientID), m_IsBot(false), m_AttributesDirty(true)
 {
 	for(short& SortTab : m_aSortTabs)
 		SortTab = -1;
@@ -232,7 +232,9 @@ void CPlayer::TryCreateEidolon()
 	{
 		if(const int EidolonCID = GS()->CreateBot(TYPE_BOT_EIDOLON, pEidolonData->GetDataBotID(), m_ClientID); EidolonCID != -1)
 		{
-			dynamic_cast<CPlayerBot*>(GS()->m_apPlayers[EidolonCID])->m_EidolonItemID = EidolonItemID;
+			CPlayerBot* pEidolon = dynamic_cast<CPlayerBot*>(GS()->m_apPlayers[EidolonCID]);
+			pEidolon->m_EidolonItemID = EidolonItemID;
+			pEidolon->MarkAttributesDirty();
 			m_EidolonCID = EidolonCID;
 		}
 	}
@@ -258,21 +260,13 @@ void CPlayer::TryRemoveEidolon()
 
 void CPlayer::HandleEffects()
 {
-	if(Server()->Tick() % Server()->TickSpeed() != 0 || CGS::ms_aEffects[m_ClientID].empty())
+	if(Server()->Tick() % Server()->TickSpeed() != 0 || CGS::ms_aEffects[m_ClientID].IsEmpty())
 		return;
 
-	for(auto pEffect = CGS::ms_aEffects[m_ClientID].begin(); pEffect != CGS::ms_aEffects[m_ClientID].end();)
+	CGS::ms_aEffects[m_ClientID].Tick([this](int EffectID)
 	{
-		pEffect->second--;
-		if(pEffect->second <= 0)
-		{
-			GS()->Chat(m_ClientID, "You lost the {STR} effect.", pEffect->first.c_str());
-			pEffect = CGS::ms_aEffects[m_ClientID].erase(pEffect);
-			continue;
-		}
-
-		++pEffect;
-	}
+		GS()->Chat(m_ClientID, "You lost the {STR} effect.", CEffects::GetName(EffectID));
+	});
 }
 
 void CPlayer::HandleScoreboardColors()
@@ -815,27 +809,27 @@ bool CPlayer::Upgrade(int Value, int* Upgrade, int* Useless, int Price, int Maxi
 /* #########################################################################
 	FUNCTIONS PLAYER ACCOUNT
 ######################################################################### */
-void CPlayer::GiveEffect(const char* Potion, int Sec, float Chance)
+void CPlayer::GiveEffect(int EffectID, int Sec, float Chance)
 {
 	if(m_pCharacter && m_pCharacter->IsAlive())
 	{
 		const float RandomChance = random_float(100.0f);
 		if(RandomChance < Chance)
 		{
-			GS()->Chat(m_ClientID, "You got the effect {STR} time {INT} seconds.", Potion, Sec);
-			CGS::ms_aEffects[m_ClientID][Potion] = Sec;
+			GS()->Chat(m_ClientID, "You got the effect {STR} time {INT} seconds.", CEffects::GetName(EffectID), Sec);
+			CGS::ms_aEffects[m_ClientID].Give(EffectID, Sec);
 		}
 	}
 }
 
-bool CPlayer::IsActiveEffect(const char* Potion) const
+bool CPlayer::IsActiveEffect(int EffectID) const
 {
-	return CGS::ms_aEffects[m_ClientID].count(Potion) > 0;
+	return CGS::ms_aEffects[m_ClientID].IsActive(EffectID);
 }
 
 void CPlayer::ClearEffects()
 {
-	CGS::ms_aEffects[m_ClientID].clear();
+	CGS::ms_aEffects[m_ClientID].Clear();
 }
 
 const char* CPlayer::GetLanguage() const
@@ -843,6 +837,11 @@ const char* CPlayer::GetLanguage() const
 	return Server()->GetClientLanguage(m_ClientID);
 }
 
+int CPlayer::GetLanguageIndex() const
+{
+	return Server()->GetClientLanguageIndex(m_ClientID);
+}
+
 void CPlayer::UpdateTempData(int Health, int Mana)
 {
 	GetTempData().m_TempHealth = Health;
@@ -1026,13 +1025,12 @@ CPlayerItem* CPlayer::GetItem(ItemIdentifier ID)
 {
 	dbg_assert(CItemDescription::Data().find(ID) != CItemDescription::Data().end(), "invalid referring to the CPlayerItem");
 
-	if(CPlayerItem::Data()[m_ClientID].find(ID) == CPlayerItem::Data()[m_ClientID].end())
-	{
-		CPlayerItem(ID, m_ClientID).Init({}, {}, {}, {});
-		return &CPlayerItem::Data()[m_ClientID][ID];
-	}
+	CPlayerItemsTable& Items = CPlayerItem::Data()[m_ClientID];
+	if(CPlayerItem* pItem = Items.Find(ID))
+		return pItem;
 
-	return &CPlayerItem::Data()[m_ClientID][ID];
+	CPlayerItem(ID, m_ClientID).Init({}, {}, {}, {});
+	return Items.Find(ID);
 }
 
 CSkill* CPlayer::GetSkill(SkillIdentifier ID)
@@ -1064,15 +1062,14 @@ CPlayerQuest* CPlayer::GetQuest(QuestIdentifier ID)
 // This function returns the ID of the equipped item with the specified functionality, excluding the specified item ID.
 int CPlayer::GetEquippedItemID(ItemFunctional EquipID, int SkipItemID) const
 {
-	// Iterate through each item
-	const auto& playerItems = CPlayerItem::Data()[m_ClientID];
-	for(const auto& [itemID, item] : playerItems)
+	// Iterate through each item that can be equipped
+	for(const CPlayerItem* pItem : CPlayerItem::Data()[m_ClientID].GetSideIndex())
 	{
 		// Check if the item has an item and is equipped and has the specified functionality and is not the excluded item
-		if(item.HasItem() && item.IsEquipped() && item.Info()->IsFunctional(EquipID) && itemID != SkipItemID)
+		if(pItem->HasItem() && pItem->IsEquipped() && pItem->Info()->IsFunctional(EquipID) && pItem->GetID() != SkipItemID)
 		{
 			// Return the item ID
-			return itemID;
+			return pItem->GetID();
 		}
 	}
 
@@ -1082,29 +1079,53 @@ int CPlayer::GetEquippedItemID(ItemFunctional EquipID, int SkipItemID) const
 
 int CPlayer::GetAttributeSize(AttributeIdentifier ID)
 {
+	ms_AttributeLookups.fetch_add(1, std::memory_order_relaxed);
+	if(ID < AttributeIdentifier::SpreadShotgun || ID >= AttributeIdentifier::ATTRIBUTES_NUM)
+		return 0;
+
+	if(m_AttributesDirty)
+		UpdateAttributesSheet();
+
 	// if the best tank class is selected among the players we return the sync dungeon stats
-	const CAttributeDescription* pAtt = GS()->GetAttributeInfo(ID);
-	if(GS()->IsDungeon() && pAtt->GetUpgradePrice() < 4 && CDungeonData::ms_aDungeon[GS()->GetDungeonID()].IsDungeonPlaying())
+	if(m_aAttributesDungeonSync[(int)ID] && GS()->IsDungeon() && CDungeonData::ms_aDungeon[GS()->GetDungeonID()].IsDungeonPlaying())
 	{
 		const CGameControllerDungeon* pDungeon = dynamic_cast<CGameControllerDungeon*>(GS()->m_pController);
 		return pDungeon->GetAttributeDungeonSync(this, ID);
 	}
 
+	return m_aAttributesSheet[(int)ID];
+}
+
+void CPlayer::UpdateAttributesSheet()
+{
+	ms_AttributeRebuilds.fetch_add(1, std::memory_order_relaxed);
+	m_AttributesDirty = false;
+	mem_zero(m_aAttributesSheet, sizeof(m_aAttributesSheet));
+	mem_zero(m_aAttributesDungeonSync, sizeof(m_aAttributesDungeonSync));
+
 	// get all attributes from items
-	int Size = 0;
-	for(const auto& [ItemID, ItemData] : CPlayerItem::Data()[m_ClientID])
+	for(const CPlayerItem* pItem : CPlayerItem::Data()[m_ClientID].GetSideIndex())
 	{
-		if(ItemData.IsEquipped() && ItemData.Info()->IsEnchantable() && ItemData.Info()->GetInfoEnchantStats(ID))
+		if(!pItem->IsEquipped() || !pItem->Info()->IsEnchantable())
+			continue;
+
+		for(int i = (int)AttributeIdentifier::SpreadShotgun; i < (int)AttributeIdentifier::ATTRIBUTES_NUM; i++)
 		{
-			Size += ItemData.GetEnchantStats(ID);
+			if(pItem->Info()->GetInfoEnchantStats((AttributeIdentifier)i))
+				m_aAttributesSheet[i] += pItem->GetEnchantStats((AttributeIdentifier)i);
 		}
 	}
 
 	// if the attribute has the value of player upgrades we sum up
-	if(pAtt->HasDatabaseField())
-		Size += Account()->m_aStats[ID];
+	for(const auto& [ID, pAttribute] : CAttributeDescription::Data())
+	{
+		if(ID < AttributeIdentifier::SpreadShotgun || ID >= AttributeIdentifier::ATTRIBUTES_NUM)
+			continue;
 
-	return Size;
+		m_aAttributesDungeonSync[(int)ID] = pAttribute->GetUpgradePrice() < 4;
+		if(pAttribute->HasDatabaseField())
+			m_aAttributesSheet[(int)ID] += Account()->m_aStats[ID];
+	}
 }
 
 float CPlayer::GetAttributePercent(AttributeIdentifier ID)
@@ -1182,8 +1203,9 @@ CVoteEventOptional* CPlayer::CreateVoteOptional(int OptionID, int OptionID2, int
 	// Format the information string using localization and variable arguments
 	va_list VarArgs;
 	va_start(VarArgs, pInformation);
-	dynamic_string Buffer;
-	Server()->Localization()->Format_VL(Buffer, GetLanguage(), pInformation, VarArgs);
+	CLocalization::CBufferScope BufferScope;
+	dynamic_string& Buffer = BufferScope.Get();
+	Server()->Localization()->Format_VL(Buffer, GetLanguageIndex(), pInformation, VarArgs);
 	Optional.m_Description = Buffer.buffer();
 	Buffer.clear();
 	va_end(VarArgs);
@@ -46,6 +46,7 @@ protected:
 
 	IServer* Server() const;
 	int m_ClientID;
+	bool m_IsBot; // type tag, lets hot loops skip a dynamic_cast
 
 	// lastest afk state
 	bool m_Afk;
@@ -53,6 +54,16 @@ protected:
 	int64_t m_LastPlaytime;
 	std::function<void()> m_PostVotes;
 
+	// attributes from equipped items and upgrades, rebuilt on the first lookup after a change
+	int m_aAttributesSheet[(int)AttributeIdentifier::ATTRIBUTES_NUM];
+	bool m_aAttributesDungeonSync[(int)AttributeIdentifier::ATTRIBUTES_NUM];
+	bool m_AttributesDirty;
+
+private:
+	void UpdateAttributesSheet();
+
+protected:
+
 public:
 	CGS* GS() const { return m_pGS; }
 	vec2 m_ViewPos;
@@ -96,7 +107,7 @@ public:
 	virtual ~CPlayer();
 
 	virtual int GetTeam();
-	virtual bool IsBot() const { return false; }
+	bool IsBot() const { return m_IsBot; }
 	virtual int GetBotID() const { return -1; }
 	virtual int GetBotType() const { return -1; }
 	virtual int GetBotMobID() const { return -1; }
@@ -118,10 +129,14 @@ public:
 	virtual int GetEquippedItemID(ItemFunctional EquipID, int SkipItemID = -1) const;
 	virtual int GetAttributeSize(AttributeIdentifier ID);
 	float GetAttributePercent(AttributeIdentifier ID);
+	void MarkAttributesDirty() { m_AttributesDirty = true; }
+	static inline std::atomic<uint64_t> ms_AttributeLookups {};
+	static inline std::atomic<uint64_t> ms_AttributeRebuilds {};
 	virtual void UpdateTempData(int Health, int Mana);
 
-	virtual void GiveEffect(const char* Potion, int Sec, float Chance = 100.0f);
-	virtual bool IsActiveEffect(const char* Potion) const;
+	void GiveEffect(const char* pEffect, int Sec, float Chance = 100.0f) { GiveEffect(CEffects::Register(pEffect), Sec, Chance); }
+	virtual void GiveEffect(int EffectID, int Sec, float Chance = 100.0f);
+	virtual bool IsActiveEffect(int EffectID) const;
 	virtual void ClearEffects();
 
 	virtual void Tick();
@@ -165,6 +180,7 @@ public:
 		FUNCTIONS PLAYER ACCOUNT
 	========================================================== */
 	const char* GetLanguage() const;
+	int GetLanguageIndex() const;
 
 	bool GetHiddenMenu(int HideID) const;
 	bool IsAuthed() const;
@@ -15,6 +15,7 @@ MACRO_ALLOC_POOL_ID_IMPL(CPlayerBot, MAX_CLIENTS* ENGINE_MAX_WORLDS + MAX_CLIENT
 CPlayerBot::CPlayerBot(CGS* pGS, int ClientID, int BotID, int SubBotID, int SpawnPoint)
 	: CPlayer(pGS, ClientID), m_BotType(SpawnPoint), m_BotID(BotID), m_MobID(SubBotID), m_BotHealth(0), m_LastPosTick(0)
 {
+	m_IsBot = true;
 	m_EidolonCID = -1;
 	m_OldTargetPos = vec2(0, 0);
 	m_DungeonAllowedSpawn = false;
@@ -42,6 +43,7 @@ void CPlayerBot::InitQuestBotMobInfo(CQuestBotMobInfo elem)
 	{
 		// Assign the passed CQuestBotMobInfo instance to the member variable m_QuestMobInfo
 		m_QuestMobInfo = elem;
+		MarkAttributesDirty();
 
 		// Set all elements of m_ActiveForClient m_CompleteClient array to false
 		std::memset(m_QuestMobInfo.m_ActiveForClient, 0, MAX_PLAYERS * sizeof(bool));
@@ -132,19 +134,10 @@ CPlayerItem* CPlayerBot::GetItem(ItemIdentifier ID)
 
 void CPlayerBot::HandleEffects()
 {
-	if(Server()->Tick() % Server()->TickSpeed() != 0 || m_aEffects.empty())
+	if(Server()->Tick() % Server()->TickSpeed() != 0 || m_aEffects.IsEmpty())
 		return;
 
-	for(auto pEffect = m_aEffects.begin(); pEffect != m_aEffects.end();)
-	{
-		pEffect->second--;
-		if(pEffect->second <= 0)
-		{
-			pEffect = m_aEffects.erase(pEffect);
-			continue;
-		}
-		++pEffect;
-	}
+	m_aEffects.Tick([](int EffectID) {});
 }
 
 bool CPlayerBot::IsActive() const
@@ -181,6 +174,30 @@ void CPlayerBot::ResetRespawnTick()
 }
 
 int CPlayerBot::GetAttributeSize(AttributeIdentifier ID)
+{
+	ms_AttributeLookups.fetch_add(1, std::memory_order_relaxed);
+	if(ID < AttributeIdentifier::SpreadShotgun || ID >= AttributeIdentifier::ATTRIBUTES_NUM)
+		return 0;
+
+	// eidolons follow the sync factor of the dungeon
+	if(m_BotType == TYPE_BOT_EIDOLON && GS()->IsDungeon())
+		return CalculateAttributeSize(ID);
+
+	if(m_AttributesDirty)
+	{
+		ms_AttributeRebuilds.fetch_add(1, std::memory_order_relaxed);
+		m_AttributesDirty = false;
+		mem_zero(m_aAttributesSheet, sizeof(m_aAttributesSheet));
+		for(const auto& [AttributeID, pAttribute] : CAttributeDescription::Data())
+		{
+			if(AttributeID >= AttributeIdentifier::SpreadShotgun && AttributeID < AttributeIdentifier::ATTRIBUTES_NUM)
+				m_aAttributesSheet[(int)AttributeID] = CalculateAttributeSize(AttributeID);
+		}
+	}
+	return m_aAttributesSheet[(int)ID];
+}
+
+int CPlayerBot::CalculateAttributeSize(AttributeIdentifier ID)
 {
 	if(m_BotType == TYPE_BOT_MOB || m_BotType == TYPE_BOT_EIDOLON || m_BotType == TYPE_BOT_QUEST_MOB ||
 		(m_BotType == TYPE_BOT_NPC && NpcBotInfo::ms_aNpcBot[m_MobID].m_Function == FUNCTION_NPC_GUARDIAN))
@@ -256,24 +273,24 @@ int CPlayerBot::GetAttributeSize(AttributeIdentifier ID)
 	return 10;
 }
 
-void CPlayerBot::GiveEffect(const char* Potion, int Sec, float Chance)
+void CPlayerBot::GiveEffect(int EffectID, int Sec, float Chance)
 {
 	if(!m_pCharacter || !m_pCharacter->IsAlive())
 		return;
 
 	const float RandomChance = random_float(100.0f);
 	if(RandomChance < Chance)
-		m_aEffects[Potion] = Sec;
+		m_aEffects.Give(EffectID, Sec);
 }
 
-bool CPlayerBot::IsActiveEffect(const char* Potion) const
+bool CPlayerBot::IsActiveEffect(int EffectID) const
 {
-	return m_aEffects.find(Potion) != m_aEffects.end();
+	return m_aEffects.IsActive(EffectID);
 }
 
 void CPlayerBot::ClearEffects()
 {
-	m_aEffects.clear();
+	m_aEffects.Clear();
 }
 
 void CPlayerBot::TryRespawn()
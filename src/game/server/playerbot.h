@@ -32,6 +32,8 @@ class CPlayerBot : public CPlayer
 		bool m_CompleteClient[MAX_PLAYERS]{};
 	} m_QuestMobInfo;
 
+	int CalculateAttributeSize(AttributeIdentifier ID);
+
 public:
 	int m_LastPosTick;
 	vec2 m_TargetPos;
@@ -45,7 +47,6 @@ public:
 	CQuestBotMobInfo& GetQuestBotMobInfo() { return m_QuestMobInfo; }
 
 	int GetTeam() override { return TEAM_BLUE; }
-	bool IsBot() const override { return true; }
 	int GetBotID() const override { return m_BotID; }
 	int GetBotType() const override { return m_BotType; }
 	int GetBotMobID() const override { return m_MobID; }
@@ -64,8 +65,9 @@ public:
 	int GetEquippedItemID(ItemFunctional EquipID, int SkipItemID = -1) const override;
 	int GetAttributeSize(AttributeIdentifier ID) override;
 
-	void GiveEffect(const char* Potion, int Sec, float Chance = 100.0f) override;
-	bool IsActiveEffect(const char* Potion) const override;
+	using CPlayer::GiveEffect;
+	void GiveEffect(int EffectID, int Sec, float Chance = 100.0f) override;
+	bool IsActiveEffect(int EffectID) const override;
 	void ClearEffects() override;
 
 	void Tick() override;
@@ -85,7 +87,7 @@ public:
 
 private:
 	ska::unordered_map< int, std::unique_ptr<CPlayerItem> > m_Items {};
-	ska::unordered_map < std::string /* effect */, int /* seconds */ > m_aEffects;
+	CEffectTable m_aEffects;
 	void HandleEffects() override;
 	void TryRespawn() override;
 
@@ -0,0 +1,170 @@
+#ifndef GAME_SERVER_SPATIAL_GRID_H
+#define GAME_SERVER_SPATIAL_GRID_H
+
+#include <base/math.h>
+#include <base/vmath.h>
+
+#include <vector>
+
+/*
+	Struct: CSpatialGridHandle
+		Position of an item inside a CSpatialGrid, owned by the item.
+*/
+struct CSpatialGridHandle
+{
+	int m_Cell = -1;
+	int m_Slot = -1;
+
+	bool IsLinked() const { return m_Cell != -1; }
+};
+
+/*
+	Class: CSpatialGrid
+		Uniform grid of buckets over the map area. Every item is kept in
+		the cell of the position it was last synced with, items outside
+		the map end up in the border cells. Queries return candidates,
+		the caller checks the real distance of each of them.
+*/
+template<typename T>
+class CSpatialGrid
+{
+	struct CEntry
+	{
+		T* m_pItem;
+		CSpatialGridHandle* m_pHandle;
+		vec2 m_Pos;
+	};
+
+	std::vector<std::vector<CEntry>> m_vCells;
+	float m_CellSize;
+	int m_Width;
+	int m_Height;
+	int m_NumItems;
+
+	int CellX(float Pos) const { return clamp((int)(Pos / m_CellSize), 0, m_Width - 1); }
+	int CellY(float Pos) const { return clamp((int)(Pos / m_CellSize), 0, m_Height - 1); }
+	int CellIndex(vec2 Pos) const { return CellY(Pos.y) * m_Width + CellX(Pos.x); }
+
+	void Link(const CEntry& Entry, int Cell)
+	{
+		std::vector<CEntry>& vCell = m_vCells[Cell];
+		Entry.m_pHandle->m_Cell = Cell;
+		Entry.m_pHandle->m_Slot = (int)vCell.size();
+		vCell.push_back(Entry);
+	}
+
+	CEntry Unlink(CSpatialGridHandle& Handle)
+	{
+		// swap with the last entry of the cell to keep removal O(1)
+		std::vector<CEntry>& vCell = m_vCells[Handle.m_Cell];
+		CEntry Entry = vCell[Handle.m_Slot];
+		vCell[Handle.m_Slot] = vCell.back();
+		vCell[Handle.m_Slot].m_pHandle->m_Slot = Handle.m_Slot;
+		vCell.pop_back();
+
+		Handle.m_Cell = -1;
+		Handle.m_Slot = -1;
+		return Entry;
+	}
+
+public:
+	CSpatialGrid() : m_vCells(1), m_CellSize(256.0f), m_Width(1), m_Height(1), m_NumItems(0) {}
+
+	/*
+		Function: Init
+			Resizes the grid to cover Width x Height world units,
+			items that are already inside are redistributed.
+	*/
+	void Init(float Width, float Height, float CellSize)
+	{
+		std::vector<CEntry> vEntries;
+		vEntries.reserve(m_NumItems);
+		for(auto& vCell : m_vCells)
+			vEntries.insert(vEntries.end(), vCell.begin(), vCell.end());
+
+		m_CellSize = CellSize;
+		m_Width = maximum(1, (int)(Width / CellSize) + 1);
+		m_Height = maximum(1, (int)(Height / CellSize) + 1);
+		m_vCells.clear();
+		m_vCells.resize((size_t)m_Width * m_Height);
+
+		for(const auto& Entry : vEntries)
+			Link(Entry, CellIndex(Entry.m_Pos));
+	}
+
+	void Insert(T* pItem, CSpatialGridHandle& Handle, vec2 Pos)
+	{
+		if(Handle.IsLinked())
+			return;
+
+		Link({ pItem, &Handle, Pos }, CellIndex(Pos));
+		m_NumItems++;
+	}
+
+	void Remove(CSpatialGridHandle& Handle)
+	{
+		if(!Handle.IsLinked())
+			return;
+
+		Unlink(Handle);
+		m_NumItems--;
+	}
+
+	// returns true when the item changed its cell
+	bool Move(CSpatialGridHandle& Handle, vec2 Pos)
+	{
+		if(!Handle.IsLinked())
+			return false;
+
+		const int Cell = CellIndex(Pos);
+		if(Cell == Handle.m_Cell)
+		{
+			m_vCells[Cell][Handle.m_Slot].m_Pos = Pos;
+			return false;
+		}
+
+		CEntry Entry = Unlink(Handle);
+		Entry.m_Pos = Pos;
+		Link(Entry, Cell);
+		return true;
+	}
+
+	int Size() const { return m_NumItems; }
+	float CellSize() const { return m_CellSize; }
+
+	// number of cells a query over the rectangle would visit
+	int CellsInRect(vec2 Min, vec2 Max) const
+	{
+		return (CellX(Max.x) - CellX(Min.x) + 1) * (CellY(Max.y) - CellY(Min.y) + 1);
+	}
+
+	/*
+		Function: Query
+			Calls Fn(pItem) for every item stored in the cells overlapping
+			the rectangle, stops as soon as Fn returns false.
+
+		Returns:
+			False if the query was stopped by the callback.
+	*/
+	template<typename F>
+	bool Query(vec2 Min, vec2 Max, F&& Fn) const
+	{
+		const int MinX = CellX(Min.x);
+		const int MaxX = CellX(Max.x);
+		const int MaxY = CellY(Max.y);
+		for(int y = CellY(Min.y); y <= MaxY; y++)
+		{
+			for(int x = MinX; x <= MaxX; x++)
+			{
+				for(const auto& Entry : m_vCells[y * m_Width + x])
+				{
+					if(!Fn(Entry.m_pItem))
+						return false;
+				}
+			}
+		}
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef GAME_SERVER_VOTE_DELTA_H
+#define GAME_SERVER_VOTE_DELTA_H
+
+#include <climits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+	Class: CVoteDelta
+		Plans how to turn the vote options a client has into a new list.
+		The client can only append options and remove the first option
+		with a given description, so the options that are kept must be a
+		prefix of the old list that holds no description of a removed one.
+*/
+class CVoteDelta
+{
+public:
+	enum
+	{
+		MAX_OPTIONS_PER_MESSAGE = 15, // Sv_VoteOptionListAdd
+	};
+
+	// options at and above the returned index are removed, the new ones from there on are added
+	template<typename TGetDesc>
+	static int KeepPrefix(const std::vector<std::string>& vSent, int NumNew, TGetDesc GetDesc)
+	{
+		const int NumSent = (int)vSent.size();
+		int Prefix = 0;
+		while(Prefix < NumSent && Prefix < NumNew && vSent[Prefix] == GetDesc(Prefix))
+			Prefix++;
+		if(Prefix == NumSent)
+			return Prefix;
+
+		std::unordered_map<std::string_view, int> FirstIndex;
+		FirstIndex.reserve(NumSent);
+		for(int i = 0; i < NumSent; i++)
+			FirstIndex.emplace(vSent[i], i);
+
+		// largest Keep <= Prefix where every removed option is the first one of its description
+		int MinFirst = INT_MAX;
+		for(int k = NumSent - 1; k >= 0; k--)
+		{
+			const int First = FirstIndex[vSent[k]];
+			if(First < MinFirst)
+				MinFirst = First;
+			if(k <= Prefix && MinFirst >= k)
+				return k;
+		}
+		return 0;
+	}
+
+	// approximate packed sizes, a message id plus the strings with their terminators
+	static int RemoveBytes(const std::string& Desc) { return 1 + (int)Desc.size() + 1; }
+	static int ListAddBytes(int NumOptions, int DescBytes) { return 2 + DescBytes + NumOptions + (MAX_OPTIONS_PER_MESSAGE - NumOptions); }
+	static int ListAddMessages(int NumOptions) { return (NumOptions + MAX_OPTIONS_PER_MESSAGE - 1) / MAX_OPTIONS_PER_MESSAGE; }
+};
+
+#endif
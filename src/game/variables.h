@@ -148,7 +148,14 @@ MACRO_CONFIG_STR(SvMySqlLogin, sv_sql_login, 32, "root", CFGFLAG_SERVER, "MySQL
 MACRO_CONFIG_STR(SvMySqlPassword, sv_sql_password, 32, "", CFGFLAG_SERVER, "MySQL Password")
 MACRO_CONFIG_INT(SvMySqlPort, sv_sql_port, 3306, 0, 65000, CFGFLAG_SERVER, "MySQL Port")
 MACRO_CONFIG_INT(SvMySqlPoolSize, sv_sql_pool_size, 3, 2, 12, CFGFLAG_SERVER, "MySQL Pool size");
-
+MACRO_CONFIG_INT(SvItemFlushInterval, sv_item_flush_interval, 5, 1, 300, CFGFLAG_SERVER, "Seconds between batched writes of changed player items")
+MACRO_CONFIG_INT(SvItemFlushSize, sv_item_flush_size, 256, 16, 4096, CFGFLAG_SERVER, "Changed player items that force a batched write on the next tick")
+MACRO_CONFIG_INT(SvLeaderboardReconcileTime, sv_leaderboard_reconcile_time, 300, 30, 3600, CFGFLAG_SERVER, "Seconds between reloads of the top lists from the database")
+MACRO_CONFIG_INT(SvVoteMenuCacheTime, sv_vote_menu_cache_time, 5, 0, 60, CFGFLAG_SERVER, "Seconds an unchanged vote menu is reused without building it again (0 = always build)")
+MACRO_CONFIG_INT(SvQuestCommitInterval, sv_quest_commit_interval, 500, 50, 10000, CFGFLAG_SERVER, "Milliseconds quest progress is collected in memory before it is written to disk")
+MACRO_CONFIG_INT(SvMySqlQueueSize, sv_sql_queue_size, 4096, 64, 65536, CFGFLAG_SERVER, "Max pending asynchronous MySQL queries before producers wait");
+
+MACRO_CONFIG_INT(SvSnapLodDistance, sv_snap_lod_distance, 600, 0, 5000, CFGFLAG_SERVER, "Distance from which world text and laser rings are sent simplified while the snapshots of a client overflow (0 = never)")
 MACRO_CONFIG_INT(SvLoltextHspace, sv_loltext_hspace, 7, 7, 25, CFGFLAG_SERVER, "horizontal offset between loltext 'pixels'")
 MACRO_CONFIG_INT(SvLoltextVspace, sv_loltext_vspace, 7, 7, 25, CFGFLAG_SERVER, "vertical offset between loltext 'pixels'")
 
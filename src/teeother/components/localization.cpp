@@ -4,31 +4,79 @@
 
 #include "localization.h"
 
-CLocalization::CLanguage::CLanguage() : m_Loaded(false), m_Direction(CLocalization::DIRECTION_LTR)
+void CLocalization::CFormat::Compile(const char* pText)
+{
+	m_pText = pText;
+	m_vTokens.clear();
+
+	int Iter = 0;
+	int Start = 0;
+	int ParamTypeStart = -1;
+	while(pText[Iter])
+	{
+		if(ParamTypeStart >= 0)
+		{
+			if(pText[Iter] == '}')
+			{
+				// unknown parameters are dropped from the output
+				if(str_comp_num("STR", pText + ParamTypeStart, 3) == 0)
+					m_vTokens.push_back({ TOKEN_STR, 0, 0 });
+				else if(str_comp_num("INT", pText + ParamTypeStart, 3) == 0)
+					m_vTokens.push_back({ TOKEN_INT, 0, 0 });
+				else if(str_comp_num("VAL", pText + ParamTypeStart, 3) == 0)
+					m_vTokens.push_back({ TOKEN_VAL, 0, 0 });
+
+				Start = Iter + 1;
+				ParamTypeStart = -1;
+			}
+		}
+		else if(pText[Iter] == '{')
+		{
+			if(Iter > Start)
+				m_vTokens.push_back({ TOKEN_TEXT, Start, Iter - Start });
+			ParamTypeStart = Iter + 1;
+		}
+
+		Iter = str_utf8_forward(pText, Iter);
+	}
+
+	// an unclosed parameter swallows the rest of the text
+	if(ParamTypeStart == -1 && Iter > Start)
+		m_vTokens.push_back({ TOKEN_TEXT, Start, Iter - Start });
+}
+
+static thread_local std::vector<std::unique_ptr<dynamic_string>> gs_vpFormatBuffers;
+static thread_local int gs_FormatBuffersUsed = 0;
+
+CLocalization::CBufferScope::CBufferScope()
+{
+	if(gs_FormatBuffersUsed == (int)gs_vpFormatBuffers.size())
+		gs_vpFormatBuffers.push_back(std::make_unique<dynamic_string>());
+
+	m_pBuffer = gs_vpFormatBuffers[gs_FormatBuffersUsed++].get();
+	m_pBuffer->clear();
+}
+
+CLocalization::CBufferScope::~CBufferScope()
+{
+	gs_FormatBuffersUsed--;
+}
+
+CLocalization::CLanguage::CLanguage() : m_ParentIndex(-1), m_Loaded(false), m_LoadTried(false), m_Direction(CLocalization::DIRECTION_LTR)
 {
 	m_aName[0] = 0;
 	m_aFilename[0] = 0;
 	m_aParentFilename[0] = 0;
 }
 
-CLocalization::CLanguage::CLanguage(const char* pName, const char* pFilename, const char* pParentFilename) : m_Loaded(false), m_Direction(CLocalization::DIRECTION_LTR)
+CLocalization::CLanguage::CLanguage(const char* pName, const char* pFilename, const char* pParentFilename) : m_ParentIndex(-1), m_Loaded(false), m_LoadTried(false), m_Direction(CLocalization::DIRECTION_LTR)
 {
 	str_copy(m_aName, pName, sizeof(m_aName));
 	str_copy(m_aFilename, pFilename, sizeof(m_aFilename));
 	str_copy(m_aParentFilename, pParentFilename, sizeof(m_aParentFilename));
 }
 
-CLocalization::CLanguage::~CLanguage()
-{
-	hashtable< CEntry, 128 >::iterator Iter = m_Translations.begin();
-	while(Iter != m_Translations.end())
-	{
-		if(Iter.data())
-			Iter.data()->Free();
-
-		++Iter;
-	}
-}
+CLocalization::CLanguage::~CLanguage() = default;
 
 bool CLocalization::CLanguage::Load(CLocalization* pLocalization, IStorageEngine* pStorage)
 {
@@ -44,22 +92,26 @@ bool CLocalization::CLanguage::Load(CLocalization* pLocalization, IStorageEngine
 	io_read(File, pFileData, FileSize);
 	io_close(File);
 
+	const bool Result = LoadFromMemory(pFileData, FileSize);
+	free(pFileData);
+	if(!Result)
+		dbg_msg("Localization", "Can't load the localization file %s", aBuf);
+	return Result;
+}
+
+bool CLocalization::CLanguage::LoadFromMemory(const char* pData, int Size)
+{
 	// parse json data
 	json_settings JsonSettings;
 	mem_zero(&JsonSettings, sizeof(JsonSettings));
 	char aError[256];
-	json_value* pJsonData = json_parse_ex(&JsonSettings, pFileData, FileSize, aError);
-	free(pFileData);
-
+	json_value* pJsonData = json_parse_ex(&JsonSettings, pData, Size, aError);
 	if(pJsonData == nullptr)
 	{
-		dbg_msg("Localization", "Can't load the localization file %s : %s", aBuf, aError);
+		dbg_msg("Localization", "%s", aError);
 		return false;
 	}
 
-	dynamic_string Buffer;
-	int Length;
-
 	// extract data
 	const json_value& rStart = (*pJsonData)["translation"];
 	if(rStart.type == json_array)
@@ -67,18 +119,9 @@ bool CLocalization::CLanguage::Load(CLocalization* pLocalization, IStorageEngine
 		for(unsigned i = 0; i < rStart.u.array.length; ++i)
 		{
 			const char* pKey = rStart[i]["key"];
-			if(pKey && pKey[0])
-			{
-				CEntry* pEntry = m_Translations.set(pKey);
-
-				const char* pSingular = rStart[i]["value"];
-				if(pSingular && pSingular[0])
-				{
-					Length = str_length(pSingular) + 1;
-					pEntry->m_apVersions = new char[Length];
-					str_copy(pEntry->m_apVersions, pSingular, Length);
-				}
-			}
+			const char* pSingular = rStart[i]["value"];
+			if(pKey && pKey[0] && pSingular && pSingular[0])
+				AddTranslation(pKey, pSingular);
 		}
 	}
 
@@ -89,13 +132,47 @@ bool CLocalization::CLanguage::Load(CLocalization* pLocalization, IStorageEngine
 	return true;
 }
 
-const char* CLocalization::CLanguage::Localize(const char* pText) const
+void CLocalization::CLanguage::EnsureLoaded(CLocalization* pLocalization, IStorageEngine* pStorage)
 {
-	const CEntry* pEntry = m_Translations.get(pText);
-	if(!pEntry)
-		return nullptr;
+	if(m_Loaded)
+		return;
 
-	return pEntry->m_apVersions;
+	// worlds format in parallel, only one of them reads the file
+	std::lock_guard Lock(m_LoadLock);
+	if(m_Loaded || m_LoadTried)
+		return;
+
+	m_LoadTried = true;
+	Load(pLocalization, pStorage);
+}
+
+void CLocalization::CLanguage::AddTranslation(const char* pKey, const char* pValue)
+{
+	// the last translation of a key wins
+	if(const auto Iter = m_Translations.find(std::string_view(pKey)); Iter != m_Translations.end())
+	{
+		Iter->second->m_Text = pValue;
+		Iter->second->m_Format.Compile(Iter->second->m_Text.c_str());
+		return;
+	}
+
+	CEntry& Entry = m_Entries.emplace_back();
+	Entry.m_Key = pKey;
+	Entry.m_Text = pValue;
+	Entry.m_Format.Compile(Entry.m_Text.c_str());
+	m_Translations.emplace(std::string_view(Entry.m_Key), &Entry);
+}
+
+const CLocalization::CFormat* CLocalization::CLanguage::Find(const char* pKey) const
+{
+	const auto Iter = m_Translations.find(std::string_view(pKey));
+	return Iter != m_Translations.end() ? &Iter->second->m_Format : nullptr;
+}
+
+const char* CLocalization::CLanguage::Localize(const char* pText) const
+{
+	const CFormat* pFormat = Find(pText);
+	return pFormat ? pFormat->GetText() : nullptr;
 }
 
 CLocalization::CLocalization(IStorageEngine* pStorage) : m_pStorage(pStorage), m_pMainLanguage(nullptr)
@@ -144,16 +221,7 @@ bool CLocalization::Init()
 	if(rStart.type == json_array)
 	{
 		for(unsigned i = 0; i < rStart.u.array.length; ++i)
-		{
-			CLanguage*& pLanguage = m_pLanguages.increment();
-			pLanguage = new CLanguage((const char*)rStart[i]["name"], (const char*)rStart[i]["file"], (const char*)rStart[i]["parent"]);
-
-			if(m_Cfg_MainLanguage == pLanguage->GetFilename())
-			{
-				pLanguage->Load(this, Storage());
-				m_pMainLanguage = pLanguage;
-			}
-		}
+			AddLanguage((const char*)rStart[i]["name"], (const char*)rStart[i]["file"], (const char*)rStart[i]["parent"]);
 	}
 
 	// clean up
@@ -161,129 +229,158 @@ bool CLocalization::Init()
 	return true;
 }
 
-const char* CLocalization::LocalizeWithDepth(const char* pLanguageCode, const char* pText, int Depth)
+CLocalization::CLanguage* CLocalization::AddLanguage(const char* pName, const char* pFilename, const char* pParentFilename)
 {
-	CLanguage* pLanguage = m_pMainLanguage;
-	if(pLanguageCode)
+	CLanguage*& pLanguage = m_pLanguages.increment();
+	pLanguage = new CLanguage(pName, pFilename, pParentFilename);
+	m_LanguageIndices.emplace(pLanguage->GetFilename(), m_pLanguages.size() - 1);
+
+	// parents can be listed in any order
+	for(int i = 0; i < m_pLanguages.size(); i++)
 	{
-		for(int i = 0; i < m_pLanguages.size(); i++)
-		{
-			if(str_comp(m_pLanguages[i]->GetFilename(), pLanguageCode) == 0)
-			{
-				pLanguage = m_pLanguages[i];
-				break;
-			}
-		}
+		if(m_pLanguages[i]->GetParentFilename()[0])
+			m_pLanguages[i]->m_ParentIndex = GetLanguageIndex(m_pLanguages[i]->GetParentFilename());
 	}
 
-	if(!pLanguage)
-		return pText;
+	if(m_Cfg_MainLanguage == pLanguage->GetFilename())
+	{
+		pLanguage->EnsureLoaded(this, Storage());
+		m_pMainLanguage = pLanguage;
+	}
+	return pLanguage;
+}
 
-	if(!pLanguage->IsLoaded())
-		pLanguage->Load(this, Storage());
+int CLocalization::GetLanguageIndex(const char* pLanguageCode) const
+{
+	if(!pLanguageCode)
+		return -1;
 
-	const char* pResult = pLanguage->Localize(pText);
-	if(pResult)
-		return pResult;
-	if(pLanguage->GetParentFilename()[0] && Depth < 4)
-		return LocalizeWithDepth(pLanguage->GetParentFilename(), pText, Depth + 1);
-	return pText;
+	const auto Iter = m_LanguageIndices.find(pLanguageCode);
+	return Iter != m_LanguageIndices.end() ? Iter->second : -1;
 }
 
-const char* CLocalization::Localize(const char* pLanguageCode, const char* pText)
+CLocalization::CLanguage* CLocalization::GetLanguage(int LanguageIndex)
 {
-	return LocalizeWithDepth(pLanguageCode, pText, 0);
+	if(LanguageIndex < 0 || LanguageIndex >= m_pLanguages.size())
+		return m_pMainLanguage;
+	return m_pLanguages[LanguageIndex];
 }
 
-void CLocalization::Format_V(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs)
+const CLocalization::CFormat* CLocalization::FindWithDepth(CLanguage* pLanguage, const char* pText, int Depth)
 {
-	CLanguage* pLanguage = m_pMainLanguage;
-	if(pLanguageCode)
-	{
-		for(int i = 0; i < m_pLanguages.size(); i++)
-		{
-			if(str_comp(m_pLanguages[i]->GetFilename(), pLanguageCode) != 0)
-				continue;
+	pLanguage->EnsureLoaded(this, Storage());
+	if(const CFormat* pFormat = pLanguage->Find(pText))
+		return pFormat;
 
-			pLanguage = m_pLanguages[i];
-			break;
-		}
-	}
+	if(pLanguage->m_ParentIndex >= 0 && Depth < 4)
+		return FindWithDepth(m_pLanguages[pLanguage->m_ParentIndex], pText, Depth + 1);
+	return nullptr;
+}
 
+const char* CLocalization::Localize(int LanguageIndex, const char* pText)
+{
+	CLanguage* pLanguage = GetLanguage(LanguageIndex);
 	if(!pLanguage)
-	{
-		Buffer.append(pText);
-		return;
-	}
+		return pText;
 
-	// start parameters of the end of the name and type string
-	const int BufferStart = Buffer.length();
-	int BufferIter = BufferStart;
-	int ParamTypeStart = -1;
+	const CFormat* pFormat = FindWithDepth(pLanguage, pText, 0);
+	return pFormat ? pFormat->GetText() : pText;
+}
 
+const char* CLocalization::Localize(const char* pLanguageCode, const char* pText)
+{
+	return Localize(GetLanguageIndex(pLanguageCode), pText);
+}
+
+void CLocalization::FormatTokens(dynamic_string& Buffer, CLanguage* pLanguage, const CFormat& Format, va_list VarArgs)
+{
 	// argument parsing
 	va_list VarArgsIter;
 	va_copy(VarArgsIter, VarArgs);
 
-	// character positions
-	int Iter = 0;
-	int Start = 0;
-
-	// parse text to search for positions
-	while(pText[Iter])
+	const char* pText = Format.GetText();
+	int BufferIter = Buffer.length();
+	for(const CFormat::CToken& Token : Format.GetTokens())
 	{
-		if(ParamTypeStart >= 0)
+		switch(Token.m_Type)
 		{
-			if(pText[Iter] != '}')
-			{
-				Iter = str_utf8_forward(pText, Iter);
-				continue;
-			}
+			case CFormat::TOKEN_TEXT:
+				BufferIter = Buffer.append_at_num(BufferIter, pText + Token.m_Offset, Token.m_Length);
+				break;
 
-			// we get data from an argument parsing arguments
-			if(str_comp_num("STR", pText + ParamTypeStart, 3) == 0) // string
+			case CFormat::TOKEN_STR:
 			{
 				const char* pVarArgValue = va_arg(VarArgsIter, const char*);
 				const char* pTranslatedValue = pLanguage->Localize(pVarArgValue);
 				BufferIter = Buffer.append_at(BufferIter, (pTranslatedValue ? pTranslatedValue : pVarArgValue));
+				break;
 			}
-			else if(str_comp_num("INT", pText + ParamTypeStart, 3) == 0) // intiger
+
+			case CFormat::TOKEN_INT:
 			{
-				char aBuf[128];
-				const int pVarArgValue = va_arg(VarArgsIter, int);
-				str_format(aBuf, sizeof(aBuf), "%d", pVarArgValue); // %ll
+				char aBuf[16];
+				str_from_int(va_arg(VarArgsIter, int), aBuf);
 				BufferIter = Buffer.append_at(BufferIter, aBuf);
-			}
-			else if(str_comp_num("VAL", pText + ParamTypeStart, 3) == 0) // value
-			{
-				const int pVarArgValue = va_arg(VarArgsIter, int);
-				BufferIter = Buffer.append_at(BufferIter, get_commas<int>(pVarArgValue).c_str());
+				break;
 			}
 
-			//
-			Start = Iter + 1;
-			ParamTypeStart = -1;
-		}
-
-		// parameter parsing start
-		else
-		{
-			if(pText[Iter] == '{')
+			case CFormat::TOKEN_VAL:
 			{
-				BufferIter = Buffer.append_at_num(BufferIter, pText + Start, Iter - Start);
-				Iter++;
-				ParamTypeStart = Iter;
+				const int VarArgValue = va_arg(VarArgsIter, int);
+				BufferIter = Buffer.append_at(BufferIter, get_commas<int>(VarArgValue).c_str());
+				break;
 			}
 		}
-
-		Iter = str_utf8_forward(pText, Iter);
 	}
 
 	// close the argument macro
 	va_end(VarArgsIter);
+}
+
+const CLocalization::CFormat& CLocalization::SourceFormat(const char* pText)
+{
+	// untranslated texts are compiled once per thread, keyed by the text since callers reuse their buffers
+	struct CSource
+	{
+		std::string m_Text;
+		CFormat m_Format;
+	};
+	static thread_local std::deque<CSource> s_Sources;
+	static thread_local ska::flat_hash_map<std::string_view, const CFormat*> s_Formats;
 
-	if(Iter > 0 && ParamTypeStart == -1)
-		Buffer.append_at_num(BufferIter, pText + Start, Iter - Start);
+	if(const auto Iter = s_Formats.find(std::string_view(pText)); Iter != s_Formats.end())
+		return *Iter->second;
+
+	// texts built at runtime would grow it without end
+	if(s_Sources.size() >= MAX_SOURCE_FORMATS)
+	{
+		s_Formats.clear();
+		s_Sources.clear();
+	}
+
+	CSource& Source = s_Sources.emplace_back();
+	Source.m_Text = pText;
+	Source.m_Format.Compile(Source.m_Text.c_str());
+	s_Formats.emplace(Source.m_Text, &Source.m_Format);
+	return Source.m_Format;
+}
+
+void CLocalization::Format_V(dynamic_string& Buffer, int LanguageIndex, const char* pText, va_list VarArgs)
+{
+	CLanguage* pLanguage = GetLanguage(LanguageIndex);
+	if(!pLanguage)
+	{
+		Buffer.append(pText);
+		return;
+	}
+
+	pLanguage->EnsureLoaded(this, Storage());
+	FormatTokens(Buffer, pLanguage, SourceFormat(pText), VarArgs);
+}
+
+void CLocalization::Format_V(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs)
+{
+	Format_V(Buffer, GetLanguageIndex(pLanguageCode), pText, VarArgs);
 }
 
 void CLocalization::Format(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, ...)
@@ -296,11 +393,25 @@ void CLocalization::Format(dynamic_string& Buffer, const char* pLanguageCode, co
 	va_end(VarArgs);
 }
 
-void CLocalization::Format_VL(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs)
+void CLocalization::Format_VL(dynamic_string& Buffer, int LanguageIndex, const char* pText, va_list VarArgs)
 {
-	const char* pLocalText = Localize(pLanguageCode, pText);
+	CLanguage* pLanguage = GetLanguage(LanguageIndex);
+	if(!pLanguage)
+	{
+		Buffer.append(pText);
+		return;
+	}
 
-	Format_V(Buffer, pLanguageCode, pLocalText, VarArgs);
+	// translations are compiled when the language is loaded
+	if(const CFormat* pFormat = FindWithDepth(pLanguage, pText, 0))
+		FormatTokens(Buffer, pLanguage, *pFormat, VarArgs);
+	else
+		Format_V(Buffer, LanguageIndex, pText, VarArgs);
+}
+
+void CLocalization::Format_VL(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs)
+{
+	Format_VL(Buffer, GetLanguageIndex(pLanguageCode), pText, VarArgs);
 }
 
 void CLocalization::Format_L(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, ...)
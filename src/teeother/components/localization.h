@@ -2,6 +2,15 @@
 #define TEEOTHER_COMPONENTS_LOCALIZATION_H
 
 #include <teeother/tl/hashtable.h>
+#include <teeother/flat_hash_map/flat_hash_map.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
 
 /*
  * TODO: Join plural rules example {RP:{INT}:{STR}} or {PR:{INT}:player} use rules from lang files
@@ -14,33 +23,59 @@ class CLocalization
 
 public:
 
+	// text split once into literal parts and {STR} {INT} {VAL} parameters
+	class CFormat
+	{
+	public:
+		enum
+		{
+			TOKEN_TEXT = 0,
+			TOKEN_STR,
+			TOKEN_INT,
+			TOKEN_VAL,
+		};
+
+		struct CToken
+		{
+			int m_Type;
+			int m_Offset;
+			int m_Length;
+		};
+
+		void Compile(const char* pText);
+		const char* GetText() const { return m_pText; }
+		const std::vector<CToken>& GetTokens() const { return m_vTokens; }
+
+	private:
+		const char* m_pText {};
+		std::vector<CToken> m_vTokens {};
+	};
+
 	class CLanguage
 	{
 	protected:
 		class CEntry
 		{
 		public:
-			char* m_apVersions;
-
-			CEntry() : m_apVersions(nullptr) {}
-
-			void Free()
-			{
-				if (m_apVersions)
-				{
-					delete[] m_apVersions;
-					m_apVersions = nullptr;
-				}
-			}
+			std::string m_Key;
+			std::string m_Text;
+			CFormat m_Format;
 		};
 
 		char m_aName[64];
 		char m_aFilename[64];
 		char m_aParentFilename[64];
-		bool m_Loaded;
+		int m_ParentIndex;
+		std::atomic<bool> m_Loaded;
+		bool m_LoadTried;
+		std::mutex m_LoadLock;
 		int m_Direction;
 
-		hashtable< CEntry, 128 > m_Translations;
+		// entries never move, the keys of the map point into them
+		std::deque<CEntry> m_Entries;
+		ska::flat_hash_map<std::string_view, CEntry*> m_Translations;
+
+		friend class CLocalization;
 
 	public:
 		CLanguage();
@@ -52,25 +87,50 @@ public:
 		const char* GetName() const { return m_aName; }
 		bool IsLoaded() const { return m_Loaded; }
 		bool Load(CLocalization* pLocalization, IStorageEngine* pStorage);
+		bool LoadFromMemory(const char* pData, int Size);
+		void EnsureLoaded(CLocalization* pLocalization, IStorageEngine* pStorage);
+		void AddTranslation(const char* pKey, const char* pValue);
+		const CFormat* Find(const char* pKey) const;
 		const char* Localize(const char* pKey) const;
 	};
 
+	// formatting target taken from a per thread pool, nested scopes get their own buffer
+	class CBufferScope
+	{
+		dynamic_string* m_pBuffer;
+
+	public:
+		CBufferScope();
+		~CBufferScope();
+		CBufferScope(const CBufferScope&) = delete;
+		CBufferScope& operator=(const CBufferScope&) = delete;
+
+		dynamic_string& Get() { return *m_pBuffer; }
+	};
+
 	enum
 	{
 		DIRECTION_LTR=0,
 		DIRECTION_RTL,
 		NUM_DIRECTIONS,
+
+		// untranslated formats cached per thread
+		MAX_SOURCE_FORMATS=4096,
 	};
 
 protected:
 	CLanguage* m_pMainLanguage;
+	ska::flat_hash_map<std::string, int> m_LanguageIndices;
 
 public:
 	array<CLanguage*> m_pLanguages;
 	fixed_string128 m_Cfg_MainLanguage;
 
 protected:
-	const char* LocalizeWithDepth(const char* pLanguageCode, const char* pText, int Depth);
+	CLanguage* GetLanguage(int LanguageIndex);
+	const CFormat* FindWithDepth(CLanguage* pLanguage, const char* pText, int Depth);
+	static const CFormat& SourceFormat(const char* pText);
+	void FormatTokens(dynamic_string& Buffer, CLanguage* pLanguage, const CFormat& Format, va_list VarArgs);
 
 public:
 	CLocalization(IStorageEngine* pStorage);
@@ -79,15 +139,24 @@ public:
 	virtual bool InitConfig(int argc, const char** argv);
 	virtual bool Init();
 
+	// registers a language, the main one is loaded right away
+	CLanguage* AddLanguage(const char* pName, const char* pFilename, const char* pParentFilename);
+
+	// -1 stands for the main language
+	int GetLanguageIndex(const char* pLanguageCode) const;
+
 	//localize
+	const char* Localize(int LanguageIndex, const char* pText);
 	const char* Localize(const char* pLanguageCode, const char* pText);
 
 	//format
+	void Format_V(dynamic_string& Buffer, int LanguageIndex, const char* pText, va_list VarArgs);
 	void Format_V(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs);
 	void Format(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, ...);
 	//localize, format
+	void Format_VL(dynamic_string& Buffer, int LanguageIndex, const char* pText, va_list VarArgs);
 	void Format_VL(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, va_list VarArgs);
 	void Format_L(dynamic_string& Buffer, const char* pLanguageCode, const char* pText, ...);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -20,7 +20,6 @@
 // custom something that is subject to less changes is introduced
 #include <base/math.h>
 #include <base/vmath.h>
-#include <base/threadpool.h>
 #include <base/tl/array.h>
 #include <engine/shared/protocol.h>
 #include <generated/protocol.h>
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <game/collision.h>
+#include <game/mapitems.h>
+
+#include <cstdio>
+#include <random>
+
+// a map with scattered solid blocks and invisible walls, borders are solid
+static std::vector<CTile> MakeTiles(int Width, int Height, std::mt19937& Rng)
+{
+	std::vector<CTile> vTiles(Width * Height);
+	std::uniform_int_distribution<int> Percent(0, 99);
+	for(int y = 0; y < Height; y++)
+	{
+		for(int x = 0; x < Width; x++)
+		{
+			CTile& Tile = vTiles[y * Width + x];
+			Tile = {};
+			const int Roll = Percent(Rng);
+			if(x == 0 || y == 0 || x == Width - 1 || y == Height - 1 || Roll < 2)
+				Tile.m_Index = TILE_SOLID;
+			else if(Roll < 3)
+				Tile.m_Index = TILE_INVISIBLE_WALL;
+		}
+	}
+	return vTiles;
+}
+
+struct CRays
+{
+	std::vector<vec2> m_vFrom;
+	std::vector<vec2> m_vTo;
+};
+
+static CRays MakeRays(const CCollision& Collision, int NumRays, std::mt19937& Rng)
+{
+	std::uniform_real_distribution<float> RandomX(0.0f, Collision.GetWidth() * 32.0f);
+	std::uniform_real_distribution<float> RandomY(0.0f, Collision.GetHeight() * 32.0f);
+	std::uniform_real_distribution<float> RandomOffset(-800.0f, 800.0f);
+
+	CRays Rays;
+	for(int i = 0; i < NumRays; i++)
+	{
+		const vec2 From(RandomX(Rng), RandomY(Rng));
+		Rays.m_vFrom.push_back(From);
+		Rays.m_vTo.push_back(From + vec2(RandomOffset(Rng), RandomOffset(Rng)));
+	}
+	return Rays;
+}
+
+TEST(Collision, SightMatchesLine)
+{
+	std::mt19937 Rng(1);
+	std::vector<CTile> vTiles = MakeTiles(300, 150, Rng);
+	CCollision Collision;
+	Collision.Init(vTiles.data(), 300, 150);
+
+	// every ray on its own, a cached answer may stand for another line between the same tiles
+	const CRays Rays = MakeRays(Collision, 20000, Rng);
+	for(size_t i = 0; i < Rays.m_vFrom.size(); i++)
+	{
+		Collision.ResetSightCache();
+		ASSERT_EQ(Collision.IntersectSight(Rays.m_vFrom[i], Rays.m_vTo[i]), Collision.IntersectLineWithInvisible(Rays.m_vFrom[i], Rays.m_vTo[i], nullptr, nullptr))
+			<< "ray " << i << " from " << Rays.m_vFrom[i].x << "," << Rays.m_vFrom[i].y << " to " << Rays.m_vTo[i].x << "," << Rays.m_vTo[i].y;
+	}
+}
+
+// rays per second of the line walk, the bit grid and the cached bit grid,
+// run it with --gtest_also_run_disabled_tests
+TEST(Collision, DISABLED_SightBenchmark)
+{
+	constexpr int NumRays = 1000000;
+	std::mt19937 Rng(1);
+	std::vector<CTile> vTiles = MakeTiles(1000, 500, Rng);
+	CCollision Collision;
+	Collision.Init(vTiles.data(), 1000, 500);
+	const CRays Rays = MakeRays(Collision, NumRays, Rng);
+
+	int Blocked = 0;
+	const auto Measure = [&](const char* pName, int NumQueries, auto&& Func) {
+		Blocked = 0;
+		const int64_t Start = time_get_impl();
+		Func();
+		const int64_t Time = time_get_impl() - Start;
+		printf("[collision] %s: %.2fM rays/s (%d blocked)\n", pName, (double)NumQueries * time_freq() / Time / 1000000.0, Blocked);
+	};
+
+	Measure("line", NumRays, [&]() {
+		for(int i = 0; i < NumRays; i++)
+			Blocked += Collision.IntersectLineWithInvisible(Rays.m_vFrom[i], Rays.m_vTo[i], nullptr, nullptr);
+	});
+	Measure("bit grid", NumRays, [&]() {
+		for(int i = 0; i < NumRays; i++)
+		{
+			Collision.ResetSightCache();
+			Blocked += Collision.IntersectSight(Rays.m_vFrom[i], Rays.m_vTo[i]);
+		}
+	});
+
+	// every pair is asked both ways, like a bot looking at a player and back
+	Collision.ResetSightCache();
+	Measure("cached bit grid", NumRays * 2, [&]() {
+		for(int i = 0; i < NumRays; i++)
+		{
+			Blocked += Collision.IntersectSight(Rays.m_vFrom[i], Rays.m_vTo[i]);
+			Blocked += Collision.IntersectSight(Rays.m_vTo[i], Rays.m_vFrom[i]);
+		}
+	});
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <game/server/mmocore/Utils/DenseTable.h>
+
+#include <cstdio>
+#include <map>
+#include <random>
+
+class CRecord
+{
+public:
+	int m_ID {};
+	int m_Value {};
+	int m_Settings {};
+
+	CRecord() = default;
+	CRecord(int ID, int Value, int Settings) : m_ID(ID), m_Value(Value), m_Settings(Settings) {}
+	int GetID() const { return m_ID; }
+};
+
+struct CEquippable
+{
+	static bool Check(const CRecord& Record) { return Record.m_ID % 8 == 0; }
+};
+
+using CTable = CDenseTable<CRecord, CEquippable>;
+
+TEST(DenseTable, Basic)
+{
+	CTable Table;
+	EXPECT_TRUE(Table.empty());
+	EXPECT_EQ(Table.Find(3), nullptr);
+	EXPECT_EQ(Table.Find(-1), nullptr);
+
+	Table.Insert(16, CRecord(16, 1, 0));
+	Table.Insert(3, CRecord(3, 2, 0));
+	CRecord* pRecord = &Table.Insert(8, CRecord(8, 3, 1));
+	EXPECT_EQ(Table.size(), 3);
+
+	// assigning keeps the address
+	Table.Insert(8, CRecord(8, 5, 0));
+	EXPECT_EQ(Table.Find(8), pRecord);
+	EXPECT_EQ(pRecord->m_Value, 5);
+
+	// ascending IDs no matter the insertion order
+	std::vector<int> vIDs;
+	for(const auto& Record : Table)
+		vIDs.push_back(Record.GetID());
+	EXPECT_EQ(vIDs, std::vector<int>({3, 8, 16}));
+
+	ASSERT_EQ(Table.GetSideIndex().size(), 2u);
+	EXPECT_EQ(Table.GetSideIndex()[0]->GetID(), 8);
+	EXPECT_EQ(Table.GetSideIndex()[1]->GetID(), 16);
+
+	// records never move while others are added
+	for(int i = 100; i < 1000; i++)
+		Table.Insert(i, CRecord(i, i, 0));
+	EXPECT_EQ(Table.Find(8), pRecord);
+
+	Table.clear();
+	EXPECT_TRUE(Table.empty());
+	EXPECT_EQ(Table.Find(8), nullptr);
+	EXPECT_TRUE(Table.GetSideIndex().empty());
+}
+
+// 500 items for each of 64 players, the old nested map against the table,
+// run it with --gtest_also_run_disabled_tests
+TEST(DenseTable, DISABLED_Benchmark)
+{
+	constexpr int NumPlayers = 64;
+	constexpr int NumItems = 500;
+	constexpr int NumRounds = 200;
+
+	std::mt19937 Rng(1);
+	std::vector<int> vItemIDs;
+	for(int i = 1; i <= NumItems; i++)
+		vItemIDs.push_back(i);
+
+	std::map<int, std::map<int, CRecord>> Nested;
+	std::map<int, CTable> Dense;
+	for(int c = 0; c < NumPlayers; c++)
+	{
+		std::shuffle(vItemIDs.begin(), vItemIDs.end(), Rng);
+		for(int ID : vItemIDs)
+		{
+			Nested[c][ID] = CRecord(ID, ID % 3, ID % 5 == 0);
+			Dense[c].Insert(ID, CRecord(ID, ID % 3, ID % 5 == 0));
+		}
+	}
+
+	std::uniform_int_distribution<int> RandomID(1, NumItems * 2);
+	std::vector<int> vLookups;
+	for(int i = 0; i < 4096; i++)
+		vLookups.push_back(RandomID(Rng));
+
+	int64_t Sum = 0;
+	const auto Measure = [&](const char* pName, auto&& Func)
+	{
+		const int64_t Start = time_get_impl();
+		for(int r = 0; r < NumRounds; r++)
+			Func();
+		const int64_t Time = time_get_impl() - Start;
+		printf("[dense_table] %s: %.3f us per round\n", pName, Time * 1000000.0 / time_freq() / NumRounds);
+	};
+
+	int64_t NestedScan = 0;
+	int64_t DenseScan = 0;
+	Measure("nested map scan", [&]() {
+		for(int c = 0; c < NumPlayers; c++)
+			for(const auto& [ID, Record] : Nested[c])
+				NestedScan += Record.m_Value > 0 && Record.m_Settings;
+	});
+	Measure("dense table scan", [&]() {
+		for(int c = 0; c < NumPlayers; c++)
+			for(const auto& Record : Dense[c])
+				DenseScan += Record.m_Value > 0 && Record.m_Settings;
+	});
+	Measure("dense side index scan", [&]() {
+		for(int c = 0; c < NumPlayers; c++)
+			for(const CRecord* pRecord : Dense[c].GetSideIndex())
+				Sum += pRecord->m_Value > 0 && pRecord->m_Settings;
+	});
+	EXPECT_EQ(NestedScan, DenseScan);
+
+	int64_t NestedFound = 0;
+	int64_t DenseFound = 0;
+	Measure("nested map lookup", [&]() {
+		for(int c = 0; c < NumPlayers; c++)
+		{
+			const auto& Items = Nested[c];
+			for(int ID : vLookups)
+				NestedFound += Items.find(ID) != Items.end();
+		}
+	});
+	Measure("dense table lookup", [&]() {
+		for(int c = 0; c < NumPlayers; c++)
+		{
+			const CTable& Items = Dense[c];
+			for(int ID : vLookups)
+				DenseFound += Items.Find(ID) != nullptr;
+		}
+	});
+	EXPECT_EQ(NestedFound, DenseFound);
+
+	int64_t SideExpected = 0;
+	for(const auto& [ClientID, Items] : Nested)
+		for(const auto& [ID, Record] : Items)
+			SideExpected += CEquippable::Check(Record) && Record.m_Value > 0 && Record.m_Settings;
+	EXPECT_EQ(Sum, SideExpected * NumRounds);
+}
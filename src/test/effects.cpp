@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <game/server/mmocore/Effects.h>
+
+#include <vector>
+
+TEST(Effects, Register)
+{
+	EXPECT_EQ(CEffects::Register("Slowdown"), (int)CEffects::SLOWDOWN);
+	EXPECT_EQ(CEffects::Register("RegenMana"), (int)CEffects::REGEN_MANA);
+
+	const int ID = CEffects::Register("TestEffect");
+	EXPECT_GE(ID, (int)CEffects::NUM_BUILTIN);
+	EXPECT_EQ(CEffects::Register("TestEffect"), ID);
+	EXPECT_STREQ(CEffects::GetName(ID), "TestEffect");
+	EXPECT_STREQ(CEffects::GetName(-1), "unknown");
+}
+
+TEST(Effects, Table)
+{
+	CEffectTable Table;
+	EXPECT_TRUE(Table.IsEmpty());
+	EXPECT_FALSE(Table.IsActive(CEffects::FIRE));
+
+	Table.Give(CEffects::FIRE, 2);
+	Table.Give(CEffects::POISON, 1);
+	Table.Give(-1, 5);
+	EXPECT_EQ(Table.GetSize(), 2);
+	EXPECT_TRUE(Table.IsActive(CEffects::FIRE));
+	EXPECT_TRUE(Table.IsActive(CEffects::POISON));
+
+	// giving an active effect again only resets its time
+	Table.Give(CEffects::FIRE, 3);
+	EXPECT_EQ(Table.GetSize(), 2);
+
+	std::vector<int> vExpired;
+	const auto OnExpire = [&vExpired](int EffectID) { vExpired.push_back(EffectID); };
+	Table.Tick(OnExpire);
+	EXPECT_EQ(vExpired, std::vector<int>({CEffects::POISON}));
+	EXPECT_FALSE(Table.IsActive(CEffects::POISON));
+	EXPECT_TRUE(Table.IsActive(CEffects::FIRE));
+
+	Table.Tick(OnExpire);
+	Table.Tick(OnExpire);
+	EXPECT_EQ(vExpired, std::vector<int>({CEffects::POISON, CEffects::FIRE}));
+	EXPECT_TRUE(Table.IsEmpty());
+
+	for(int i = 0; i < CEffectTable::MAX_SLOTS + 4; i++)
+		Table.Give(i, 10);
+	EXPECT_EQ(Table.GetSize(), (int)CEffectTable::MAX_SLOTS);
+	Table.Clear();
+	EXPECT_TRUE(Table.IsEmpty());
+	EXPECT_FALSE(Table.IsActive(0));
+}
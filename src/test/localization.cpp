@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <teeother/components/localization.h>
+
+#include <cstdio>
+
+static const char gs_aTranslation[] = R"({"translation": [
+	{"key": "Sword", "value": "Schwert"},
+	{"key": "You have {INT} unread letters!", "value": "Du hast {INT} ungelesene Briefe!"},
+	{"key": "{STR} costs {VAL} gold", "value": "{STR} kostet {VAL} Gold"}
+]})";
+
+static const char gs_aChildTranslation[] = R"({"translation": [
+	{"key": "Sword", "value": "Klinge"}
+]})";
+
+static void FormatL(CLocalization& Localization, dynamic_string& Buffer, int LanguageIndex, const char* pText, ...)
+{
+	va_list VarArgs;
+	va_start(VarArgs, pText);
+	Localization.Format_VL(Buffer, LanguageIndex, pText, VarArgs);
+	va_end(VarArgs);
+}
+
+static void SetupLanguages(CLocalization& Localization)
+{
+	Localization.InitConfig(0, nullptr);
+	Localization.AddLanguage("Test", "xx", "")->LoadFromMemory(gs_aTranslation, sizeof(gs_aTranslation) - 1);
+	Localization.AddLanguage("Child", "yy", "xx")->LoadFromMemory(gs_aChildTranslation, sizeof(gs_aChildTranslation) - 1);
+}
+
+TEST(Localization, Format)
+{
+	CLocalization Localization(nullptr);
+	SetupLanguages(Localization);
+	const int Test = Localization.GetLanguageIndex("xx");
+	const int Child = Localization.GetLanguageIndex("yy");
+	EXPECT_EQ(Test, 0);
+	EXPECT_EQ(Child, 1);
+	EXPECT_EQ(Localization.GetLanguageIndex("zz"), -1);
+
+	dynamic_string Buffer;
+	FormatL(Localization, Buffer, Test, "You have {INT} unread letters!", 3);
+	EXPECT_STREQ(Buffer.buffer(), "Du hast 3 ungelesene Briefe!");
+
+	// string parameters are translated as well
+	Buffer.clear();
+	FormatL(Localization, Buffer, Test, "{STR} costs {VAL} gold", "Sword", 1500000);
+	EXPECT_STREQ(Buffer.buffer(), "Schwert kostet 1,500,000 Gold");
+
+	// missing keys are taken from the parent
+	Buffer.clear();
+	FormatL(Localization, Buffer, Child, "{STR} costs {VAL} gold", "Sword", 10);
+	EXPECT_STREQ(Buffer.buffer(), "Klinge kostet 10 Gold");
+
+	// untranslated text, unknown parameters are dropped
+	Buffer.clear();
+	FormatL(Localization, Buffer, Test, "[{FOO}{INT}/{INT}] {STR}", 1, 2, "Sword");
+	EXPECT_STREQ(Buffer.buffer(), "[1/2] Schwert");
+
+	// untranslated formats are cached by their text, not by the buffer holding it
+	char aText[64];
+	str_copy(aText, "Level {INT}", sizeof(aText));
+	Buffer.clear();
+	FormatL(Localization, Buffer, Test, aText, 3);
+	EXPECT_STREQ(Buffer.buffer(), "Level 3");
+	str_copy(aText, "Gold {VAL}!", sizeof(aText));
+	Buffer.clear();
+	FormatL(Localization, Buffer, Test, aText, 2000);
+	EXPECT_STREQ(Buffer.buffer(), "Gold 2,000!");
+
+	// an unclosed parameter swallows the rest
+	Buffer.clear();
+	FormatL(Localization, Buffer, Test, "Level {INT} {broken", 7);
+	EXPECT_STREQ(Buffer.buffer(), "Level 7 ");
+
+	// appends to what is already in the buffer
+	Buffer.copy("- ");
+	FormatL(Localization, Buffer, Test, "Sword");
+	EXPECT_STREQ(Buffer.buffer(), "- Schwert");
+
+	// without any language the text is kept as it is
+	CLocalization Empty(nullptr);
+	Buffer.clear();
+	FormatL(Empty, Buffer, -1, "Level {INT}", 7);
+	EXPECT_STREQ(Buffer.buffer(), "Level {INT}");
+}
+
+TEST(Localization, BufferScope)
+{
+	CLocalization::CBufferScope Outer;
+	Outer.Get().append("outer");
+	{
+		CLocalization::CBufferScope Inner;
+		EXPECT_NE(&Outer.Get(), &Inner.Get());
+		EXPECT_TRUE(Inner.Get().empty());
+	}
+	EXPECT_STREQ(Outer.Get().buffer(), "outer");
+}
+
+// formats a vote menu of 200 lines the way CGS::AVM does, translated and untranslated keys,
+// run it with --gtest_also_run_disabled_tests
+TEST(Localization, DISABLED_Benchmark)
+{
+	CLocalization Localization(nullptr);
+	SetupLanguages(Localization);
+	const int Child = Localization.GetLanguageIndex("yy");
+
+	constexpr int NumRebuilds = 1000;
+	constexpr int NumLines = 200;
+	for(const char* pText : { "{STR} costs {VAL} gold", "Receive {STR}x{VAL} (L{INT})" })
+	{
+		const int64_t Start = time_get_impl();
+		for(int r = 0; r < NumRebuilds; r++)
+		{
+			for(int i = 0; i < NumLines; i++)
+			{
+				CLocalization::CBufferScope BufferScope;
+				dynamic_string& Buffer = BufferScope.Get();
+				Buffer.append("- ");
+				FormatL(Localization, Buffer, Child, pText, "Sword", i * 1000, i);
+			}
+		}
+		const int64_t Time = time_get_impl() - Start;
+		printf("[localization] \"%s\": %.3f us per %d line menu rebuild\n", pText, Time * 1000000.0 / time_freq() / NumRebuilds, NumLines);
+	}
+}
@@ -0,0 +1,80 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/scheduler.h>
+#include <game/server/mmocore/Components/Quests/QuestProgressStore.h>
+
+#include <string>
+
+static std::vector<unsigned char> Bytes(const char* pStr)
+{
+	return std::vector<unsigned char>(pStr, pStr + str_length(pStr));
+}
+
+TEST(QuestProgressStore, ReadsQueuedRecords)
+{
+	CTestInfo Info;
+	const std::string Path = Info.m_aFilename;
+
+	// not started, commits run on the calling thread
+	CScheduler Scheduler;
+	CQuestProgressStore Store(&Scheduler);
+	std::vector<unsigned char> vData;
+	EXPECT_FALSE(Store.Read(Path, &vData));
+
+	Store.Write(Path, "abc", 3);
+	ASSERT_TRUE(Store.Read(Path, &vData));
+	EXPECT_EQ(vData, Bytes("abc"));
+
+	Store.Remove(Path);
+	EXPECT_FALSE(Store.Read(Path, &vData));
+	EXPECT_FALSE(fs_is_file((Path + ".tmp").c_str()));
+}
+
+TEST(QuestProgressStore, GroupCommit)
+{
+	CTestInfo Info;
+	const std::string Path = Info.m_aFilename;
+	const std::string OtherPath = Path + "2";
+
+	CScheduler Scheduler;
+	CQuestProgressStore Store(&Scheduler);
+	Store.SetCommitInterval(60 * 1000);
+	Scheduler.Start(2);
+
+	// a farming session: many kills, nothing reaches the disk before the commit
+	char aBuf[32];
+	for(int i = 0; i < 1000; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "kills %d", i);
+		Store.Write(Path, aBuf, str_length(aBuf));
+	}
+	Store.Write(OtherPath, "x", 1);
+	EXPECT_FALSE(fs_is_file(Path.c_str()));
+
+	std::vector<unsigned char> vData;
+	ASSERT_TRUE(Store.Read(Path, &vData));
+	EXPECT_EQ(vData, Bytes("kills 999"));
+
+	Store.Flush();
+	CQuestProgressStore::CStats Stats = Store.GetStats();
+	EXPECT_EQ(Stats.m_Writes, 1001u);
+	EXPECT_EQ(Stats.m_Coalesced, 999u);
+	EXPECT_EQ(Stats.m_Commits, 1u);
+	EXPECT_EQ(Stats.m_Files, 2u);
+	EXPECT_EQ(Stats.m_Failed, 0u);
+
+	// read back from the file
+	ASSERT_TRUE(fs_is_file(Path.c_str()));
+	EXPECT_FALSE(fs_is_file((Path + ".tmp").c_str()));
+	ASSERT_TRUE(Store.Read(Path, &vData));
+	EXPECT_EQ(vData, Bytes("kills 999"));
+
+	Store.Remove(Path);
+	Store.Remove(OtherPath);
+	Scheduler.Stop();
+	EXPECT_FALSE(fs_is_file(Path.c_str()));
+	EXPECT_FALSE(fs_is_file(OtherPath.c_str()));
+	EXPECT_EQ(Store.GetStats().m_Commits, 2u);
+}
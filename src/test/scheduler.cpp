@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/scheduler.h>
+
+#include <atomic>
+
+TEST(Scheduler, RunsEveryTask)
+{
+	CScheduler Scheduler;
+	Scheduler.Start(4);
+
+	std::atomic<int> Done = 0;
+	for(int i = 0; i < 1000; i++)
+		Scheduler.Add(i % CScheduler::NUM_PRIORITIES, [&Done]() { Done++; });
+
+	// tasks spawned by tasks stay on the worker and get stolen by the others
+	for(int i = 0; i < 10; i++)
+	{
+		Scheduler.Add(CScheduler::PRIORITY_TICK, [&Scheduler, &Done]() {
+			for(int j = 0; j < 100; j++)
+				Scheduler.Add(CScheduler::PRIORITY_BACKGROUND, [&Done]() { Done++; });
+		});
+	}
+
+	Scheduler.Stop();
+	EXPECT_EQ(Done, 2000);
+
+	uint64_t Executed = 0;
+	for(int i = 0; i < CScheduler::NUM_PRIORITIES; i++)
+		Executed += Scheduler.Stats(i).m_Run.Count();
+	EXPECT_EQ(Executed, 2010u);
+}
+
+TEST(Scheduler, Submit)
+{
+	CScheduler Scheduler;
+	Scheduler.Start(2);
+	std::future<int> Result = Scheduler.Submit(CScheduler::PRIORITY_IO, []() { return 42; });
+	EXPECT_EQ(Result.get(), 42);
+	Scheduler.Stop();
+
+	// without workers the task runs on the caller
+	EXPECT_EQ(Scheduler.Submit(CScheduler::PRIORITY_IO, []() { return 7; }).get(), 7);
+}
+
+TEST(Scheduler, Delayed)
+{
+	CScheduler Scheduler;
+	Scheduler.Start(2);
+
+	std::atomic<int> Order = 0;
+	std::atomic<int> Late = 0;
+	std::atomic<int> Early = 0;
+	const int64_t Start = time_get_impl();
+	Scheduler.AddDelayed(CScheduler::PRIORITY_TICK, 60, [&]() { Late = ++Order; });
+	Scheduler.AddDelayed(CScheduler::PRIORITY_TICK, 20, [&]() { Early = ++Order; });
+	while(Order < 2 && time_get_impl() - Start < time_freq() * 5)
+		thread_yield();
+
+	EXPECT_EQ(Early, 1);
+	EXPECT_EQ(Late, 2);
+	EXPECT_GE(time_get_impl() - Start, time_freq() * 60 / 1000);
+
+	// pending timers are run on stop
+	Scheduler.AddDelayed(CScheduler::PRIORITY_BACKGROUND, 100000, [&]() { Order++; });
+	Scheduler.Stop();
+	EXPECT_EQ(Order, 3);
+}
+
+TEST(Scheduler, Histogram)
+{
+	CScheduler::CHistogram Histogram;
+	for(int i = 0; i < 99; i++)
+		Histogram.Add(10);
+	Histogram.Add(5000);
+
+	EXPECT_EQ(Histogram.Count(), 100u);
+	EXPECT_EQ(Histogram.Max(), 5000u);
+	EXPECT_EQ(Histogram.Percentile(0.5), 16u);
+	EXPECT_EQ(Histogram.Percentile(0.999), 8192u);
+}
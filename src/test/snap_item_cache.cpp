@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/snap_item_cache.h>
+#include <engine/shared/snapshot.h>
+
+#include <cstdio>
+#include <algorithm>
+#include <random>
+
+struct CTestPickup
+{
+	int m_X;
+	int m_Y;
+	int m_Type;
+	int m_Subtype;
+};
+
+static bool Clipped(vec2 ViewPos, vec2 CheckPos)
+{
+	if(absolute(ViewPos.x - CheckPos.x) > 1000.0f || absolute(ViewPos.y - CheckPos.y) > 800.0f)
+		return true;
+	return distance(ViewPos, CheckPos) > 1100.0f;
+}
+
+static void AddPickup(CSnapItemCache& Cache, int ID, vec2 Pos, vec2 PosTo)
+{
+	Cache.BeginEntry(Pos, PosTo);
+	CTestPickup* pPickup = static_cast<CTestPickup*>(Cache.NewItem(1, ID, sizeof(CTestPickup)));
+	pPickup->m_X = (int)Pos.x;
+	pPickup->m_Y = (int)Pos.y;
+	pPickup->m_Type = ID % 3;
+	Cache.EndEntry();
+}
+
+static std::vector<int> QueryIDs(const CSnapItemCache& Cache, vec2 Pos, vec2 Range)
+{
+	std::vector<int> vIDs;
+	Cache.Query(Pos - Range, Pos + Range, [&](const CSnapItemCache::CEntry& Entry) {
+		for(int i = Entry.m_FirstItem; i < Entry.m_FirstItem + Entry.m_NumItems; i++)
+			vIDs.push_back(Cache.GetItem(i).m_ID);
+	});
+	std::sort(vIDs.begin(), vIDs.end());
+	return vIDs;
+}
+
+TEST(SnapItemCache, Query)
+{
+	CSnapItemCache Cache;
+	EXPECT_TRUE(QueryIDs(Cache, vec2(0, 0), vec2(1000, 1000)).empty());
+
+	AddPickup(Cache, 1, vec2(100, 100), vec2(100, 100));
+	AddPickup(Cache, 2, vec2(5000, 100), vec2(5000, 100));
+	AddPickup(Cache, 3, vec2(5000, 5000), vec2(5000, 5000));
+
+	// a laser from one end of the map to the other
+	AddPickup(Cache, 4, vec2(100, 5000), vec2(5000, 100));
+
+	// entries without items are dropped
+	Cache.BeginEntry(vec2(100, 100), vec2(100, 100));
+	Cache.EndEntry();
+	Cache.Finish();
+
+	EXPECT_EQ(Cache.NumEntries(), 4);
+	EXPECT_EQ(Cache.NumItems(), 4);
+	EXPECT_EQ(QueryIDs(Cache, vec2(0, 0), vec2(500, 500)), std::vector<int>({1, 4}));
+	EXPECT_EQ(QueryIDs(Cache, vec2(5000, 0), vec2(500, 500)), std::vector<int>({2, 4}));
+	EXPECT_EQ(QueryIDs(Cache, vec2(2500, 2500), vec2(3000, 3000)), std::vector<int>({1, 2, 3, 4}));
+
+	// outside of the map the border cells are visited
+	EXPECT_EQ(QueryIDs(Cache, vec2(9000, 9000), vec2(100, 100)), std::vector<int>({3, 4}));
+
+	const CTestPickup* pPickup = reinterpret_cast<const CTestPickup*>(Cache.GetItemData(Cache.GetItem(1)));
+	EXPECT_EQ(pPickup->m_X, 5000);
+	EXPECT_EQ(pPickup->m_Y, 100);
+	EXPECT_EQ(pPickup->m_Type, 2);
+	EXPECT_EQ(pPickup->m_Subtype, 0);
+
+	Cache.Clear();
+	EXPECT_EQ(Cache.NumEntries(), 0);
+	EXPECT_TRUE(QueryIDs(Cache, vec2(0, 0), vec2(1000, 1000)).empty());
+}
+
+TEST(SnapItemCache, PriorityAdmission)
+{
+	// decoration is cached before the characters and more than fits into a snapshot
+	CSnapItemCache Cache;
+	constexpr int NumLow = CSnapshot::MAX_ITEMS;
+	constexpr int NumHigh = 100;
+	for(int i = 0; i < NumLow; i++)
+	{
+		Cache.BeginEntry(vec2(100, 100), vec2(100, 100), 2, i % 2);
+		Cache.NewItem(2, i, sizeof(CTestPickup));
+		Cache.EndEntry();
+	}
+	for(int i = 0; i < NumHigh; i++)
+	{
+		Cache.BeginEntry(vec2(200, 200), vec2(200, 200), 0);
+		Cache.NewItem(1, i, sizeof(CTestPickup));
+		Cache.EndEntry();
+	}
+	Cache.Finish();
+
+	std::vector<const CSnapItemCache::CEntry*> avByPriority[3];
+	Cache.Collect(vec2(0, 0), vec2(1000, 1000), avByPriority, 3, [](const CSnapItemCache::CEntry&) { return true; });
+	EXPECT_EQ((int)avByPriority[0].size(), NumHigh);
+	EXPECT_TRUE(avByPriority[1].empty());
+	EXPECT_EQ((int)avByPriority[2].size(), NumLow);
+
+	// admitted by priority, what is dropped is decoration only
+	CSnapshotBuilder Builder;
+	Builder.Init();
+	for(const auto& vEntries : avByPriority)
+	{
+		for(const CSnapItemCache::CEntry* pEntry : vEntries)
+		{
+			const CSnapItemCache::CItem& Item = Cache.GetItem(pEntry->m_FirstItem);
+			Builder.NewItem(Item.m_Type, Item.m_ID, Item.m_Size);
+		}
+	}
+	for(int i = 0; i < NumHigh; i++)
+		EXPECT_NE(Builder.GetItemData((1 << 16) | i), nullptr);
+	EXPECT_EQ(Builder.NumDropped(), NumHigh + NumLow - (CSnapshot::MAX_ITEMS - 1));
+
+	// the filter skips entries, here the details
+	Cache.Collect(vec2(0, 0), vec2(1000, 1000), avByPriority, 3, [](const CSnapItemCache::CEntry& Entry) { return !Entry.m_Detail; });
+	EXPECT_EQ((int)avByPriority[0].size(), NumHigh);
+	EXPECT_EQ((int)avByPriority[2].size(), NumLow / 2);
+}
+
+// one snapshot tick for 24 players: every entity snapped per client against the cache copied per client,
+// run it with --gtest_also_run_disabled_tests
+TEST(SnapItemCache, DISABLED_Benchmark)
+{
+	constexpr int NumPlayers = 24;
+	constexpr int NumEntities = 2000;
+	constexpr int NumRounds = 50;
+	const vec2 MapSize = vec2(16000.0f, 8000.0f);
+	const vec2 ViewRange = vec2(1000.0f, 800.0f);
+
+	std::mt19937 Rng(1);
+	std::uniform_real_distribution<float> RandomX(0.0f, MapSize.x);
+	std::uniform_real_distribution<float> RandomY(0.0f, MapSize.y);
+
+	std::vector<vec2> vEntities;
+	for(int i = 0; i < NumEntities; i++)
+		vEntities.emplace_back(RandomX(Rng), RandomY(Rng));
+
+	// players gather in a few places like towns and farming spots
+	std::vector<vec2> vViews;
+	for(int i = 0; i < NumPlayers; i++)
+		vViews.push_back(vEntities[(i % 6) * 7] + vec2(i * 20.0f, 0.0f));
+
+	static char s_aData[CSnapshot::MAX_SIZE];
+	CSnapshot* pSnap = reinterpret_cast<CSnapshot*>(s_aData);
+	CSnapshotBuilder Builder;
+	CSnapItemCache Cache;
+
+	int64_t PerClientItems = 0;
+	int64_t CachedItems = 0;
+	int64_t PerClientCrc = 0;
+	int64_t CachedCrc = 0;
+	const auto Measure = [&](const char* pName, auto&& Func)
+	{
+		const int64_t Start = time_get_impl();
+		for(int r = 0; r < NumRounds; r++)
+			Func();
+		const int64_t Time = time_get_impl() - Start;
+		printf("[snap_item_cache] %s: %.3f us per snapshot tick\n", pName, Time * 1000000.0 / time_freq() / NumRounds);
+	};
+
+	Measure("per client snap", [&]() {
+		for(vec2 View : vViews)
+		{
+			Builder.Init();
+			for(int i = 0; i < NumEntities; i++)
+			{
+				if(Clipped(View, vEntities[i]))
+					continue;
+				CTestPickup* pPickup = static_cast<CTestPickup*>(Builder.NewItem(1, i, sizeof(CTestPickup)));
+				if(!pPickup)
+					continue;
+				pPickup->m_X = (int)vEntities[i].x;
+				pPickup->m_Y = (int)vEntities[i].y;
+				pPickup->m_Type = i % 3;
+			}
+			Builder.Finish(pSnap);
+			PerClientItems += pSnap->NumItems();
+			PerClientCrc += pSnap->Crc();
+		}
+	});
+
+	Measure("shared cache", [&]() {
+		Cache.Clear();
+		for(int i = 0; i < NumEntities; i++)
+			AddPickup(Cache, i, vEntities[i], vEntities[i]);
+		Cache.Finish();
+
+		for(vec2 View : vViews)
+		{
+			Builder.Init();
+			Cache.Query(View - ViewRange, View + ViewRange, [&](const CSnapItemCache::CEntry& Entry) {
+				if(Clipped(View, Entry.m_Pos) && Clipped(View, Entry.m_PosTo))
+					return;
+				for(int i = Entry.m_FirstItem; i < Entry.m_FirstItem + Entry.m_NumItems; i++)
+				{
+					const CSnapItemCache::CItem& Item = Cache.GetItem(i);
+					void* pData = Builder.NewItem(Item.m_Type, Item.m_ID, Item.m_Size);
+					if(pData)
+						mem_copy(pData, Cache.GetItemData(Item), Item.m_Size);
+				}
+			});
+			Builder.Finish(pSnap);
+			CachedItems += pSnap->NumItems();
+			CachedCrc += pSnap->Crc();
+		}
+	});
+
+	// same items in every snapshot, only the order differs
+	EXPECT_GT(PerClientItems, 0);
+	EXPECT_EQ(PerClientItems, CachedItems);
+	EXPECT_EQ(PerClientCrc, CachedCrc);
+}
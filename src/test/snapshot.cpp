@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/snapshot.h>
+
+#include <cstdio>
+
+static int BuildSnapshot(CSnapshotBuilder& Builder, char* pData, int NumItems, int Tick)
+{
+	Builder.Init();
+	for(int i = 0; i < NumItems; i++)
+	{
+		int* pItem = static_cast<int*>(Builder.NewItem(1 + i % 4, i, 4 * sizeof(int)));
+		pItem[0] = i;
+		pItem[1] = i % 7 ? Tick : 0; // a part of the items changes every tick
+		pItem[2] = -i;
+	}
+	return Builder.Finish(pData);
+}
+
+TEST(Snapshot, DeltaWithStoredKeyHash)
+{
+	static char s_aFrom[CSnapshot::MAX_SIZE];
+	static char s_aTo[CSnapshot::MAX_SIZE];
+	static char s_aDelta[CSnapshot::MAX_SIZE];
+	static char s_aCachedDelta[CSnapshot::MAX_SIZE];
+	static char s_aUnpacked[CSnapshot::MAX_SIZE];
+
+	CSnapshotBuilder Builder;
+	CSnapshotDelta Delta;
+	CSnapshotStorage Storage;
+
+	const int FromSize = BuildSnapshot(Builder, s_aFrom, 600, 1);
+	Storage.Add(1, 0, FromSize, s_aFrom, 0, nullptr);
+	const int ToSize = BuildSnapshot(Builder, s_aTo, 500, 2);
+	CSnapshot* pTo = reinterpret_cast<CSnapshot*>(s_aTo);
+
+	const CSnapshot* pFrom = nullptr;
+	const CSnapshotDelta::CKeyHash* pKeyHash = nullptr;
+	ASSERT_EQ(Storage.Get(1, nullptr, &pFrom, nullptr, &pKeyHash), FromSize);
+	ASSERT_NE(pKeyHash, nullptr);
+
+	// the hash is built once per stored snapshot
+	const CSnapshotDelta::CKeyHash* pAgain = nullptr;
+	Storage.Get(1, nullptr, nullptr, nullptr, &pAgain);
+	EXPECT_EQ(pAgain, pKeyHash);
+	EXPECT_EQ(pKeyHash->Find(pFrom->GetItem(17)->Key()), 17);
+	EXPECT_EQ(pKeyHash->Find(-5), -1);
+
+	const int DeltaSize = Delta.CreateDelta(pFrom, pTo, s_aDelta);
+	const int CachedSize = Delta.CreateDelta(pFrom, pTo, s_aCachedDelta, pKeyHash);
+	ASSERT_GT(DeltaSize, 0);
+	ASSERT_EQ(DeltaSize, CachedSize);
+	EXPECT_EQ(mem_comp(s_aDelta, s_aCachedDelta, DeltaSize), 0);
+
+	const int UnpackedSize = Delta.UnpackDelta(pFrom, reinterpret_cast<CSnapshot*>(s_aUnpacked), s_aDelta, DeltaSize);
+	ASSERT_EQ(UnpackedSize, ToSize);
+	EXPECT_EQ(mem_comp(s_aUnpacked, s_aTo, ToSize), 0);
+
+	// nothing changed, nothing to send
+	EXPECT_EQ(Delta.CreateDelta(pTo, pTo, s_aDelta), 0);
+}
+
+// one delta per client against a base snapshot that is used for several ticks,
+// run it with --gtest_also_run_disabled_tests
+TEST(Snapshot, DISABLED_DeltaBenchmark)
+{
+	constexpr int NumClients = 24;
+	constexpr int NumRounds = 200;
+	static char s_aFrom[CSnapshot::MAX_SIZE];
+	static char s_aTo[CSnapshot::MAX_SIZE];
+	static char s_aDelta[CSnapshot::MAX_SIZE];
+
+	CSnapshotBuilder Builder;
+	CSnapshotDelta Delta;
+	CSnapshotStorage Storage;
+	Storage.Add(1, 0, BuildSnapshot(Builder, s_aFrom, 800, 1), s_aFrom, 0, nullptr);
+	BuildSnapshot(Builder, s_aTo, 800, 2);
+	CSnapshot* pTo = reinterpret_cast<CSnapshot*>(s_aTo);
+
+	const CSnapshot* pFrom = nullptr;
+	const CSnapshotDelta::CKeyHash* pKeyHash = nullptr;
+	Storage.Get(1, nullptr, &pFrom, nullptr, &pKeyHash);
+
+	int64_t Sum = 0;
+	const auto Measure = [&](const char* pName, const CSnapshotDelta::CKeyHash* pHash)
+	{
+		const int64_t Start = time_get_impl();
+		for(int r = 0; r < NumRounds; r++)
+			for(int c = 0; c < NumClients; c++)
+				Sum += Delta.CreateDelta(pFrom, pTo, s_aDelta, pHash);
+		const int64_t Time = time_get_impl() - Start;
+		printf("[snapshot] %s: %.3f us per snapshot tick\n", pName, Time * 1000000.0 / time_freq() / NumRounds);
+	};
+	Measure("delta, base hashed every call", nullptr);
+	Measure("delta, stored base hash", pKeyHash);
+	EXPECT_GT(Sum, 0);
+}
+
+TEST(Snapshot, BuilderCountsDroppedItems)
+{
+	static char s_aData[CSnapshot::MAX_SIZE];
+	CSnapshotBuilder Builder;
+	Builder.Init();
+
+	// what is added first stays in, the rest is counted
+	int Added = 0;
+	for(int i = 0; i < CSnapshot::MAX_ITEMS + 100; i++)
+		Added += Builder.NewItem(1, i, 2 * sizeof(int)) != nullptr;
+	EXPECT_EQ(Added, CSnapshot::MAX_ITEMS - 1);
+	EXPECT_EQ(Builder.NumDropped(), 101);
+	EXPECT_NE(Builder.GetItemData((1 << 16) | 0), nullptr);
+	Builder.Finish(s_aData);
+
+	Builder.Init();
+	EXPECT_EQ(Builder.NumDropped(), 0);
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <game/server/spatial_grid.h>
+
+#include <cstdio>
+#include <random>
+
+struct CGridItem
+{
+	vec2 m_Pos;
+	CSpatialGridHandle m_Handle;
+};
+
+static int CountInRadius(const CSpatialGrid<CGridItem>& Grid, vec2 Pos, float Radius)
+{
+	int Num = 0;
+	const vec2 Margin = vec2(Radius, Radius);
+	Grid.Query(Pos - Margin, Pos + Margin, [&](CGridItem* pItem) {
+		if(distance(pItem->m_Pos, Pos) < Radius)
+			Num++;
+		return true;
+	});
+	return Num;
+}
+
+static int CountInRadius(const std::vector<CGridItem>& vItems, vec2 Pos, float Radius)
+{
+	int Num = 0;
+	for(const auto& Item : vItems)
+	{
+		if(distance(Item.m_Pos, Pos) < Radius)
+			Num++;
+	}
+	return Num;
+}
+
+TEST(SpatialGrid, InsertMoveRemove)
+{
+	CSpatialGrid<CGridItem> Grid;
+	Grid.Init(1024.0f, 1024.0f, 256.0f);
+
+	CGridItem aItems[3] = {{vec2(10.0f, 10.0f), {}}, {vec2(500.0f, 500.0f), {}}, {vec2(-100.0f, 2000.0f), {}}};
+	for(auto& Item : aItems)
+		Grid.Insert(&Item, Item.m_Handle, Item.m_Pos);
+	EXPECT_EQ(Grid.Size(), 3);
+
+	// outside of the map, kept in a border cell
+	EXPECT_EQ(CountInRadius(Grid, vec2(-100.0f, 2000.0f), 1.0f), 1);
+	EXPECT_EQ(CountInRadius(Grid, vec2(0.0f, 0.0f), 100.0f), 1);
+
+	aItems[0].m_Pos = vec2(900.0f, 900.0f);
+	EXPECT_TRUE(Grid.Move(aItems[0].m_Handle, aItems[0].m_Pos));
+	EXPECT_EQ(CountInRadius(Grid, vec2(0.0f, 0.0f), 100.0f), 0);
+	EXPECT_EQ(CountInRadius(Grid, vec2(900.0f, 900.0f), 10.0f), 1);
+
+	Grid.Remove(aItems[1].m_Handle);
+	EXPECT_FALSE(aItems[1].m_Handle.IsLinked());
+	EXPECT_EQ(CountInRadius(Grid, vec2(500.0f, 500.0f), 10.0f), 0);
+	EXPECT_EQ(Grid.Size(), 2);
+
+	// resizing keeps the items
+	Grid.Init(4096.0f, 4096.0f, 512.0f);
+	EXPECT_EQ(CountInRadius(Grid, vec2(900.0f, 900.0f), 10.0f), 1);
+	EXPECT_EQ(CountInRadius(Grid, vec2(-100.0f, 2000.0f), 1.0f), 1);
+}
+
+// compares grid queries with a list walk on a 500x500 tiles map,
+// run it with --gtest_also_run_disabled_tests
+TEST(SpatialGrid, DISABLED_Benchmark)
+{
+	constexpr float MapSize = 500.0f * 32.0f;
+	constexpr float Radius = 400.0f;
+	constexpr int NumQueries = 2000;
+
+	for(int NumItems : {100, 1000, 10000})
+	{
+		std::mt19937 Rng(NumItems);
+		std::uniform_real_distribution<float> Coord(0.0f, MapSize);
+
+		std::vector<CGridItem> vItems(NumItems);
+		CSpatialGrid<CGridItem> Grid;
+		Grid.Init(MapSize, MapSize, 256.0f);
+		for(auto& Item : vItems)
+		{
+			Item.m_Pos = vec2(Coord(Rng), Coord(Rng));
+			Grid.Insert(&Item, Item.m_Handle, Item.m_Pos);
+		}
+
+		std::vector<vec2> vQueries(NumQueries);
+		for(auto& Query : vQueries)
+			Query = vec2(Coord(Rng), Coord(Rng));
+
+		int64_t Start = time_get_impl();
+		int ListFound = 0;
+		for(const auto& Query : vQueries)
+			ListFound += CountInRadius(vItems, Query, Radius);
+		const int64_t ListTime = time_get_impl() - Start;
+
+		Start = time_get_impl();
+		int GridFound = 0;
+		for(const auto& Query : vQueries)
+			GridFound += CountInRadius(Grid, Query, Radius);
+		const int64_t GridTime = time_get_impl() - Start;
+
+		EXPECT_EQ(ListFound, GridFound);
+		printf("[spatial_grid] %5d entities: list %.3f us/query, grid %.3f us/query\n", NumItems,
+			ListTime * 1000000.0 / time_freq() / NumQueries, GridTime * 1000000.0 / time_freq() / NumQueries);
+	}
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+// a socket on localhost that sends to itself
+static NETSOCKET CreateLoopback(NETADDR *pAddr)
+{
+	for(int Port = 28303; Port < 28403; Port++)
+	{
+		char aAddr[32];
+		str_format(aAddr, sizeof(aAddr), "127.0.0.1:%d", Port);
+		net_addr_from_str(pAddr, aAddr);
+		NETSOCKET Socket = net_udp_create(*pAddr);
+		if(Socket)
+			return Socket;
+	}
+	return nullptr;
+}
+
+static int ReceiveAll(NETSOCKET Socket, int *pSum)
+{
+	int Received = 0;
+	NETADDR From;
+	unsigned char *pData;
+	while(net_socket_read_wait(Socket, 100000) > 0)
+	{
+		int Bytes;
+		while((Bytes = net_udp_recv(Socket, &From, &pData)) > 0)
+		{
+			*pSum += pData[0];
+			Received++;
+		}
+	}
+	return Received;
+}
+
+TEST(UdpBatch, SendsQueuedPackets)
+{
+	net_init();
+	NETADDR Addr;
+	NETSOCKET Socket = CreateLoopback(&Addr);
+	ASSERT_TRUE(Socket);
+
+	// more than fit into one sendmmsg
+	constexpr int NumPackets = 200;
+	unsigned char aData[100] = {};
+	int Expected = 0;
+	NETSTATS Before;
+	net_stats(&Before);
+
+	net_udp_batch_begin(Socket);
+	for(int i = 0; i < NumPackets; i++)
+	{
+		aData[0] = i % 7;
+		Expected += aData[0];
+		EXPECT_EQ(net_udp_send(Socket, &Addr, aData, 1 + i % (int)sizeof(aData)), 1 + i % (int)sizeof(aData));
+	}
+	const int Syscalls = net_udp_batch_flush(Socket);
+
+	NETSTATS After;
+	net_stats(&After);
+	EXPECT_EQ(After.sent_packets - Before.sent_packets, (uint64_t)NumPackets);
+#if defined(CONF_PLATFORM_LINUX)
+	EXPECT_EQ(Syscalls, 2);
+	EXPECT_EQ(After.sent_syscalls - Before.sent_syscalls, 2u);
+#else
+	EXPECT_EQ(Syscalls, 0);
+#endif
+
+	// nothing is held back once flushed
+	int Sum = 0;
+	EXPECT_EQ(ReceiveAll(Socket, &Sum), NumPackets);
+	EXPECT_EQ(Sum, Expected);
+
+	// and sends go straight out again
+	net_stats(&Before);
+	aData[0] = 5;
+	net_udp_send(Socket, &Addr, aData, 10);
+	net_stats(&After);
+	EXPECT_EQ(After.sent_syscalls - Before.sent_syscalls, 1u);
+	Sum = 0;
+	EXPECT_EQ(ReceiveAll(Socket, &Sum), 1);
+	EXPECT_EQ(Sum, 5);
+
+	net_udp_close(Socket);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <game/server/vote_delta.h>
+
+#include <algorithm>
+#include <random>
+
+// client side of the vote list, options are appended or the first one with a description is removed
+static void ApplyDelta(std::vector<std::string>& vClient, const std::vector<std::string>& vSent, const std::vector<std::string>& vNew)
+{
+	const int Keep = CVoteDelta::KeepPrefix(vSent, (int)vNew.size(), [&](int Index) { return std::string_view(vNew[Index]); });
+	for(int i = Keep; i < (int)vSent.size(); i++)
+	{
+		auto Iter = std::find(vClient.begin(), vClient.end(), vSent[i]);
+		ASSERT_NE(Iter, vClient.end());
+		vClient.erase(Iter);
+	}
+	for(int i = Keep; i < (int)vNew.size(); i++)
+		vClient.push_back(vNew[i]);
+}
+
+TEST(VoteDelta, KeepPrefix)
+{
+	const auto Keep = [](const std::vector<std::string>& vSent, const std::vector<std::string>& vNew) {
+		return CVoteDelta::KeepPrefix(vSent, (int)vNew.size(), [&](int Index) { return std::string_view(vNew[Index]); });
+	};
+
+	EXPECT_EQ(Keep({}, {"a", "b"}), 0);
+	EXPECT_EQ(Keep({"a", "b"}, {"a", "b"}), 2);
+	EXPECT_EQ(Keep({"a", "b"}, {"a", "b", "c"}), 2);
+	EXPECT_EQ(Keep({"a", "b", "c"}, {"a", "b", "d"}), 2);
+	EXPECT_EQ(Keep({"a", "b", "c"}, {"a"}), 1);
+
+	EXPECT_EQ(Keep({"a", "-", "b", "-", "c"}, {"a", "-", "b", "-", "d"}), 4);
+
+	// removing the second "-" would take out the first one
+	EXPECT_EQ(Keep({"a", "-", "b", "-", "c"}, {"a", "-", "b", "d"}), 1);
+	EXPECT_EQ(Keep({"-", "a", "-"}, {"-", "a"}), 0);
+}
+
+TEST(VoteDelta, Converges)
+{
+	std::mt19937 Rng(1);
+	const std::vector<std::string> vWords = {"-", "null", "Back", "Sword", "Shield", "Gold", "Letter", "Accept", "Delete"};
+	std::uniform_int_distribution<int> Word(0, (int)vWords.size() - 1);
+	std::uniform_int_distribution<int> Length(0, 40);
+
+	std::vector<std::string> vSent;
+	std::vector<std::string> vClient;
+	for(int Round = 0; Round < 2000; Round++)
+	{
+		// mostly small edits of the previous menu, sometimes a new one
+		std::vector<std::string> vNew = vSent;
+		if(Round % 7 == 0)
+			vNew.clear();
+		const int Edits = Length(Rng) % 5;
+		for(int e = 0; e < Edits; e++)
+		{
+			const int Pos = vNew.empty() ? 0 : (int)(Rng() % (vNew.size() + 1));
+			if(!vNew.empty() && Rng() % 2)
+				vNew.erase(vNew.begin() + std::min(Pos, (int)vNew.size() - 1));
+			else
+				vNew.insert(vNew.begin() + Pos, vWords[Word(Rng)]);
+		}
+		if(vNew.empty())
+		{
+			for(int i = Length(Rng); i > 0; i--)
+				vNew.push_back(vWords[Word(Rng)]);
+		}
+
+		ApplyDelta(vClient, vSent, vNew);
+		ASSERT_EQ(vClient, vNew) << "round " << Round;
+		vSent = vNew;
+	}
+}
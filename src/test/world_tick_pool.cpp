@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+#include <base/system.h>
+#include <engine/server/world_tick_pool.h>
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+TEST(WorldTickPool, RunsEveryWorldOnce)
+{
+	constexpr int NumWorlds = 9;
+	CWorldTickPool Pool;
+	Pool.Start(3);
+
+	std::atomic<int> aRuns[NumWorlds] {};
+	for(int Tick = 0; Tick < 100; Tick++)
+	{
+		Pool.Run(NumWorlds, [&aRuns](int WorldID) { aRuns[WorldID]++; });
+
+		// the barrier: every world of this tick is done once Run returns
+		for(int i = 0; i < NumWorlds; i++)
+			ASSERT_EQ(aRuns[i], Tick + 1);
+	}
+
+	Pool.Stop();
+	EXPECT_EQ(Pool.NumThreads(), 0);
+}
+
+// tick time against world count, serial and on the pool, the worlds do a fixed amount of work each,
+// run it with --gtest_also_run_disabled_tests
+TEST(WorldTickPool, DISABLED_Benchmark)
+{
+	constexpr int NumTicks = 200;
+	constexpr int WorldWork = 200000;
+	const int NumThreads = maximum(1, (int)std::thread::hardware_concurrency() - 1);
+
+	std::atomic<uint64_t> Sink = 0;
+	const auto TickWorld = [&Sink](int WorldID) {
+		uint64_t Value = WorldID + 1;
+		for(int i = 0; i < WorldWork; i++)
+			Value = Value * 6364136223846793005ULL + 1442695040888963407ULL;
+		Sink += Value;
+	};
+
+	const auto Measure = [&](CWorldTickPool& Pool, int NumWorlds) {
+		const int64_t Start = time_get_impl();
+		for(int Tick = 0; Tick < NumTicks; Tick++)
+			Pool.Run(NumWorlds, TickWorld);
+		return (time_get_impl() - Start) * 1000.0 / time_freq() / NumTicks;
+	};
+
+	CWorldTickPool Serial;
+	CWorldTickPool Parallel;
+	Parallel.Start(NumThreads);
+	for(int NumWorlds : { 1, 2, 4, 8, 16 })
+	{
+		const double SerialMs = Measure(Serial, NumWorlds);
+		const double ParallelMs = Measure(Parallel, NumWorlds);
+		printf("[world_tick_pool] worlds=%d threads=%d serial=%.3fms parallel=%.3fms speedup=%.2fx\n", NumWorlds, NumThreads, SerialMs, ParallelMs, SerialMs / ParallelMs);
+	}
+	EXPECT_NE(Sink, 0u);
+}